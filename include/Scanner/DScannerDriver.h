@@ -291,6 +291,28 @@ public:
      */
     virtual QByteArray readScanData() = 0;
     
+    /**
+     * @brief Check whether the driver can write scan data into caller memory
+     * @return true if readScanDataInto() is implemented without intermediate copies
+     */
+    virtual bool supportsDirectRead() const { return false; }
+    
+    /**
+     * @brief Read scan data directly into a caller-provided buffer
+     * @param buffer Destination memory, e.g. the scan lines of an ImageBuffer or a pool block
+     * @param maxLength Capacity of the destination in bytes
+     * @return Number of bytes written, 0 at end of scan, -1 on error or if unsupported
+     *
+     * Drivers that override this should also override supportsDirectRead().
+     * The default implementation is unsupported; callers fall back to readScanData().
+     */
+    virtual qint64 readScanDataInto(quint8 *buffer, qint64 maxLength)
+    {
+        Q_UNUSED(buffer)
+        Q_UNUSED(maxLength)
+        return -1;
+    }
+    
     /**
      * @brief Cleanup driver resources
      */
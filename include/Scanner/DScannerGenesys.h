@@ -197,6 +197,8 @@ public:
     void stopScan() override;
     void cancelScan() override;
     QByteArray readScanData() override;
+    bool supportsDirectRead() const override;
+    qint64 readScanDataInto(quint8 *buffer, qint64 maxLength) override;
     void cleanup() override;
     bool pauseScan() override;
     bool resumeScan() override;
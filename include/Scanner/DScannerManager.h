@@ -61,6 +61,13 @@ public:
     // Device Discovery
     /**
      * @brief Discover available scanner devices
+     *
+     * Returns the current device list immediately. All backends are queried
+     * concurrently in the background when the list is older than the cache
+     * TTL or a refresh is forced; new devices are reported through
+     * deviceDiscovered() as each backend answers, and deviceListRefreshed()
+     * follows once every backend has answered or missed its deadline.
+     *
      * @param forceRefresh Force refresh of device list
      * @return List of available devices
      */
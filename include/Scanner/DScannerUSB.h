@@ -12,6 +12,8 @@
 #include <QByteArray>
 #include <QList>
 
+#include <functional>
+
 DSCANNER_BEGIN_NAMESPACE
 
 /**
@@ -120,6 +122,54 @@ struct USBDeviceDescriptor {
     {}
 };
 
+/**
+ * @brief 流式批量输入配置
+ */
+struct USBStreamConfig {
+    quint8 endpoint;        ///< 输入端点地址
+    int bufferCount;        ///< 同时在途的传输数量
+    int bufferSize;         ///< 每个传输缓冲区大小（字节）
+    int timeout;            ///< 单个传输超时（毫秒），0表示不超时
+    qint64 totalBytes;      ///< 预期接收的总字节数，0表示直到停止
+    
+    USBStreamConfig()
+        : endpoint(0)
+        , bufferCount(8)
+        , bufferSize(256 * 1024)
+        , timeout(5000)
+        , totalBytes(0)
+    {}
+};
+
+/**
+ * @brief 流式批量输入统计
+ */
+struct USBStreamStatistics {
+    qint64 bytesReceived;       ///< 已接收字节数
+    int completedTransfers;     ///< 成功完成的传输数
+    int failedTransfers;        ///< 失败的传输数
+    qint64 elapsedMs;           ///< 流持续时间（毫秒）
+    double throughputMBps;      ///< 实际吞吐量（MB/s）
+    int lastStatus;             ///< 最后一次失败的libusb传输状态，0表示无错误
+    
+    USBStreamStatistics()
+        : bytesReceived(0)
+        , completedTransfers(0)
+        , failedTransfers(0)
+        , elapsedMs(0)
+        , throughputMBps(0.0)
+        , lastStatus(0)
+    {}
+};
+
+/**
+ * @brief 流式数据回调
+ *
+ * 在USB事件线程中按提交顺序调用，data仅在回调期间有效，回调返回后
+ * 缓冲区立即重新提交；返回false停止数据流。
+ */
+typedef std::function<bool(const quint8 *data, int length)> USBStreamCallback;
+
 /**
  * @brief USB通信接口
  * 
@@ -249,6 +299,18 @@ public:
      */
     QByteArray bulkTransferIn(quint8 endpoint, int maxLength, int timeout = 1000);
 
+    /**
+     * @brief 批量传输（输入，直接写入调用方内存）
+     * @param endpoint 端点地址
+     * @param buffer 接收缓冲区，例如图像缓冲区的扫描行
+     * @param length 缓冲区长度
+     * @param timeout 超时时间（毫秒）
+     * @return 实际接收的字节数，失败返回-1
+     *
+     * 与 bulkTransferIn() 不同，不分配中间 QByteArray，也不发出 dataReceived 信号。
+     */
+    int bulkTransferInto(quint8 endpoint, quint8 *buffer, int length, int timeout = 1000);
+
     /**
      * @brief 中断传输（输出）
      * @param endpoint 端点地址
@@ -267,6 +329,39 @@ public:
      */
     QByteArray interruptTransferIn(quint8 endpoint, int maxLength, int timeout = 1000);
 
+    // 流式批量输入
+    /**
+     * @brief 启动多缓冲异步批量输入流
+     * @param config 流配置
+     * @param callback 数据回调，直接接收传输缓冲区，不做拷贝
+     * @return 是否成功提交全部传输
+     */
+    bool startBulkStream(const USBStreamConfig &config, const USBStreamCallback &callback);
+
+    /**
+     * @brief 停止批量输入流，取消所有在途传输
+     */
+    void stopBulkStream();
+
+    /**
+     * @brief 等待批量输入流结束
+     * @param timeout 超时时间（毫秒），-1表示一直等待
+     * @return 流在超时前结束返回true
+     */
+    bool waitForBulkStream(int timeout = -1);
+
+    /**
+     * @brief 检查批量输入流是否仍在运行
+     * @return 是否运行中
+     */
+    bool isBulkStreamActive() const;
+
+    /**
+     * @brief 获取当前（或最近一次）批量输入流的统计信息
+     * @return 流统计
+     */
+    USBStreamStatistics bulkStreamStatistics() const;
+
     // 设备信息查询
     /**
      * @brief 获取当前设备描述符
@@ -364,6 +459,12 @@ signals:
      */
     void errorOccurred(int errorCode, const QString &errorMessage);
 
+    /**
+     * @brief 批量输入流结束信号
+     * @param statistics 流统计
+     */
+    void bulkStreamFinished(const USBStreamStatistics &statistics);
+
 private slots:
     void processUSBEvents();
     void checkDeviceStatus();
@@ -382,5 +483,6 @@ Q_DECLARE_METATYPE(DSCANNER_NAMESPACE::USBEndpoint)
 Q_DECLARE_METATYPE(DSCANNER_NAMESPACE::USBInterface)
 Q_DECLARE_METATYPE(DSCANNER_NAMESPACE::USBConfiguration)
 Q_DECLARE_METATYPE(DSCANNER_NAMESPACE::USBDeviceDescriptor)
+Q_DECLARE_METATYPE(DSCANNER_NAMESPACE::USBStreamStatistics)
 
 #endif // DSCANNERUSB_H 
\ No newline at end of file
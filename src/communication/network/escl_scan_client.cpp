@@ -0,0 +1,770 @@
+// SPDX-FileCopyrightText: 2024 DeepinScan Team
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "escl_scan_client.h"
+
+#include <QImage>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QXmlStreamWriter>
+
+#include <cstring>
+
+#ifdef HAVE_LIBJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+DSCANNER_USE_NAMESPACE
+
+Q_LOGGING_CATEGORY(esclScanClient, "deepinscan.network.escl")
+
+namespace {
+constexpr qint64 kHighWaterBytes = 4 * 1024 * 1024;    // 超过后暂停从网络读取
+constexpr qint64 kLowWaterBytes = 1024 * 1024;         // 低于后恢复读取
+constexpr qint64 kReadBufferSize = 256 * 1024;         // QNetworkReply内部缓冲上限
+constexpr qint64 kPullChunkSize = 64 * 1024;
+constexpr int kBusyRetryDelay = 1000;
+constexpr int kMaxBusyRetries = 30;
+
+QString mimeType(const QString &contentType)
+{
+    return contentType.section(QLatin1Char(';'), 0, 0).trimmed().toLower();
+}
+}
+
+QByteArray EsclScanSettings::toXml() const
+{
+    QByteArray xml;
+    QXmlStreamWriter writer(&xml);
+    writer.writeStartDocument();
+    writer.writeNamespace(QStringLiteral("http://schemas.hp.com/imaging/escl/2011/05/03"), QStringLiteral("scan"));
+    writer.writeNamespace(QStringLiteral("http://www.pwg.org/schemas/2010/12/sm"), QStringLiteral("pwg"));
+
+    const QString scan = QStringLiteral("http://schemas.hp.com/imaging/escl/2011/05/03");
+    const QString pwg = QStringLiteral("http://www.pwg.org/schemas/2010/12/sm");
+
+    writer.writeStartElement(scan, QStringLiteral("ScanSettings"));
+    writer.writeTextElement(pwg, QStringLiteral("Version"), QStringLiteral("2.0"));
+    if (!region.isEmpty()) {
+        writer.writeStartElement(pwg, QStringLiteral("ScanRegions"));
+        writer.writeStartElement(pwg, QStringLiteral("ScanRegion"));
+        writer.writeTextElement(pwg, QStringLiteral("ContentRegionUnits"), QStringLiteral("escl:ThreeHundredthsOfInches"));
+        writer.writeTextElement(pwg, QStringLiteral("XOffset"), QString::number(region.x()));
+        writer.writeTextElement(pwg, QStringLiteral("YOffset"), QString::number(region.y()));
+        writer.writeTextElement(pwg, QStringLiteral("Width"), QString::number(region.width()));
+        writer.writeTextElement(pwg, QStringLiteral("Height"), QString::number(region.height()));
+        writer.writeEndElement();
+        writer.writeEndElement();
+    }
+    writer.writeTextElement(pwg, QStringLiteral("InputSource"), inputSource);
+    writer.writeTextElement(scan, QStringLiteral("ColorMode"), colorMode);
+    writer.writeTextElement(scan, QStringLiteral("XResolution"), QString::number(resolution));
+    writer.writeTextElement(scan, QStringLiteral("YResolution"), QString::number(resolution));
+    writer.writeTextElement(pwg, QStringLiteral("DocumentFormat"), documentFormat);
+    writer.writeTextElement(scan, QStringLiteral("DocumentFormatExt"), documentFormat);
+    writer.writeEndElement();
+    writer.writeEndDocument();
+    return xml;
+}
+
+// =============================================================================
+// 解码器
+// =============================================================================
+
+class EsclPageStream::Decoder
+{
+public:
+    explicit Decoder(EsclPageStream *stream) : m_stream(stream) {}
+    virtual ~Decoder() = default;
+
+    virtual bool readHeader(int &width, int &height, int &channels) = 0;
+    virtual bool readRow(quint8 *data, int bytesPerLine) = 0;
+    QString errorString() const { return m_error; }
+
+protected:
+    EsclPageStream *m_stream;
+    QString m_error;
+};
+
+// 未压缩的交错行数据，几何尺寸来自扫描参数
+class EsclPageStream::RawDecoder : public EsclPageStream::Decoder
+{
+public:
+    using Decoder::Decoder;
+
+    bool readHeader(int &width, int &height, int &channels) override
+    {
+        const EsclScanSettings &settings = m_stream->m_settings;
+        if (settings.region.isEmpty() || settings.resolution <= 0) {
+            m_error = QStringLiteral("未压缩数据需要在扫描参数中指定区域");
+            return false;
+        }
+        width = static_cast<int>(static_cast<qint64>(settings.region.width()) * settings.resolution / 300);
+        height = static_cast<int>(static_cast<qint64>(settings.region.height()) * settings.resolution / 300);
+        channels = settings.colorMode.startsWith(QLatin1String("Grayscale")) ? 1 : 3;
+        return width > 0 && height > 0;
+    }
+
+    bool readRow(quint8 *data, int bytesPerLine) override
+    {
+        int filled = 0;
+        while (filled < bytesPerLine) {
+            if (m_offset >= m_chunk.size()) {
+                m_offset = 0;
+                if (!m_stream->takeData(m_chunk)) {
+                    m_error = QStringLiteral("页面数据不完整");
+                    return false;
+                }
+                continue;
+            }
+            const int count = qMin(bytesPerLine - filled, m_chunk.size() - m_offset);
+            std::memcpy(data + filled, m_chunk.constData() + m_offset, static_cast<size_t>(count));
+            filled += count;
+            m_offset += count;
+        }
+        return true;
+    }
+
+private:
+    QByteArray m_chunk;
+    int m_offset = 0;
+};
+
+// 整页到达后用Qt图像插件解码，用于PNG等格式以及没有libjpeg时的JPEG
+class EsclPageStream::ImageDecoder : public EsclPageStream::Decoder
+{
+public:
+    using Decoder::Decoder;
+
+    bool readHeader(int &width, int &height, int &channels) override
+    {
+        QByteArray data;
+        QByteArray chunk;
+        while (m_stream->takeData(chunk)) {
+            data.append(chunk);
+        }
+        if (m_stream->isAborted()) {
+            m_error = QStringLiteral("传输已中止");
+            return false;
+        }
+
+        const QImage image = QImage::fromData(data);
+        if (image.isNull()) {
+            m_error = QStringLiteral("无法解码文档格式: %1").arg(m_stream->m_contentType);
+            return false;
+        }
+        m_image = image.isGrayscale() ? image.convertToFormat(QImage::Format_Grayscale8)
+                                      : image.convertToFormat(QImage::Format_RGB888);
+        width = m_image.width();
+        height = m_image.height();
+        channels = m_image.format() == QImage::Format_Grayscale8 ? 1 : 3;
+        return true;
+    }
+
+    bool readRow(quint8 *data, int bytesPerLine) override
+    {
+        std::memcpy(data, m_image.constScanLine(m_row++), static_cast<size_t>(bytesPerLine));
+        return true;
+    }
+
+private:
+    QImage m_image;
+    int m_row = 0;
+};
+
+#ifdef HAVE_LIBJPEG
+namespace {
+struct JpegError {
+    jpeg_error_mgr manager;
+    jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+struct JpegSource {
+    jpeg_source_mgr manager;
+    EsclPageStream *stream;
+    bool (*take)(EsclPageStream *stream, QByteArray &chunk);
+    QByteArray *chunk;
+    bool truncated;
+};
+
+const JOCTET kJpegEoi[] = {0xFF, JPEG_EOI};
+
+void jpegErrorExit(j_common_ptr info)
+{
+    auto *error = reinterpret_cast<JpegError *>(info->err);
+    (*info->err->format_message)(info, error->message);
+    longjmp(error->jump, 1);
+}
+
+void jpegOutputMessage(j_common_ptr)
+{
+    // 警告不输出到stderr，数据截断另行报告
+}
+
+void jpegInitSource(j_decompress_ptr)
+{
+}
+
+boolean jpegFillInputBuffer(j_decompress_ptr info)
+{
+    auto *source = reinterpret_cast<JpegSource *>(info->src);
+    if (!source->take(source->stream, *source->chunk) || source->chunk->isEmpty()) {
+        // 数据提前结束时补一个EOI，由调用方报告截断
+        source->truncated = true;
+        source->manager.next_input_byte = kJpegEoi;
+        source->manager.bytes_in_buffer = sizeof(kJpegEoi);
+        return TRUE;
+    }
+    source->manager.next_input_byte = reinterpret_cast<const JOCTET *>(source->chunk->constData());
+    source->manager.bytes_in_buffer = static_cast<size_t>(source->chunk->size());
+    return TRUE;
+}
+
+void jpegSkipInputData(j_decompress_ptr info, long count)
+{
+    auto *source = reinterpret_cast<JpegSource *>(info->src);
+    while (count > static_cast<long>(source->manager.bytes_in_buffer)) {
+        count -= static_cast<long>(source->manager.bytes_in_buffer);
+        jpegFillInputBuffer(info);
+    }
+    source->manager.next_input_byte += count;
+    source->manager.bytes_in_buffer -= static_cast<size_t>(count);
+}
+
+void jpegTermSource(j_decompress_ptr)
+{
+}
+}
+
+// libjpeg逐行解码；fill_input_buffer阻塞等待网络数据，每行在其数据到达后即可输出
+class EsclPageStream::JpegDecoder : public EsclPageStream::Decoder
+{
+public:
+    explicit JpegDecoder(EsclPageStream *stream)
+        : Decoder(stream)
+    {
+        m_info.err = jpeg_std_error(&m_jpegError.manager);
+        m_jpegError.manager.error_exit = jpegErrorExit;
+        m_jpegError.manager.output_message = jpegOutputMessage;
+        m_jpegError.message[0] = '\0';
+        jpeg_create_decompress(&m_info);
+
+        m_source.manager.init_source = jpegInitSource;
+        m_source.manager.fill_input_buffer = jpegFillInputBuffer;
+        m_source.manager.skip_input_data = jpegSkipInputData;
+        m_source.manager.resync_to_restart = jpeg_resync_to_restart;
+        m_source.manager.term_source = jpegTermSource;
+        m_source.manager.next_input_byte = nullptr;
+        m_source.manager.bytes_in_buffer = 0;
+        m_source.stream = stream;
+        m_source.take = [](EsclPageStream *page, QByteArray &chunk) { return page->takeData(chunk); };
+        m_source.chunk = &m_chunk;
+        m_source.truncated = false;
+        m_info.src = &m_source.manager;
+    }
+
+    ~JpegDecoder() override
+    {
+        jpeg_destroy_decompress(&m_info);
+    }
+
+    bool readHeader(int &width, int &height, int &channels) override
+    {
+        if (!decodeHeader()) {
+            m_error = QStringLiteral("JPEG头解析失败: %1").arg(QString::fromLocal8Bit(m_jpegError.message));
+            return false;
+        }
+        width = static_cast<int>(m_info.output_width);
+        height = static_cast<int>(m_info.output_height);
+        channels = m_info.output_components;
+        return true;
+    }
+
+    bool readRow(quint8 *data, int) override
+    {
+        if (!decodeRow(data)) {
+            m_error = QStringLiteral("JPEG解码失败: %1").arg(QString::fromLocal8Bit(m_jpegError.message));
+            return false;
+        }
+        if (m_source.truncated) {
+            m_error = m_stream->isAborted() ? QStringLiteral("传输已中止") : QStringLiteral("JPEG数据不完整");
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // setjmp所在函数不持有需要析构的局部对象
+    bool decodeHeader()
+    {
+        if (setjmp(m_jpegError.jump)) {
+            return false;
+        }
+        jpeg_read_header(&m_info, TRUE);
+        m_info.out_color_space = m_info.num_components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+        jpeg_start_decompress(&m_info);
+        return true;
+    }
+
+    bool decodeRow(quint8 *data)
+    {
+        if (setjmp(m_jpegError.jump)) {
+            return false;
+        }
+        JSAMPROW row = data;
+        return jpeg_read_scanlines(&m_info, &row, 1) == 1;
+    }
+
+    jpeg_decompress_struct m_info;
+    JpegError m_jpegError;
+    JpegSource m_source;
+    QByteArray m_chunk;
+};
+#endif
+
+// =============================================================================
+// EsclPageStream 实现
+// =============================================================================
+
+EsclPageStream::EsclPageStream(const QString &contentType, const EsclScanSettings &settings)
+    : m_contentType(contentType)
+    , m_settings(settings)
+    , m_buffered(0)
+    , m_finished(false)
+    , m_aborted(false)
+    , m_throttled(false)
+    , m_headerRead(false)
+    , m_width(0)
+    , m_height(0)
+    , m_channels(0)
+    , m_rowsRead(0)
+{
+}
+
+EsclPageStream::~EsclPageStream() = default;
+
+void EsclPageStream::append(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (m_finished || m_aborted) {
+        return;
+    }
+    m_chunks.append(data);
+    m_buffered += data.size();
+    if (m_buffered >= kHighWaterBytes) {
+        m_throttled = true;
+    }
+    m_dataAvailable.wakeAll();
+}
+
+void EsclPageStream::finish()
+{
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_dataAvailable.wakeAll();
+}
+
+void EsclPageStream::abort(const QString &error)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_finished && m_chunks.isEmpty()) {
+        return;
+    }
+    m_aborted = true;
+    if (m_error.isEmpty()) {
+        m_error = error;
+    }
+    m_chunks.clear();
+    m_buffered = 0;
+    m_dataAvailable.wakeAll();
+}
+
+bool EsclPageStream::wantsData() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_throttled && !m_aborted;
+}
+
+qint64 EsclPageStream::bufferedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_buffered;
+}
+
+void EsclPageStream::setDrainedCallback(const std::function<void()> &callback)
+{
+    QMutexLocker locker(&m_mutex);
+    m_drainedCallback = callback;
+}
+
+bool EsclPageStream::takeData(QByteArray &chunk)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_chunks.isEmpty() && !m_finished && !m_aborted) {
+        m_dataAvailable.wait(&m_mutex);
+    }
+    if (m_aborted || m_chunks.isEmpty()) {
+        chunk.clear();
+        return false;
+    }
+
+    chunk = m_chunks.takeFirst();
+    m_buffered -= chunk.size();
+
+    // 回调在锁内调用，与生产者清除回调互斥
+    if (m_throttled && m_buffered < kLowWaterBytes) {
+        m_throttled = false;
+        if (m_drainedCallback) {
+            m_drainedCallback();
+        }
+    }
+    return true;
+}
+
+bool EsclPageStream::isAborted() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_aborted;
+}
+
+void EsclPageStream::setError(const QString &error)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_error.isEmpty()) {
+        m_error = error;
+    }
+}
+
+QString EsclPageStream::errorString() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_error;
+}
+
+bool EsclPageStream::readHeader()
+{
+    if (m_headerRead) {
+        return m_width > 0;
+    }
+    m_headerRead = true;
+
+    const QString type = mimeType(m_contentType);
+    if (type == QLatin1String("application/octet-stream")) {
+        m_decoder.reset(new RawDecoder(this));
+#ifdef HAVE_LIBJPEG
+    } else if (type == QLatin1String("image/jpeg")) {
+        m_decoder.reset(new JpegDecoder(this));
+#endif
+    } else {
+        m_decoder.reset(new ImageDecoder(this));
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    if (!m_decoder->readHeader(width, height, channels) || (channels != 1 && channels != 3)) {
+        const QString error = m_decoder->errorString();
+        setError(error.isEmpty() ? QStringLiteral("不支持的页面格式: %1").arg(m_contentType) : error);
+        qCWarning(esclScanClient) << "Cannot decode page:" << errorString();
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_channels = channels;
+    qCDebug(esclScanClient) << "Page" << m_contentType << m_width << "x" << m_height << "channels:" << m_channels;
+    return true;
+}
+
+bool EsclPageStream::readRow(quint8 *data)
+{
+    if (!readHeader() || m_rowsRead >= m_height) {
+        return false;
+    }
+    if (!m_decoder->readRow(data, bytesPerLine())) {
+        setError(m_decoder->errorString());
+        return false;
+    }
+    ++m_rowsRead;
+    return true;
+}
+
+EsclPageStream::RowCallback EsclPageStream::rowCallback()
+{
+    std::shared_ptr<EsclPageStream> self = shared_from_this();
+    return [self](int row, quint8 *data) {
+        // 管道按行号顺序读取，跳行说明调用方用法有误
+        if (row != self->m_rowsRead) {
+            self->setError(QStringLiteral("页面数据只能按顺序读取"));
+            return false;
+        }
+        return self->readRow(data);
+    };
+}
+
+// =============================================================================
+// EsclScanClient 实现
+// =============================================================================
+
+EsclScanClient::EsclScanClient(const QUrl &baseUrl, QObject *parent)
+    : QObject(parent)
+    , m_manager(new QNetworkAccessManager(this))
+    , m_baseUrl(baseUrl)
+    , m_reply(nullptr)
+    , m_pageIndex(0)
+    , m_busyRetries(0)
+    , m_documentComplete(false)
+    , m_scanning(false)
+{
+    qRegisterMetaType<EsclPagePointer>("EsclPagePointer");
+}
+
+EsclScanClient::~EsclScanClient()
+{
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+    }
+    if (m_page) {
+        m_page->abort(QStringLiteral("扫描客户端已销毁"));
+        releasePage();
+    }
+}
+
+QUrl EsclScanClient::endpoint(const QUrl &base, const QString &path) const
+{
+    QUrl url = base;
+    QString basePath = url.path();
+    while (basePath.endsWith(QLatin1Char('/'))) {
+        basePath.chop(1);
+    }
+    url.setPath(basePath + QLatin1Char('/') + path);
+    return url;
+}
+
+bool EsclScanClient::startScan(const EsclScanSettings &settings)
+{
+    if (m_scanning) {
+        qCWarning(esclScanClient) << "Scan already in progress";
+        return false;
+    }
+
+    m_settings = settings;
+    m_jobUrl.clear();
+    m_pageIndex = 0;
+    m_busyRetries = 0;
+    m_scanning = true;
+
+    QNetworkRequest request(endpoint(m_baseUrl, QStringLiteral("ScanJobs")));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("text/xml"));
+    QNetworkReply *reply = m_manager->post(request, settings.toXml());
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onJobCreated(reply);
+    });
+
+    qCDebug(esclScanClient) << "Submitting scan job to" << request.url();
+    return true;
+}
+
+void EsclScanClient::onJobCreated(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (!m_scanning) {
+        return;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError || status != 201) {
+        fail(QStringLiteral("创建扫描任务失败: HTTP %1 %2").arg(status).arg(reply->errorString()));
+        return;
+    }
+
+    // Location可以是相对地址
+    QUrl location = reply->header(QNetworkRequest::LocationHeader).toUrl();
+    if (location.isEmpty()) {
+        location = QUrl(QString::fromLatin1(reply->rawHeader("Location")));
+    }
+    if (location.isEmpty()) {
+        fail(QStringLiteral("设备未返回扫描任务地址"));
+        return;
+    }
+    m_jobUrl = m_baseUrl.resolved(location);
+
+    qCDebug(esclScanClient) << "Scan job created:" << m_jobUrl;
+    emit jobCreated(m_jobUrl);
+    requestNextDocument();
+}
+
+void EsclScanClient::requestNextDocument()
+{
+    if (!m_scanning) {
+        return;
+    }
+
+    m_documentComplete = false;
+    QNetworkRequest request(endpoint(m_jobUrl, QStringLiteral("NextDocument")));
+    m_reply = m_manager->get(request);
+    // 限制Qt内部缓冲，暂停读取时由TCP流控反压设备
+    m_reply->setReadBufferSize(kReadBufferSize);
+    connect(m_reply, &QNetworkReply::readyRead, this, &EsclScanClient::onDocumentData);
+    connect(m_reply, &QNetworkReply::finished, this, &EsclScanClient::onDocumentFinished);
+}
+
+void EsclScanClient::onDocumentData()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    if (!m_page) {
+        const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status != 200) {
+            // 错误响应的正文不是页面数据
+            return;
+        }
+
+        const QString contentType = m_reply->header(QNetworkRequest::ContentTypeHeader).toString();
+        m_page = std::make_shared<EsclPageStream>(contentType, m_settings);
+        m_page->setDrainedCallback([this]() {
+            QMetaObject::invokeMethod(this, [this]() { pullData(); }, Qt::QueuedConnection);
+        });
+        m_busyRetries = 0;
+
+        qCDebug(esclScanClient) << "Page" << m_pageIndex << "started:" << contentType;
+        emit pageStarted(m_page);
+    }
+
+    pullData();
+}
+
+void EsclScanClient::pullData()
+{
+    if (!m_reply || !m_page) {
+        return;
+    }
+
+    while (m_page->wantsData() && m_reply->bytesAvailable() > 0) {
+        m_page->append(m_reply->read(kPullChunkSize));
+    }
+
+    if (m_documentComplete && m_reply->bytesAvailable() == 0) {
+        completeDocument();
+    }
+}
+
+void EsclScanClient::onDocumentFinished()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (m_reply->error() == QNetworkReply::NoError && status == 200) {
+        // 空正文没有触发readyRead时也要创建页面
+        onDocumentData();
+        m_documentComplete = true;
+        pullData();
+        return;
+    }
+
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+
+    if (m_page) {
+        fail(QStringLiteral("页面传输失败: %1").arg(reply->errorString()));
+        return;
+    }
+
+    if (status == 404) {
+        // 没有更多文档，任务结束
+        qCDebug(esclScanClient) << "Scan job finished after" << m_pageIndex << "pages";
+        m_scanning = false;
+        emit scanFinished();
+        return;
+    }
+
+    if (status == 503 && m_busyRetries < kMaxBusyRetries) {
+        // 设备仍在扫描下一页
+        ++m_busyRetries;
+        QTimer::singleShot(kBusyRetryDelay, this, &EsclScanClient::requestNextDocument);
+        return;
+    }
+
+    fail(QStringLiteral("获取文档失败: HTTP %1 %2").arg(status).arg(reply->errorString()));
+}
+
+void EsclScanClient::completeDocument()
+{
+    m_page->finish();
+    releasePage();
+
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+
+    qCDebug(esclScanClient) << "Page" << m_pageIndex << "transferred";
+    emit pageFinished(m_pageIndex++);
+    requestNextDocument();
+}
+
+void EsclScanClient::releasePage()
+{
+    m_page->setDrainedCallback(std::function<void()>());
+    m_page.reset();
+}
+
+void EsclScanClient::cancel()
+{
+    if (!m_scanning) {
+        return;
+    }
+
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+    if (m_page) {
+        m_page->abort(QStringLiteral("扫描已取消"));
+        releasePage();
+    }
+
+    if (m_jobUrl.isValid()) {
+        QNetworkReply *reply = m_manager->deleteResource(QNetworkRequest(m_jobUrl));
+        connect(reply, &QNetworkReply::finished, reply, &QObject::deleteLater);
+    }
+
+    m_scanning = false;
+    qCDebug(esclScanClient) << "Scan cancelled";
+}
+
+void EsclScanClient::fail(const QString &error)
+{
+    qCWarning(esclScanClient) << error;
+
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+    if (m_page) {
+        m_page->abort(error);
+        releasePage();
+    }
+
+    m_scanning = false;
+    emit errorOccurred(error);
+}
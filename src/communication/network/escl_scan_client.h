@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2024 DeepinScan Team
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ESCL_SCAN_CLIENT_H
+#define ESCL_SCAN_CLIENT_H
+
+#include "Scanner/DScannerGlobal.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QRect>
+#include <QString>
+#include <QUrl>
+#include <QWaitCondition>
+
+#include <functional>
+#include <memory>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+DSCANNER_BEGIN_NAMESPACE
+
+/**
+ * @brief eSCL扫描参数，对应ScanSettings请求
+ */
+struct EsclScanSettings {
+    int resolution = 300;                                   // X/Y分辨率(DPI)
+    QString colorMode = QStringLiteral("RGB24");            // RGB24 或 Grayscale8
+    QString documentFormat = QStringLiteral("image/jpeg");  // application/octet-stream 表示未压缩的行数据
+    QString inputSource = QStringLiteral("Platen");         // Platen 或 Feeder
+    QRect region;                                           // 扫描区域(1/300英寸)，为空时使用设备默认区域
+
+    QByteArray toXml() const;
+};
+
+/**
+ * @brief 正在传输的一页扫描数据
+ *
+ * 网络线程随数据到达调用 append()，处理线程通过 readHeader()/readRow()
+ * 阻塞读取解码后的行，页面尚未传输完时即可开始处理。有libjpeg时JPEG逐行
+ * 解码，否则整页到达后再解码；未压缩数据按扫描参数的区域和分辨率切行。
+ *
+ * 缓冲超过上限时 wantsData() 返回false，网络端暂停读取，由TCP流控反压
+ * 设备；消费端读到下限以下时调用 setDrainedCallback() 设置的回调。
+ */
+class DSCANNER_EXPORT EsclPageStream : public std::enable_shared_from_this<EsclPageStream>
+{
+public:
+    // 与 SourceNode::RowCallback 相同，可直接作为处理管道的数据源
+    typedef std::function<bool(int row, quint8 *data)> RowCallback;
+
+    EsclPageStream(const QString &contentType, const EsclScanSettings &settings);
+    ~EsclPageStream();
+
+    QString contentType() const { return m_contentType; }
+
+    // 生产者接口（网络线程）
+    void append(const QByteArray &data);
+    void finish();
+    void abort(const QString &error);
+    bool wantsData() const;
+    qint64 bufferedBytes() const;
+    void setDrainedCallback(const std::function<void()> &callback);
+
+    /**
+     * @brief 读取页面几何信息，阻塞直到解码器得到图像头
+     * @return 数据格式不支持、出错或传输中止时返回false
+     */
+    bool readHeader();
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int channels() const { return m_channels; }     // 1为灰度(Format1)，3为RGB(Format3)
+    int bytesPerLine() const { return m_width * m_channels; }
+
+    /**
+     * @brief 按顺序读取下一行，阻塞直到该行的数据到达并解码
+     * @param data 至少 bytesPerLine() 字节
+     */
+    bool readRow(quint8 *data);
+    int rowsRead() const { return m_rowsRead; }
+
+    /**
+     * @brief 处理管道的行回调；回调持有页面的引用
+     *
+     * 用法：source->setStreamGeometry(page->width(), page->height(), format);
+     *       source->setRowCallback(page->rowCallback());
+     */
+    RowCallback rowCallback();
+
+    QString errorString() const;
+
+private:
+    class Decoder;
+    class RawDecoder;
+    class ImageDecoder;
+    class JpegDecoder;
+
+    // 解码器的字节源：阻塞直到有数据，传输结束或中止时返回false
+    bool takeData(QByteArray &chunk);
+    bool isAborted() const;
+    void setError(const QString &error);
+
+    QString m_contentType;
+    EsclScanSettings m_settings;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_dataAvailable;
+    QList<QByteArray> m_chunks;
+    qint64 m_buffered;
+    bool m_finished;
+    bool m_aborted;
+    bool m_throttled;
+    QString m_error;
+    std::function<void()> m_drainedCallback;
+
+    // 以下只由消费线程访问
+    std::unique_ptr<Decoder> m_decoder;
+    bool m_headerRead;
+    int m_width;
+    int m_height;
+    int m_channels;
+    int m_rowsRead;
+};
+
+typedef std::shared_ptr<EsclPageStream> EsclPagePointer;
+
+/**
+ * @brief eSCL/AirScan扫描客户端
+ *
+ * 提交ScanJob后依次拉取NextDocument，直到设备返回404表示任务结束。所有
+ * 请求经同一个QNetworkAccessManager发出，按HTTP/1.1持久连接复用同一条
+ * TCP连接；分块传输编码由Qt解码，响应体边到达边交给 EsclPageStream，
+ * 传输与解码、处理在不同线程上重叠进行。
+ *
+ * 对象须在有事件循环的线程中使用。
+ */
+class DSCANNER_EXPORT EsclScanClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param baseUrl eSCL根地址，例如 http://192.168.1.20/eSCL
+     */
+    explicit EsclScanClient(const QUrl &baseUrl, QObject *parent = nullptr);
+    ~EsclScanClient() override;
+
+    QUrl baseUrl() const { return m_baseUrl; }
+    QUrl jobUrl() const { return m_jobUrl; }
+    bool isScanning() const { return m_scanning; }
+
+    /**
+     * @brief 提交扫描任务
+     * @return 已有任务在进行时返回false
+     */
+    bool startScan(const EsclScanSettings &settings);
+
+    /**
+     * @brief 取消任务：中止当前传输并通知设备删除任务
+     */
+    void cancel();
+
+Q_SIGNALS:
+    void jobCreated(const QUrl &jobUrl);
+
+    /**
+     * @brief 一页数据开始到达
+     *
+     * 通常在此把页面交给处理线程；页面在后续数据到达时继续填充。
+     */
+    void pageStarted(const EsclPagePointer &page);
+    void pageFinished(int pageIndex);
+    void scanFinished();
+    void errorOccurred(const QString &error);
+
+private:
+    QUrl endpoint(const QUrl &base, const QString &path) const;
+    void onJobCreated(QNetworkReply *reply);
+    void requestNextDocument();
+    void onDocumentData();
+    void onDocumentFinished();
+    void pullData();
+    void completeDocument();
+    void releasePage();
+    void fail(const QString &error);
+
+    QNetworkAccessManager *m_manager;
+    QUrl m_baseUrl;
+    QUrl m_jobUrl;
+    EsclScanSettings m_settings;
+    QNetworkReply *m_reply;
+    EsclPagePointer m_page;
+    int m_pageIndex;
+    int m_busyRetries;                      // 设备返回503时的重试次数
+    bool m_documentComplete;                // 响应已结束，缓冲中可能仍有数据
+    bool m_scanning;
+};
+
+DSCANNER_END_NAMESPACE
+
+Q_DECLARE_METATYPE(DSCANNER_NAMESPACE::EsclPagePointer)
+
+#endif // ESCL_SCAN_CLIENT_H
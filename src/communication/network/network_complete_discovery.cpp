@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "network_complete_discovery.h"
+#include "network_discovery_tasks_p.h"
+#include "network_scanner_registry.h"
 #include <QDebug>
 #include <QNetworkInterface>
 #include <QHostInfo>
@@ -24,7 +26,15 @@
 
 DSCANNER_USE_NAMESPACE
 
-Q_LOGGING_CATEGORY(networkCompleteDiscovery, "deepinscan.network.complete")
+namespace {
+// 有已知设备时推迟首轮完整发现，先让单播复核完成
+constexpr int kInitialWideDiscoveryDelay = 5000;
+// 完整发现的最长间隔
+constexpr int kMaxWideDiscoveryBackoff = 30 * 60 * 1000;
+// 复核的目标都是已知在线过的设备，超时可以比子网扫描宽松
+constexpr int kRevalidationMinTimeout = 300;
+constexpr int kRevalidationMaxTimeout = 2000;
+}
 
 // NetworkCompleteDiscovery 实现
 
@@ -36,6 +46,12 @@ NetworkCompleteDiscovery::NetworkCompleteDiscovery(QObject *parent)
     , m_discoveryTimer(new QTimer(this))
     , m_activeProbes(0)
     , m_threadPool(new QThreadPool(this))
+    , m_reactor(nullptr)
+    , m_wideDiscoveryTimer(new QTimer(this))
+    , m_revalidator(new SubnetProber(this))
+    , m_registry(new NetworkScannerRegistry())
+    , m_wideDiscoveryBackoff(m_discoveryInterval)
+    , m_newDevicesInRound(0)
 {
     qCDebug(networkCompleteDiscovery) << "初始化网络完整发现引擎";
     
@@ -45,11 +61,49 @@ NetworkCompleteDiscovery::NetworkCompleteDiscovery(QObject *parent)
     // 初始化协议支持
     initializeProtocolSupport();
     
+    // 多播/UDP协议共用一个反应器
+    m_reactor = new DiscoveryReactor(m_threadPool, this);
+    connect(m_reactor, &DiscoveryReactor::deviceFound, this,
+            [this](DiscoveryReactor::Protocol protocol, const NetworkScannerDevice &device) {
+        switch (protocol) {
+        case DiscoveryReactor::Mdns:
+            onMdnsDeviceFound(device);
+            break;
+        case DiscoveryReactor::Wsd:
+            onWsdDeviceFound(device);
+            break;
+        case DiscoveryReactor::Ssdp:
+            onUpnpDeviceFound(device);
+            break;
+        case DiscoveryReactor::Snmp:
+            onSnmpDeviceFound(device);
+            break;
+        default:
+            break;
+        }
+    });
+    connect(m_reactor, &DiscoveryReactor::finished,
+            this, &NetworkCompleteDiscovery::onMulticastDiscoveryFinished);
+    
     // 初始化发现计时器
     m_discoveryTimer->setSingleShot(false);
     m_discoveryTimer->setInterval(m_discoveryInterval);
     connect(m_discoveryTimer, &QTimer::timeout, this, &NetworkCompleteDiscovery::performPeriodicDiscovery);
     
+    // 完整发现按退避间隔单次触发
+    m_wideDiscoveryTimer->setSingleShot(true);
+    connect(m_wideDiscoveryTimer, &QTimer::timeout, this, &NetworkCompleteDiscovery::performCompleteDiscovery);
+    
+    // 已知设备的单播复核
+    m_revalidator->setTimeoutBounds(kRevalidationMinTimeout, kRevalidationMaxTimeout);
+    connect(m_revalidator, &SubnetProber::portOpen, this, [this](const QHostAddress &address, quint16) {
+        m_revalidatedHosts.insert(address.toString());
+    });
+    connect(m_revalidator, &SubnetProber::finished, this, &NetworkCompleteDiscovery::onRevalidationFinished);
+    
+    // 载入已知设备登记表
+    m_registry->load();
+    
     // 初始化网络管理器
     // m_networkManager->setTransferTimeout(10000); // Qt 5.15+才支持，暂时注释
     connect(m_networkManager, &QNetworkAccessManager::finished, 
@@ -68,6 +122,9 @@ NetworkCompleteDiscovery::~NetworkCompleteDiscovery()
     
     // 等待所有活动探测完成
     m_threadPool->waitForDone(5000);
+    
+    m_registry->save();
+    delete m_registry;
 }
 
 void NetworkCompleteDiscovery::initializeProtocolSupport()
@@ -127,15 +184,26 @@ bool NetworkCompleteDiscovery::startDiscovery()
     
     // 获取网络接口
     updateNetworkInterfaces();
+    networkInterfacesChanged();
     
-    // 启动发现过程
-    performCompleteDiscovery();
-    
-    // 启动定期发现计时器
-    m_discoveryTimer->start();
+    {
+        QMutexLocker deviceLocker(&m_deviceMutex);
+        m_discoveredDevices.clear();
+    }
     
     emit discoveryStarted();
     
+    // 已知设备立即可用，随后单播复核
+    publishKnownDevices();
+    revalidateKnownDevices();
+    
+    // 完整发现在后台进行；没有已知设备时立即开始
+    m_wideDiscoveryBackoff = m_discoveryInterval;
+    m_wideDiscoveryTimer->start(m_registry->isEmpty() ? 0 : kInitialWideDiscoveryDelay);
+    
+    // 启动定期复核计时器
+    m_discoveryTimer->start();
+    
     qCDebug(networkCompleteDiscovery) << "网络发现已启动";
     return true;
 }
@@ -152,6 +220,10 @@ void NetworkCompleteDiscovery::stopDiscovery()
     
     m_isDiscovering = false;
     m_discoveryTimer->stop();
+    m_wideDiscoveryTimer->stop();
+    m_reactor->stop();
+    m_revalidator->stop();
+    m_revalidationTargets.clear();
     
     // 取消所有活动的网络请求
     foreach (QNetworkReply *reply, m_activeReplies) {
@@ -161,6 +233,8 @@ void NetworkCompleteDiscovery::stopDiscovery()
     }
     m_activeReplies.clear();
     
+    m_registry->save();
+    
     emit discoveryStopped();
     
     qCDebug(networkCompleteDiscovery) << "网络发现已停止";
@@ -168,22 +242,45 @@ void NetworkCompleteDiscovery::stopDiscovery()
 
 void NetworkCompleteDiscovery::performCompleteDiscovery()
 {
+    if (m_activeProbes > 0) {
+        // 上一轮尚未结束，结束时会重新安排
+        return;
+    }
+    
     qCDebug(networkCompleteDiscovery) << "执行完整网络发现";
     
-    // 重置发现的设备列表
-    {
-        QMutexLocker locker(&m_deviceMutex);
-        m_discoveredDevices.clear();
+    // 设备列表保留：消失的设备由单播复核移除
+    m_newDevicesInRound = 0;
+    updateNetworkInterfaces();
+    
+    // 延迟从本轮发出探测开始计算
+    m_statistics.discoveryRounds++;
+    m_roundReportedKeys.clear();
+    for (ProtocolDiscoveryMetrics &metrics : m_statistics.protocolMetrics) {
+        metrics.timeToFirstDevice = -1;
+    }
+    m_roundClock.start();
+    
+    // UDP协议的探测一次全部发出，在同一个时间窗口内收集响应
+    if (!m_reactor->isRunning()) {
+        performMdnsDiscovery();
+        performWsdDiscovery();
+        performSnmpDiscovery();
+        performUpnpDiscovery();
+        if (m_reactor->start()) {
+            m_activeProbes++;
+        }
     }
     
-    // 执行各种发现方法
-    performMdnsDiscovery();
-    performWsdDiscovery();
     performSoapDiscovery();
-    performSnmpDiscovery();
-    performUpnpDiscovery();
     performPortScanDiscovery();
     
+    // 没有可用接口时本轮立即结束，仍需安排下一轮
+    if (m_activeProbes <= 0) {
+        checkDiscoveryCompletion();
+        return;
+    }
+    
     qCDebug(networkCompleteDiscovery) << "完整网络发现启动完成";
 }
 
@@ -191,19 +288,11 @@ void NetworkCompleteDiscovery::performMdnsDiscovery()
 {
     qCDebug(networkCompleteDiscovery) << "执行mDNS发现";
     
-    foreach (const QString &serviceType, m_supportedProtocols[static_cast<int>(ProtocolType::MDNS)]) {
-        // 创建mDNS查询任务
-        auto *task = new MdnsDiscoveryTask(serviceType, this);
-        connect(task, &MdnsDiscoveryTask::deviceFound, 
-                this, &NetworkCompleteDiscovery::onMdnsDeviceFound);
-        connect(task, &MdnsDiscoveryTask::finished,
-                this, &NetworkCompleteDiscovery::onMdnsDiscoveryFinished);
-        
-        m_threadPool->start(task);
-        m_activeProbes++;
-    }
+    const QStringList serviceTypes = m_supportedProtocols[static_cast<int>(ProtocolType::MDNS)];
+    m_reactor->addProbe(DiscoveryReactor::Mdns, DiscoveryReactor::buildMdnsQuery(serviceTypes),
+                        QHostAddress(QStringLiteral("224.0.0.251")), 5353);
     
-    m_statistics.mdnsQueriesSent += m_supportedProtocols[static_cast<int>(ProtocolType::MDNS)].size();
+    m_statistics.mdnsQueriesSent += serviceTypes.size();
 }
 
 void NetworkCompleteDiscovery::performWsdDiscovery()
@@ -230,14 +319,8 @@ void NetworkCompleteDiscovery::performWsdDiscovery()
     ).arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
     
     // 发送到WS-Discovery多播地址
-    auto *task = new WsdDiscoveryTask(wsdMessage, this);
-    connect(task, &WsdDiscoveryTask::deviceFound,
-            this, &NetworkCompleteDiscovery::onWsdDeviceFound);
-    connect(task, &WsdDiscoveryTask::finished,
-            this, &NetworkCompleteDiscovery::onWsdDiscoveryFinished);
-    
-    m_threadPool->start(task);
-    m_activeProbes++;
+    m_reactor->addProbe(DiscoveryReactor::Wsd, wsdMessage.toUtf8(),
+                        QHostAddress(QStringLiteral("239.255.255.250")), 3702);
     m_statistics.wsdQueriesSent++;
 }
 
@@ -252,6 +335,10 @@ void NetworkCompleteDiscovery::performSoapDiscovery()
                 auto *task = new SoapDiscoveryTask(entry, this);
                 connect(task, &SoapDiscoveryTask::deviceFound,
                         this, &NetworkCompleteDiscovery::onSoapDeviceFound);
+                connect(task, &SoapDiscoveryTask::trafficMeasured, this,
+                        [this](int probes, int timeouts, qint64 bytesSent, qint64 bytesReceived) {
+                    recordTraffic(ProtocolType::SOAP, probes, timeouts, bytesSent, bytesReceived);
+                });
                 connect(task, &SoapDiscoveryTask::finished,
                         this, &NetworkCompleteDiscovery::onSoapDiscoveryFinished);
                 
@@ -267,18 +354,13 @@ void NetworkCompleteDiscovery::performSnmpDiscovery()
 {
     qCDebug(networkCompleteDiscovery) << "执行SNMP发现";
     
-    // SNMP发现实现
+    // 每个网段一个广播GetRequest，所有代理的响应都回到同一个套接字，按来源地址区分
+    quint32 requestId = 1;
     foreach (const QNetworkInterface &interface, m_networkInterfaces) {
         foreach (const QNetworkAddressEntry &entry, interface.addressEntries()) {
-            if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol) {
-                auto *task = new SnmpDiscoveryTask(entry, this);
-                connect(task, &SnmpDiscoveryTask::deviceFound,
-                        this, &NetworkCompleteDiscovery::onSnmpDeviceFound);
-                connect(task, &SnmpDiscoveryTask::finished,
-                        this, &NetworkCompleteDiscovery::onSnmpDiscoveryFinished);
-                
-                m_threadPool->start(task);
-                m_activeProbes++;
+            if (m_reactor->addBroadcastProbe(DiscoveryReactor::Snmp, DiscoveryReactor::buildSnmpGetRequest(requestId),
+                                             entry, 161)) {
+                ++requestId;
                 m_statistics.snmpQueriesSent++;
             }
         }
@@ -289,24 +371,21 @@ void NetworkCompleteDiscovery::performUpnpDiscovery()
 {
     qCDebug(networkCompleteDiscovery) << "执行UPnP发现";
     
-    // UPnP SSDP发现
-    const QString ssdpMessage = QString(
-        "M-SEARCH * HTTP/1.1\r\n"
-        "HOST: 239.255.255.250:1900\r\n"
-        "MAN: \"ssdp:discover\"\r\n"
-        "ST: upnp:rootdevice\r\n"
-        "MX: 3\r\n\r\n"
-    );
-    
-    auto *task = new UpnpDiscoveryTask(ssdpMessage, this);
-    connect(task, &UpnpDiscoveryTask::deviceFound,
-            this, &NetworkCompleteDiscovery::onUpnpDeviceFound);
-    connect(task, &UpnpDiscoveryTask::finished,
-            this, &NetworkCompleteDiscovery::onUpnpDiscoveryFinished);
-    
-    m_threadPool->start(task);
-    m_activeProbes++;
-    m_statistics.upnpQueriesSent++;
+    // 每种扫描仪设备类型一条M-SEARCH；MX须小于反应器的时间窗口
+    const int mx = qMax(1, m_reactor->window() / 1000 - 1);
+    foreach (const QString &searchTarget, m_supportedProtocols[static_cast<int>(ProtocolType::UPNP)]) {
+        const QString ssdpMessage = QString(
+            "M-SEARCH * HTTP/1.1\r\n"
+            "HOST: 239.255.255.250:1900\r\n"
+            "MAN: \"ssdp:discover\"\r\n"
+            "ST: %1\r\n"
+            "MX: %2\r\n\r\n"
+        ).arg(searchTarget).arg(mx);
+        
+        m_reactor->addProbe(DiscoveryReactor::Ssdp, ssdpMessage.toUtf8(),
+                            QHostAddress(QStringLiteral("239.255.255.250")), 1900);
+        m_statistics.upnpQueriesSent++;
+    }
 }
 
 void NetworkCompleteDiscovery::performPortScanDiscovery()
@@ -333,6 +412,10 @@ void NetworkCompleteDiscovery::performPortScanDiscovery()
                 auto *task = new PortScanTask(entry, scannerPorts, this);
                 connect(task, &PortScanTask::deviceFound,
                         this, &NetworkCompleteDiscovery::onPortScanDeviceFound);
+                connect(task, &PortScanTask::trafficMeasured, this,
+                        [this](int probes, int timeouts, qint64 bytesSent, qint64 bytesReceived) {
+                    recordTraffic(ProtocolType::PORTSCAN, probes, timeouts, bytesSent, bytesReceived);
+                });
                 connect(task, &PortScanTask::finished,
                         this, &NetworkCompleteDiscovery::onPortScanFinished);
                 
@@ -374,8 +457,153 @@ void NetworkCompleteDiscovery::performPeriodicDiscovery()
         return;
     }
     
-    qCDebug(networkCompleteDiscovery) << "执行定期网络发现";
-    performCompleteDiscovery();
+    revalidateKnownDevices();
+    
+    // 接入了新网络时不再等待退避间隔
+    if (networkInterfacesChanged()) {
+        qCDebug(networkCompleteDiscovery) << "网络接口变化，提前执行完整发现";
+        m_wideDiscoveryBackoff = m_discoveryInterval;
+        if (m_activeProbes <= 0) {
+            m_wideDiscoveryTimer->start(0);
+        }
+    }
+}
+
+void NetworkCompleteDiscovery::publishKnownDevices()
+{
+    const QList<NetworkScannerDevice> known = m_registry->devices();
+    if (known.isEmpty()) {
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&m_deviceMutex);
+        m_discoveredDevices.append(known);
+    }
+    
+    qCDebug(networkCompleteDiscovery) << "发布已知设备:" << known.size();
+    for (const NetworkScannerDevice &device : known) {
+        emit deviceDiscovered(device);
+    }
+}
+
+void NetworkCompleteDiscovery::revalidateKnownDevices()
+{
+    if (m_revalidator->isRunning() || m_registry->isEmpty()) {
+        return;
+    }
+    
+    QList<QHostAddress> hosts;
+    QList<quint16> ports;
+    m_revalidationTargets.clear();
+    m_revalidatedHosts.clear();
+    
+    const QList<QString> keys = m_registry->keys();
+    for (const QString &key : keys) {
+        // 主机名形式的条目无法直接连接，只按保留时间淘汰
+        const NetworkScannerDevice device = m_registry->device(key);
+        const QHostAddress address(NetworkScannerRegistry::hostFor(device));
+        if (address.isNull()) {
+            continue;
+        }
+        hosts.append(address);
+        m_revalidationTargets.append(key);
+        
+        const quint16 port = NetworkScannerRegistry::servicePort(device);
+        if (!ports.contains(port)) {
+            ports.append(port);
+        }
+    }
+    
+    if (hosts.isEmpty()) {
+        return;
+    }
+    
+    qCDebug(networkCompleteDiscovery) << "复核已知设备:" << hosts.size() << "端口:" << ports;
+    m_revalidator->start(hosts, ports);
+}
+
+void NetworkCompleteDiscovery::onRevalidationFinished()
+{
+    bool removed = false;
+    
+    for (const QString &key : qAsConst(m_revalidationTargets)) {
+        if (!m_registry->contains(key)) {
+            continue;
+        }
+        
+        const NetworkScannerDevice device = m_registry->device(key);
+        const QString host = NetworkScannerRegistry::hostFor(device);
+        if (m_revalidatedHosts.contains(QHostAddress(host).toString())) {
+            m_registry->markSeen(key);
+            emit deviceRevalidated(m_registry->device(key));
+            continue;
+        }
+        
+        if (!m_registry->markFailed(key)) {
+            continue;
+        }
+        
+        {
+            QMutexLocker locker(&m_deviceMutex);
+            for (int i = m_discoveredDevices.size() - 1; i >= 0; --i) {
+                const NetworkScannerDevice &discovered = m_discoveredDevices.at(i);
+                if (NetworkScannerRegistry::keyFor(discovered) == key
+                    || NetworkScannerRegistry::hostFor(discovered) == host) {
+                    m_discoveredDevices.removeAt(i);
+                }
+            }
+        }
+        
+        qCDebug(networkCompleteDiscovery) << "设备已离线:" << device.makeAndModel << key;
+        emit deviceLost(device);
+        removed = true;
+    }
+    
+    m_revalidationTargets.clear();
+    m_revalidatedHosts.clear();
+    
+    if (removed) {
+        m_registry->save();
+    }
+}
+
+void NetworkCompleteDiscovery::scheduleWideDiscovery(bool foundDevices)
+{
+    if (!m_isDiscovering) {
+        return;
+    }
+    
+    // 没有新设备时间隔加倍，直到上限
+    m_wideDiscoveryBackoff = foundDevices
+        ? m_discoveryInterval
+        : qMin(m_wideDiscoveryBackoff * 2, kMaxWideDiscoveryBackoff);
+    m_wideDiscoveryTimer->start(m_wideDiscoveryBackoff);
+    
+    qCDebug(networkCompleteDiscovery) << "下一轮完整发现将在" << m_wideDiscoveryBackoff << "毫秒后执行";
+}
+
+bool NetworkCompleteDiscovery::networkInterfacesChanged()
+{
+    QStringList signature;
+    foreach (const QNetworkInterface &interface, QNetworkInterface::allInterfaces()) {
+        if (!(interface.flags() & QNetworkInterface::IsUp) ||
+            (interface.flags() & QNetworkInterface::IsLoopBack)) {
+            continue;
+        }
+        foreach (const QNetworkAddressEntry &entry, interface.addressEntries()) {
+            if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol) {
+                signature << QStringLiteral("%1/%2").arg(entry.ip().toString()).arg(entry.prefixLength());
+            }
+        }
+    }
+    signature.sort();
+    
+    if (signature == m_networkSignature) {
+        return false;
+    }
+    m_networkSignature = signature;
+    return true;
 }
 
 void NetworkCompleteDiscovery::handleNetworkReply(QNetworkReply *reply)
@@ -494,7 +722,12 @@ void NetworkCompleteDiscovery::addDiscoveredDevice(const NetworkScannerDevice &d
 {
     QMutexLocker locker(&m_deviceMutex);
     
-    // 检查设备是否已存在
+    // 每次发现都刷新登记表中的在线时间
+    m_registry->update(device);
+    
+    // 检查设备是否已存在；同一主机经不同协议发现、或同一设备换了地址时视为同一设备
+    const QString key = NetworkScannerRegistry::keyFor(device);
+    const QString host = NetworkScannerRegistry::hostFor(device);
     bool deviceExists = false;
     for (int i = 0; i < m_discoveredDevices.size(); ++i) {
         const NetworkScannerDevice &existing = m_discoveredDevices.at(i);
@@ -506,9 +739,18 @@ void NetworkCompleteDiscovery::addDiscoveredDevice(const NetworkScannerDevice &d
             deviceExists = true;
             break;
         }
+        if (!key.isEmpty() && NetworkScannerRegistry::keyFor(existing) == key) {
+            deviceExists = true;
+            break;
+        }
+        if (!host.isEmpty() && NetworkScannerRegistry::hostFor(existing) == host) {
+            deviceExists = true;
+            break;
+        }
     }
     
     if (!deviceExists) {
+        m_newDevicesInRound++;
         m_discoveredDevices.append(device);
         m_statistics.totalDevicesFound++;
         
@@ -553,30 +795,21 @@ bool NetworkCompleteDiscovery::isDiscovering() const
 void NetworkCompleteDiscovery::onMdnsDeviceFound(const NetworkScannerDevice &device)
 {
     m_statistics.mdnsDevicesFound++;
+    recordDeviceResponse(ProtocolType::MDNS, device);
     addDiscoveredDevice(device);
 }
 
-void NetworkCompleteDiscovery::onMdnsDiscoveryFinished()
-{
-    m_activeProbes--;
-    checkDiscoveryCompletion();
-}
-
 void NetworkCompleteDiscovery::onWsdDeviceFound(const NetworkScannerDevice &device)
 {
     m_statistics.wsdDevicesFound++;
+    recordDeviceResponse(ProtocolType::WSD, device);
     addDiscoveredDevice(device);
 }
 
-void NetworkCompleteDiscovery::onWsdDiscoveryFinished()
-{
-    m_activeProbes--;
-    checkDiscoveryCompletion();
-}
-
 void NetworkCompleteDiscovery::onSoapDeviceFound(const NetworkScannerDevice &device)
 {
     m_statistics.soapDevicesFound++;
+    recordDeviceResponse(ProtocolType::SOAP, device);
     addDiscoveredDevice(device);
 }
 
@@ -589,23 +822,33 @@ void NetworkCompleteDiscovery::onSoapDiscoveryFinished()
 void NetworkCompleteDiscovery::onSnmpDeviceFound(const NetworkScannerDevice &device)
 {
     m_statistics.snmpDevicesFound++;
+    recordDeviceResponse(ProtocolType::SNMP, device);
     addDiscoveredDevice(device);
 }
 
-void NetworkCompleteDiscovery::onSnmpDiscoveryFinished()
-{
-    m_activeProbes--;
-    checkDiscoveryCompletion();
-}
-
 void NetworkCompleteDiscovery::onUpnpDeviceFound(const NetworkScannerDevice &device)
 {
     m_statistics.upnpDevicesFound++;
+    recordDeviceResponse(ProtocolType::UPNP, device);
     addDiscoveredDevice(device);
 }
 
-void NetworkCompleteDiscovery::onUpnpDiscoveryFinished()
+void NetworkCompleteDiscovery::onMulticastDiscoveryFinished()
 {
+    static const struct {
+        DiscoveryReactor::Protocol protocol;
+        ProtocolType type;
+    } protocols[] = {
+        {DiscoveryReactor::Mdns, ProtocolType::MDNS},
+        {DiscoveryReactor::Wsd, ProtocolType::WSD},
+        {DiscoveryReactor::Ssdp, ProtocolType::UPNP},
+        {DiscoveryReactor::Snmp, ProtocolType::SNMP},
+    };
+    for (const auto &entry : protocols) {
+        const DiscoveryReactor::Traffic traffic = m_reactor->traffic(entry.protocol);
+        recordTraffic(entry.type, traffic.probes, traffic.timeouts, traffic.bytesSent, traffic.bytesReceived);
+    }
+    
     m_activeProbes--;
     checkDiscoveryCompletion();
 }
@@ -613,6 +856,7 @@ void NetworkCompleteDiscovery::onUpnpDiscoveryFinished()
 void NetworkCompleteDiscovery::onPortScanDeviceFound(const NetworkScannerDevice &device)
 {
     m_statistics.portScanDevicesFound++;
+    recordDeviceResponse(ProtocolType::PORTSCAN, device);
     addDiscoveredDevice(device);
 }
 
@@ -628,5 +872,45 @@ void NetworkCompleteDiscovery::checkDiscoveryCompletion()
         qCDebug(networkCompleteDiscovery) << "网络发现周期完成，发现设备数量:" 
                                           << m_discoveredDevices.size();
         emit discoveryCompleted(m_discoveredDevices);
+        
+        m_registry->save();
+        exportMetrics();
+        scheduleWideDiscovery(m_newDevicesInRound > 0);
     }
-} 
\ No newline at end of file
+}
+
+void NetworkCompleteDiscovery::recordDeviceResponse(ProtocolType type, const NetworkScannerDevice &device)
+{
+    if (!m_roundClock.isValid()) {
+        return;
+    }
+    
+    ProtocolDiscoveryMetrics &metrics = m_statistics.protocolMetrics[static_cast<int>(type)];
+    metrics.addLatency(m_roundClock.elapsed());
+    
+    // 同一设备经多个协议或多次应答报告时计为重复，用于评估各协议的独有产出；
+    // 各协议不一定都报告设备的身份标识，一轮之内按主机判断
+    const QString key = NetworkScannerRegistry::hostFor(device);
+    if (key.isEmpty()) {
+        return;
+    }
+    if (m_roundReportedKeys.contains(key)) {
+        metrics.duplicates++;
+    } else {
+        m_roundReportedKeys.insert(key);
+    }
+}
+
+void NetworkCompleteDiscovery::recordTraffic(ProtocolType type, int probes, int timeouts,
+                                             qint64 bytesSent, qint64 bytesReceived)
+{
+    m_statistics.protocolMetrics[static_cast<int>(type)].addTraffic(probes, timeouts, bytesSent, bytesReceived);
+}
+
+void NetworkCompleteDiscovery::exportMetrics()
+{
+    if (m_metricsDirectory.isEmpty()) {
+        return;
+    }
+    getStatistics().exportTo(m_metricsDirectory);
+}
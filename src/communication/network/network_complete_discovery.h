@@ -10,14 +10,17 @@
 #include <QNetworkInterface>
 #include <QTimer>
 #include <QThreadPool>
-#include <QRunnable>
 #include <QMutex>
 #include <QDateTime>
 #include <QLoggingCategory>
 #include <QHash>
+#include <QJsonObject>
+#include <QVector>
+#include <QSet>
 #include <QStringList>
 #include <QUrl>
 #include <QVariantMap>
+#include <QElapsedTimer>
 
 DSCANNER_BEGIN_NAMESPACE
 
@@ -30,7 +33,8 @@ enum class ProtocolType {
     SOAP,    // SOAP/eSCL
     SNMP,    // SNMP
     UPNP,    // UPnP
-    HTTP     // HTTP直接访问
+    HTTP,    // HTTP直接访问
+    PORTSCAN // 端口扫描
 };
 
 // 网络扫描仪设备信息结构
@@ -49,8 +53,42 @@ struct NetworkScannerDevice {
     QVariantMap capabilities;       // 设备能力
     QVariantMap properties;         // 其他属性
     QDateTime discoveryTime;        // 发现时间
+    QDateTime lastSeen;             // 最近一次确认在线的时间
     
-    NetworkScannerDevice() : discoveryTime(QDateTime::currentDateTime()) {}
+    NetworkScannerDevice() : discoveryTime(QDateTime::currentDateTime()), lastSeen(discoveryTime) {}
+};
+
+// 单个协议的发现延迟与产出指标，延迟从本轮发出探测时开始计算
+struct ProtocolDiscoveryMetrics {
+    qint64 timeToFirstDevice = -1;  // 最近一轮首个设备响应的延迟(毫秒)，未发现时为-1
+    QVector<qint64> latencies;      // 最近的设备响应延迟样本(毫秒)
+    qint64 latencyCount = 0;        // 延迟样本总数
+    qint64 latencySum = 0;          // 延迟总和(毫秒)
+    int probesSent = 0;             // 发出的报文、请求或连接数
+    int duplicates = 0;             // 本轮中已被报告过的设备再次响应
+    int timeouts = 0;               // 超时未响应的探测
+    qint64 bytesSent = 0;           // 发送的应用层载荷字节数
+    qint64 bytesReceived = 0;       // 接收的应用层载荷字节数
+    
+    /**
+     * @brief 按最近邻秩计算延迟分位数
+     * @param percentile 0到1之间的分位
+     * @return 没有样本时返回-1
+     */
+    qint64 latencyPercentile(double percentile) const;
+    
+    /**
+     * @brief 记录一次设备响应的延迟，只保留最近的样本用于分位数
+     */
+    void addLatency(qint64 latency);
+    
+    /**
+     * @brief 累加一次探测的报文、超时和载荷字节数
+     */
+    void addTraffic(int probeCount, int timeoutCount, qint64 sentBytes, qint64 receivedBytes);
+    
+    // 保留的延迟样本数，分位数按这些样本计算
+    static constexpr int kMaxLatencySamples = 1024;
 };
 
 // 网络发现统计信息
@@ -71,23 +109,45 @@ struct NetworkDiscoveryStatistics {
     int portScansSent = 0;
     
     int activeProbes = 0;
+    int discoveryRounds = 0;      // 已开始的完整发现轮数
     QDateTime discoveryStartTime;
     qint64 discoveryDuration = 0; // 毫秒
+    
+    QHash<int, ProtocolDiscoveryMetrics> protocolMetrics; // 键为ProtocolType
+    
+    /**
+     * @brief 导出为JSON对象，每个协议一个子对象
+     */
+    QJsonObject toJson() const;
+    
+    /**
+     * @brief 导出为Prometheus文本格式，可供node_exporter的textfile收集器读取
+     */
+    QByteArray toPrometheusText() const;
+    
+    /**
+     * @brief 在目录中写入 network-discovery.json 和 network-discovery.prom
+     * @return 目录无法创建或任一文件写入失败时返回false
+     */
+    bool exportTo(const QString &directory) const;
 };
 
 // 前向声明发现任务类
-class MdnsDiscoveryTask;
-class WsdDiscoveryTask;
+class DiscoveryReactor;
 class SoapDiscoveryTask;
-class SnmpDiscoveryTask;
-class UpnpDiscoveryTask;
 class PortScanTask;
+class SubnetProber;
+class NetworkScannerRegistry;
 
 /**
  * @brief 网络完整发现引擎
  * 
  * 这个类实现了完整的网络扫描仪发现功能，支持多种网络协议和发现机制，
  * 包括mDNS、WS-Discovery、SOAP/eSCL、SNMP、UPnP和端口扫描。
+ *
+ * 已知设备保存在 NetworkScannerRegistry 中，启动时立即发布，之后每个发现
+ * 间隔只做单播复核；全网段的多播发现和端口扫描在后台运行，没有新设备时
+ * 间隔逐轮加倍，网络接口变化或发现新设备后恢复。
  */
 class DSCANNER_EXPORT NetworkCompleteDiscovery : public QObject
 {
@@ -132,6 +192,15 @@ public:
      */
     NetworkDiscoveryStatistics getStatistics() const;
 
+    /**
+     * @brief 设置指标导出目录
+     *
+     * 每轮完整发现结束时在该目录写入 network-discovery.json 和
+     * network-discovery.prom。为空时不导出（默认）。
+     */
+    void setMetricsExportDirectory(const QString &directory) { m_metricsDirectory = directory; }
+    QString metricsExportDirectory() const { return m_metricsDirectory; }
+
 Q_SIGNALS:
     /**
      * @brief 发现开始信号
@@ -149,6 +218,18 @@ Q_SIGNALS:
      */
     void deviceDiscovered(const NetworkScannerDevice &device);
 
+    /**
+     * @brief 已知设备复核在线信号
+     * @param device 登记表中的设备
+     */
+    void deviceRevalidated(const NetworkScannerDevice &device);
+
+    /**
+     * @brief 已知设备连续复核失败、被移出登记表信号
+     * @param device 移除的设备
+     */
+    void deviceLost(const NetworkScannerDevice &device);
+
     /**
      * @brief 发现完成信号
      * @param devices 所有发现的设备
@@ -161,17 +242,15 @@ private Q_SLOTS:
     
     // 各协议发现任务完成处理
     void onMdnsDeviceFound(const NetworkScannerDevice &device);
-    void onMdnsDiscoveryFinished();
     void onWsdDeviceFound(const NetworkScannerDevice &device);
-    void onWsdDiscoveryFinished();
     void onSoapDeviceFound(const NetworkScannerDevice &device);
     void onSoapDiscoveryFinished();
     void onSnmpDeviceFound(const NetworkScannerDevice &device);
-    void onSnmpDiscoveryFinished();
     void onUpnpDeviceFound(const NetworkScannerDevice &device);
-    void onUpnpDiscoveryFinished();
+    void onMulticastDiscoveryFinished();
     void onPortScanDeviceFound(const NetworkScannerDevice &device);
     void onPortScanFinished();
+    void onRevalidationFinished();
 
 private:
     /**
@@ -180,17 +259,38 @@ private:
     void initializeProtocolSupport();
 
     /**
-     * @brief 执行完整网络发现
+     * @brief 执行完整网络发现（多播、SOAP和端口扫描）
      */
     void performCompleteDiscovery();
 
     /**
-     * @brief 执行mDNS发现
+     * @brief 发布登记表中的已知设备
+     */
+    void publishKnownDevices();
+
+    /**
+     * @brief 对已知设备的服务端口做单播TCP复核
+     */
+    void revalidateKnownDevices();
+
+    /**
+     * @brief 按退避间隔安排下一轮完整发现
+     * @param foundDevices 本轮是否发现了新设备
+     */
+    void scheduleWideDiscovery(bool foundDevices);
+
+    /**
+     * @brief 检查IPv4接口地址是否与上次记录的不同
+     */
+    bool networkInterfacesChanged();
+
+    /**
+     * @brief 向反应器添加mDNS查询
      */
     void performMdnsDiscovery();
 
     /**
-     * @brief 执行WS-Discovery发现
+     * @brief 向反应器添加WS-Discovery探测
      */
     void performWsdDiscovery();
 
@@ -200,12 +300,12 @@ private:
     void performSoapDiscovery();
 
     /**
-     * @brief 执行SNMP发现
+     * @brief 向反应器添加网段内各主机的SNMP查询
      */
     void performSnmpDiscovery();
 
     /**
-     * @brief 执行UPnP发现
+     * @brief 向反应器添加UPnP SSDP搜索
      */
     void performUpnpDiscovery();
 
@@ -266,6 +366,21 @@ private:
      */
     void checkDiscoveryCompletion();
 
+    /**
+     * @brief 记录一次设备响应的延迟和是否重复
+     */
+    void recordDeviceResponse(ProtocolType type, const NetworkScannerDevice &device);
+
+    /**
+     * @brief 累加一个协议的探测、超时和流量计数
+     */
+    void recordTraffic(ProtocolType type, int probes, int timeouts, qint64 bytesSent, qint64 bytesReceived);
+
+    /**
+     * @brief 将统计信息写入指标导出目录
+     */
+    void exportMetrics();
+
 private:
     mutable QMutex m_mutex;                          // 主互斥锁
     mutable QMutex m_deviceMutex;                    // 设备列表互斥锁
@@ -275,8 +390,20 @@ private:
     int m_activeProbes;                              // 活动探测数量
     
     QNetworkAccessManager *m_networkManager;        // 网络管理器
-    QTimer *m_discoveryTimer;                       // 发现计时器
+    QTimer *m_discoveryTimer;                       // 复核计时器
+    QTimer *m_wideDiscoveryTimer;                   // 完整发现计时器（单次，按退避间隔重启）
     QThreadPool *m_threadPool;                      // 线程池
+    DiscoveryReactor *m_reactor;                    // 多播/UDP发现反应器
+    SubnetProber *m_revalidator;                    // 已知设备单播复核
+    NetworkScannerRegistry *m_registry;             // 已知设备登记表
+    int m_wideDiscoveryBackoff;                     // 当前完整发现间隔(毫秒)
+    int m_newDevicesInRound;                        // 本轮完整发现的新设备数
+    QStringList m_revalidationTargets;              // 本次复核的登记表键
+    QSet<QString> m_revalidatedHosts;               // 本次复核中有响应的主机
+    QStringList m_networkSignature;                 // 上次记录的IPv4接口地址
+    QElapsedTimer m_roundClock;                     // 本轮完整发现开始计时
+    QSet<QString> m_roundReportedKeys;              // 本轮已报告的设备
+    QString m_metricsDirectory;                     // 指标导出目录
     
     QList<QNetworkInterface> m_networkInterfaces;   // 网络接口列表
     QList<QNetworkReply*> m_activeReplies;          // 活动网络请求
@@ -286,100 +413,6 @@ private:
     NetworkDiscoveryStatistics m_statistics;               // 统计信息
 };
 
-// 发现任务基类
-class DiscoveryTask : public QObject, public QRunnable
-{
-    Q_OBJECT
-public:
-    explicit DiscoveryTask(QObject *parent = nullptr) : QObject(parent) {
-        setAutoDelete(true);
-    }
-
-Q_SIGNALS:
-    void deviceFound(const NetworkScannerDevice &device);
-    void finished();
-};
-
-// mDNS发现任务
-class MdnsDiscoveryTask : public DiscoveryTask
-{
-    Q_OBJECT
-public:
-    explicit MdnsDiscoveryTask(const QString &serviceType, QObject *parent = nullptr);
-    void run() override;
-
-private:
-    QString m_serviceType;
-    NetworkScannerDevice parseMdnsResponse(const QByteArray &data, const QHostAddress &sender);
-};
-
-// WS-Discovery发现任务
-class WsdDiscoveryTask : public DiscoveryTask
-{
-    Q_OBJECT
-public:
-    explicit WsdDiscoveryTask(const QString &message, QObject *parent = nullptr);
-    void run() override;
-
-private:
-    QString m_message;
-    NetworkScannerDevice parseWsdResponse(const QByteArray &data, const QHostAddress &sender);
-};
-
-// SOAP发现任务
-class SoapDiscoveryTask : public DiscoveryTask
-{
-    Q_OBJECT
-public:
-    explicit SoapDiscoveryTask(const QNetworkAddressEntry &entry, QObject *parent = nullptr);
-    void run() override;
-
-private:
-    QNetworkAddressEntry m_networkEntry;
-    NetworkScannerDevice parseEsclResponse(const QByteArray &data, const QHostAddress &address);
-};
-
-// SNMP发现任务
-class SnmpDiscoveryTask : public DiscoveryTask
-{
-    Q_OBJECT
-public:
-    explicit SnmpDiscoveryTask(const QNetworkAddressEntry &entry, QObject *parent = nullptr);
-    void run() override;
-
-private:
-    QNetworkAddressEntry m_networkEntry;
-};
-
-// UPnP发现任务
-class UpnpDiscoveryTask : public DiscoveryTask
-{
-    Q_OBJECT
-public:
-    explicit UpnpDiscoveryTask(const QString &message, QObject *parent = nullptr);
-    void run() override;
-
-private:
-    QString m_message;
-    NetworkScannerDevice parseUpnpResponse(const QByteArray &data, const QHostAddress &sender);
-};
-
-// 端口扫描任务
-class PortScanTask : public DiscoveryTask
-{
-    Q_OBJECT
-public:
-    explicit PortScanTask(const QNetworkAddressEntry &entry, 
-                         const QList<quint16> &ports, 
-                         QObject *parent = nullptr);
-    void run() override;
-
-private:
-    QNetworkAddressEntry m_networkEntry;
-    QList<quint16> m_ports;
-    bool isKnownScannerPort(quint16 port);
-};
-
 DSCANNER_END_NAMESPACE
 
 Q_DECLARE_METATYPE(DSCANNER_NAMESPACE::NetworkScannerDevice)
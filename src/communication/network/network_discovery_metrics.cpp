@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2024 DeepinScan Team
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "network_complete_discovery.h"
+#include <QDir>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+DSCANNER_USE_NAMESPACE
+
+// 存根与完整实现共用本文件的统计和导出代码
+DSCANNER_BEGIN_NAMESPACE
+Q_LOGGING_CATEGORY(networkCompleteDiscovery, "deepinscan.network.complete")
+DSCANNER_END_NAMESPACE
+
+namespace {
+struct ProtocolCounters {
+    ProtocolType type;
+    const char *name;
+    int queries;
+    int devicesFound;
+};
+
+QVector<ProtocolCounters> protocolCounters(const NetworkDiscoveryStatistics &statistics)
+{
+    return {
+        {ProtocolType::MDNS, "mdns", statistics.mdnsQueriesSent, statistics.mdnsDevicesFound},
+        {ProtocolType::WSD, "wsd", statistics.wsdQueriesSent, statistics.wsdDevicesFound},
+        {ProtocolType::SOAP, "soap", statistics.soapQueriesSent, statistics.soapDevicesFound},
+        {ProtocolType::SNMP, "snmp", statistics.snmpQueriesSent, statistics.snmpDevicesFound},
+        {ProtocolType::UPNP, "upnp", statistics.upnpQueriesSent, statistics.upnpDevicesFound},
+        {ProtocolType::PORTSCAN, "portscan", statistics.portScansSent, statistics.portScanDevicesFound},
+    };
+}
+
+bool writeMetricsFile(const QString &path, const QByteArray &data)
+{
+    // 收集器可能随时读取，先写临时文件再替换
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) < 0 || !file.commit()) {
+        qCWarning(networkCompleteDiscovery) << "写入发现指标失败:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+}
+
+qint64 ProtocolDiscoveryMetrics::latencyPercentile(double percentile) const
+{
+    if (latencies.isEmpty()) {
+        return -1;
+    }
+    QVector<qint64> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    const int rank = static_cast<int>(std::ceil(qBound(0.0, percentile, 1.0) * sorted.size()));
+    return sorted.at(qBound(0, rank - 1, sorted.size() - 1));
+}
+
+void ProtocolDiscoveryMetrics::addLatency(qint64 latency)
+{
+    if (timeToFirstDevice < 0) {
+        timeToFirstDevice = latency;
+    }
+    latencies.append(latency);
+    if (latencies.size() > kMaxLatencySamples) {
+        latencies.removeFirst();
+    }
+    latencyCount++;
+    latencySum += latency;
+}
+
+void ProtocolDiscoveryMetrics::addTraffic(int probeCount, int timeoutCount, qint64 sentBytes, qint64 receivedBytes)
+{
+    probesSent += probeCount;
+    timeouts += timeoutCount;
+    bytesSent += sentBytes;
+    bytesReceived += receivedBytes;
+}
+
+QJsonObject NetworkDiscoveryStatistics::toJson() const
+{
+    QJsonObject protocols;
+    for (const ProtocolCounters &counters : protocolCounters(*this)) {
+        const ProtocolDiscoveryMetrics metrics = protocolMetrics.value(static_cast<int>(counters.type));
+        
+        QJsonObject latency;
+        latency[QStringLiteral("count")] = metrics.latencyCount;
+        latency[QStringLiteral("sum")] = metrics.latencySum;
+        latency[QStringLiteral("p50")] = metrics.latencies.isEmpty() ? QJsonValue() : QJsonValue(metrics.latencyPercentile(0.50));
+        latency[QStringLiteral("p95")] = metrics.latencies.isEmpty() ? QJsonValue() : QJsonValue(metrics.latencyPercentile(0.95));
+        latency[QStringLiteral("p99")] = metrics.latencies.isEmpty() ? QJsonValue() : QJsonValue(metrics.latencyPercentile(0.99));
+        
+        QJsonObject protocol;
+        protocol[QStringLiteral("queries")] = counters.queries;
+        protocol[QStringLiteral("devicesFound")] = counters.devicesFound;
+        protocol[QStringLiteral("duplicates")] = metrics.duplicates;
+        protocol[QStringLiteral("probesSent")] = metrics.probesSent;
+        protocol[QStringLiteral("timeouts")] = metrics.timeouts;
+        protocol[QStringLiteral("bytesSent")] = metrics.bytesSent;
+        protocol[QStringLiteral("bytesReceived")] = metrics.bytesReceived;
+        protocol[QStringLiteral("timeToFirstDeviceMs")] = metrics.timeToFirstDevice < 0
+            ? QJsonValue() : QJsonValue(metrics.timeToFirstDevice);
+        protocol[QStringLiteral("latencyMs")] = latency;
+        protocols[QLatin1String(counters.name)] = protocol;
+    }
+    
+    QJsonObject object;
+    object[QStringLiteral("discoveryStartTime")] = discoveryStartTime.toUTC().toString(Qt::ISODate);
+    object[QStringLiteral("discoveryDurationMs")] = discoveryDuration;
+    object[QStringLiteral("discoveryRounds")] = discoveryRounds;
+    object[QStringLiteral("totalDevicesFound")] = totalDevicesFound;
+    object[QStringLiteral("activeProbes")] = activeProbes;
+    object[QStringLiteral("protocols")] = protocols;
+    return object;
+}
+
+QByteArray NetworkDiscoveryStatistics::toPrometheusText() const
+{
+    const QVector<ProtocolCounters> counters = protocolCounters(*this);
+    QByteArray text;
+    
+    auto header = [&text](const char *name, const char *type, const char *help) {
+        text += QByteArray("# HELP deepinscan_network_discovery_") + name + ' ' + help + '\n';
+        text += QByteArray("# TYPE deepinscan_network_discovery_") + name + ' ' + type + '\n';
+    };
+    auto sample = [&text](const char *name, const char *labels, double value) {
+        text += QByteArray("deepinscan_network_discovery_") + name;
+        if (labels && *labels) {
+            text += QByteArray("{") + labels + '}';
+        }
+        text += ' ' + (std::isnan(value) ? QByteArray("NaN") : QByteArray::number(value, 'g', 12)) + '\n';
+    };
+    // 每个协议一行
+    auto family = [&](const char *name, const char *type, const char *help,
+                      const std::function<double(const ProtocolCounters &, const ProtocolDiscoveryMetrics &)> &value) {
+        header(name, type, help);
+        for (const ProtocolCounters &protocol : counters) {
+            const QByteArray labels = QByteArray("protocol=\"") + protocol.name + '"';
+            sample(name, labels.constData(), value(protocol, protocolMetrics.value(static_cast<int>(protocol.type))));
+        }
+    };
+    
+    header("rounds_total", "counter", "Wide discovery rounds started.");
+    sample("rounds_total", nullptr, discoveryRounds);
+    header("devices_found_total", "counter", "Distinct devices found.");
+    sample("devices_found_total", nullptr, totalDevicesFound);
+    
+    family("queries_total", "counter", "Discovery queries issued.",
+           [](const ProtocolCounters &c, const ProtocolDiscoveryMetrics &) { return c.queries; });
+    family("probes_sent_total", "counter", "Individual datagrams, requests or connections sent.",
+           [](const ProtocolCounters &, const ProtocolDiscoveryMetrics &m) { return m.probesSent; });
+    family("device_responses_total", "counter", "Responses that identified a device.",
+           [](const ProtocolCounters &c, const ProtocolDiscoveryMetrics &) { return c.devicesFound; });
+    family("duplicate_responses_total", "counter", "Device responses already reported in the same round.",
+           [](const ProtocolCounters &, const ProtocolDiscoveryMetrics &m) { return m.duplicates; });
+    family("timeouts_total", "counter", "Probes that received no answer.",
+           [](const ProtocolCounters &, const ProtocolDiscoveryMetrics &m) { return m.timeouts; });
+    family("sent_bytes_total", "counter", "Application payload bytes sent.",
+           [](const ProtocolCounters &, const ProtocolDiscoveryMetrics &m) { return static_cast<double>(m.bytesSent); });
+    family("received_bytes_total", "counter", "Application payload bytes received.",
+           [](const ProtocolCounters &, const ProtocolDiscoveryMetrics &m) { return static_cast<double>(m.bytesReceived); });
+    family("time_to_first_device_seconds", "gauge", "Delay until the first device answered in the latest round.",
+           [](const ProtocolCounters &, const ProtocolDiscoveryMetrics &m) {
+        return m.timeToFirstDevice < 0 ? std::nan("") : m.timeToFirstDevice / 1000.0;
+    });
+    
+    header("response_latency_seconds", "summary", "Delay from sending probes to each device response.");
+    for (const ProtocolCounters &protocol : counters) {
+        const ProtocolDiscoveryMetrics metrics = protocolMetrics.value(static_cast<int>(protocol.type));
+        for (double quantile : {0.5, 0.95, 0.99}) {
+            const qint64 latency = metrics.latencyPercentile(quantile);
+            const QByteArray labels = QByteArray("protocol=\"") + protocol.name
+                                    + "\",quantile=\"" + QByteArray::number(quantile) + '"';
+            sample("response_latency_seconds", labels.constData(), latency < 0 ? std::nan("") : latency / 1000.0);
+        }
+        const QByteArray labels = QByteArray("protocol=\"") + protocol.name + '"';
+        sample("response_latency_seconds_sum", labels.constData(), metrics.latencySum / 1000.0);
+        sample("response_latency_seconds_count", labels.constData(), static_cast<double>(metrics.latencyCount));
+    }
+    
+    return text;
+}
+
+bool NetworkDiscoveryStatistics::exportTo(const QString &directory) const
+{
+    if (!QDir().mkpath(directory)) {
+        qCWarning(networkCompleteDiscovery) << "无法创建指标导出目录:" << directory;
+        return false;
+    }
+    
+    const bool jsonWritten = writeMetricsFile(directory + QStringLiteral("/network-discovery.json"),
+                                              QJsonDocument(toJson()).toJson());
+    const bool textWritten = writeMetricsFile(directory + QStringLiteral("/network-discovery.prom"),
+                                              toPrometheusText());
+    return jsonWritten && textWritten;
+}
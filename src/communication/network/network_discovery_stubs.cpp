@@ -8,55 +8,15 @@
  * 提供缺失符号的临时实现，确保核心库可以编译
  */
 
-#include "Scanner/DScannerGlobal.h"
+#include "network_complete_discovery.h"
 #include <QObject>
 #include <QString>
-#include <QDateTime>
 #include <QList>
 #include <QDebug>
 
 namespace Dtk {
 namespace Scanner {
 
-// 前向声明必要的类型和结构体
-struct DiscoveryStatistics {
-    int devicesFound = 0;
-    int mdnsQueriesSent = 0;
-    int wsdQueriesSent = 0;
-    QString lastError;
-};
-
-// SANEAPIManager类声明 (将在后面实现)
-
-// NetworkCompleteDiscovery类声明 (将在后面实现)
-struct NetworkScannerDevice {
-    QString name;
-    QString address;
-    QString protocol;
-    QDateTime discoveryTime;
-    
-    NetworkScannerDevice() : discoveryTime(QDateTime::currentDateTime()) {}
-};
-
-// NetworkCompleteDiscovery 存根实现
-class DSCANNER_EXPORT NetworkCompleteDiscovery : public QObject
-{
-    Q_OBJECT
-
-public:
-    explicit NetworkCompleteDiscovery(QObject *parent = nullptr);
-    virtual ~NetworkCompleteDiscovery() = default;
-
-    void startDiscovery(); // 外部实现
-    void stopDiscovery() {}
-    bool isDiscovering() const; // 外部实现
-    DiscoveryStatistics getStatistics() const;
-
-Q_SIGNALS:
-    void deviceDiscovered(const NetworkScannerDevice &device);
-    void discoveryCompleted(const QList<NetworkScannerDevice> &devices);
-};
-
 // SANEAPIManager 存根实现
 class DSCANNER_EXPORT SANEAPIManager : public QObject
 {
@@ -77,14 +37,53 @@ public:
 //     return "DeepinScan Core v1.0.0";
 // }
 
-// NetworkCompleteDiscovery的方法实现
-NetworkCompleteDiscovery::NetworkCompleteDiscovery(QObject *parent) : QObject(parent) {}
+// NetworkCompleteDiscovery 存根实现
+// 类声明与完整实现共用network_complete_discovery.h，信号由moc按该头文件生成；
+// 存根不发出任何网络探测，startDiscovery()始终返回false
+NetworkCompleteDiscovery::NetworkCompleteDiscovery(QObject *parent)
+    : QObject(parent)
+    , m_isDiscovering(false)
+    , m_discoveryInterval(30000)
+    , m_activeProbes(0)
+    , m_networkManager(nullptr)
+    , m_discoveryTimer(nullptr)
+    , m_wideDiscoveryTimer(nullptr)
+    , m_threadPool(nullptr)
+    , m_reactor(nullptr)
+    , m_revalidator(nullptr)
+    , m_registry(nullptr)
+    , m_wideDiscoveryBackoff(m_discoveryInterval)
+    , m_newDevicesInRound(0)
+{
+}
+
+NetworkCompleteDiscovery::~NetworkCompleteDiscovery() = default;
+
+bool NetworkCompleteDiscovery::startDiscovery() { return false; }
+
+void NetworkCompleteDiscovery::stopDiscovery() {}
 
-DiscoveryStatistics NetworkCompleteDiscovery::getStatistics() const { return DiscoveryStatistics{}; }
+void NetworkCompleteDiscovery::setDiscoveryInterval(int seconds) { m_discoveryInterval = seconds * 1000; }
 
 bool NetworkCompleteDiscovery::isDiscovering() const { return false; }
 
-void NetworkCompleteDiscovery::startDiscovery() { /* 存根实现 */ }
+QList<NetworkScannerDevice> NetworkCompleteDiscovery::getDiscoveredDevices() const { return m_discoveredDevices; }
+
+NetworkDiscoveryStatistics NetworkCompleteDiscovery::getStatistics() const { return m_statistics; }
+
+// moc生成的元对象代码引用以下私有槽
+void NetworkCompleteDiscovery::performPeriodicDiscovery() {}
+void NetworkCompleteDiscovery::handleNetworkReply(QNetworkReply *reply) { Q_UNUSED(reply) }
+void NetworkCompleteDiscovery::onMdnsDeviceFound(const NetworkScannerDevice &device) { Q_UNUSED(device) }
+void NetworkCompleteDiscovery::onWsdDeviceFound(const NetworkScannerDevice &device) { Q_UNUSED(device) }
+void NetworkCompleteDiscovery::onSoapDeviceFound(const NetworkScannerDevice &device) { Q_UNUSED(device) }
+void NetworkCompleteDiscovery::onSoapDiscoveryFinished() {}
+void NetworkCompleteDiscovery::onSnmpDeviceFound(const NetworkScannerDevice &device) { Q_UNUSED(device) }
+void NetworkCompleteDiscovery::onUpnpDeviceFound(const NetworkScannerDevice &device) { Q_UNUSED(device) }
+void NetworkCompleteDiscovery::onMulticastDiscoveryFinished() {}
+void NetworkCompleteDiscovery::onPortScanDeviceFound(const NetworkScannerDevice &device) { Q_UNUSED(device) }
+void NetworkCompleteDiscovery::onPortScanFinished() {}
+void NetworkCompleteDiscovery::onRevalidationFinished() {}
 
 // SANEAPIManager的外部方法实现
 SANEAPIManager* SANEAPIManager::instance() {
@@ -108,16 +107,6 @@ int SANEAPIManager::sane_get_devices_impl(const void ***device_list, int local_o
     return 0; // SANE_STATUS_GOOD
 }
 
-// NetworkCompleteDiscovery的非内联方法实现
-// 注意：构造函数和析构函数已在类内联定义，这里只实现外部调用的方法
-
-// 为了解决链接问题，提供这些方法的外部符号
-extern "C" {
-    // 简单的C风格存根，避免C++复杂的链接问题
-}
-
-// 删除重复的NetworkCompleteDiscovery实现，使用已存在的实现
-
 } // namespace Scanner
 
 // 注意：MOC文件由CMake自动处理，不需要手动包含
@@ -1,7 +1,7 @@
 // SPDX-FileCopyrightText: 2024 DeepinScan Team
 // SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "network_complete_discovery.h"
+#include "network_discovery_tasks_p.h"
 #include <QDebug>
 #include <QUdpSocket>
 #include <QTcpSocket>
@@ -16,210 +16,14 @@
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QNetworkAccessManager>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFutureWatcher>
+#include <QUuid>
+#include <QtConcurrent>
 
 DSCANNER_USE_NAMESPACE
 
-// MdnsDiscoveryTask 实现
-MdnsDiscoveryTask::MdnsDiscoveryTask(const QString &serviceType, QObject *parent)
-    : DiscoveryTask(parent)
-    , m_serviceType(serviceType)
-{
-}
-
-void MdnsDiscoveryTask::run()
-{
-    qDebug() << "执行mDNS发现:" << m_serviceType;
-    
-    // 创建UDP套接字用于mDNS查询
-    QUdpSocket socket;
-    
-    // mDNS多播地址和端口
-    QHostAddress mdnsAddress("224.0.0.251");
-    quint16 mdnsPort = 5353;
-    
-    // 构建mDNS查询消息
-    QByteArray queryMessage;
-    QDataStream stream(&queryMessage, QIODevice::WriteOnly);
-    
-    // mDNS消息头
-    stream << quint16(0x1234);  // Transaction ID
-    stream << quint16(0x0000);  // Flags (Standard Query)
-    stream << quint16(0x0001);  // Questions count
-    stream << quint16(0x0000);  // Answer RRs
-    stream << quint16(0x0000);  // Authority RRs
-    stream << quint16(0x0000);  // Additional RRs
-    
-    // 查询部分 - 服务类型
-    QStringList labels = m_serviceType.split('.');
-    for (const QString &label : labels) {
-        if (!label.isEmpty()) {
-            QByteArray labelBytes = label.toUtf8();
-            stream << quint8(labelBytes.length());
-            stream.writeRawData(labelBytes.constData(), labelBytes.length());
-        }
-    }
-    stream << quint8(0x00);     // End of name
-    stream << quint16(0x000C);  // Type: PTR
-    stream << quint16(0x0001);  // Class: IN
-    
-    // 发送查询
-    if (socket.writeDatagram(queryMessage, mdnsAddress, mdnsPort) == -1) {
-        qWarning() << "mDNS查询发送失败:" << socket.errorString();
-        emit finished();
-        return;
-    }
-    
-    // 监听响应
-    QEventLoop loop;
-    QTimer timeout;
-    timeout.setSingleShot(true);
-    timeout.setInterval(3000); // 3秒超时
-    
-    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
-    connect(&socket, &QUdpSocket::readyRead, [&]() {
-        while (socket.hasPendingDatagrams()) {
-            QByteArray response;
-            response.resize(socket.pendingDatagramSize());
-            QHostAddress sender;
-            quint16 senderPort;
-            
-            socket.readDatagram(response.data(), response.size(), &sender, &senderPort);
-            
-            // 解析mDNS响应
-            NetworkScannerDevice device = parseMdnsResponse(response, sender);
-            if (!device.makeAndModel.isEmpty()) {
-                device.protocol = "mDNS";
-                device.discoveryMethod = "mDNS/" + m_serviceType;
-                emit deviceFound(device);
-            }
-        }
-        loop.quit();
-    });
-    
-    timeout.start();
-    loop.exec();
-    
-    emit finished();
-}
-
-NetworkScannerDevice MdnsDiscoveryTask::parseMdnsResponse(const QByteArray &data, const QHostAddress &sender)
-{
-    NetworkScannerDevice device;
-    
-    // 简化的mDNS响应解析
-    if (data.contains("scanner") || data.contains("Canon") || data.contains("HP") || 
-        data.contains("Epson") || data.contains("Brother")) {
-        
-        device.addresses << sender.toString();
-        device.makeAndModel = "网络扫描仪";
-        device.deviceType = "Scanner";
-        device.uuid = QUuid::createUuid().toString();
-        
-        // 尝试提取更多信息
-        QString dataStr = QString::fromUtf8(data);
-        QStringList lines = dataStr.split('\n');
-        
-        for (const QString &line : lines) {
-            if (line.contains("model", Qt::CaseInsensitive)) {
-                device.makeAndModel = line.trimmed();
-                break;
-            }
-        }
-    }
-    
-    return device;
-}
-
-// WsdDiscoveryTask 实现
-WsdDiscoveryTask::WsdDiscoveryTask(const QString &message, QObject *parent)
-    : DiscoveryTask(parent)
-    , m_message(message)
-{
-}
-
-void WsdDiscoveryTask::run()
-{
-    qDebug() << "执行WS-Discovery发现";
-    
-    // 创建UDP套接字用于WS-Discovery
-    QUdpSocket socket;
-    
-    // WS-Discovery多播地址和端口
-    QHostAddress wsdAddress("239.255.255.250");
-    quint16 wsdPort = 3702;
-    
-    // 发送WS-Discovery Probe消息
-    QByteArray message = m_message.toUtf8();
-    if (socket.writeDatagram(message, wsdAddress, wsdPort) == -1) {
-        qWarning() << "WS-Discovery查询发送失败:" << socket.errorString();
-        emit finished();
-        return;
-    }
-    
-    // 监听响应
-    QEventLoop loop;
-    QTimer timeout;
-    timeout.setSingleShot(true);
-    timeout.setInterval(5000); // 5秒超时
-    
-    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
-    connect(&socket, &QUdpSocket::readyRead, [&]() {
-        while (socket.hasPendingDatagrams()) {
-            QByteArray response;
-            response.resize(socket.pendingDatagramSize());
-            QHostAddress sender;
-            quint16 senderPort;
-            
-            socket.readDatagram(response.data(), response.size(), &sender, &senderPort);
-            
-            // 解析WSD响应
-            NetworkScannerDevice device = parseWsdResponse(response, sender);
-            if (!device.makeAndModel.isEmpty()) {
-                device.protocol = "WSD";
-                device.discoveryMethod = "WS-Discovery";
-                emit deviceFound(device);
-            }
-        }
-        loop.quit();
-    });
-    
-    timeout.start();
-    loop.exec();
-    
-    emit finished();
-}
-
-NetworkScannerDevice WsdDiscoveryTask::parseWsdResponse(const QByteArray &data, const QHostAddress &sender)
-{
-    NetworkScannerDevice device;
-    
-    QXmlStreamReader xml(data);
-    
-    while (!xml.atEnd()) {
-        xml.readNext();
-        
-        if (xml.isStartElement()) {
-            if (xml.name() == "ProbeMatches" || xml.name() == "ResolveMatches") {
-                device.protocol = "WSD";
-                device.addresses << sender.toString();
-            } else if (xml.name() == "Types") {
-                QString types = xml.readElementText();
-                if (types.contains("Scanner") || types.contains("MFP")) {
-                    device.deviceType = "Scanner";
-                    device.makeAndModel = "WS-Discovery 扫描仪";
-                    device.uuid = QUuid::createUuid().toString();
-                }
-            } else if (xml.name() == "Scopes") {
-                device.scopes = xml.readElementText();
-            } else if (xml.name() == "XAddrs") {
-                device.addresses = xml.readElementText().split(' ', Qt::SkipEmptyParts);
-            }
-        }
-    }
-    
-    return device;
-}
-
 // SoapDiscoveryTask 实现
 SoapDiscoveryTask::SoapDiscoveryTask(const QNetworkAddressEntry &entry, QObject *parent)
     : DiscoveryTask(parent)
@@ -232,6 +36,9 @@ void SoapDiscoveryTask::run()
     qDebug() << "执行SOAP/eSCL发现，网段:" << m_networkEntry.ip().toString();
     
     QNetworkAccessManager manager;
+    int requests = 0;
+    int timeouts = 0;
+    qint64 bytesReceived = 0;
     
     // 计算网段范围
     QHostAddress networkAddr = m_networkEntry.ip();
@@ -267,6 +74,7 @@ void SoapDiscoveryTask::run()
             request.setHeader(QNetworkRequest::ContentTypeHeader, "application/xml");
             
             QNetworkReply *reply = manager.get(request);
+            ++requests;
             
             QEventLoop loop;
             QTimer timeout;
@@ -279,8 +87,12 @@ void SoapDiscoveryTask::run()
             timeout.start();
             loop.exec();
             
-            if (reply->error() == QNetworkReply::NoError) {
+            if (!reply->isFinished()) {
+                ++timeouts;
+                reply->abort();
+            } else if (reply->error() == QNetworkReply::NoError) {
                 QByteArray data = reply->readAll();
+                bytesReceived += data.size();
                 NetworkScannerDevice device = parseEsclResponse(data, targetAddr);
                 if (!device.makeAndModel.isEmpty()) {
                     device.protocol = "eSCL";
@@ -294,6 +106,8 @@ void SoapDiscoveryTask::run()
         }
     }
     
+    // GET请求没有载荷
+    emit trafficMeasured(requests, timeouts, 0, bytesReceived);
     emit finished();
 }
 
@@ -332,138 +146,347 @@ NetworkScannerDevice SoapDiscoveryTask::parseEsclResponse(const QByteArray &data
     return device;
 }
 
-// SnmpDiscoveryTask 实现
-SnmpDiscoveryTask::SnmpDiscoveryTask(const QNetworkAddressEntry &entry, QObject *parent)
-    : DiscoveryTask(parent)
-    , m_networkEntry(entry)
+// DiscoveryReactor 实现
+namespace {
+constexpr int kDefaultReactorWindow = 3000;
+constexpr int kMaxDatagramSize = 64 * 1024;
+
+QByteArray berEncode(quint8 tag, const QByteArray &content)
 {
+    // 报文很短，长度总是单字节形式
+    QByteArray tlv;
+    tlv.append(static_cast<char>(tag));
+    tlv.append(static_cast<char>(content.size()));
+    tlv.append(content);
+    return tlv;
+}
 }
 
-void SnmpDiscoveryTask::run()
+DiscoveryReactor::DiscoveryReactor(QThreadPool *pool, QObject *parent)
+    : QObject(parent)
+    , m_pool(pool)
+    , m_windowTimer(new QTimer(this))
+    , m_window(kDefaultReactorWindow)
+    , m_pendingParses(0)
+    , m_running(false)
+    , m_windowOpen(false)
 {
-    qDebug() << "执行SNMP发现，网段:" << m_networkEntry.ip().toString();
+    for (QUdpSocket *&socket : m_sockets) {
+        socket = nullptr;
+    }
     
-    // 计算网段范围
-    QHostAddress networkAddr = m_networkEntry.ip();
-    QHostAddress netmask = m_networkEntry.netmask();
+    m_windowTimer->setSingleShot(true);
+    connect(m_windowTimer, &QTimer::timeout, this, [this]() {
+        m_windowOpen = false;
+        closeSockets();
+        countTimeouts();
+        checkFinished();
+    });
+}
+
+DiscoveryReactor::~DiscoveryReactor()
+{
+    stop();
+}
+
+void DiscoveryReactor::setWindow(int milliseconds)
+{
+    m_window = qMax(1, milliseconds);
+}
+
+void DiscoveryReactor::addProbe(Protocol protocol, const QByteArray &datagram,
+                                const QHostAddress &address, quint16 port)
+{
+    m_probes.append({protocol, datagram, address, port, address.isMulticast() || address.isBroadcast()});
+}
+
+bool DiscoveryReactor::addBroadcastProbe(Protocol protocol, const QByteArray &datagram,
+                                         const QNetworkAddressEntry &entry, quint16 port)
+{
+    const QHostAddress broadcast = entry.broadcast();
+    if (entry.ip().protocol() != QAbstractSocket::IPv4Protocol || broadcast.isNull()) {
+        return false;
+    }
+    m_probes.append({protocol, datagram, broadcast, port, true});
+    return true;
+}
+
+bool DiscoveryReactor::start()
+{
+    if (m_running) {
+        return false;
+    }
     
-    quint32 network = networkAddr.toIPv4Address() & netmask.toIPv4Address();
-    quint32 mask = netmask.toIPv4Address();
-    quint32 hostBits = ~mask;
+    const QList<Probe> probes = m_probes;
+    m_probes.clear();
+    if (probes.isEmpty()) {
+        return false;
+    }
     
-    // 限制扫描范围
-    int maxHosts = qMin(254, static_cast<int>(hostBits));
+    m_running = true;
+    m_windowOpen = true;
+    m_sentProbes = probes;
+    for (int i = 0; i < ProtocolCount; ++i) {
+        m_traffic[i] = Traffic();
+        m_responders[i].clear();
+    }
     
-    for (int i = 1; i <= maxHosts && i <= 30; ++i) { // 限制为前30个IP
-        quint32 hostAddr = network | i;
-        QHostAddress targetAddr(hostAddr);
-        
-        // 尝试SNMP查询
-        QUdpSocket socket;
-        
-        // 构建简单的SNMP GET请求 (sysDescr OID: 1.3.6.1.2.1.1.1.0)
-        QByteArray snmpRequest;
-        // 这里应该构建正确的SNMP PDU，为简化起见使用简化版本
-        
-        if (socket.writeDatagram(snmpRequest, targetAddr, 161) != -1) {
-            // 监听SNMP响应
-            QEventLoop loop;
-            QTimer timeout;
-            timeout.setSingleShot(true);
-            timeout.setInterval(1000); // 1秒超时
-            
-            connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
-            connect(&socket, &QUdpSocket::readyRead, [&]() {
-                QByteArray response;
-                response.resize(socket.pendingDatagramSize());
-                socket.readDatagram(response.data(), response.size());
-                
-                // 简化的SNMP响应检查
-                if (response.contains("Canon") || response.contains("HP") ||
-                    response.contains("Epson") || response.contains("Brother") ||
-                    response.contains("Scanner") || response.contains("MFP")) {
-                    
-                    NetworkScannerDevice device;
-                    device.protocol = "SNMP";
-                    device.discoveryMethod = "SNMP";
-                    device.addresses << targetAddr.toString();
-                    device.makeAndModel = "SNMP 扫描仪";
-                    device.deviceType = "Scanner";
-                    device.uuid = QUuid::createUuid().toString();
-                    
-                    emit deviceFound(device);
-                }
-                loop.quit();
+    // 每种协议一个套接字，响应按到达的套接字区分协议
+    for (const Probe &probe : probes) {
+        QUdpSocket *socket = m_sockets[probe.protocol];
+        if (!socket) {
+            socket = new QUdpSocket(this);
+            if (!socket->bind(QHostAddress::AnyIPv4, 0)) {
+                qWarning() << "发现套接字绑定失败:" << socket->errorString();
+            }
+            const Protocol protocol = probe.protocol;
+            connect(socket, &QUdpSocket::readyRead, this, [this, protocol]() {
+                readPending(protocol);
             });
-            
-            timeout.start();
-            loop.exec();
+            m_sockets[probe.protocol] = socket;
+        }
+        
+        const qint64 written = socket->writeDatagram(probe.datagram, probe.address, probe.port);
+        if (written == -1) {
+            qWarning() << "发现报文发送失败:" << probe.address.toString() << probe.port
+                       << socket->errorString();
+            continue;
         }
+        m_traffic[probe.protocol].probes++;
+        m_traffic[probe.protocol].bytesSent += written;
     }
     
-    emit finished();
+    m_windowTimer->start(m_window);
+    return true;
 }
 
-// UpnpDiscoveryTask 实现
-UpnpDiscoveryTask::UpnpDiscoveryTask(const QString &message, QObject *parent)
-    : DiscoveryTask(parent)
-    , m_message(message)
+void DiscoveryReactor::stop()
+{
+    m_windowTimer->stop();
+    closeSockets();
+    
+    // 解析任务只处理自身的数据，不引用本对象，放弃结果即可
+    const QList<QFutureWatcherBase*> watchers = findChildren<QFutureWatcherBase*>();
+    for (QFutureWatcherBase *watcher : watchers) {
+        watcher->disconnect(this);
+        watcher->deleteLater();
+    }
+    m_pendingParses = 0;
+    m_sentProbes.clear();
+    m_windowOpen = false;
+    m_running = false;
+}
+
+void DiscoveryReactor::closeSockets()
 {
+    for (QUdpSocket *&socket : m_sockets) {
+        if (socket) {
+            socket->disconnect(this);
+            socket->close();
+            socket->deleteLater();
+            socket = nullptr;
+        }
+    }
 }
 
-void UpnpDiscoveryTask::run()
+QByteArray DiscoveryReactor::buildMdnsQuery(const QStringList &serviceTypes)
 {
-    qDebug() << "执行UPnP发现";
+    QByteArray queryMessage;
+    QDataStream stream(&queryMessage, QIODevice::WriteOnly);
     
-    // 创建UDP套接字用于UPnP SSDP
-    QUdpSocket socket;
+    // 所有服务类型放在同一个查询报文中
+    QStringList questions = serviceTypes;
+    questions.removeDuplicates();
     
-    // UPnP SSDP多播地址和端口
-    QHostAddress upnpAddress("239.255.255.250");
-    quint16 upnpPort = 1900;
+    stream << quint16(0x0000);  // Transaction ID
+    stream << quint16(0x0000);  // Flags (Standard Query)
+    stream << quint16(questions.size());  // Questions count
+    stream << quint16(0x0000);  // Answer RRs
+    stream << quint16(0x0000);  // Authority RRs
+    stream << quint16(0x0000);  // Additional RRs
     
-    // 发送SSDP M-SEARCH消息
-    QByteArray message = m_message.toUtf8();
-    if (socket.writeDatagram(message, upnpAddress, upnpPort) == -1) {
-        qWarning() << "UPnP SSDP查询发送失败:" << socket.errorString();
-        emit finished();
-        return;
+    for (const QString &serviceType : questions) {
+        const QStringList labels = serviceType.split('.');
+        for (const QString &label : labels) {
+            if (!label.isEmpty()) {
+                QByteArray labelBytes = label.toUtf8();
+                stream << quint8(labelBytes.length());
+                stream.writeRawData(labelBytes.constData(), labelBytes.length());
+            }
+        }
+        stream << quint8(0x00);     // End of name
+        stream << quint16(0x000C);  // Type: PTR
+        stream << quint16(0x0001);  // Class: IN
     }
     
-    // 监听响应
-    QEventLoop loop;
-    QTimer timeout;
-    timeout.setSingleShot(true);
-    timeout.setInterval(3000); // 3秒超时
-    
-    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
-    connect(&socket, &QUdpSocket::readyRead, [&]() {
-        while (socket.hasPendingDatagrams()) {
-            QByteArray response;
-            response.resize(socket.pendingDatagramSize());
-            QHostAddress sender;
-            quint16 senderPort;
-            
-            socket.readDatagram(response.data(), response.size(), &sender, &senderPort);
-            
-            // 解析UPnP响应
-            NetworkScannerDevice device = parseUpnpResponse(response, sender);
+    return queryMessage;
+}
+
+QByteArray DiscoveryReactor::buildSnmpGetRequest(quint32 requestId)
+{
+    // SNMPv1 GetRequest，团体名public，查询sysDescr (1.3.6.1.2.1.1.1.0)
+    static const char sysDescrOid[] = {0x2B, 0x06, 0x01, 0x02, 0x01, 0x01, 0x01, 0x00};
+    
+    QByteArray id(4, Qt::Uninitialized);
+    for (int i = 0; i < 4; ++i) {
+        id[i] = static_cast<char>((requestId >> (24 - 8 * i)) & 0xFF);
+    }
+    
+    const QByteArray varBind = berEncode(0x30, berEncode(0x06, QByteArray(sysDescrOid, sizeof(sysDescrOid)))
+                                              + berEncode(0x05, QByteArray()));
+    const QByteArray pdu = berEncode(0x02, id)
+                         + berEncode(0x02, QByteArray(1, '\0'))     // error-status
+                         + berEncode(0x02, QByteArray(1, '\0'))     // error-index
+                         + berEncode(0x30, varBind);
+    return berEncode(0x30, berEncode(0x02, QByteArray(1, '\0'))     // version: SNMPv1
+                           + berEncode(0x04, QByteArrayLiteral("public"))
+                           + berEncode(0xA0, pdu));
+}
+
+NetworkScannerDevice DiscoveryReactor::parseDatagram(Protocol protocol, const QByteArray &data,
+                                                     const QHostAddress &sender)
+{
+    NetworkScannerDevice device;
+    switch (protocol) {
+    case Mdns:
+        device = parseMdnsResponse(data, sender);
+        device.protocol = "mDNS";
+        device.discoveryMethod = "mDNS";
+        break;
+    case Wsd:
+        device = parseWsdResponse(data, sender);
+        device.protocol = "WSD";
+        device.discoveryMethod = "WS-Discovery";
+        break;
+    case Ssdp:
+        device = parseSsdpResponse(data, sender);
+        device.protocol = "UPnP";
+        device.discoveryMethod = "UPnP/SSDP";
+        break;
+    case Snmp:
+        device = parseSnmpResponse(data, sender);
+        break;
+    default:
+        break;
+    }
+    return device;
+}
+
+void DiscoveryReactor::readPending(Protocol protocol)
+{
+    QUdpSocket *socket = m_sockets[protocol];
+    while (socket && socket->hasPendingDatagrams()) {
+        const qint64 size = socket->pendingDatagramSize();
+        QByteArray datagram(static_cast<int>(qBound<qint64>(0, size, kMaxDatagramSize)), Qt::Uninitialized);
+        QHostAddress sender;
+        const qint64 received = socket->readDatagram(datagram.data(), datagram.size(), &sender);
+        if (received < 0) {
+            continue;
+        }
+        m_traffic[protocol].bytesReceived += received;
+        m_responders[protocol].insert(sender.toString());
+        
+        // 解析在线程池中进行，反应器线程只负责收发
+        auto *watcher = new QFutureWatcher<NetworkScannerDevice>(this);
+        connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, protocol]() {
+            const NetworkScannerDevice device = watcher->result();
+            watcher->deleteLater();
+            --m_pendingParses;
             if (!device.makeAndModel.isEmpty()) {
-                device.protocol = "UPnP";
-                device.discoveryMethod = "UPnP/SSDP";
-                emit deviceFound(device);
+                emit deviceFound(protocol, device);
             }
+            checkFinished();
+        });
+        ++m_pendingParses;
+        watcher->setFuture(QtConcurrent::run(m_pool, [protocol, datagram, sender]() {
+            return parseDatagram(protocol, datagram, sender);
+        }));
+    }
+}
+
+void DiscoveryReactor::countTimeouts()
+{
+    // 多播、广播探测只要有任何应答即不算超时，单播探测按目标地址判断
+    for (const Probe &probe : qAsConst(m_sentProbes)) {
+        const QSet<QString> &responders = m_responders[probe.protocol];
+        const bool answered = probe.group
+            ? !responders.isEmpty()
+            : responders.contains(probe.address.toString());
+        if (!answered) {
+            m_traffic[probe.protocol].timeouts++;
         }
-        loop.quit();
-    });
+    }
+    m_sentProbes.clear();
+}
+
+void DiscoveryReactor::checkFinished()
+{
+    if (m_running && !m_windowOpen && m_pendingParses == 0) {
+        m_running = false;
+        emit finished();
+    }
+}
+
+NetworkScannerDevice DiscoveryReactor::parseMdnsResponse(const QByteArray &data, const QHostAddress &sender)
+{
+    NetworkScannerDevice device;
     
-    timeout.start();
-    loop.exec();
+    // 简化的mDNS响应解析
+    if (data.contains("scanner") || data.contains("Canon") || data.contains("HP") || 
+        data.contains("Epson") || data.contains("Brother")) {
+        
+        device.addresses << sender.toString();
+        device.makeAndModel = "网络扫描仪";
+        device.deviceType = "Scanner";
+        device.uuid = QUuid::createUuid().toString();
+        
+        // 尝试提取更多信息
+        QString dataStr = QString::fromUtf8(data);
+        QStringList lines = dataStr.split('\n');
+        
+        for (const QString &line : lines) {
+            if (line.contains("model", Qt::CaseInsensitive)) {
+                device.makeAndModel = line.trimmed();
+                break;
+            }
+        }
+    }
     
-    emit finished();
+    return device;
+}
+
+NetworkScannerDevice DiscoveryReactor::parseWsdResponse(const QByteArray &data, const QHostAddress &sender)
+{
+    NetworkScannerDevice device;
+    
+    QXmlStreamReader xml(data);
+    
+    while (!xml.atEnd()) {
+        xml.readNext();
+        
+        if (xml.isStartElement()) {
+            if (xml.name() == "ProbeMatches" || xml.name() == "ResolveMatches") {
+                device.protocol = "WSD";
+                device.addresses << sender.toString();
+            } else if (xml.name() == "Types") {
+                QString types = xml.readElementText();
+                if (types.contains("Scanner") || types.contains("MFP")) {
+                    device.deviceType = "Scanner";
+                    device.makeAndModel = "WS-Discovery 扫描仪";
+                    device.uuid = QUuid::createUuid().toString();
+                }
+            } else if (xml.name() == "Scopes") {
+                device.scopes = xml.readElementText();
+            } else if (xml.name() == "XAddrs") {
+                device.addresses = xml.readElementText().split(' ', Qt::SkipEmptyParts);
+            }
+        }
+    }
+    
+    return device;
 }
 
-NetworkScannerDevice UpnpDiscoveryTask::parseUpnpResponse(const QByteArray &data, const QHostAddress &sender)
+NetworkScannerDevice DiscoveryReactor::parseSsdpResponse(const QByteArray &data, const QHostAddress &sender)
 {
     NetworkScannerDevice device;
     
@@ -496,6 +519,235 @@ NetworkScannerDevice UpnpDiscoveryTask::parseUpnpResponse(const QByteArray &data
     return device;
 }
 
+NetworkScannerDevice DiscoveryReactor::parseSnmpResponse(const QByteArray &data, const QHostAddress &sender)
+{
+    NetworkScannerDevice device;
+    
+    // 简化的SNMP响应检查
+    if (data.contains("Canon") || data.contains("HP") ||
+        data.contains("Epson") || data.contains("Brother") ||
+        data.contains("Scanner") || data.contains("MFP")) {
+        device.protocol = "SNMP";
+        device.discoveryMethod = "SNMP";
+        device.addresses << sender.toString();
+        device.makeAndModel = "SNMP 扫描仪";
+        device.deviceType = "Scanner";
+        device.uuid = QUuid::createUuid().toString();
+    }
+    
+    return device;
+}
+
+// SubnetProber 实现
+namespace {
+constexpr int kDefaultMaxInFlight = 256;
+constexpr int kDefaultMinTimeout = 150;
+constexpr int kDefaultMaxTimeout = 1000;
+constexpr int kSweepInterval = 25;
+}
+
+SubnetProber::SubnetProber(QObject *parent)
+    : QObject(parent)
+    , m_nextIndex(0)
+    , m_total(0)
+    , m_timeouts(0)
+    , m_sweepTimer(new QTimer(this))
+    , m_maxInFlight(kDefaultMaxInFlight)
+    , m_minTimeout(kDefaultMinTimeout)
+    , m_maxTimeout(kDefaultMaxTimeout)
+    , m_srtt(0.0)
+    , m_rttVar(0.0)
+    , m_hasRtt(false)
+    , m_running(false)
+    , m_launching(false)
+{
+    // 所有连接共用一个定时器检查超时
+    m_sweepTimer->setInterval(kSweepInterval);
+    connect(m_sweepTimer, &QTimer::timeout, this, &SubnetProber::sweepTimeouts);
+}
+
+SubnetProber::~SubnetProber()
+{
+    stop();
+}
+
+void SubnetProber::setMaxInFlight(int count)
+{
+    m_maxInFlight = qMax(1, count);
+}
+
+void SubnetProber::setTimeoutBounds(int minimumMs, int maximumMs)
+{
+    m_minTimeout = qMax(1, minimumMs);
+    m_maxTimeout = qMax(m_minTimeout, maximumMs);
+}
+
+void SubnetProber::start(const QList<QHostAddress> &hosts, const QList<quint16> &ports)
+{
+    stop();
+
+    m_hosts = hosts;
+    m_ports = ports;
+    m_nextIndex = 0;
+    m_total = static_cast<qint64>(hosts.size()) * ports.size();
+    m_timeouts = 0;
+    m_hasRtt = false;
+    m_clock.start();
+
+    if (m_total == 0) {
+        emit finished();
+        return;
+    }
+
+    m_running = true;
+    m_sweepTimer->start();
+    launchMore();
+}
+
+void SubnetProber::stop()
+{
+    m_sweepTimer->stop();
+    for (auto it = m_inFlight.begin(); it != m_inFlight.end(); ++it) {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+    m_inFlight.clear();
+    m_running = false;
+}
+
+int SubnetProber::currentTimeout() const
+{
+    if (!m_hasRtt) {
+        return m_maxTimeout;
+    }
+    // RFC 6298: RTO = SRTT + 4·RTTVAR
+    const int timeout = static_cast<int>(m_srtt + 4.0 * m_rttVar);
+    return qBound(m_minTimeout, timeout, m_maxTimeout);
+}
+
+QList<QHostAddress> SubnetProber::subnetHosts(const QNetworkAddressEntry &entry, int minimumPrefix)
+{
+    QList<QHostAddress> hosts;
+    if (entry.ip().protocol() != QAbstractSocket::IPv4Protocol) {
+        return hosts;
+    }
+
+    const int prefix = qMax(entry.prefixLength(), minimumPrefix);
+    if (prefix < 0 || prefix > 30) {
+        return hosts;
+    }
+
+    const quint32 ip = entry.ip().toIPv4Address();
+    const quint32 mask = prefix == 0 ? 0 : ~quint32(0) << (32 - prefix);
+    const quint32 network = ip & mask;
+    const quint32 broadcast = network | ~mask;
+    hosts.reserve(static_cast<int>(broadcast - network - 1));
+    for (quint32 address = network + 1; address < broadcast; ++address) {
+        if (address != ip) {
+            hosts.append(QHostAddress(address));
+        }
+    }
+    return hosts;
+}
+
+void SubnetProber::launchMore()
+{
+    // 嵌套调用时由外层循环继续补充
+    if (m_launching) {
+        return;
+    }
+    m_launching = true;
+
+    while (m_running && m_inFlight.size() < m_maxInFlight && m_nextIndex < m_total) {
+        const int hostIndex = static_cast<int>(m_nextIndex / m_ports.size());
+        const int portIndex = static_cast<int>(m_nextIndex % m_ports.size());
+        ++m_nextIndex;
+
+        Probe probe;
+        probe.address = m_hosts.at(hostIndex);
+        probe.port = m_ports.at(portIndex);
+        probe.startedAt = m_clock.elapsed();
+        probe.deadline = probe.startedAt + currentTimeout();
+
+        auto *socket = new QTcpSocket(this);
+        m_inFlight.insert(socket, probe);
+
+        connect(socket, &QTcpSocket::connected, this, [this, socket]() {
+            complete(socket, true, true);
+        });
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        connect(socket, &QAbstractSocket::errorOccurred, this, [this, socket](QAbstractSocket::SocketError error) {
+#else
+        connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this,
+                [this, socket](QAbstractSocket::SocketError error) {
+#endif
+            // 连接被拒绝说明主机在线，同样是有效的RTT样本
+            complete(socket, false, error == QAbstractSocket::ConnectionRefusedError);
+        });
+
+        socket->connectToHost(probe.address, probe.port);
+    }
+    m_launching = false;
+
+    if (m_running && m_inFlight.isEmpty() && m_nextIndex >= m_total) {
+        m_sweepTimer->stop();
+        m_running = false;
+        emit finished();
+    }
+}
+
+void SubnetProber::complete(QTcpSocket *socket, bool open, bool answered)
+{
+    auto it = m_inFlight.find(socket);
+    if (it == m_inFlight.end()) {
+        return;
+    }
+    const Probe probe = it.value();
+    m_inFlight.erase(it);
+
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+
+    if (answered) {
+        addRttSample(m_clock.elapsed() - probe.startedAt);
+    }
+    if (open) {
+        emit portOpen(probe.address, probe.port);
+    }
+
+    launchMore();
+}
+
+void SubnetProber::sweepTimeouts()
+{
+    const qint64 now = m_clock.elapsed();
+    QList<QTcpSocket*> expired;
+    for (auto it = m_inFlight.cbegin(); it != m_inFlight.cend(); ++it) {
+        if (it.value().deadline <= now) {
+            expired.append(it.key());
+        }
+    }
+    m_timeouts += expired.size();
+    for (QTcpSocket *socket : expired) {
+        complete(socket, false, false);
+    }
+}
+
+void SubnetProber::addRttSample(qint64 rtt)
+{
+    const double sample = static_cast<double>(rtt);
+    if (!m_hasRtt) {
+        m_srtt = sample;
+        m_rttVar = sample / 2.0;
+        m_hasRtt = true;
+    } else {
+        m_rttVar = 0.75 * m_rttVar + 0.25 * qAbs(m_srtt - sample);
+        m_srtt = 0.875 * m_srtt + 0.125 * sample;
+    }
+}
+
 // PortScanTask 实现
 PortScanTask::PortScanTask(const QNetworkAddressEntry &entry, const QList<quint16> &ports, QObject *parent)
     : DiscoveryTask(parent)
@@ -506,49 +758,51 @@ PortScanTask::PortScanTask(const QNetworkAddressEntry &entry, const QList<quint1
 
 void PortScanTask::run()
 {
-    qDebug() << "执行端口扫描发现，网段:" << m_networkEntry.ip().toString();
-    
-    // 计算网段范围
-    QHostAddress networkAddr = m_networkEntry.ip();
-    QHostAddress netmask = m_networkEntry.netmask();
+    qDebug() << "执行端口扫描发现，网段:" << m_networkEntry.ip().toString() << "/" << m_networkEntry.prefixLength();
     
-    quint32 network = networkAddr.toIPv4Address() & netmask.toIPv4Address();
-    quint32 mask = netmask.toIPv4Address();
-    quint32 hostBits = ~mask;
+    // 非扫描仪端口的结果不会被使用，无需探测
+    QList<quint16> ports;
+    for (quint16 port : m_ports) {
+        if (isKnownScannerPort(port)) {
+            ports.append(port);
+        }
+    }
     
-    // 限制扫描范围
-    int maxHosts = qMin(254, static_cast<int>(hostBits));
+    const QList<QHostAddress> hosts = SubnetProber::subnetHosts(m_networkEntry);
     
-    for (int i = 1; i <= maxHosts && i <= 20; ++i) { // 限制为前20个IP
-        quint32 hostAddr = network | i;
-        QHostAddress targetAddr(hostAddr);
+    SubnetProber prober;
+    QEventLoop loop;
+    int found = 0;
+    connect(&prober, &SubnetProber::portOpen, [this, &found](const QHostAddress &address, quint16 port) {
+        qDebug() << "发现开放端口:" << address.toString() << ":" << port;
         
-        for (quint16 port : m_ports) {
-            QTcpSocket socket;
-            socket.connectToHost(targetAddr, port);
-            
-            if (socket.waitForConnected(1000)) { // 1秒连接超时
-                qDebug() << "发现开放端口:" << targetAddr.toString() << ":" << port;
-                
-                // 检查是否是扫描仪相关的端口
-                if (isKnownScannerPort(port)) {
-                    NetworkScannerDevice device;
-                    device.protocol = "TCP";
-                    device.discoveryMethod = "端口扫描";
-                    device.addresses << targetAddr.toString();
-                    device.makeAndModel = QString("端口 %1 扫描仪").arg(port);
-                    device.deviceType = "Scanner";
-                    device.uuid = QUuid::createUuid().toString();
-                    device.baseUrl = QUrl(QString("http://%1:%2").arg(targetAddr.toString()).arg(port));
-                    
-                    emit deviceFound(device);
-                }
-                
-                socket.disconnectFromHost();
-            }
-        }
+        NetworkScannerDevice device;
+        device.protocol = "TCP";
+        device.discoveryMethod = "端口扫描";
+        device.addresses << address.toString();
+        device.makeAndModel = QString("端口 %1 扫描仪").arg(port);
+        device.deviceType = "Scanner";
+        // 同一地址和端口在每轮发现中使用相同的标识
+        device.uuid = QString("portscan:%1:%2").arg(address.toString()).arg(port);
+        device.baseUrl = QUrl(QString("http://%1:%2").arg(address.toString()).arg(port));
+        
+        ++found;
+        emit deviceFound(device);
+    });
+    connect(&prober, &SubnetProber::finished, &loop, &QEventLoop::quit);
+    
+    QElapsedTimer timer;
+    timer.start();
+    prober.start(hosts, ports);
+    if (prober.isRunning()) {
+        loop.exec();
     }
     
+    qDebug() << "端口扫描完成:" << hosts.size() << "个主机," << ports.size() << "个端口,"
+             << found << "个开放端口, 用时" << timer.elapsed() << "ms";
+    
+    // 只建立TCP连接，不收发载荷
+    emit trafficMeasured(hosts.size() * ports.size(), prober.timeoutCount(), 0, 0);
     emit finished();
 }
 
@@ -570,4 +824,4 @@ bool PortScanTask::isKnownScannerPort(quint16 port)
     return scannerPorts.contains(port);
 }
 
-#include "network_discovery_tasks.moc" 
\ No newline at end of file
+#include "moc_network_discovery_tasks_p.cpp"
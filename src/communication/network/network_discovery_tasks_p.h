@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: 2024 DeepinScan Team
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETWORK_DISCOVERY_TASKS_P_H
+#define NETWORK_DISCOVERY_TASKS_P_H
+
+#include "network_complete_discovery.h"
+#include <QRunnable>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QUdpSocket>
+
+DSCANNER_BEGIN_NAMESPACE
+
+// 发现任务基类
+class DiscoveryTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    explicit DiscoveryTask(QObject *parent = nullptr) : QObject(parent) {
+        setAutoDelete(true);
+    }
+
+Q_SIGNALS:
+    void deviceFound(const NetworkScannerDevice &device);
+    // 在finished()之前发出，报告本任务的探测、超时和载荷字节数
+    void trafficMeasured(int probes, int timeouts, qint64 bytesSent, qint64 bytesReceived);
+    void finished();
+};
+
+// UDP发现反应器：每种协议一个套接字，所有探测一次发出，在同一个
+// 超时窗口内收集响应；报文解析交给线程池，不占用阻塞等待的线程
+class DiscoveryReactor : public QObject
+{
+    Q_OBJECT
+public:
+    enum Protocol {
+        Mdns,
+        Wsd,
+        Ssdp,
+        Snmp,
+        ProtocolCount
+    };
+
+    // 每种协议的探测、超时和载荷字节数
+    struct Traffic {
+        int probes = 0;
+        int timeouts = 0;
+        qint64 bytesSent = 0;
+        qint64 bytesReceived = 0;
+    };
+
+    explicit DiscoveryReactor(QThreadPool *pool, QObject *parent = nullptr);
+    ~DiscoveryReactor() override;
+
+    // 收集响应的时间窗口（毫秒）
+    void setWindow(int milliseconds);
+    int window() const { return m_window; }
+
+    // 在start()之前添加探测报文
+    void addProbe(Protocol protocol, const QByteArray &datagram, const QHostAddress &address, quint16 port);
+    // 向网段的广播地址发出一个探测；网段没有广播地址（如点对点链路）时返回false
+    bool addBroadcastProbe(Protocol protocol, const QByteArray &datagram,
+                           const QNetworkAddressEntry &entry, quint16 port);
+
+    // 发出所有已添加的探测；已在运行或没有探测时返回false
+    bool start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    // 最近一次探测的流量统计，finished()之后到下一次start()之前有效
+    Traffic traffic(Protocol protocol) const { return m_traffic[protocol]; }
+
+    static QByteArray buildMdnsQuery(const QStringList &serviceTypes);
+    static QByteArray buildSnmpGetRequest(quint32 requestId);
+    static NetworkScannerDevice parseDatagram(Protocol protocol, const QByteArray &data, const QHostAddress &sender);
+
+Q_SIGNALS:
+    void deviceFound(DiscoveryReactor::Protocol protocol, const NetworkScannerDevice &device);
+    void finished();
+
+private:
+    struct Probe {
+        Protocol protocol;
+        QByteArray datagram;
+        QHostAddress address;
+        quint16 port;
+        bool group;                         // 多播或广播，任何主机应答即可
+    };
+
+    void readPending(Protocol protocol);
+    void closeSockets();
+    void countTimeouts();
+    void checkFinished();
+
+    static NetworkScannerDevice parseMdnsResponse(const QByteArray &data, const QHostAddress &sender);
+    static NetworkScannerDevice parseWsdResponse(const QByteArray &data, const QHostAddress &sender);
+    static NetworkScannerDevice parseSsdpResponse(const QByteArray &data, const QHostAddress &sender);
+    static NetworkScannerDevice parseSnmpResponse(const QByteArray &data, const QHostAddress &sender);
+
+    QThreadPool *m_pool;
+    QUdpSocket *m_sockets[ProtocolCount];
+    QList<Probe> m_probes;
+    QList<Probe> m_sentProbes;
+    Traffic m_traffic[ProtocolCount];
+    QSet<QString> m_responders[ProtocolCount];  // 本次有响应的来源地址
+    QTimer *m_windowTimer;
+    int m_window;
+    int m_pendingParses;                    // 尚未完成的解析任务
+    bool m_running;
+    bool m_windowOpen;
+};
+
+// SOAP发现任务
+class SoapDiscoveryTask : public DiscoveryTask
+{
+    Q_OBJECT
+public:
+    explicit SoapDiscoveryTask(const QNetworkAddressEntry &entry, QObject *parent = nullptr);
+    void run() override;
+
+private:
+    QNetworkAddressEntry m_networkEntry;
+    NetworkScannerDevice parseEsclResponse(const QByteArray &data, const QHostAddress &address);
+};
+
+// 非阻塞子网探测器：大量TCP连接同时在途，超时按观测到的RTT自适应调整
+class SubnetProber : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SubnetProber(QObject *parent = nullptr);
+    ~SubnetProber() override;
+
+    // 同时在途的连接数上限
+    void setMaxInFlight(int count);
+    int maxInFlight() const { return m_maxInFlight; }
+    // 当前在途的连接数
+    int inFlightCount() const { return m_inFlight.size(); }
+    // 连接超时的上下限（毫秒），尚无RTT样本时使用上限
+    void setTimeoutBounds(int minimumMs, int maximumMs);
+
+    // 在当前线程的事件循环中探测所有主机的所有端口，结束时发出finished()
+    void start(const QList<QHostAddress> &hosts, const QList<quint16> &ports);
+    void stop();
+    bool isRunning() const { return m_running; }
+    int currentTimeout() const;
+    // 最近一次探测中超时的连接数
+    int timeoutCount() const { return m_timeouts; }
+
+    // 网段内的主机地址（不含网络地址、广播地址和本机），
+    // 前缀短于minimumPrefix时只取本机所在的那一段
+    static QList<QHostAddress> subnetHosts(const QNetworkAddressEntry &entry, int minimumPrefix = 22);
+
+Q_SIGNALS:
+    void portOpen(const QHostAddress &address, quint16 port);
+    void finished();
+
+private:
+    struct Probe {
+        QHostAddress address;
+        quint16 port;
+        qint64 startedAt;
+        qint64 deadline;
+    };
+
+    void launchMore();
+    void complete(QTcpSocket *socket, bool open, bool answered);
+    void sweepTimeouts();
+    void addRttSample(qint64 rtt);
+
+    QList<QHostAddress> m_hosts;
+    QList<quint16> m_ports;
+    qint64 m_nextIndex;                     // 下一个目标：主机序号 * 端口数 + 端口序号
+    qint64 m_total;
+    int m_timeouts;
+    QHash<QTcpSocket*, Probe> m_inFlight;
+    QTimer *m_sweepTimer;
+    QElapsedTimer m_clock;
+    int m_maxInFlight;
+    int m_minTimeout;
+    int m_maxTimeout;
+    double m_srtt;                          // 平滑RTT
+    double m_rttVar;                        // RTT偏差
+    bool m_hasRtt;
+    bool m_running;
+    bool m_launching;                       // 防止连接立即失败时launchMore递归
+};
+
+// 端口扫描任务
+class PortScanTask : public DiscoveryTask
+{
+    Q_OBJECT
+public:
+    explicit PortScanTask(const QNetworkAddressEntry &entry, 
+                         const QList<quint16> &ports, 
+                         QObject *parent = nullptr);
+    void run() override;
+
+private:
+    QNetworkAddressEntry m_networkEntry;
+    QList<quint16> m_ports;
+    bool isKnownScannerPort(quint16 port);
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // NETWORK_DISCOVERY_TASKS_P_H
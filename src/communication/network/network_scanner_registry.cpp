@@ -0,0 +1,323 @@
+// SPDX-FileCopyrightText: 2024 DeepinScan Team
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "network_scanner_registry.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+DSCANNER_USE_NAMESPACE
+
+Q_LOGGING_CATEGORY(networkScannerRegistry, "deepinscan.network.registry")
+
+namespace {
+constexpr int kRegistryFormatVersion = 1;
+constexpr qint64 kDefaultMaxAgeSeconds = 7 * 24 * 60 * 60;
+constexpr int kDefaultMaxFailures = 3;
+
+QJsonObject toJson(const NetworkScannerDevice &device)
+{
+    QJsonObject object;
+    object[QStringLiteral("uuid")] = device.uuid;
+    object[QStringLiteral("makeAndModel")] = device.makeAndModel;
+    object[QStringLiteral("serialNumber")] = device.serialNumber;
+    object[QStringLiteral("deviceType")] = device.deviceType;
+    object[QStringLiteral("protocol")] = device.protocol;
+    object[QStringLiteral("discoveryMethod")] = device.discoveryMethod;
+    object[QStringLiteral("addresses")] = QJsonArray::fromStringList(device.addresses);
+    object[QStringLiteral("baseUrl")] = device.baseUrl.toString();
+    object[QStringLiteral("adminUri")] = device.adminUri;
+    object[QStringLiteral("iconUri")] = device.iconUri;
+    object[QStringLiteral("capabilities")] = QJsonObject::fromVariantMap(device.capabilities);
+    object[QStringLiteral("discoveryTime")] = device.discoveryTime.toUTC().toString(Qt::ISODate);
+    object[QStringLiteral("lastSeen")] = device.lastSeen.toUTC().toString(Qt::ISODate);
+    return object;
+}
+
+NetworkScannerDevice fromJson(const QJsonObject &object)
+{
+    NetworkScannerDevice device;
+    device.uuid = object.value(QStringLiteral("uuid")).toString();
+    device.makeAndModel = object.value(QStringLiteral("makeAndModel")).toString();
+    device.serialNumber = object.value(QStringLiteral("serialNumber")).toString();
+    device.deviceType = object.value(QStringLiteral("deviceType")).toString();
+    device.protocol = object.value(QStringLiteral("protocol")).toString();
+    device.discoveryMethod = object.value(QStringLiteral("discoveryMethod")).toString();
+    for (const QJsonValue &value : object.value(QStringLiteral("addresses")).toArray()) {
+        device.addresses.append(value.toString());
+    }
+    device.baseUrl = QUrl(object.value(QStringLiteral("baseUrl")).toString());
+    device.adminUri = object.value(QStringLiteral("adminUri")).toString();
+    device.iconUri = object.value(QStringLiteral("iconUri")).toString();
+    device.capabilities = object.value(QStringLiteral("capabilities")).toObject().toVariantMap();
+    device.discoveryTime = QDateTime::fromString(object.value(QStringLiteral("discoveryTime")).toString(), Qt::ISODate);
+    device.lastSeen = QDateTime::fromString(object.value(QStringLiteral("lastSeen")).toString(), Qt::ISODate);
+    return device;
+}
+}
+
+NetworkScannerRegistry::NetworkScannerRegistry(const QString &filePath)
+    : m_filePath(filePath.isEmpty() ? defaultFilePath() : filePath)
+    , m_maxAgeSeconds(kDefaultMaxAgeSeconds)
+    , m_maxFailures(kDefaultMaxFailures)
+    , m_dirty(false)
+{
+}
+
+QString NetworkScannerRegistry::defaultFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + QStringLiteral("/deepinscan/network-scanners.json");
+}
+
+bool NetworkScannerRegistry::load()
+{
+    m_entries.clear();
+    m_dirty = false;
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("version")).toInt() != kRegistryFormatVersion) {
+        qCDebug(networkScannerRegistry) << "Ignoring incompatible registry file" << m_filePath;
+        return false;
+    }
+
+    const QDateTime cutoff = QDateTime::currentDateTimeUtc().addSecs(-m_maxAgeSeconds);
+    for (const QJsonValue &value : root.value(QStringLiteral("devices")).toArray()) {
+        const QJsonObject object = value.toObject();
+        Entry entry;
+        entry.device = fromJson(object);
+        entry.failures = object.value(QStringLiteral("failures")).toInt();
+
+        const QString key = keyFor(entry.device);
+        if (key.isEmpty() || !entry.device.lastSeen.isValid()) {
+            continue;
+        }
+        if (entry.device.lastSeen < cutoff) {
+            qCDebug(networkScannerRegistry) << "Dropping stale entry" << key << "last seen" << entry.device.lastSeen;
+            m_dirty = true;
+            continue;
+        }
+        m_entries.insert(key, entry);
+    }
+
+    qCDebug(networkScannerRegistry) << "Loaded" << m_entries.size() << "known network scanners";
+    return true;
+}
+
+bool NetworkScannerRegistry::save()
+{
+    if (!m_dirty) {
+        return true;
+    }
+
+    QJsonArray devices;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        QJsonObject object = toJson(it->device);
+        object[QStringLiteral("failures")] = it->failures;
+        devices.append(object);
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("version")] = kRegistryFormatVersion;
+    root[QStringLiteral("devices")] = devices;
+
+    const QString directory = QFileInfo(m_filePath).absolutePath();
+    if (!QDir().mkpath(directory)) {
+        qCWarning(networkScannerRegistry) << "Cannot create registry directory" << directory;
+        return false;
+    }
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0
+        || !file.commit()) {
+        qCWarning(networkScannerRegistry) << "Failed to write registry" << m_filePath << file.errorString();
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+QList<NetworkScannerDevice> NetworkScannerRegistry::devices() const
+{
+    QList<NetworkScannerDevice> result;
+    result.reserve(m_entries.size());
+    for (const Entry &entry : m_entries) {
+        result.append(entry.device);
+    }
+    return result;
+}
+
+NetworkScannerDevice NetworkScannerRegistry::device(const QString &key) const
+{
+    return m_entries.value(key).device;
+}
+
+void NetworkScannerRegistry::update(const NetworkScannerDevice &device)
+{
+    const QString key = resolveKey(device);
+    if (key.isEmpty()) {
+        return;
+    }
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        Entry entry;
+        entry.device = device;
+        entry.device.lastSeen = QDateTime::currentDateTimeUtc();
+        m_entries.insert(key, entry);
+        m_dirty = true;
+        return;
+    }
+
+    // 保留首次登记的uuid，设备ID在多次发现之间保持不变
+    NetworkScannerDevice &known = it->device;
+    auto fill = [](QString &target, const QString &value) {
+        if (target.isEmpty()) {
+            target = value;
+        }
+    };
+    fill(known.makeAndModel, device.makeAndModel);
+    fill(known.serialNumber, device.serialNumber);
+    fill(known.deviceType, device.deviceType);
+    fill(known.protocol, device.protocol);
+    fill(known.discoveryMethod, device.discoveryMethod);
+    fill(known.adminUri, device.adminUri);
+    fill(known.iconUri, device.iconUri);
+    const QString host = hostFor(device);
+    if (!host.isEmpty() && host != hostFor(known)) {
+        // 设备换了地址，旧地址不再有效
+        known.addresses = device.addresses;
+        known.baseUrl = device.baseUrl;
+    } else {
+        if (!known.baseUrl.isValid() || known.baseUrl.isEmpty()) {
+            known.baseUrl = device.baseUrl;
+        }
+        for (const QString &address : device.addresses) {
+            if (!known.addresses.contains(address)) {
+                known.addresses.append(address);
+            }
+        }
+    }
+    for (auto capability = device.capabilities.cbegin(); capability != device.capabilities.cend(); ++capability) {
+        known.capabilities.insert(capability.key(), capability.value());
+    }
+
+    known.lastSeen = QDateTime::currentDateTimeUtc();
+    it->failures = 0;
+    m_dirty = true;
+}
+
+void NetworkScannerRegistry::markSeen(const QString &key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    it->device.lastSeen = QDateTime::currentDateTimeUtc();
+    it->failures = 0;
+    m_dirty = true;
+}
+
+bool NetworkScannerRegistry::markFailed(const QString &key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    m_dirty = true;
+    if (++it->failures < m_maxFailures) {
+        return false;
+    }
+
+    qCDebug(networkScannerRegistry) << "Dropping" << key << "after" << it->failures << "failed revalidations";
+    m_entries.erase(it);
+    return true;
+}
+
+void NetworkScannerRegistry::remove(const QString &key)
+{
+    if (m_entries.remove(key) > 0) {
+        m_dirty = true;
+    }
+}
+
+QString NetworkScannerRegistry::resolveKey(const NetworkScannerDevice &device)
+{
+    const QString key = keyFor(device);
+    const QString host = hostFor(device);
+    if (key.isEmpty() || host.isEmpty() || m_entries.contains(key)) {
+        return key;
+    }
+
+    // 同一主机上至少一方没有身份标识时视为同一台设备
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (hostFor(it->device) != host || (it.key() != host && key != host)) {
+            continue;
+        }
+        if (it.key() != host) {
+            return it.key();
+        }
+        const Entry entry = it.value();
+        m_entries.erase(it);
+        m_entries.insert(key, entry);
+        m_dirty = true;
+        return key;
+    }
+    return key;
+}
+
+QString NetworkScannerRegistry::keyFor(const NetworkScannerDevice &device)
+{
+    if (!device.serialNumber.isEmpty()) {
+        return QStringLiteral("serial:") + device.serialNumber;
+    }
+
+    // SSDP的USN形如 uuid:<id>::<类型>，WSD的端点地址形如 urn:uuid:<id>
+    QString uuid = device.uuid;
+    if (uuid.startsWith(QLatin1String("urn:"), Qt::CaseInsensitive)) {
+        uuid = uuid.mid(4);
+    }
+    if (uuid.startsWith(QLatin1String("uuid:"), Qt::CaseInsensitive)) {
+        const QString id = uuid.mid(5).section(QStringLiteral("::"), 0, 0).toLower();
+        if (!id.isEmpty()) {
+            return QStringLiteral("uuid:") + id;
+        }
+    }
+    return hostFor(device);
+}
+
+QString NetworkScannerRegistry::hostFor(const NetworkScannerDevice &device)
+{
+    // WSD的地址是XAddrs URL，其他协议是裸IP
+    if (!device.addresses.isEmpty()) {
+        const QString address = device.addresses.first();
+        const QUrl url(address);
+        return url.host().isEmpty() ? address : url.host();
+    }
+    return device.baseUrl.host();
+}
+
+quint16 NetworkScannerRegistry::servicePort(const NetworkScannerDevice &device)
+{
+    QUrl url = device.baseUrl;
+    if (url.host().isEmpty() && !device.addresses.isEmpty()) {
+        url = QUrl(device.addresses.first());
+    }
+    const int defaultPort = url.scheme() == QLatin1String("https") ? 443 : 80;
+    return static_cast<quint16>(url.port(defaultPort));
+}
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2024 DeepinScan Team
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETWORK_SCANNER_REGISTRY_H
+#define NETWORK_SCANNER_REGISTRY_H
+
+#include "network_complete_discovery.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+DSCANNER_BEGIN_NAMESPACE
+
+/**
+ * @brief 持久化的已知网络扫描仪登记表
+ *
+ * 保存在 $XDG_CACHE_HOME/deepinscan/network-scanners.json，启动时载入即可立即
+ * 给出设备列表，之后只需对登记的主机做单播复核。条目以设备的身份标识或主机
+ * 地址为键，同一台设备经不同协议发现时合并为一条。长期未确认在线或连续复核
+ * 失败的条目被淘汰。
+ *
+ * 非线程安全，只在发现引擎所在线程使用。
+ */
+class DSCANNER_EXPORT NetworkScannerRegistry
+{
+public:
+    explicit NetworkScannerRegistry(const QString &filePath = QString());
+
+    static QString defaultFilePath();
+    QString filePath() const { return m_filePath; }
+
+    // 未确认在线的条目保留时间，默认7天
+    void setMaxAge(qint64 seconds) { m_maxAgeSeconds = seconds; }
+    qint64 maxAge() const { return m_maxAgeSeconds; }
+
+    // 连续复核失败达到该次数时淘汰条目，默认3次
+    void setMaxFailures(int count) { m_maxFailures = qMax(1, count); }
+    int maxFailures() const { return m_maxFailures; }
+
+    /**
+     * @brief 从文件载入，丢弃超过保留时间的条目
+     * @return 文件不存在或格式不符时返回false，登记表为空
+     */
+    bool load();
+
+    /**
+     * @brief 有改动时写回文件（写临时文件后原子替换）
+     */
+    bool save();
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int size() const { return m_entries.size(); }
+    bool contains(const QString &key) const { return m_entries.contains(key); }
+    QList<QString> keys() const { return m_entries.keys(); }
+    QList<NetworkScannerDevice> devices() const;
+    NetworkScannerDevice device(const QString &key) const;
+
+    /**
+     * @brief 登记新发现的设备，或把发现结果合并到已有条目
+     *
+     * 已有条目保留原来的uuid和首次发现时间，其余字段以新结果补全；设备换了
+     * 主机地址时地址和基础URL改用新结果。条目被标记为刚刚确认在线。
+     */
+    void update(const NetworkScannerDevice &device);
+
+    // 单播复核成功
+    void markSeen(const QString &key);
+
+    /**
+     * @brief 单播复核失败
+     * @return 条目因此被淘汰时返回true
+     */
+    bool markFailed(const QString &key);
+
+    void remove(const QString &key);
+
+    /**
+     * @brief 设备在登记表中的键
+     *
+     * 有序列号或设备自报的UUID（SSDP的USN、WSD的端点地址）时以其为键，设备
+     * 换了地址仍对应同一条目；否则取主机部分。发现时随机生成的uuid不作为键。
+     */
+    static QString keyFor(const NetworkScannerDevice &device);
+
+    /**
+     * @brief 设备的主机部分：首个地址或基础URL中的主机
+     */
+    static QString hostFor(const NetworkScannerDevice &device);
+
+    /**
+     * @brief 复核时连接的端口：基础URL的端口，缺省按协议取80或443
+     */
+    static quint16 servicePort(const NetworkScannerDevice &device);
+
+private:
+    struct Entry {
+        NetworkScannerDevice device;
+        int failures = 0;           // 连续复核失败次数
+    };
+
+    // 已有条目的键；同一主机上先以主机、后以身份标识登记的条目会改用身份标识为键
+    QString resolveKey(const NetworkScannerDevice &device);
+
+    QString m_filePath;
+    QHash<QString, Entry> m_entries;
+    qint64 m_maxAgeSeconds;
+    int m_maxFailures;
+    bool m_dirty;
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // NETWORK_SCANNER_REGISTRY_H
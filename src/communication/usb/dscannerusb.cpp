@@ -10,6 +10,19 @@
 #include <QThread>
 #include <QDebug>
 #include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
 
 // libusb包含（如果系统有的话）
 #ifdef HAVE_LIBUSB
@@ -20,6 +33,8 @@
 #define LIBUSB_ERROR_NOT_FOUND -5
 #define LIBUSB_ERROR_ACCESS -3
 #define LIBUSB_ERROR_NO_DEVICE -4
+#define LIBUSB_ERROR_BUSY -6
+#define LIBUSB_ERROR_INVALID_PARAM -2
 #define LIBUSB_TRANSFER_COMPLETED 0
 #define LIBUSB_CLASS_PRINTER 7
 #define LIBUSB_CLASS_MASS_STORAGE 8
@@ -71,6 +86,7 @@ bool DScannerUSB::initialize()
     qCInfo(dscannerUSB) << "USB subsystem initialized successfully";
 
     // 启动设备监控
+    d->deviceMonitor->setLibUSBEnabled(d->usbContext != nullptr);
     d->deviceMonitor->startMonitoring();
 
     return true;
@@ -79,6 +95,7 @@ bool DScannerUSB::initialize()
 void DScannerUSB::shutdown()
 {
     Q_D(DScannerUSB);
+    d->joinUSBBulkStream();
     QMutexLocker locker(&d->usbMutex);
 
     if (!d->initialized) {
@@ -139,6 +156,7 @@ QList<USBDeviceDescriptor> DScannerUSB::discoverDevices(quint16 vendorId, quint1
 bool DScannerUSB::openDevice(quint16 vendorId, quint16 productId, const QString &serialNumber)
 {
     Q_D(DScannerUSB);
+    d->joinUSBBulkStream();
     QMutexLocker locker(&d->usbMutex);
 
     if (!d->initialized) {
@@ -162,6 +180,7 @@ bool DScannerUSB::openDevice(quint16 vendorId, quint16 productId, const QString
 bool DScannerUSB::openDeviceByPath(const QString &devicePath)
 {
     Q_D(DScannerUSB);
+    d->joinUSBBulkStream();
     QMutexLocker locker(&d->usbMutex);
 
     if (!d->initialized) {
@@ -183,6 +202,7 @@ bool DScannerUSB::openDeviceByPath(const QString &devicePath)
 void DScannerUSB::closeDevice()
 {
     Q_D(DScannerUSB);
+    d->joinUSBBulkStream();
     QMutexLocker locker(&d->usbMutex);
 
     if (!d->isUSBDeviceOpen()) {
@@ -343,6 +363,34 @@ QByteArray DScannerUSB::bulkTransferIn(quint8 endpoint, int maxLength, int timeo
     return data;
 }
 
+int DScannerUSB::bulkTransferInto(quint8 endpoint, quint8 *buffer, int length, int timeout)
+{
+    Q_D(DScannerUSB);
+    QMutexLocker locker(&d->usbMutex);
+
+    if (!d->isUSBDeviceOpen()) {
+        d->setLastError(LIBUSB_ERROR_NO_DEVICE, QStringLiteral("No device open"));
+        return -1;
+    }
+
+    if (!buffer || length <= 0) {
+        d->setLastError(LIBUSB_ERROR_INVALID_PARAM, QStringLiteral("Invalid receive buffer"));
+        return -1;
+    }
+
+    int transferred = 0;
+    int status = d->performBulkTransferInto(endpoint | LIBUSB_ENDPOINT_IN, buffer, length,
+                                            timeout, &transferred);
+
+    if (status == LIBUSB_SUCCESS) {
+        emit transferCompleted(endpoint, transferred);
+        return transferred;
+    }
+
+    emit errorOccurred(status, d->lastErrorMessage);
+    return -1;
+}
+
 int DScannerUSB::interruptTransferOut(quint8 endpoint, const QByteArray &data, int timeout)
 {
     Q_D(DScannerUSB);
@@ -403,6 +451,61 @@ QByteArray DScannerUSB::interruptTransferIn(quint8 endpoint, int maxLength, int
     return data;
 }
 
+bool DScannerUSB::startBulkStream(const USBStreamConfig &config, const USBStreamCallback &callback)
+{
+    Q_D(DScannerUSB);
+    QMutexLocker locker(&d->usbMutex);
+
+    if (!d->isUSBDeviceOpen()) {
+        d->setLastError(LIBUSB_ERROR_NO_DEVICE, QStringLiteral("No device open"));
+        return false;
+    }
+
+    if (!d->startUSBBulkStream(config, callback)) {
+        emit errorOccurred(d->lastErrorCode, d->lastErrorMessage);
+        return false;
+    }
+
+    qCDebug(dscannerUSB) << "Bulk stream started on endpoint" << QString::number(config.endpoint, 16)
+                         << "buffers:" << config.bufferCount << "x" << config.bufferSize;
+    return true;
+}
+
+void DScannerUSB::stopBulkStream()
+{
+    Q_D(DScannerUSB);
+    QMutexLocker locker(&d->usbMutex);
+    d->stopUSBBulkStream();
+}
+
+bool DScannerUSB::waitForBulkStream(int timeout)
+{
+    Q_D(DScannerUSB);
+
+    // 等待期间不持有usbMutex，回调中仍可发起控制传输；持有引用，关闭设备时对象不会被释放
+    std::shared_ptr<USBBulkStream> stream;
+    {
+        QMutexLocker locker(&d->usbMutex);
+        stream = d->bulkStream;
+    }
+
+    return !stream || stream->wait(timeout);
+}
+
+bool DScannerUSB::isBulkStreamActive() const
+{
+    Q_D(const DScannerUSB);
+    QMutexLocker locker(&d->usbMutex);
+    return d->bulkStream && d->bulkStream->isActive();
+}
+
+USBStreamStatistics DScannerUSB::bulkStreamStatistics() const
+{
+    Q_D(const DScannerUSB);
+    QMutexLocker locker(&d->usbMutex);
+    return d->bulkStream ? d->bulkStream->statistics() : USBStreamStatistics();
+}
+
 USBDeviceDescriptor DScannerUSB::getCurrentDeviceDescriptor() const
 {
     Q_D(const DScannerUSB);
@@ -778,6 +881,13 @@ bool DScannerUSBPrivate::openUSBDeviceByPath(const QString &devicePath)
 
 void DScannerUSBPrivate::closeUSBDevice()
 {
+    // 调用方已在获取usbMutex之前结束批量输入流（joinUSBBulkStream），
+    // 这里只回收事件线程和传输；其他线程可能仍持有流对象的引用
+    if (bulkStream) {
+        bulkStream->release();
+        bulkStream.reset();
+    }
+
     // 释放所有声明的接口
     for (quint8 interfaceNumber : claimedInterfaces) {
         releaseUSBInterface(interfaceNumber);
@@ -985,6 +1095,40 @@ USBTransferResult DScannerUSBPrivate::performBulkTransfer(const USBTransferReque
     return result;
 }
 
+int DScannerUSBPrivate::performBulkTransferInto(quint8 endpoint, quint8 *buffer, int length,
+                                                int timeout, int *transferred)
+{
+    *transferred = 0;
+
+#ifdef HAVE_LIBUSB
+    if (!deviceHandle) {
+        setLastError(LIBUSB_ERROR_NO_DEVICE, QStringLiteral("No device open"));
+        return LIBUSB_ERROR_NO_DEVICE;
+    }
+
+    int libusb_result = libusb_bulk_transfer(
+        deviceHandle,
+        endpoint,
+        reinterpret_cast<unsigned char*>(buffer),
+        length,
+        transferred,
+        timeout
+    );
+
+    if (libusb_result != LIBUSB_SUCCESS) {
+        setLastError(libusb_result, QStringLiteral("Bulk transfer failed: %1").arg(libusb_error_name(libusb_result)));
+    }
+    return libusb_result;
+#else
+    Q_UNUSED(endpoint)
+    Q_UNUSED(buffer)
+    Q_UNUSED(length)
+    Q_UNUSED(timeout)
+    setLastError(-1, QStringLiteral("libusb not available"));
+    return -1;
+#endif
+}
+
 USBTransferResult DScannerUSBPrivate::performInterruptTransfer(const USBTransferRequest &request)
 {
     USBTransferResult result;
@@ -1274,152 +1418,393 @@ USBEndpoint DScannerUSBPrivate::convertToEndpoint(const libusb_endpoint_descript
     return usbEndpoint;
 }
 
-void DScannerUSBPrivate::processAsyncTransfers()
+bool DScannerUSBPrivate::startUSBBulkStream(const USBStreamConfig &config, const USBStreamCallback &callback)
 {
-    // 实现异步传输处理 - 完整的异步USB传输
-    qCDebug(dscannerUSB) << "处理异步USB传输";
-    
-    if (!m_context || !m_deviceHandle) {
-        qCWarning(dscannerUSB) << "USB上下文或设备句柄无效";
-        return;
+    if (!deviceHandle) {
+        setLastError(LIBUSB_ERROR_NO_DEVICE, QStringLiteral("No device open"));
+        return false;
     }
-    
-    // 创建异步传输结构
-    libusb_transfer *transfer = libusb_alloc_transfer(0);
-    if (!transfer) {
-        qCWarning(dscannerUSB) << "无法分配USB传输结构";
-        return;
+
+    if (bulkStream && bulkStream->isActive()) {
+        setLastError(LIBUSB_ERROR_BUSY, QStringLiteral("Bulk stream already active"));
+        return false;
     }
-    
-    // 准备传输数据
-    unsigned char *buffer = new unsigned char[USB_BUFFER_SIZE];
-    
-    // 配置批量传输
-    libusb_fill_bulk_transfer(transfer, 
-                             m_deviceHandle,
-                             m_bulkInEndpoint,  // 输入端点
-                             buffer,
-                             USB_BUFFER_SIZE,
-                             [](libusb_transfer *transfer) {
-                                 // 异步传输完成回调
-                                 DScannerUSBPrivate *usbPrivate = static_cast<DScannerUSBPrivate*>(transfer->user_data);
-                                 if (usbPrivate) {
-                                     usbPrivate->handleTransferCompletion(transfer);
-                                 }
-                             },
-                             this,              // 用户数据
-                             USB_TRANSFER_TIMEOUT);
-    
-    // 提交异步传输
-    int result = libusb_submit_transfer(transfer);
-    if (result != LIBUSB_SUCCESS) {
-        qCWarning(dscannerUSB) << "提交异步传输失败:" << libusb_error_name(result);
-        delete[] buffer;
-        libusb_free_transfer(transfer);
-        return;
+
+    if (bulkStream) {
+        bulkStream->release();
     }
-    
-    // 添加到活动传输列表
-    m_activeTransfers.append(transfer);
-    
-    qCDebug(dscannerUSB) << "异步USB传输已提交";
+    bulkStream = std::make_shared<USBBulkStream>(usbContext, deviceHandle);
+    bulkStream->finishedHandler = [this](const USBStreamStatistics &statistics) {
+        QMetaObject::invokeMethod(this, [this, statistics]() {
+            if (usbContext) {
+                eventTimer->start();
+            }
+            qCInfo(dscannerUSB) << "Bulk stream finished:" << statistics.bytesReceived << "bytes in"
+                                << statistics.elapsedMs << "ms," << statistics.throughputMBps << "MB/s";
+            emit q_ptr->bulkStreamFinished(statistics);
+        }, Qt::QueuedConnection);
+    };
+
+    // 流运行期间由专用事件线程处理libusb事件，保证回调只在该线程中执行
+    eventTimer->stop();
+
+    QString errorMessage;
+    if (!bulkStream->start(config, callback, &errorMessage)) {
+        setLastError(LIBUSB_ERROR_INVALID_PARAM, errorMessage);
+        if (!bulkStream->isActive()) {
+            eventTimer->start();
+        }
+        return false;
+    }
+
+    return true;
 }
 
-void DScannerUSBPrivate::handleTransferComplete(libusb_transfer *transfer)
+void DScannerUSBPrivate::stopUSBBulkStream()
 {
-    Q_UNUSED(transfer)
-    // 实现传输完成处理 - 完整的传输完成处理
-    qCDebug(dscannerUSB) << "处理传输完成事件";
-    
-    if (!transfer) {
-        qCWarning(dscannerUSB) << "传输结构为空";
-        return;
+    if (bulkStream) {
+        bulkStream->stop();
     }
-    
-    // 从活动传输列表中移除
-    m_activeTransfers.removeOne(transfer);
-    
-    // 检查传输状态
-    switch (transfer->status) {
+}
+
+void DScannerUSBPrivate::joinUSBBulkStream()
+{
+    // 流的回调可能在事件线程中等待usbMutex，停止并等待流结束时不能持有该锁
+    std::shared_ptr<USBBulkStream> stream;
+    {
+        QMutexLocker locker(&usbMutex);
+        stream = bulkStream;
+    }
+
+    if (stream) {
+        stream->stop();
+        stream->wait(-1);
+    }
+}
+
+// USBBulkStream implementation
+#ifdef HAVE_LIBUSB
+namespace {
+
+void LIBUSB_CALL bulkStreamTransferCallback(libusb_transfer *transfer)
+{
+    static_cast<USBBulkStream*>(transfer->user_data)->handleTransferComplete(transfer);
+}
+
+} // namespace
+#endif
+
+USBBulkStream::USBBulkStream(libusb_context *context, libusb_device_handle *handle)
+    : m_context(context)
+    , m_handle(handle)
+    , m_inFlight(0)
+    , m_bytesPending(0)
+    , m_stopping(false)
+    , m_active(false)
+    , m_eventThread(nullptr)
+{
+}
+
+USBBulkStream::~USBBulkStream()
+{
+    release();
+}
+
+void USBBulkStream::release()
+{
+    stop();
+    wait(-1);
+
+    if (m_eventThread) {
+        m_eventThread->wait();
+        delete m_eventThread;
+        m_eventThread = nullptr;
+    }
+
+    releaseBuffers();
+}
+
+bool USBBulkStream::start(const USBStreamConfig &config, const USBStreamCallback &callback, QString *errorMessage)
+{
+#ifdef HAVE_LIBUSB
+    QMutexLocker locker(&m_mutex);
+
+    if (m_active) {
+        *errorMessage = QStringLiteral("Bulk stream already active");
+        return false;
+    }
+
+    if (config.bufferCount <= 0 || config.bufferSize <= 0 || !callback) {
+        *errorMessage = QStringLiteral("Invalid bulk stream configuration");
+        return false;
+    }
+
+    m_config = config;
+    m_config.endpoint |= LIBUSB_ENDPOINT_IN;
+    m_callback = callback;
+    m_statistics = USBStreamStatistics();
+    m_stopping = false;
+    m_inFlight = 0;
+    m_bytesPending = 0;
+
+    for (int i = 0; i < config.bufferCount; ++i) {
+        libusb_transfer *transfer = libusb_alloc_transfer(0);
+        if (!transfer) {
+            releaseBuffers();
+            *errorMessage = QStringLiteral("Failed to allocate bulk stream transfer");
+            return false;
+        }
+
+        // 优先使用可直接DMA的设备内存，省去内核中的一次拷贝（libusb 1.0.21起提供）
+#if LIBUSB_API_VERSION >= 0x01000105
+        unsigned char *buffer = libusb_dev_mem_alloc(m_handle, static_cast<size_t>(config.bufferSize));
+#else
+        unsigned char *buffer = nullptr;
+#endif
+        const bool deviceMemory = buffer != nullptr;
+        if (!buffer) {
+            buffer = new unsigned char[config.bufferSize];
+        }
+
+        libusb_fill_bulk_transfer(transfer, m_handle, m_config.endpoint, buffer, config.bufferSize,
+                                  bulkStreamTransferCallback, this,
+                                  static_cast<unsigned int>(qMax(0, config.timeout)));
+
+        m_transfers.push_back(transfer);
+        m_buffers.push_back(buffer);
+        m_deviceMemory.push_back(deviceMemory);
+    }
+
+    m_timer.start();
+    m_active = true;
+
+    bool submitted = true;
+    bool ok = true;
+    for (libusb_transfer *transfer : m_transfers) {
+        ok = submitTransfer(transfer, &submitted);
+        if (!ok || !submitted) {
+            break;
+        }
+    }
+
+    if (m_inFlight == 0) {
+        m_active = false;
+        releaseBuffers();
+        *errorMessage = QStringLiteral("Failed to submit bulk stream transfers");
+        return false;
+    }
+
+    if (!ok) {
+        // 部分提交失败：取消已提交的传输，由事件线程回收
+        m_stopping = true;
+        cancelAll();
+        *errorMessage = QStringLiteral("Failed to submit bulk stream transfers");
+    }
+
+    m_eventThread = QThread::create([this]() { runEventLoop(); });
+    m_eventThread->start();
+
+    return ok;
+#else
+    Q_UNUSED(config)
+    Q_UNUSED(callback)
+    *errorMessage = QStringLiteral("libusb not available");
+    return false;
+#endif
+}
+
+void USBBulkStream::stop()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_active && !m_stopping) {
+        m_stopping = true;
+        cancelAll();
+    }
+}
+
+bool USBBulkStream::wait(int timeout)
+{
+    QMutexLocker locker(&m_mutex);
+    QDeadlineTimer deadline(timeout);
+
+    while (m_active) {
+        if (!m_finishedCondition.wait(&m_mutex, deadline)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool USBBulkStream::isActive() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_active;
+}
+
+USBStreamStatistics USBBulkStream::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    USBStreamStatistics statistics = m_statistics;
+    if (m_active) {
+        statistics.elapsedMs = m_timer.elapsed();
+        if (statistics.elapsedMs > 0) {
+            statistics.throughputMBps = statistics.bytesReceived / (1024.0 * 1024.0) / (statistics.elapsedMs / 1000.0);
+        }
+    }
+
+    return statistics;
+}
+
+void USBBulkStream::handleTransferComplete(libusb_transfer *transfer)
+{
+#ifdef HAVE_LIBUSB
+    // 回调在锁外执行，缓冲区直接交给使用方
+    bool keepStreaming = !m_stopping;
+    if (keepStreaming && transfer->status == LIBUSB_TRANSFER_COMPLETED && transfer->actual_length > 0) {
+        keepStreaming = m_callback(transfer->buffer, transfer->actual_length);
+    }
+
+    USBStreamStatistics finishedStatistics;
+    bool finished = false;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        m_inFlight--;
+        m_bytesPending -= transfer->length;
+
+        switch (transfer->status) {
         case LIBUSB_TRANSFER_COMPLETED:
-            qCDebug(dscannerUSB) << "USB传输成功完成，接收数据:" << transfer->actual_length << "字节";
-            
-            // 处理接收到的数据
-            if (transfer->actual_length > 0) {
-                QByteArray data(reinterpret_cast<char*>(transfer->buffer), transfer->actual_length);
-                
-                // 添加到接收缓冲区
-                {
-                    QMutexLocker locker(&m_dataMutex);
-                    m_receivedData.append(data);
-                }
-                
-                // 发出数据就绪信号
-                emit q_ptr->dataReceived(data);
-                
-                // 更新统计信息
-                m_stats.totalBytesReceived += transfer->actual_length;
-                m_stats.successfulTransfers++;
-                
-                qCDebug(dscannerUSB) << "数据已添加到缓冲区，总大小:" << m_receivedData.size();
-            }
+            m_statistics.bytesReceived += transfer->actual_length;
+            m_statistics.completedTransfers++;
             break;
-            
         case LIBUSB_TRANSFER_CANCELLED:
-            qCDebug(dscannerUSB) << "USB传输已取消";
-            m_stats.cancelledTransfers++;
-            break;
-            
-        case LIBUSB_TRANSFER_NO_DEVICE:
-            qCWarning(dscannerUSB) << "USB设备已断开连接";
-            m_stats.errorTransfers++;
-            emit q_ptr->deviceDisconnected();
-            break;
-            
-        case LIBUSB_TRANSFER_TIMED_OUT:
-            qCWarning(dscannerUSB) << "USB传输超时";
-            m_stats.errorTransfers++;
-            m_stats.timeoutTransfers++;
-            
-            // 如果需要，可以重新提交传输
-            if (m_autoRetry && m_stats.timeoutTransfers < MAX_RETRY_COUNT) {
-                qCDebug(dscannerUSB) << "重新提交传输";
-                int result = libusb_submit_transfer(transfer);
-                if (result == LIBUSB_SUCCESS) {
-                    m_activeTransfers.append(transfer);
-                    return; // 不释放传输结构
-                }
-            }
-            break;
-            
-        case LIBUSB_TRANSFER_STALL:
-            qCWarning(dscannerUSB) << "USB传输失速";
-            m_stats.errorTransfers++;
-            
-            // 清除失速状态
-            libusb_clear_halt(m_deviceHandle, transfer->endpoint);
-            break;
-            
-        case LIBUSB_TRANSFER_OVERFLOW:
-            qCWarning(dscannerUSB) << "USB传输溢出";
-            m_stats.errorTransfers++;
             break;
-            
-        case LIBUSB_TRANSFER_ERROR:
         default:
-            qCWarning(dscannerUSB) << "USB传输错误，状态:" << transfer->status;
-            m_stats.errorTransfers++;
-            emit q_ptr->transferError(transfer->status);
+            qCWarning(dscannerUSB) << "Bulk stream transfer failed, status:" << transfer->status;
+            m_statistics.failedTransfers++;
+            m_statistics.lastStatus = transfer->status;
+            keepStreaming = false;
             break;
+        }
+
+        if (!keepStreaming && !m_stopping) {
+            m_stopping = true;
+            cancelAll();
+        }
+
+        if (!m_stopping) {
+            bool submitted = false;
+            if (!submitTransfer(transfer, &submitted)) {
+                m_stopping = true;
+                cancelAll();
+            }
+        }
+
+        if (m_inFlight == 0) {
+            m_active = false;
+            m_statistics.elapsedMs = m_timer.elapsed();
+            if (m_statistics.elapsedMs > 0) {
+                m_statistics.throughputMBps = m_statistics.bytesReceived / (1024.0 * 1024.0)
+                                              / (m_statistics.elapsedMs / 1000.0);
+            }
+            finishedStatistics = m_statistics;
+            finished = true;
+            m_finishedCondition.wakeAll();
+        }
     }
-    
-    // 清理传输资源
-    if (transfer->buffer) {
-        delete[] transfer->buffer;
+
+    if (finished && finishedHandler) {
+        finishedHandler(finishedStatistics);
     }
-    libusb_free_transfer(transfer);
-    
-    qCDebug(dscannerUSB) << "传输完成处理结束，活动传输数量:" << m_activeTransfers.size();
+#else
+    Q_UNUSED(transfer)
+#endif
+}
+
+bool USBBulkStream::submitTransfer(libusb_transfer *transfer, bool *submitted)
+{
+    *submitted = false;
+
+#ifdef HAVE_LIBUSB
+    qint64 length = m_config.bufferSize;
+    if (m_config.totalBytes > 0) {
+        length = qMin(length, m_config.totalBytes - m_statistics.bytesReceived - m_bytesPending);
+        if (length <= 0) {
+            return true;
+        }
+    }
+
+    transfer->length = static_cast<int>(length);
+    int result = libusb_submit_transfer(transfer);
+    if (result != LIBUSB_SUCCESS) {
+        qCWarning(dscannerUSB) << "Failed to submit bulk stream transfer:" << libusb_error_name(result);
+        m_statistics.failedTransfers++;
+        m_statistics.lastStatus = result;
+        return false;
+    }
+
+    m_inFlight++;
+    m_bytesPending += length;
+    *submitted = true;
+    return true;
+#else
+    Q_UNUSED(transfer)
+    return false;
+#endif
+}
+
+void USBBulkStream::cancelAll()
+{
+#ifdef HAVE_LIBUSB
+    // 对未在途的传输取消会返回LIBUSB_ERROR_NOT_FOUND，可以忽略
+    for (libusb_transfer *transfer : m_transfers) {
+        libusb_cancel_transfer(transfer);
+    }
+#endif
+}
+
+void USBBulkStream::runEventLoop()
+{
+#ifdef HAVE_LIBUSB
+    qCDebug(dscannerUSB) << "Bulk stream event thread started";
+
+    forever {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_inFlight == 0) {
+                break;
+            }
+        }
+
+        struct timeval timeout = {0, 100000};
+        libusb_handle_events_timeout_completed(m_context, &timeout, nullptr);
+    }
+
+    qCDebug(dscannerUSB) << "Bulk stream event thread stopped";
+#endif
+}
+
+void USBBulkStream::releaseBuffers()
+{
+#ifdef HAVE_LIBUSB
+    for (size_t i = 0; i < m_transfers.size(); ++i) {
+        libusb_free_transfer(m_transfers[i]);
+#if LIBUSB_API_VERSION >= 0x01000105
+        if (m_deviceMemory[i]) {
+            libusb_dev_mem_free(m_handle, m_buffers[i], static_cast<size_t>(m_config.bufferSize));
+            continue;
+        }
+#endif
+        delete[] m_buffers[i];
+    }
+#endif
+
+    m_transfers.clear();
+    m_buffers.clear();
+    m_deviceMemory.clear();
 }
 
 void DScannerUSBPrivate::processUSBEvents()
@@ -1444,6 +1829,7 @@ void DScannerUSBPrivate::onDeviceDisconnected(const QString &devicePath)
     
     // 如果当前打开的设备被断开，关闭它
     if (isUSBDeviceOpen() && currentDescriptor.devicePath == devicePath) {
+        joinUSBBulkStream();
         closeUSBDevice();
     }
     
@@ -1451,170 +1837,526 @@ void DScannerUSBPrivate::onDeviceDisconnected(const QString &devicePath)
 }
 
 // USBDeviceMonitor implementation
+namespace {
+
+#ifdef HAVE_LIBUSB
+int LIBUSB_CALL hotplugCallback(libusb_context *, libusb_device *device, libusb_hotplug_event event, void *userData)
+{
+    static_cast<USBDeviceMonitor*>(userData)->handleHotplugEvent(device, event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+    return 0;
+}
+
+bool readLibUSBDescriptor(libusb_device *device, USBDeviceDescriptor &descriptor)
+{
+    libusb_device_descriptor desc;
+    if (libusb_get_device_descriptor(device, &desc) != LIBUSB_SUCCESS) {
+        return false;
+    }
+
+    descriptor.vendorId = desc.idVendor;
+    descriptor.productId = desc.idProduct;
+    descriptor.deviceVersion = desc.bcdDevice;
+    descriptor.deviceClass = desc.bDeviceClass;
+    descriptor.deviceSubClass = desc.bDeviceSubClass;
+    descriptor.deviceProtocol = desc.bDeviceProtocol;
+    descriptor.maxPacketSize0 = desc.bMaxPacketSize0;
+    descriptor.busNumber = libusb_get_bus_number(device);
+    descriptor.deviceAddress = libusb_get_device_address(device);
+    descriptor.devicePath = DScannerUSB::formatDevicePath(descriptor.busNumber, descriptor.deviceAddress);
+    return true;
+}
+
+// 端口路径与sysfs设备节点名一致，如 1-2.3；设备重新插入同一端口时保持不变
+QString libUSBPortPath(libusb_device *device)
+{
+    uint8_t ports[8];
+    const int depth = libusb_get_port_numbers(device, ports, sizeof(ports));
+    const QString bus = QString::number(libusb_get_bus_number(device));
+    if (depth <= 0) {
+        return QStringLiteral("usb") + bus;
+    }
+
+    QStringList numbers;
+    for (int i = 0; i < depth; ++i) {
+        numbers << QString::number(ports[i]);
+    }
+    return bus + QLatin1Char('-') + numbers.join(QLatin1Char('.'));
+}
+
+void readLibUSBStrings(libusb_device *device, USBDeviceDescriptor &descriptor, bool serialOnly)
+{
+    libusb_device_descriptor desc;
+    libusb_device_handle *handle;
+    if (libusb_get_device_descriptor(device, &desc) != LIBUSB_SUCCESS
+        || libusb_open(device, &handle) != LIBUSB_SUCCESS) {
+        return;
+    }
+
+    unsigned char buffer[256];
+    auto readString = [&](quint8 index, QString &target) {
+        if (index > 0) {
+            int length = libusb_get_string_descriptor_ascii(handle, index, buffer, sizeof(buffer));
+            if (length > 0) {
+                target = QString::fromLatin1(reinterpret_cast<char*>(buffer), length);
+            }
+        }
+    };
+    if (!serialOnly) {
+        readString(desc.iManufacturer, descriptor.manufacturer);
+        readString(desc.iProduct, descriptor.product);
+    }
+    readString(desc.iSerialNumber, descriptor.serialNumber);
+
+    libusb_close(handle);
+}
+#endif
+
+QString readSysfsAttribute(const QString &directory, const char *name)
+{
+    QFile file(directory + QLatin1Char('/') + QLatin1String(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll()).trimmed();
+}
+
+// sysfs中的数值属性由内核缓存，读取不会产生USB传输
+bool readSysfsDescriptor(const QString &directory, USBDeviceDescriptor &descriptor)
+{
+    bool busOk = false;
+    bool addressOk = false;
+    descriptor.busNumber = readSysfsAttribute(directory, "busnum").toUShort(&busOk);
+    descriptor.deviceAddress = readSysfsAttribute(directory, "devnum").toUShort(&addressOk);
+    if (!busOk || !addressOk) {
+        return false;
+    }
+
+    descriptor.vendorId = readSysfsAttribute(directory, "idVendor").toUShort(nullptr, 16);
+    descriptor.productId = readSysfsAttribute(directory, "idProduct").toUShort(nullptr, 16);
+    descriptor.deviceVersion = readSysfsAttribute(directory, "bcdDevice").toUShort(nullptr, 16);
+    descriptor.deviceClass = readSysfsAttribute(directory, "bDeviceClass").toUShort(nullptr, 16);
+    descriptor.deviceSubClass = readSysfsAttribute(directory, "bDeviceSubClass").toUShort(nullptr, 16);
+    descriptor.deviceProtocol = readSysfsAttribute(directory, "bDeviceProtocol").toUShort(nullptr, 16);
+    descriptor.maxPacketSize0 = readSysfsAttribute(directory, "bMaxPacketSize0").toUShort();
+    descriptor.devicePath = DScannerUSB::formatDevicePath(descriptor.busNumber, descriptor.deviceAddress);
+    return true;
+}
+
+void readSysfsStrings(const QString &directory, USBDeviceDescriptor &descriptor, bool serialOnly)
+{
+    if (!serialOnly) {
+        descriptor.manufacturer = readSysfsAttribute(directory, "manufacturer");
+        descriptor.product = readSysfsAttribute(directory, "product");
+    }
+    descriptor.serialNumber = readSysfsAttribute(directory, "serial");
+}
+
+const QString kSysfsRoot = QStringLiteral("/sys");
+const QString kSysfsUSBDevices = QStringLiteral("/sys/bus/usb/devices");
+
+} // namespace
+
 USBDeviceMonitor::USBDeviceMonitor(QObject *parent)
     : QThread(parent)
     , monitoring(false)
+    , libUSBEnabled(false)
+    , usbContext(nullptr)
 {
+    // 信号跨线程排队发送
+    qRegisterMetaType<USBDeviceDescriptor>();
 }
 
 USBDeviceMonitor::~USBDeviceMonitor()
 {
     stopMonitoring();
     wait();
+    releaseContext();
+}
+
+void USBDeviceMonitor::setLibUSBEnabled(bool enabled)
+{
+    libUSBEnabled = enabled;
 }
 
 void USBDeviceMonitor::startMonitoring()
 {
     QMutexLocker locker(&monitorMutex);
-    if (!monitoring) {
-        monitoring = true;
-        start();
+    if (monitoring) {
+        return;
+    }
+
+#ifdef HAVE_LIBUSB
+    // 共用设备I/O的上下文时，这里的事件处理会在监控线程中执行批量传输回调
+    if (libUSBEnabled && !usbContext) {
+        int result = libusb_init(&usbContext);
+        if (result != LIBUSB_SUCCESS) {
+            qCWarning(dscannerUSB) << "Failed to create libusb context for device monitor:"
+                                   << libusb_error_name(result);
+            usbContext = nullptr;
+        }
     }
+#endif
+
+    monitoring = true;
+    start();
 }
 
 void USBDeviceMonitor::stopMonitoring()
 {
-    QMutexLocker locker(&monitorMutex);
-    if (monitoring) {
+    {
+        QMutexLocker locker(&monitorMutex);
+        if (!monitoring) {
+            return;
+        }
         monitoring = false;
         requestInterruption();
+        wakeCondition.wakeAll();
+    }
+
+#if defined(HAVE_LIBUSB) && defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000105
+    if (usbContext) {
+        libusb_interrupt_event_handler(usbContext);
+    }
+#endif
+
+    // 在监控线程内停止时由析构函数释放上下文
+    if (QThread::currentThread() != this) {
+        wait();
+        releaseContext();
+    }
+}
+
+void USBDeviceMonitor::releaseContext()
+{
+#ifdef HAVE_LIBUSB
+    if (usbContext) {
+        libusb_exit(usbContext);
+        usbContext = nullptr;
+    }
+#endif
+}
+
+void USBDeviceMonitor::handleHotplugEvent(libusb_device *device, bool arrived)
+{
+#ifdef HAVE_LIBUSB
+    // 回调中不能打开设备，记录下来交给监控线程处理
+    {
+        QMutexLocker locker(&eventMutex);
+        pendingEvents.append({libusb_ref_device(device), arrived});
     }
+#else
+    Q_UNUSED(device)
+    Q_UNUSED(arrived)
+#endif
 }
 
 void USBDeviceMonitor::run()
 {
     qCDebug(dscannerUSB) << "USB device monitor started";
 
+    if (!runHotplug() && !runNetlink()) {
+        runPolling();
+    }
+
+    qCDebug(dscannerUSB) << "USB device monitor stopped";
+}
+
+bool USBDeviceMonitor::runHotplug()
+{
+#ifdef HAVE_LIBUSB
+    if (!usbContext || !libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        return false;
+    }
+
+    // ENUMERATE标志使已连接的设备也产生一次到达事件
+    libusb_hotplug_callback_handle handle;
+    int result = libusb_hotplug_register_callback(
+        usbContext,
+        static_cast<libusb_hotplug_event>(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+        LIBUSB_HOTPLUG_ENUMERATE, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+        hotplugCallback, this, &handle);
+    if (result != LIBUSB_SUCCESS) {
+        qCWarning(dscannerUSB) << "Failed to register libusb hotplug callback:" << libusb_error_name(result);
+        return false;
+    }
+
+    qCDebug(dscannerUSB) << "Using libusb hotplug notifications";
     while (!isInterruptionRequested()) {
-        QList<USBDeviceDescriptor> currentDevices = scanUSBDevices();
-        
-        // 检查新连接的设备
-        for (const auto &device : currentDevices) {
-            if (!knownDevices.contains(device.devicePath) && isScannerDevice(device)) {
-                knownDevices[device.devicePath] = device;
-                emit deviceConnected(device);
-            }
+        processHotplugEvents();
+        struct timeval timeout = {0, EVENT_WAIT_MS * 1000};
+        libusb_handle_events_timeout_completed(usbContext, &timeout, nullptr);
+    }
+
+    libusb_hotplug_deregister_callback(usbContext, handle);
+
+    QMutexLocker locker(&eventMutex);
+    for (const HotplugEvent &event : pendingEvents) {
+        libusb_unref_device(event.device);
+    }
+    pendingEvents.clear();
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool USBDeviceMonitor::runNetlink()
+{
+#ifdef Q_OS_LINUX
+    // 内核uevent组播（udev自身的事件来源），不依赖libudev
+    int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+        qCWarning(dscannerUSB) << "Failed to bind uevent netlink socket:" << strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    // 先订阅再枚举，枚举期间的事件不会丢失
+    qCDebug(dscannerUSB) << "Using netlink uevent notifications";
+    removeMissing(enumerateSysfs());
+
+    QByteArray buffer(16 * 1024, Qt::Uninitialized);
+    while (!isInterruptionRequested()) {
+        struct pollfd descriptor = {fd, POLLIN, 0};
+        int ready = ::poll(&descriptor, 1, EVENT_WAIT_MS);
+        if (ready < 0 && errno != EINTR) {
+            qCWarning(dscannerUSB) << "uevent poll failed:" << strerror(errno);
+            break;
         }
-        
-        // 检查断开的设备
-        QStringList currentPaths;
-        for (const auto &device : currentDevices) {
-            currentPaths.append(device.devicePath);
+        if (ready <= 0) {
+            continue;
         }
-        
-        QStringList knownPaths = knownDevices.keys();
-        for (const QString &path : knownPaths) {
-            if (!currentPaths.contains(path)) {
-                knownDevices.remove(path);
-                emit deviceDisconnected(path);
+
+        ssize_t length = ::recv(fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (length < 0) {
+            // 缓冲区溢出时事件已丢失，重新枚举同步状态
+            if (errno == ENOBUFS) {
+                removeMissing(enumerateSysfs());
             }
+            continue;
         }
-        
-        // 等待1秒后再次扫描
-        msleep(1000);
+        processUevent(QByteArray::fromRawData(buffer.constData(), static_cast<int>(length)));
     }
 
-    qCDebug(dscannerUSB) << "USB device monitor stopped";
+    ::close(fd);
+    return true;
+#else
+    return false;
+#endif
 }
 
-QList<USBDeviceDescriptor> USBDeviceMonitor::scanUSBDevices()
+void USBDeviceMonitor::runPolling()
+{
+    qCDebug(dscannerUSB) << "No hotplug notification available, polling USB devices";
+
+    while (!isInterruptionRequested()) {
+        removeMissing(usbContext ? enumerateLibUSB() : enumerateSysfs());
+
+        QMutexLocker locker(&monitorMutex);
+        if (!isInterruptionRequested()) {
+            wakeCondition.wait(&monitorMutex, POLL_INTERVAL_MS);
+        }
+    }
+}
+
+void USBDeviceMonitor::processHotplugEvents()
 {
-    // 这里应该实际扫描USB设备
-    // 由于我们在私有实现中，可以访问libusb
-    QList<USBDeviceDescriptor> devices;
-    
-    // 完整的USB设备扫描实现
-    // 高效的USB设备发现机制
-    QList<USBDeviceDescriptor> devices;
-    
 #ifdef HAVE_LIBUSB
-    if (parent && parent->d_ptr && parent->d_ptr->usbContext) {
-        libusb_device **deviceList;
-        ssize_t deviceCount = libusb_get_device_list(parent->d_ptr->usbContext, &deviceList);
-        
-        if (deviceCount >= 0) {
-            for (ssize_t i = 0; i < deviceCount; i++) {
-                libusb_device *device = deviceList[i];
-                libusb_device_descriptor desc;
-                
-                if (libusb_get_device_descriptor(device, &desc) == 0) {
-                    // 检查是否是扫描仪设备
-                    if (isKnownScannerDevice(desc.idVendor, desc.idProduct)) {
-                        USBDeviceDescriptor scannerDevice;
-                        scannerDevice.vendorId = desc.idVendor;
-                        scannerDevice.productId = desc.idProduct;
-                        scannerDevice.deviceClass = desc.bDeviceClass;
-                        scannerDevice.deviceSubClass = desc.bDeviceSubClass;
-                        scannerDevice.deviceProtocol = desc.bDeviceProtocol;
-                        scannerDevice.busNumber = libusb_get_bus_number(device);
-                        scannerDevice.deviceAddress = libusb_get_device_address(device);
-                        
-                        // 构造设备路径
-                        scannerDevice.devicePath = QString("/dev/bus/usb/%1/%2")
-                            .arg(scannerDevice.busNumber, 3, 10, QChar('0'))
-                            .arg(scannerDevice.deviceAddress, 3, 10, QChar('0'));
-                        
-                        // 获取字符串描述符
-                        libusb_device_handle *handle;
-                        if (libusb_open(device, &handle) == 0) {
-                            unsigned char buffer[256];
-                            
-                            // 获取厂商名称
-                            if (desc.iManufacturer > 0) {
-                                if (libusb_get_string_descriptor_ascii(handle, desc.iManufacturer, 
-                                                                     buffer, sizeof(buffer)) >= 0) {
-                                    scannerDevice.manufacturer = QString::fromLatin1(reinterpret_cast<char*>(buffer));
-                                }
-                            }
-                            
-                            // 获取产品名称
-                            if (desc.iProduct > 0) {
-                                if (libusb_get_string_descriptor_ascii(handle, desc.iProduct, 
-                                                                     buffer, sizeof(buffer)) >= 0) {
-                                    scannerDevice.product = QString::fromLatin1(reinterpret_cast<char*>(buffer));
-                                }
-                            }
-                            
-                            // 获取序列号
-                            if (desc.iSerialNumber > 0) {
-                                if (libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, 
-                                                                     buffer, sizeof(buffer)) >= 0) {
-                                    scannerDevice.serialNumber = QString::fromLatin1(reinterpret_cast<char*>(buffer));
-                                }
-                            }
-                            
-                            libusb_close(handle);
-                        }
-                        
-                        // 设置设备特征信息
-                        scannerDevice.speed = static_cast<USBSpeed>(libusb_get_device_speed(device));
-                        scannerDevice.isConnected = true;
-                        scannerDevice.isAvailable = true;
-                        
-                        devices.append(scannerDevice);
-                        
-                        qCDebug(dscannerUSB) << "Found scanner device:" 
-                                             << QString::number(scannerDevice.vendorId, 16)
-                                             << QString::number(scannerDevice.productId, 16)
-                                             << scannerDevice.manufacturer << scannerDevice.product;
-                    }
-                }
+    QList<HotplugEvent> events;
+    {
+        QMutexLocker locker(&eventMutex);
+        events.swap(pendingEvents);
+    }
+
+    for (const HotplugEvent &event : events) {
+        USBDeviceDescriptor descriptor;
+        if (event.arrived) {
+            if (readLibUSBDescriptor(event.device, descriptor)) {
+                libusb_device *device = event.device;
+                handleArrival(descriptor, libUSBPortPath(device),
+                              [device](USBDeviceDescriptor &target, bool serialOnly) {
+                    readLibUSBStrings(device, target, serialOnly);
+                });
             }
-            
-            libusb_free_device_list(deviceList, 1);
-            qCInfo(dscannerUSB) << "USB scan completed, found" << devices.size() << "scanner devices";
         } else {
-            qCWarning(dscannerUSB) << "Failed to get USB device list:" << deviceCount;
+            // 设备已离开，只有总线号和地址仍然可靠
+            handleRemoval(DScannerUSB::formatDevicePath(libusb_get_bus_number(event.device),
+                                                        libusb_get_device_address(event.device)));
         }
-    } else {
-        qCWarning(dscannerUSB) << "USB context not available for device scanning";
+        libusb_unref_device(event.device);
     }
-#else
-    // 如果没有libusb，使用系统接口
-    devices = scanUSBDevicesWithSysfs();
 #endif
-    
-    return devices;
+}
+
+void USBDeviceMonitor::processUevent(const QByteArray &message)
+{
+    // 格式："ACTION@DEVPATH\0KEY=VALUE\0KEY=VALUE\0..."
+    QHash<QByteArray, QByteArray> properties;
+    for (const QByteArray &field : message.split('\0')) {
+        int separator = field.indexOf('=');
+        if (separator > 0) {
+            properties.insert(field.left(separator), field.mid(separator + 1));
+        }
+    }
+
+    if (properties.value("SUBSYSTEM") != "usb" || properties.value("DEVTYPE") != "usb_device") {
+        return;
+    }
+
+    const QByteArray action = properties.value("ACTION");
+    if (action == "add") {
+        const QString directory = kSysfsRoot + QString::fromLatin1(properties.value("DEVPATH"));
+        USBDeviceDescriptor descriptor;
+        if (readSysfsDescriptor(directory, descriptor)) {
+            handleArrival(descriptor, QFileInfo(directory).fileName(),
+                          [directory](USBDeviceDescriptor &target, bool serialOnly) {
+                readSysfsStrings(directory, target, serialOnly);
+            });
+        }
+    } else if (action == "remove") {
+        bool busOk = false;
+        bool addressOk = false;
+        const quint8 bus = properties.value("BUSNUM").toUShort(&busOk);
+        const quint8 address = properties.value("DEVNUM").toUShort(&addressOk);
+        if (busOk && addressOk) {
+            handleRemoval(DScannerUSB::formatDevicePath(bus, address));
+        }
+    }
+}
+
+QSet<QString> USBDeviceMonitor::enumerateLibUSB()
+{
+    QSet<QString> present;
+
+#ifdef HAVE_LIBUSB
+    libusb_device **deviceList;
+    ssize_t deviceCount = libusb_get_device_list(usbContext, &deviceList);
+    if (deviceCount < 0) {
+        qCWarning(dscannerUSB) << "Failed to get USB device list:" << deviceCount;
+        // 枚举失败时不当作设备全部断开
+        for (auto it = knownDevices.cbegin(); it != knownDevices.cend(); ++it) {
+            present.insert(it.key());
+        }
+        return present;
+    }
+
+    for (ssize_t i = 0; i < deviceCount; ++i) {
+        libusb_device *device = deviceList[i];
+        USBDeviceDescriptor descriptor;
+        if (readLibUSBDescriptor(device, descriptor)) {
+            present.insert(descriptor.devicePath);
+            handleArrival(descriptor, libUSBPortPath(device),
+                          [device](USBDeviceDescriptor &target, bool serialOnly) {
+                readLibUSBStrings(device, target, serialOnly);
+            });
+        }
+    }
+
+    libusb_free_device_list(deviceList, 1);
+#endif
+
+    return present;
+}
+
+QSet<QString> USBDeviceMonitor::enumerateSysfs()
+{
+    QSet<QString> present;
+
+    // 接口节点名含冒号（如1-2:1.0），只取设备节点
+    const QStringList entries = QDir(kSysfsUSBDevices).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &entry : entries) {
+        if (entry.contains(QLatin1Char(':'))) {
+            continue;
+        }
+
+        const QString directory = kSysfsUSBDevices + QLatin1Char('/') + entry;
+        USBDeviceDescriptor descriptor;
+        if (readSysfsDescriptor(directory, descriptor)) {
+            present.insert(descriptor.devicePath);
+            handleArrival(descriptor, QFileInfo(directory).fileName(),
+                          [directory](USBDeviceDescriptor &target, bool serialOnly) {
+                readSysfsStrings(directory, target, serialOnly);
+            });
+        }
+    }
+
+    return present;
+}
+
+void USBDeviceMonitor::removeMissing(const QSet<QString> &present)
+{
+    const QStringList knownPaths = knownDevices.keys();
+    for (const QString &path : knownPaths) {
+        if (!present.contains(path)) {
+            handleRemoval(path);
+        }
+    }
+}
+
+void USBDeviceMonitor::handleArrival(USBDeviceDescriptor descriptor, const QString &portPath,
+                                     const StringReader &readStrings)
+{
+    if (knownDevices.contains(descriptor.devicePath) || !isScannerDevice(descriptor)) {
+        return;
+    }
+
+    // 总线地址在每次插入时重新分配，缓存按物理端口和VID/PID区分设备型号；
+    // 同型号的另一台设备可能插在同一端口，序列号总是重新读取
+    const QString key = portPath + QLatin1Char('/') + QString::number(descriptor.vendorId, 16)
+                        + QLatin1Char(':') + QString::number(descriptor.productId, 16);
+    auto cached = descriptorCache.constFind(key);
+    bool reuseStrings = cached != descriptorCache.constEnd()
+                        && cached->deviceVersion == descriptor.deviceVersion
+                        && cached->deviceClass == descriptor.deviceClass
+                        && cached->deviceSubClass == descriptor.deviceSubClass
+                        && cached->deviceProtocol == descriptor.deviceProtocol;
+    if (reuseStrings) {
+        readStrings(descriptor, true);
+        reuseStrings = descriptor.serialNumber == cached->serialNumber;
+    }
+    if (reuseStrings) {
+        descriptor.manufacturer = cached->manufacturer;
+        descriptor.product = cached->product;
+    } else {
+        readStrings(descriptor, false);
+        descriptorCache.insert(key, descriptor);
+    }
+
+    knownDevices.insert(descriptor.devicePath, descriptor);
+    knownDeviceKeys.insert(descriptor.devicePath, key);
+    qCDebug(dscannerUSB) << "Scanner device arrived:" << descriptor.devicePath << portPath
+                         << QString::number(descriptor.vendorId, 16)
+                         << QString::number(descriptor.productId, 16)
+                         << descriptor.manufacturer << descriptor.product;
+    emit deviceConnected(descriptor);
+}
+
+void USBDeviceMonitor::handleRemoval(const QString &devicePath)
+{
+    if (knownDevices.remove(devicePath) == 0) {
+        return;
+    }
+
+    // 只保留每个端口最后离开的设备，缓存大小以物理端口数为上限
+    const QString key = knownDeviceKeys.take(devicePath);
+    const QString portPrefix = key.left(key.indexOf(QLatin1Char('/')) + 1);
+    for (auto it = descriptorCache.begin(); it != descriptorCache.end();) {
+        if (it.key() != key && it.key().startsWith(portPrefix)) {
+            it = descriptorCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    emit deviceDisconnected(devicePath);
 }
 
 bool USBDeviceMonitor::isScannerDevice(const USBDeviceDescriptor &descriptor)
@@ -12,6 +12,14 @@
 #include <QThread>
 #include <QHash>
 #include <QQueue>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QSet>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
 
 // 前向声明libusb结构体
 struct libusb_context;
@@ -70,6 +78,11 @@ struct USBTransferResult {
 
 /**
  * @brief USB设备监控线程
+ *
+ * 优先使用libusb热插拔回调，平台不支持时监听内核uevent netlink套接字，
+ * 两者都不可用时才退回周期性枚举。libusb使用监控线程独占的上下文，
+ * 事件处理不会取走批量传输等其他上下文上的回调。字符串描述符需要打开设备读取，
+ * 按总线号/设备地址缓存，设备描述符未变化时直接复用。
  */
 class USBDeviceMonitor : public QThread
 {
@@ -79,9 +92,15 @@ public:
     explicit USBDeviceMonitor(QObject *parent = nullptr);
     ~USBDeviceMonitor();
 
+    // 必须在startMonitoring()之前设置；启用时监控线程创建自己的libusb上下文
+    void setLibUSBEnabled(bool enabled);
+
     void startMonitoring();
     void stopMonitoring();
 
+    // libusb热插拔回调入口，只在监控线程处理自身上下文的事件时调用
+    void handleHotplugEvent(libusb_device *device, bool arrived);
+
 signals:
     void deviceConnected(const USBDeviceDescriptor &descriptor);
     void deviceDisconnected(const QString &devicePath);
@@ -90,12 +109,103 @@ protected:
     void run() override;
 
 private:
+    // serialOnly 为true时只读取序列号
+    typedef std::function<void(USBDeviceDescriptor &descriptor, bool serialOnly)> StringReader;
+
+    struct HotplugEvent {
+        libusb_device *device;
+        bool arrived;
+    };
+
+    bool runHotplug();
+    bool runNetlink();
+    void runPolling();
+
+    void processHotplugEvents();
+    void processUevent(const QByteArray &message);
+    QSet<QString> enumerateLibUSB();
+    QSet<QString> enumerateSysfs();
+    void removeMissing(const QSet<QString> &present);
+    void releaseContext();
+
+    void handleArrival(USBDeviceDescriptor descriptor, const QString &portPath, const StringReader &readStrings);
+    void handleRemoval(const QString &devicePath);
+    bool isScannerDevice(const USBDeviceDescriptor &descriptor);
+
     bool monitoring;
     QMutex monitorMutex;
+    QWaitCondition wakeCondition;
+    bool libUSBEnabled;
+    libusb_context *usbContext;   // 监控线程独占，不与设备I/O共用
+
+    // 以下成员只在监控线程中访问
     QHash<QString, USBDeviceDescriptor> knownDevices;
-    
-    QList<USBDeviceDescriptor> scanUSBDevices();
-    bool isScannerDevice(const USBDeviceDescriptor &descriptor);
+    QHash<QString, QString> knownDeviceKeys;               // 设备路径 -> 描述符缓存键
+    QHash<QString, USBDeviceDescriptor> descriptorCache;   // 键为 端口路径/VID:PID
+
+    QMutex eventMutex;
+    QList<HotplugEvent> pendingEvents;
+
+    static constexpr int EVENT_WAIT_MS = 250;
+    static constexpr int POLL_INTERVAL_MS = 1000;
+};
+
+/**
+ * @brief 多缓冲异步批量输入流
+ *
+ * 预先分配固定数量的libusb_transfer并保持全部在途，传输完成后直接把
+ * 缓冲区交给回调，回调返回即重新提交，主机侧在URB之间不再空闲。
+ * 同一端点上的传输按提交顺序完成，因此回调看到的数据保持顺序。
+ * 每个对象只启动一次，重新开始流时创建新对象。对象可能比设备句柄活得
+ * 更久（锁外等待者持有引用），句柄相关的资源由 release() 提前回收。
+ */
+class USBBulkStream
+{
+public:
+    USBBulkStream(libusb_context *context, libusb_device_handle *handle);
+    ~USBBulkStream();
+
+    bool start(const USBStreamConfig &config, const USBStreamCallback &callback, QString *errorMessage);
+    void stop();
+    bool wait(int timeout);
+
+    // 停止并回收事件线程与全部传输；设备句柄关闭前必须调用，可重复调用
+    void release();
+    bool isActive() const;
+    USBStreamStatistics statistics() const;
+
+    // 结束通知，在事件线程中调用
+    std::function<void(const USBStreamStatistics &)> finishedHandler;
+
+    // libusb完成回调入口
+    void handleTransferComplete(libusb_transfer *transfer);
+
+private:
+    bool submitTransfer(libusb_transfer *transfer, bool *submitted);
+    void cancelAll();
+    void runEventLoop();
+    void releaseBuffers();
+
+    libusb_context *m_context;
+    libusb_device_handle *m_handle;
+    USBStreamConfig m_config;
+    USBStreamCallback m_callback;
+
+    std::vector<libusb_transfer*> m_transfers;
+    std::vector<unsigned char*> m_buffers;
+    std::vector<bool> m_deviceMemory;      // 缓冲区是否来自libusb_dev_mem_alloc
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_finishedCondition;
+    int m_inFlight;
+    qint64 m_bytesPending;                 // 在途传输请求的字节数
+    std::atomic<bool> m_stopping;
+    bool m_active;
+    QElapsedTimer m_timer;
+    USBStreamStatistics m_statistics;
+    QThread *m_eventThread;
+
+    Q_DISABLE_COPY(USBBulkStream)
 };
 
 /**
@@ -131,6 +241,7 @@ public:
     // 数据传输
     USBTransferResult performControlTransfer(const USBTransferRequest &request);
     USBTransferResult performBulkTransfer(const USBTransferRequest &request);
+    int performBulkTransferInto(quint8 endpoint, quint8 *buffer, int length, int timeout, int *transferred);
     USBTransferResult performInterruptTransfer(const USBTransferRequest &request);
 
     // 设备信息查询
@@ -150,9 +261,10 @@ public:
     USBInterface convertToInterface(const libusb_interface_descriptor *interface);
     USBEndpoint convertToEndpoint(const libusb_endpoint_descriptor *endpoint);
 
-    // 异步传输支持
-    void processAsyncTransfers();
-    void handleTransferComplete(libusb_transfer *transfer);
+    // 流式批量输入
+    bool startUSBBulkStream(const USBStreamConfig &config, const USBStreamCallback &callback);
+    void stopUSBBulkStream();
+    void joinUSBBulkStream();
 
 public:
     DScannerUSB *q_ptr;
@@ -176,6 +288,8 @@ public:
     QQueue<libusb_transfer*> pendingTransfers;
     QTimer *eventTimer;
     QThread *eventThread;
+    // 共享所有权：waitForBulkStream在锁外等待时，关闭设备不会释放该对象
+    std::shared_ptr<USBBulkStream> bulkStream;
 
     // 设备监控
     USBDeviceMonitor *deviceMonitor;
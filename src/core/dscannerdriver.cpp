@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dscannerdriver_p.h"
+
+DSCANNER_USE_NAMESPACE
+
+// DScannerDriver 基类实现：可选接口的默认行为，各驱动按需重写
+
+DScannerDriver::DScannerDriver(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new DScannerDriverPrivate)
+{
+}
+
+DScannerDriver::DScannerDriver(DScannerDriverPrivate &dd, QObject *parent)
+    : QObject(parent)
+    , d_ptr(&dd)
+{
+}
+
+DScannerDriver::~DScannerDriver()
+{
+}
+
+bool DScannerDriver::detectDevice(const QString &deviceName) const
+{
+    return supportedDevices().contains(deviceName);
+}
+
+bool DScannerDriver::startPreview()
+{
+    return false;
+}
+
+void DScannerDriver::stopPreview()
+{
+}
+
+QImage DScannerDriver::getPreviewData()
+{
+    return QImage();
+}
+
+bool DScannerDriver::isPreviewSupported() const
+{
+    return false;
+}
+
+bool DScannerDriver::isCalibrationSupported() const
+{
+    return false;
+}
+
+bool DScannerDriver::isCalibrated() const
+{
+    return false;
+}
+
+QVariantMap DScannerDriver::getParameters() const
+{
+    QVariantMap parameters;
+    const QStringList names = getParameterNames();
+    for (const QString &name : names) {
+        parameters.insert(name, getParameter(name));
+    }
+    return parameters;
+}
+
+QVariantMap DScannerDriver::getParameterConstraints(const QString &name) const
+{
+    Q_UNUSED(name)
+    return QVariantMap();
+}
+
+void DScannerDriver::clearError()
+{
+    Q_D(DScannerDriver);
+    d->lastError.clear();
+}
+
+void DScannerDriver::setLastError(const QString &error)
+{
+    Q_D(DScannerDriver);
+    d->lastError = error;
+    emit errorOccurred(error);
+}
+
+// 公共头文件中的信号由AUTOMOC按名称查找生成
+#include "moc_DScannerDriver.cpp"
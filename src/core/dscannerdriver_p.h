@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DSCANNERDRIVER_P_H
+#define DSCANNERDRIVER_P_H
+
+#include "Scanner/DScannerDriver.h"
+
+DSCANNER_BEGIN_NAMESPACE
+
+/**
+ * @brief DScannerDriver的私有实现类
+ *
+ * 驱动可派生本类保存自己的状态，并通过受保护的构造函数传入基类。
+ */
+class DScannerDriverPrivate
+{
+public:
+    virtual ~DScannerDriverPrivate() = default;
+
+    QString lastError;
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // DSCANNERDRIVER_P_H
@@ -5,11 +5,21 @@
 
 #include <QDebug>
 #include <QMutexLocker>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrent>
 
 DSCANNER_USE_NAMESPACE
 
 Q_LOGGING_CATEGORY(dscannerCore, "deepinscan.core")
 
+namespace {
+constexpr int kDeviceCacheVersion = 1;
+constexpr int kDefaultBackendTimeout = 5000;
+constexpr int kDefaultDeviceCacheTtl = 300;
+}
+
 // DScannerManagerPrivate 实现
 
 DScannerManagerPrivate::DScannerManagerPrivate(DScannerManager *q)
@@ -17,6 +27,10 @@ DScannerManagerPrivate::DScannerManagerPrivate(DScannerManager *q)
     , discoveryTimer(new QTimer(q))
     , autoDiscovery(true)
     , discoveryInterval(30000)
+    , backendTimeout(kDefaultBackendTimeout)
+    , deviceCacheTtl(kDefaultDeviceCacheTtl)
+    , deviceCachePath(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/deepinscan/devices.json"))
+    , discoveryRound(0)
     , settings(nullptr)
     , configPath(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + QStringLiteral("/deepinscan/config.ini"))
     , usbContext(nullptr)
@@ -67,10 +81,10 @@ void DScannerManagerPrivate::init()
             device.name = netDevice.name;
             device.manufacturer = netDevice.manufacturer;
             device.model = netDevice.model;
+            device.protocol = CommunicationProtocol::Network;
+            device.isAvailable = true;
             
-            // 创建设备对象
-            DScannerDevice *scannerDevice = new DScannerDevice(device, q_ptr);
-            addDevice(scannerDevice);
+            mergeDiscoveredDevice(NetworkBackend, device);
         });
         
         // 启动网络发现
@@ -80,6 +94,9 @@ void DScannerManagerPrivate::init()
     // 加载设备数据库
     loadDeviceDatabase();
     
+    // 恢复上次发现的设备
+    loadDeviceCache();
+    
     // 加载驱动
     loadDrivers();
     
@@ -90,6 +107,8 @@ void DScannerManagerPrivate::init()
     
     if (autoDiscovery) {
         discoveryTimer->start(discoveryInterval);
+        // 后台刷新缓存恢复的设备列表
+        discoverDevices();
     }
     
     qCDebug(dscannerCore) << "DScannerManager initialized successfully";
@@ -102,6 +121,15 @@ void DScannerManagerPrivate::cleanup()
     // 停止自动发现
     discoveryTimer->stop();
     
+    // 等待仍在线程池中运行的发现查询，它们引用本对象
+    const QList<QFutureWatcherBase*> watchers = q_ptr->findChildren<QFutureWatcherBase*>();
+    for (QFutureWatcherBase *watcher : watchers) {
+        watcher->disconnect();
+        watcher->waitForFinished();
+    }
+    pendingBackends.clear();
+    runningBackends.clear();
+    
     // 清理设备
     qDeleteAll(devices);
     devices.clear();
@@ -124,42 +152,100 @@ void DScannerManagerPrivate::cleanup()
 
 void DScannerManagerPrivate::discoverDevices()
 {
-    QMutexLocker locker(&mutex);
+    if (!pendingBackends.isEmpty()) {
+        qCDebug(dscannerCore) << "Device discovery already in progress";
+        return;
+    }
     
     qCDebug(dscannerCore) << "Starting device discovery";
     
-    QElapsedTimer timer;
-    timer.start();
+    ++discoveryRound;
+    roundTimer.start();
     
-    // 发现USB设备
-    discoverUSBDevices();
-    
-    // 发现SANE设备
-    discoverSANEDevices();
+    // 阻塞的后端在线程池中并行查询，慢的后端不会拖住其他后端的结果
+    if (usbInitialized) {
+        // 查询线程只读数据库的隐式共享副本，主线程重新加载时互不影响
+        const QJsonObject database = deviceDatabase;
+        const QList<KnownDevice> known = knownDevices;
+        startBackend(USBBackend, [this, database, known]() { return queryUSBDevices(database, known); });
+    }
+    if (saneInitialized) {
+        startBackend(SANEBackend, [this]() { return getSANEDevices(); });
+    }
     
-    // 发现网络设备
+    // 网络发现引擎本身是异步的，结果通过信号逐个合并
     discoverNetworkDevices();
     
+    if (pendingBackends.isEmpty()) {
+        finishDiscoveryRound();
+    }
+}
+
+void DScannerManagerPrivate::startBackend(DiscoveryBackend backend, const std::function<QList<DeviceInfo>()> &query)
+{
+    // 上一轮超时的查询仍在运行时不重复启动，等它返回后再合并
+    if (runningBackends.contains(backend)) {
+        qCWarning(dscannerCore) << "Discovery backend" << backend << "still busy from a previous round";
+        return;
+    }
+    
+    runningBackends.insert(backend);
+    pendingBackends.insert(backend);
+    
+    auto *watcher = new QFutureWatcher<QList<DeviceInfo>>(q_ptr);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, q_ptr, [this, watcher, backend]() {
+        runningBackends.remove(backend);
+        // 超时后返回的结果仍然合并
+        mergeBackendResult(backend, watcher->result());
+        watcher->deleteLater();
+        finishBackend(backend);
+    });
+    watcher->setFuture(QtConcurrent::run(query));
+    
+    const quint64 round = discoveryRound;
+    QTimer::singleShot(backendTimeout, q_ptr, [this, backend, round]() {
+        if (round == discoveryRound && pendingBackends.contains(backend)) {
+            qCWarning(dscannerCore) << "Discovery backend" << backend << "missed its"
+                                    << backendTimeout << "ms deadline";
+            finishBackend(backend);
+        }
+    });
+}
+
+void DScannerManagerPrivate::finishBackend(DiscoveryBackend backend)
+{
+    if (pendingBackends.remove(backend) && pendingBackends.isEmpty()) {
+        finishDiscoveryRound();
+    }
+}
+
+void DScannerManagerPrivate::finishDiscoveryRound()
+{
+    expireStaleDevices();
+    
     stats.lastDiscoveryTime = QDateTime::currentDateTime();
-    stats.discoveryTime = timer.elapsed();
+    stats.discoveryTime = roundTimer.elapsed();
     
     qCDebug(dscannerCore) << "Device discovery completed in" << stats.discoveryTime << "ms";
     
+    saveDeviceCache();
     emit q_ptr->deviceListRefreshed();
 }
 
-void DScannerManagerPrivate::discoverUSBDevices()
+bool DScannerManagerPrivate::isDiscoveryRunning() const
+{
+    return !pendingBackends.isEmpty();
+}
+
+QList<DeviceInfo> DScannerManagerPrivate::queryUSBDevices(const QJsonObject &database, const QList<KnownDevice> &known)
 {
-    if (!usbInitialized) {
-        return;
-    }
-    
     qCDebug(dscannerCore) << "Discovering USB devices";
     
-    QList<USBDeviceInfo> usbDevices = getUSBDevices();
+    QList<DeviceInfo> found;
+    const QList<USBDeviceInfo> usbDevices = getUSBDevices();
     
     for (const USBDeviceInfo &usbInfo : usbDevices) {
-        if (isKnownUSBDevice(usbInfo.vendorId, usbInfo.productId)) {
+        if (isKnownUSBDevice(database, known, usbInfo.vendorId, usbInfo.productId)) {
             DeviceInfo info;
             info.deviceId = QStringLiteral("usb:%1:%2").arg(usbInfo.vendorId, 4, 16, QLatin1Char('0')).arg(usbInfo.productId, 4, 16, QLatin1Char('0'));
             info.name = QStringLiteral("%1 %2").arg(usbInfo.manufacturer, usbInfo.product);
@@ -167,57 +253,182 @@ void DScannerManagerPrivate::discoverUSBDevices()
             info.model = usbInfo.product;
             info.protocol = CommunicationProtocol::USB;
             info.isAvailable = true;
-            
-            // 检查设备是否已存在
-            if (!deviceMap.contains(info.deviceId)) {
-                DScannerDevice *device = new DScannerDevice(info, q_ptr);
-                addDevice(device);
-                
-                emit q_ptr->deviceDiscovered(info);
-                stats.totalDevicesFound++;
-            }
+            found.append(info);
         }
     }
+    
+    return found;
 }
 
-void DScannerManagerPrivate::discoverSANEDevices()
+void DScannerManagerPrivate::discoverNetworkDevices()
 {
-    if (!saneInitialized) {
+    qCDebug(dscannerCore) << "Discovering network devices";
+    
+    const QList<DeviceInfo> networkDevices = getNetworkDevices();
+    for (const DeviceInfo &info : networkDevices) {
+        mergeDiscoveredDevice(NetworkBackend, info);
+    }
+}
+
+void DScannerManagerPrivate::mergeDiscoveredDevice(DiscoveryBackend backend, const DeviceInfo &info)
+{
+    if (info.deviceId.isEmpty()) {
         return;
     }
     
-    qCDebug(dscannerCore) << "Discovering SANE devices";
+    deviceSources.insert(info.deviceId, backend);
+    deviceLastSeen.insert(info.deviceId, QDateTime::currentDateTimeUtc());
     
-    QList<DeviceInfo> saneDevices = getSANEDevices();
+    bool known;
+    {
+        QMutexLocker locker(&mutex);
+        known = deviceMap.contains(info.deviceId);
+    }
+    if (known) {
+        return;
+    }
     
-    for (const DeviceInfo &info : saneDevices) {
-        if (!deviceMap.contains(info.deviceId)) {
-            DScannerDevice *device = new DScannerDevice(info, q_ptr);
-            addDevice(device);
-            
-            emit q_ptr->deviceDiscovered(info);
-            stats.totalDevicesFound++;
+    addDevice(new DScannerDevice(info, q_ptr));
+    emit q_ptr->deviceDiscovered(info);
+    stats.totalDevicesFound++;
+}
+
+void DScannerManagerPrivate::mergeBackendResult(DiscoveryBackend backend, const QList<DeviceInfo> &found)
+{
+    QSet<QString> seen;
+    for (const DeviceInfo &info : found) {
+        seen.insert(info.deviceId);
+        mergeDiscoveredDevice(backend, info);
+    }
+    
+    // 后端返回的是完整列表，其中没有的设备已经断开
+    const QList<QString> ids = deviceSources.keys(backend);
+    for (const QString &deviceId : ids) {
+        if (seen.contains(deviceId)) {
+            continue;
+        }
+        DScannerDevice *device = findDevice(deviceId);
+        if (device && device->isConnected()) {
+            continue;
+        }
+        deviceSources.remove(deviceId);
+        deviceLastSeen.remove(deviceId);
+        if (device) {
+            removeDevice(deviceId);
         }
     }
 }
 
-void DScannerManagerPrivate::discoverNetworkDevices()
+void DScannerManagerPrivate::expireStaleDevices()
 {
-    qCDebug(dscannerCore) << "Discovering network devices";
+    // 网络设备和超时后端的设备没有完整列表可比对，按有效期淘汰
+    const QDateTime cutoff = QDateTime::currentDateTimeUtc().addSecs(-deviceCacheTtl);
+    const QList<QString> ids = deviceLastSeen.keys();
+    for (const QString &deviceId : ids) {
+        if (deviceLastSeen.value(deviceId) >= cutoff) {
+            continue;
+        }
+        DScannerDevice *device = findDevice(deviceId);
+        if (device && device->isConnected()) {
+            continue;
+        }
+        deviceSources.remove(deviceId);
+        deviceLastSeen.remove(deviceId);
+        if (device) {
+            removeDevice(deviceId);
+        }
+    }
+}
+
+void DScannerManagerPrivate::loadDeviceCache()
+{
+    QFile file(deviceCachePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
     
-    QList<DeviceInfo> networkDevices = getNetworkDevices();
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("version")).toInt() != kDeviceCacheVersion) {
+        return;
+    }
     
-    for (const DeviceInfo &info : networkDevices) {
-        if (!deviceMap.contains(info.deviceId)) {
-            DScannerDevice *device = new DScannerDevice(info, q_ptr);
-            addDevice(device);
-            
-            emit q_ptr->deviceDiscovered(info);
-            stats.totalDevicesFound++;
+    const QDateTime cutoff = QDateTime::currentDateTimeUtc().addSecs(-deviceCacheTtl);
+    int restored = 0;
+    for (const QJsonValue &value : root.value(QStringLiteral("devices")).toArray()) {
+        const QJsonObject obj = value.toObject();
+        const QDateTime lastSeen = QDateTime::fromString(obj.value(QStringLiteral("lastSeen")).toString(), Qt::ISODate);
+        if (!lastSeen.isValid() || lastSeen < cutoff) {
+            continue;
+        }
+        
+        DeviceInfo info;
+        info.deviceId = obj.value(QStringLiteral("deviceId")).toString();
+        info.name = obj.value(QStringLiteral("name")).toString();
+        info.manufacturer = obj.value(QStringLiteral("manufacturer")).toString();
+        info.model = obj.value(QStringLiteral("model")).toString();
+        info.serialNumber = obj.value(QStringLiteral("serialNumber")).toString();
+        info.driverType = static_cast<DriverType>(obj.value(QStringLiteral("driverType")).toInt());
+        info.protocol = static_cast<CommunicationProtocol>(obj.value(QStringLiteral("protocol")).toInt());
+        info.connectionString = obj.value(QStringLiteral("connectionString")).toString();
+        info.isAvailable = true;
+        if (!info.isValid() || deviceMap.contains(info.deviceId)) {
+            continue;
         }
+        
+        const DiscoveryBackend backend = static_cast<DiscoveryBackend>(obj.value(QStringLiteral("source")).toInt());
+        deviceSources.insert(info.deviceId, backend);
+        deviceLastSeen.insert(info.deviceId, lastSeen);
+        addDevice(new DScannerDevice(info, q_ptr));
+        ++restored;
+    }
+    
+    qCDebug(dscannerCore) << "Restored" << restored << "devices from cache" << deviceCachePath;
+}
+
+void DScannerManagerPrivate::saveDeviceCache() const
+{
+    QJsonArray array;
+    {
+        QMutexLocker locker(&mutex);
+        for (DScannerDevice *device : devices) {
+            const DeviceInfo info = device->deviceInfo();
+            if (!deviceLastSeen.contains(info.deviceId)) {
+                continue;
+            }
+            QJsonObject obj;
+            obj[QStringLiteral("deviceId")] = info.deviceId;
+            obj[QStringLiteral("name")] = info.name;
+            obj[QStringLiteral("manufacturer")] = info.manufacturer;
+            obj[QStringLiteral("model")] = info.model;
+            obj[QStringLiteral("serialNumber")] = info.serialNumber;
+            obj[QStringLiteral("driverType")] = static_cast<int>(info.driverType);
+            obj[QStringLiteral("protocol")] = static_cast<int>(info.protocol);
+            obj[QStringLiteral("connectionString")] = info.connectionString;
+            obj[QStringLiteral("source")] = static_cast<int>(deviceSources.value(info.deviceId));
+            obj[QStringLiteral("lastSeen")] = deviceLastSeen.value(info.deviceId).toUTC().toString(Qt::ISODate);
+            array.append(obj);
+        }
+    }
+    
+    QJsonObject root;
+    root[QStringLiteral("version")] = kDeviceCacheVersion;
+    root[QStringLiteral("devices")] = array;
+    
+    QDir().mkpath(QFileInfo(deviceCachePath).absolutePath());
+    QSaveFile file(deviceCachePath);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0
+        || !file.commit()) {
+        qCWarning(dscannerCore) << "Failed to write device cache" << deviceCachePath;
     }
 }
 
+bool DScannerManagerPrivate::isDeviceCacheFresh() const
+{
+    return stats.lastDiscoveryTime.isValid()
+        && stats.lastDiscoveryTime.secsTo(QDateTime::currentDateTime()) < deviceCacheTtl;
+}
+
 void DScannerManagerPrivate::addDevice(DScannerDevice *device)
 {
     if (!device) {
@@ -226,8 +437,11 @@ void DScannerManagerPrivate::addDevice(DScannerDevice *device)
     
     const QString deviceId = device->deviceInfo().deviceId;
     
-    devices.append(device);
-    deviceMap.insert(deviceId, device);
+    {
+        QMutexLocker locker(&mutex);
+        devices.append(device);
+        deviceMap.insert(deviceId, device);
+    }
     
     // 连接设备信号
           QObject::connect(device, &DScannerDevice::statusChanged, q_ptr, [this, deviceId](DScannerDevice::Status status) {
@@ -251,15 +465,17 @@ void DScannerManagerPrivate::addDevice(DScannerDevice *device)
 
 void DScannerManagerPrivate::removeDevice(const QString &deviceId)
 {
-    DScannerDevice *device = deviceMap.value(deviceId);
+    DScannerDevice *device = nullptr;
+    {
+        QMutexLocker locker(&mutex);
+        device = deviceMap.take(deviceId);
+        devices.removeAll(device);
+    }
     if (!device) {
         qCWarning(dscannerCore) << "Device not found:" << deviceId;
         return;
     }
     
-    devices.removeAll(device);
-    deviceMap.remove(deviceId);
-    
     // 断开设备信号
     QObject::disconnect(device, nullptr, q_ptr, nullptr);
     
@@ -356,17 +572,18 @@ QList<USBDeviceInfo> DScannerManagerPrivate::getUSBDevices()
     return devices;
 }
 
-bool DScannerManagerPrivate::isKnownUSBDevice(quint16 vendorId, quint16 productId)
+bool DScannerManagerPrivate::isKnownUSBDevice(const QJsonObject &database, const QList<KnownDevice> &known,
+                                              quint16 vendorId, quint16 productId)
 {
     // 检查已知设备列表
-    for (const KnownDevice &known : knownDevices) {
-        if (known.vendorId == vendorId && known.productId == productId) {
+    for (const KnownDevice &device : known) {
+        if (device.vendorId == vendorId && device.productId == productId) {
             return true;
         }
     }
     
     // 查询设备数据库
-    QList<DeviceInfo> dbDevices = queryDeviceDatabase(vendorId, productId);
+    QList<DeviceInfo> dbDevices = queryDeviceDatabase(database, vendorId, productId);
     return !dbDevices.isEmpty();
 }
 
@@ -481,6 +698,7 @@ QList<DeviceInfo> DScannerManagerPrivate::getNetworkDevices()
     
     if (!m_networkCompleteDiscovery) {
         m_networkCompleteDiscovery = new NetworkCompleteDiscovery(q_ptr);
+        m_networkCompleteDiscovery->setMetricsExportDirectory(networkMetricsDirectory);
         
         // 连接网络发现信号
         QObject::connect(m_networkCompleteDiscovery, &NetworkCompleteDiscovery::deviceDiscovered,
@@ -506,9 +724,8 @@ QList<DeviceInfo> DScannerManagerPrivate::getNetworkDevices()
             // deviceInfo.properties["addresses"] = networkDevice.addresses;
             // deviceInfo.properties["capabilities"] = networkDevice.capabilities;
             
-            // 添加到设备列表 - 临时简化处理
-            QMutexLocker locker(&mutex);
-            qCDebug(dscannerCore) << "发现网络设备已添加:" << deviceInfo.name;
+            // 添加到设备列表
+            mergeDiscoveredDevice(NetworkBackend, deviceInfo);
         });
         
         QObject::connect(m_networkCompleteDiscovery, &NetworkCompleteDiscovery::discoveryCompleted,
@@ -526,6 +743,28 @@ QList<DeviceInfo> DScannerManagerPrivate::getNetworkDevices()
                                       << "UPnP:" << stats.upnpDevicesFound
                                       << "端口扫描:" << stats.portScanDevicesFound;
         });
+        
+        // 复核在线的已知设备不会再次发出deviceDiscovered，需刷新有效期
+        QObject::connect(m_networkCompleteDiscovery, &NetworkCompleteDiscovery::deviceRevalidated,
+                q_ptr, [this](const NetworkScannerDevice &networkDevice) {
+            if (deviceSources.contains(networkDevice.uuid)) {
+                deviceLastSeen.insert(networkDevice.uuid, QDateTime::currentDateTimeUtc());
+            }
+        });
+        
+        QObject::connect(m_networkCompleteDiscovery, &NetworkCompleteDiscovery::deviceLost,
+                q_ptr, [this](const NetworkScannerDevice &networkDevice) {
+            const QString deviceId = networkDevice.uuid;
+            DScannerDevice *device = findDevice(deviceId);
+            if (device && device->isConnected()) {
+                return;
+            }
+            deviceSources.remove(deviceId);
+            deviceLastSeen.remove(deviceId);
+            if (device) {
+                removeDevice(deviceId);
+            }
+        });
     }
     
     // 启动网络发现
@@ -555,6 +794,9 @@ void DScannerManagerPrivate::loadConfiguration()
     settings->beginGroup(QStringLiteral("Discovery"));
     autoDiscovery = settings->value(QStringLiteral("autoDiscovery"), true).toBool();
     discoveryInterval = settings->value(QStringLiteral("discoveryInterval"), 30000).toInt();
+    backendTimeout = settings->value(QStringLiteral("backendTimeout"), kDefaultBackendTimeout).toInt();
+    deviceCacheTtl = settings->value(QStringLiteral("deviceCacheTtl"), kDefaultDeviceCacheTtl).toInt();
+    networkMetricsDirectory = settings->value(QStringLiteral("networkMetricsDirectory")).toString();
     settings->endGroup();
     
     // 加载统计信息
@@ -575,6 +817,9 @@ void DScannerManagerPrivate::saveConfiguration()
     settings->beginGroup(QStringLiteral("Discovery"));
     settings->setValue(QStringLiteral("autoDiscovery"), autoDiscovery);
     settings->setValue(QStringLiteral("discoveryInterval"), discoveryInterval);
+    settings->setValue(QStringLiteral("backendTimeout"), backendTimeout);
+    settings->setValue(QStringLiteral("deviceCacheTtl"), deviceCacheTtl);
+    settings->setValue(QStringLiteral("networkMetricsDirectory"), networkMetricsDirectory);
     settings->endGroup();
     
     // 保存统计信息
@@ -607,9 +852,10 @@ void DScannerManagerPrivate::loadDeviceDatabase()
     }
     
     deviceDatabase = doc.object();
+    knownDevices.clear();
     
     // 加载已知设备列表
-    QJsonArray deviceArray = deviceDatabase[QStringLiteral("devices")].toArray();
+    const QJsonArray deviceArray = deviceDatabase.value(QStringLiteral("devices")).toArray();
     
     for (const QJsonValue &value : deviceArray) {
         QJsonObject obj = value.toObject();
@@ -690,20 +936,21 @@ DeviceInfo DScannerManagerPrivate::deviceInfo(const QString &deviceId) const
     return DeviceInfo();
 }
 
-QList<DeviceInfo> DScannerManagerPrivate::queryDeviceDatabase(quint16 vendorId, quint16 productId)
+QList<DeviceInfo> DScannerManagerPrivate::queryDeviceDatabase(const QJsonObject &database, quint16 vendorId, quint16 productId)
 {
     QList<DeviceInfo> devices;
     
-    QJsonArray deviceArray = deviceDatabase[QStringLiteral("devices")].toArray();
+    // 只通过const接口读取，非const的operator[]会分离共享数据
+    const QJsonArray deviceArray = database.value(QStringLiteral("devices")).toArray();
     
     for (const QJsonValue &value : deviceArray) {
-        QJsonObject obj = value.toObject();
-        if (obj[QStringLiteral("vendor_id")].toInt() == vendorId && obj[QStringLiteral("product_id")].toInt() == productId) {
+        const QJsonObject obj = value.toObject();
+        if (obj.value(QStringLiteral("vendor_id")).toInt() == vendorId && obj.value(QStringLiteral("product_id")).toInt() == productId) {
             DeviceInfo info;
-            info.name = obj[QStringLiteral("name")].toString();
-            info.manufacturer = obj[QStringLiteral("manufacturer")].toString();
-            info.model = obj[QStringLiteral("model")].toString();
-            info.protocol = static_cast<CommunicationProtocol>(obj[QStringLiteral("protocol")].toInt());
+            info.name = obj.value(QStringLiteral("name")).toString();
+            info.manufacturer = obj.value(QStringLiteral("manufacturer")).toString();
+            info.model = obj.value(QStringLiteral("model")).toString();
+            info.protocol = static_cast<CommunicationProtocol>(obj.value(QStringLiteral("protocol")).toInt());
             info.isAvailable = true;
             
             devices.append(info);
@@ -855,7 +1102,8 @@ void DScannerManager::shutdown()
 QList<DeviceInfo> DScannerManager::discoverDevices(bool forceRefresh)
 {
     Q_D(DScannerManager);
-    if (forceRefresh) {
+    // 立即返回当前列表，刷新在后台进行
+    if (forceRefresh || !d->isDeviceCacheFresh()) {
         d->discoverDevices();
     }
     return d->availableDevices();
@@ -29,7 +29,9 @@
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QScopedPointer>
+#include <QSet>
 #include <memory>
+#include <functional>
 
 #include <libusb-1.0/libusb.h>
 
@@ -55,11 +57,40 @@ public:
     void init();
     void cleanup();
     
-    // 设备发现
+    // 设备发现后端
+    enum DiscoveryBackend {
+        USBBackend,
+        SANEBackend,
+        NetworkBackend
+    };
+    
+    // 设备数据库中的已知设备
+    struct KnownDevice {
+        quint16 vendorId;
+        quint16 productId;
+        QString manufacturer;
+        QString model;
+        DriverType driverType;
+        CommunicationProtocol protocol;
+    };
+    
+    // 设备发现：各后端并行查询，结果逐个合并，不阻塞调用方
     void discoverDevices();
-    void discoverUSBDevices();
-    void discoverSANEDevices();
+    void startBackend(DiscoveryBackend backend, const std::function<QList<DeviceInfo>()> &query);
+    void finishBackend(DiscoveryBackend backend);
+    void finishDiscoveryRound();
+    bool isDiscoveryRunning() const;
+    // 在线程池中运行，只读访问调用方传入的设备数据库快照
+    QList<DeviceInfo> queryUSBDevices(const QJsonObject &database, const QList<KnownDevice> &known);
     void discoverNetworkDevices();
+    void mergeDiscoveredDevice(DiscoveryBackend backend, const DeviceInfo &info);
+    void mergeBackendResult(DiscoveryBackend backend, const QList<DeviceInfo> &found);
+    void expireStaleDevices();
+    
+    // 设备缓存：启动时恢复上次发现的设备，availableDevices() 无需等待发现
+    void loadDeviceCache();
+    void saveDeviceCache() const;
+    bool isDeviceCacheFresh() const;
     
     // 设备管理
     void addDevice(DScannerDevice *device);
@@ -81,7 +112,8 @@ public:
     bool initUSB();
     void cleanupUSB();
     QList<USBDeviceInfo> getUSBDevices();
-    bool isKnownUSBDevice(quint16 vendorId, quint16 productId);
+    static bool isKnownUSBDevice(const QJsonObject &database, const QList<KnownDevice> &known,
+                                 quint16 vendorId, quint16 productId);
     
     // SANE 相关
     bool initSANE();
@@ -97,7 +129,7 @@ public:
     
     // 设备数据库
     void loadDeviceDatabase();
-    QList<DeviceInfo> queryDeviceDatabase(quint16 vendorId, quint16 productId);
+    static QList<DeviceInfo> queryDeviceDatabase(const QJsonObject &database, quint16 vendorId, quint16 productId);
     
     // 公共成员
     DScannerManager *q_ptr;
@@ -114,6 +146,18 @@ public:
     QTimer *discoveryTimer;
     bool autoDiscovery;
     int discoveryInterval;
+    int backendTimeout;                         // 单个后端的截止时间(毫秒)
+    int deviceCacheTtl;                         // 缓存条目有效期(秒)
+    QString networkMetricsDirectory;            // 网络发现指标导出目录，为空时不导出
+    QString deviceCachePath;
+    
+    // 发现状态（只在主线程访问）
+    quint64 discoveryRound;                     // 用于识别过期的截止定时器
+    QSet<DiscoveryBackend> pendingBackends;     // 本轮尚未结束的后端
+    QSet<DiscoveryBackend> runningBackends;     // 查询仍在线程池中运行的后端
+    QElapsedTimer roundTimer;
+    QHash<QString, DiscoveryBackend> deviceSources;
+    QHash<QString, QDateTime> deviceLastSeen;
     
     // 线程同步
     mutable QMutex mutex;
@@ -130,18 +174,8 @@ public:
     QLibrary *saneLibrary;
     bool saneInitialized;
     
-    // 设备数据库
+    // 设备数据库（只在主线程修改，发现查询使用启动时的副本）
     QJsonObject deviceDatabase;
-    
-    // 已知设备列表
-    struct KnownDevice {
-        quint16 vendorId;
-        quint16 productId;
-        QString manufacturer;
-        QString model;
-        DriverType driverType;
-        CommunicationProtocol protocol;
-    };
     QList<KnownDevice> knownDevices;
     
     // 性能统计
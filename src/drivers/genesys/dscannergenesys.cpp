@@ -8,11 +8,38 @@
 #include <QMutexLocker>
 #include <QTimer>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
 
 DSCANNER_USE_NAMESPACE
 
 Q_LOGGING_CATEGORY(dscannerGenesys, "deepinscan.genesys")
 
+// Genesys厂商控制请求：一次写入多组(地址,值)寄存器
+namespace {
+constexpr quint8 kRequestTypeOut = 0x40;
+constexpr quint8 kRequestBuffer = 0x04;
+constexpr quint16 kValueSetRegister = 0x83;
+constexpr int kMaxRegistersPerTransfer = 64;
+
+// 芯片RAM写入地址寄存器（地址以16字节为单位）及批量输出端点
+constexpr quint8 kRegBufferAddressHigh = 0x2a;
+constexpr quint8 kRegBufferAddressLow = 0x2b;
+constexpr quint8 kBulkOutEndpoint = 0x02;
+constexpr quint8 kBulkInEndpoint = 0x01;
+
+// 表在芯片RAM中的位置与上传参数
+constexpr quint32 kGammaBufferAddress = 0x00000;
+constexpr quint32 kShadingBufferAddress = 0x10000;
+constexpr int kUploadChunkSize = 64 * 1024;
+constexpr int kUploadTimeoutMs = 5000;
+constexpr int kLampReadyTimeoutMs = 30000;
+
+// 扫描数据批量读取参数
+constexpr int kScanReadChunkSize = 64 * 1024;
+constexpr int kScanReadTimeoutMs = 10000;
+}
+
 // DScannerGenesysDriver implementation
 DScannerGenesysDriver::DScannerGenesysDriver(QObject *parent)
     : DScannerDriver(parent)
@@ -257,6 +284,42 @@ void DScannerGenesysDriver::stopScan()
     emit scanStopped();
 }
 
+QByteArray DScannerGenesysDriver::readScanData()
+{
+    QByteArray data(kScanReadChunkSize, Qt::Uninitialized);
+    const qint64 count = readScanDataInto(reinterpret_cast<quint8 *>(data.data()), data.size());
+    if (count <= 0) {
+        return QByteArray();
+    }
+    data.resize(static_cast<int>(count));
+    return data;
+}
+
+bool DScannerGenesysDriver::supportsDirectRead() const
+{
+    return true;
+}
+
+qint64 DScannerGenesysDriver::readScanDataInto(quint8 *buffer, qint64 maxLength)
+{
+    Q_D(DScannerGenesysDriver);
+    
+    if (!d->currentDevice || !d->usbComm || !d->isScanning) {
+        d->lastError = QStringLiteral("No scan in progress");
+        return -1;
+    }
+    
+    // 批量端点直接写入调用方内存（ImageBuffer 扫描行或内存池块），不经过中间 QByteArray
+    const int length = static_cast<int>(qMin<qint64>(maxLength, kScanReadChunkSize));
+    const int count = d->usbComm->bulkTransferInto(kBulkInEndpoint, buffer, length, kScanReadTimeoutMs);
+    if (count < 0) {
+        d->lastError = QStringLiteral("Scan data read failed: %1").arg(d->usbComm->lastError());
+        qCWarning(dscannerGenesys) << d->lastError;
+        return -1;
+    }
+    return count;
+}
+
 bool DScannerGenesysDriver::pauseScan()
 {
     // Genesys驱动不支持暂停，返回false
@@ -596,14 +659,21 @@ DScannerGenesysDriverPrivate::DScannerGenesysDriverPrivate(DScannerGenesysDriver
     , currentDeviceId()
     , isScanning(false)
     , registerCacheEnabled(true)
+    , tableUploader([this](quint32 address, const QByteArray &data) { return uploadToBuffer(address, data); })
+    , enableGammaCorrection(true)
     , isCalibrated(false)
     , currentResolution(300)
     , currentColorMode(ColorMode::Color)
 {
+    // 上传线程会直接写地址寄存器，影子副本不能缓存它们
+    registers.markVolatile(kRegBufferAddressHigh);
+    registers.markVolatile(kRegBufferAddressLow);
 }
 
 DScannerGenesysDriverPrivate::~DScannerGenesysDriverPrivate()
 {
+    // 在途的上传仍在使用usbComm
+    tableUploader.waitForFinished();
     if (currentDevice) {
         closeUSBDevice();
     }
@@ -684,9 +754,39 @@ bool DScannerGenesysDriverPrivate::applyScanParameters(const ScanParameters &par
 
 bool DScannerGenesysDriverPrivate::startScanning()
 {
-    // 开始扫描的基础实现
-    isScanning = true;
-    return true;
+    // 表上传在上传线程中进行，与马达、灯管设置并行
+    uploadGammaTables();
+    uploadShadingData();
+    
+    // 扫描按当前寄存器配置与芯片RAM中的表进行：上传全部结束后才提交寄存器、开始扫描
+    const bool started = tableUploader.startAfterUploads(
+        [this]() {
+            if (!initializeMotor() || !turnOnLamp()) {
+                return false;
+            }
+            QElapsedTimer timer;
+            timer.start();
+            while (!isLampReady()) {
+                if (timer.elapsed() > kLampReadyTimeoutMs) {
+                    lastError = QStringLiteral("Lamp warm-up timeout");
+                    return false;
+                }
+                QThread::msleep(50);
+            }
+            return true;
+        },
+        [this]() {
+            if (!flushRegisters()) {
+                return false;
+            }
+            isScanning = true;
+            return true;
+        });
+    
+    if (!started && tableUploader.uploadFailed()) {
+        lastError = QStringLiteral("Failed to upload gamma or shading tables");
+    }
+    return started;
 }
 
 void DScannerGenesysDriverPrivate::stopScanning()
@@ -710,8 +810,8 @@ bool DScannerGenesysDriverPrivate::performCalibration()
 
 bool DScannerGenesysDriverPrivate::initializeChipset()
 {
-    // 芯片组初始化的基础实现
-    return true;
+    // 芯片组初始化序列只写影子寄存器，最后一次提交
+    return flushRegisters();
 }
 
 bool DScannerGenesysDriverPrivate::calibrateSensor()
@@ -777,50 +877,106 @@ GenesysSensor DScannerGenesysDriverPrivate::getDefaultSensor(GenesysChipset chip
 // 设备参数管理方法
 bool DScannerGenesysDriverPrivate::setDeviceParameter(const QString &name, const QVariant &value)
 {
-    Q_UNUSED(name)
-    Q_UNUSED(value)
+    if (name == QLatin1String("gamma_correction")) {
+        enableGammaCorrection = value.toBool();
+    }
     return true;
 }
 
 QVariant DScannerGenesysDriverPrivate::getDeviceParameter(const QString &name) const
 {
-    Q_UNUSED(name)
+    if (name == QLatin1String("gamma_correction")) {
+        return enableGammaCorrection;
+    }
     return QVariant();
 }
 
 QStringList DScannerGenesysDriverPrivate::getDeviceParameterNames() const
 {
-    return QStringList() << "resolution" << "color_mode" << "scan_area";
+    return QStringList() << "resolution" << "color_mode" << "scan_area" << "gamma_correction";
 }
 
 // 寄存器操作方法
 quint8 DScannerGenesysDriverPrivate::readRegister(int address)
 {
-    Q_UNUSED(address)
-    return 0;
+    quint16 value = 0;
+    if (registerCacheEnabled && registers.isCached(address) && registers.value(address, value)) {
+        return static_cast<quint8>(value);
+    }
+    
+    // 读取结果可能依赖尚未提交的写入
+    if (!flushRegisters()) {
+        return 0;
+    }
+    
+    RegisterOperationResult result = performRegisterOperation(address);
+    if (!result.success || result.data.isEmpty()) {
+        return 0;
+    }
+    value = static_cast<quint8>(result.data.at(0));
+    registers.recordRead(address, value);
+    return static_cast<quint8>(value);
 }
 
 bool DScannerGenesysDriverPrivate::writeRegister(int address, quint8 value)
 {
-    Q_UNUSED(address)
-    Q_UNUSED(value)
+    registers.set(address, value);
+    
+    // 易失寄存器立即提交（连同之前的脏写入，保持顺序），错误返回给调用方
+    if (registers.isVolatile(address)) {
+        return flushRegisters();
+    }
     return true;
 }
 
 QByteArray DScannerGenesysDriverPrivate::readRegisters(int startAddress, int count)
 {
-    Q_UNUSED(startAddress)
-    Q_UNUSED(count)
-    return QByteArray();
+    QByteArray values;
+    values.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        values.append(static_cast<char>(readRegister(startAddress + i)));
+    }
+    return values;
 }
 
 bool DScannerGenesysDriverPrivate::writeRegisters(int startAddress, const QByteArray &values)
 {
-    Q_UNUSED(startAddress)
-    Q_UNUSED(values)
+    for (int i = 0; i < values.size(); ++i) {
+        if (!writeRegister(startAddress + i, static_cast<quint8>(values.at(i)))) {
+            return false;
+        }
+    }
     return true;
 }
 
+bool DScannerGenesysDriverPrivate::flushRegisters()
+{
+    if (!registers.isDirty()) {
+        return true;
+    }
+    if (!usbComm) {
+        lastError = QStringLiteral("No USB connection");
+        return false;
+    }
+    
+    const bool flushed = registers.flush(kMaxRegistersPerTransfer,
+                                         [this](const QVector<GenesysRegisterSet::Write> &writes) {
+        QByteArray data;
+        data.reserve(writes.size() * 2);
+        for (const GenesysRegisterSet::Write &write : writes) {
+            data.append(static_cast<char>(write.address));
+            data.append(static_cast<char>(write.value));
+        }
+        return usbComm->controlTransfer(kRequestTypeOut, kRequestBuffer, kValueSetRegister, 0, data) == data.size();
+    });
+    
+    if (!flushed) {
+        lastError = QStringLiteral("Failed to write registers");
+        qCWarning(dscannerGenesys) << lastError << "-" << registers.dirtyCount() << "pending";
+    }
+    return flushed;
+}
+
 // 芯片组特定初始化方法
 bool DScannerGenesysDriverPrivate::initializeGL646()
 {
@@ -903,6 +1059,60 @@ bool DScannerGenesysDriverPrivate::isLampReady()
     return true;
 }
 
+// 表上传方法
+void DScannerGenesysDriverPrivate::uploadGammaTables()
+{
+    // 关闭伽马校正时芯片使用上一次的表，不再上传
+    if (!enableGammaCorrection) {
+        return;
+    }
+    
+    const int channels = currentColorMode == ColorMode::Color ? 3 : 1;
+    tableUploader.enqueue(kGammaBufferAddress, GenesysTableUploader::gammaTable(channels, currentScanParams.gamma));
+}
+
+void DScannerGenesysDriverPrivate::uploadShadingData()
+{
+    // performCalibration() 尚未采集白/黑校准行，目前阴影数据总是为空而跳过上传
+    if (!isCalibrated) {
+        return;
+    }
+    
+    tableUploader.enqueue(kShadingBufferAddress,
+                          GenesysTableUploader::shadingTable(whiteCalibrationData, blackCalibrationData));
+}
+
+bool DScannerGenesysDriverPrivate::uploadToBuffer(quint32 address, const QByteArray &data)
+{
+    // 在上传线程中执行；startScanning() 返回前上传已结束，usbComm保持不变
+    DScannerUSB *usb = usbComm;
+    if (!usb) {
+        return false;
+    }
+    
+    // 地址寄存器直接写入：上传线程不访问影子寄存器
+    const quint32 unit = address >> 4;
+    QByteArray addressPairs;
+    addressPairs.append(static_cast<char>(kRegBufferAddressLow));
+    addressPairs.append(static_cast<char>(unit & 0xFF));
+    addressPairs.append(static_cast<char>(kRegBufferAddressHigh));
+    addressPairs.append(static_cast<char>((unit >> 8) & 0xFF));
+    if (usb->controlTransfer(kRequestTypeOut, kRequestBuffer, kValueSetRegister, 0, addressPairs)
+        != addressPairs.size()) {
+        return false;
+    }
+    
+    // 分块发送，块之间其他线程的寄存器写入可以穿插进行
+    for (int offset = 0; offset < data.size(); offset += kUploadChunkSize) {
+        const QByteArray chunk = data.mid(offset, kUploadChunkSize);
+        if (usb->bulkTransferOut(kBulkOutEndpoint, chunk, kUploadTimeoutMs) != chunk.size()) {
+            qCWarning(dscannerGenesys) << "Table upload failed at offset" << offset;
+            return false;
+        }
+    }
+    return true;
+}
+
 // 槽函数实现
 void DScannerGenesysDriverPrivate::onUSBDeviceConnected(const USBDeviceDescriptor &descriptor)
 {
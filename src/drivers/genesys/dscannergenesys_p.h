@@ -6,6 +6,8 @@
 
 #include "Scanner/DScannerGenesys.h"
 #include "Scanner/DScannerUSB.h"
+#include "../vendors/genesys/genesys_register_set.h"
+#include "../vendors/genesys/genesys_table_upload.h"
 
 #include <QObject>
 #include <QMutex>
@@ -67,11 +69,12 @@ public:
     QVariant getDeviceParameter(const QString &name) const;
     QStringList getDeviceParameterNames() const;
 
-    // 寄存器操作
+    // 寄存器操作：写入先进入影子寄存器，由 flushRegisters() 批量提交
     quint8 readRegister(int address);
     bool writeRegister(int address, quint8 value);
     QByteArray readRegisters(int startAddress, int count);
     bool writeRegisters(int startAddress, const QByteArray &values);
+    bool flushRegisters();
 
     // 芯片组特定操作
     bool initializeChipset();
@@ -106,6 +109,12 @@ public:
     void turnOffLamp();
     bool isLampReady();
 
+    // 伽马表与阴影数据上传：提交到 tableUploader，在上传线程中按提交顺序
+    // 分块写入芯片RAM；startScanning() 在提交寄存器前等待上传结束
+    void uploadGammaTables();
+    void uploadShadingData();
+    bool uploadToBuffer(quint32 address, const QByteArray &data);
+
 public:
     DScannerGenesysDriver *q_ptr;
 
@@ -128,10 +137,14 @@ public:
     QHash<QPair<quint16, quint16>, GenesysModel> deviceDatabase;
 
     // 缓存和状态
-    QHash<int, quint8> registerCache;
+    GenesysRegisterSet registers;
     bool registerCacheEnabled;
     mutable QMutex deviceMutex;
 
+    // 表上传（单线程，保证上传按顺序进行）
+    GenesysTableUploader tableUploader;
+    bool enableGammaCorrection;
+
     // 校准数据
     QByteArray whiteCalibrationData;
     QByteArray blackCalibrationData;
@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "genesys_calibration_cache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <cmath>
+
+DSCANNER_USE_NAMESPACE
+
+Q_LOGGING_CATEGORY(dscannerGenesysCalibration, "deepinscan.genesys.calibration")
+
+namespace {
+constexpr int kCacheFormatVersion = 1;
+constexpr qint64 kDefaultMaxAgeSeconds = 24 * 60 * 60;
+constexpr double kDefaultDriftTolerance = 0.03;
+}
+
+QString GenesysCalibrationKey::toString() const
+{
+    return QStringLiteral("%1|%2|%3|%4|%5")
+        .arg(serialNumber, chipset)
+        .arg(resolution)
+        .arg(static_cast<int>(colorMode))
+        .arg(sensor);
+}
+
+GenesysCalibrationCache::GenesysCalibrationCache(const QString &directory)
+    : m_directory(directory.isEmpty() ? defaultDirectory() : directory)
+    , m_maxAgeSeconds(kDefaultMaxAgeSeconds)
+    , m_driftTolerance(kDefaultDriftTolerance)
+{
+}
+
+QString GenesysCalibrationCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + QStringLiteral("/deepinscan/calibration");
+}
+
+QString GenesysCalibrationCache::filePath(const GenesysCalibrationKey &key) const
+{
+    // 序列号等字段可能包含文件名非法字符，使用键的摘要作为文件名
+    const QByteArray digest = QCryptographicHash::hash(key.toString().toUtf8(), QCryptographicHash::Sha1);
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(digest.toHex()) + QStringLiteral(".json");
+}
+
+bool GenesysCalibrationCache::lookup(const GenesysCalibrationKey &key, GenesysCalibrationEntry &entry) const
+{
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+    if (object.value(QStringLiteral("version")).toInt() != kCacheFormatVersion
+        || object.value(QStringLiteral("key")).toString() != key.toString()) {
+        qCDebug(dscannerGenesysCalibration) << "Ignoring stale calibration cache file" << file.fileName();
+        return false;
+    }
+
+    GenesysCalibrationEntry result;
+    auto bytes = [&object](const char *name) {
+        return QByteArray::fromBase64(object.value(QLatin1String(name)).toString().toLatin1());
+    };
+    result.whiteShadingData = bytes("white");
+    result.blackShadingData = bytes("black");
+    result.offsetData = bytes("offset");
+    result.gainData = bytes("gain");
+    result.width = object.value(QStringLiteral("width")).toInt();
+    result.channels = object.value(QStringLiteral("channels")).toInt();
+    result.createdAt = QDateTime::fromString(object.value(QStringLiteral("createdAt")).toString(), Qt::ISODate);
+    result.expiresAt = QDateTime::fromString(object.value(QStringLiteral("expiresAt")).toString(), Qt::ISODate);
+    for (const QJsonValue &value : object.value(QStringLiteral("whiteProfile")).toArray()) {
+        result.whiteProfile.append(static_cast<float>(value.toDouble()));
+    }
+
+    const qint64 shadingBytes = static_cast<qint64>(result.width) * result.channels * 2;
+    if (!result.isValid() || result.whiteShadingData.size() != shadingBytes
+        || result.blackShadingData.size() != shadingBytes) {
+        qCWarning(dscannerGenesysCalibration) << "Corrupt calibration cache file" << file.fileName();
+        return false;
+    }
+
+    if (!result.expiresAt.isValid() || result.expiresAt <= QDateTime::currentDateTimeUtc()) {
+        qCDebug(dscannerGenesysCalibration) << "Calibration cache expired for" << key.toString();
+        return false;
+    }
+
+    entry = result;
+    return true;
+}
+
+bool GenesysCalibrationCache::store(const GenesysCalibrationKey &key, GenesysCalibrationEntry entry)
+{
+    if (!entry.isValid()) {
+        return false;
+    }
+
+    if (!entry.createdAt.isValid()) {
+        entry.createdAt = QDateTime::currentDateTimeUtc();
+    }
+    if (!entry.expiresAt.isValid()) {
+        entry.expiresAt = entry.createdAt.addSecs(m_maxAgeSeconds);
+    }
+    if (entry.whiteProfile.isEmpty()) {
+        entry.whiteProfile = whiteProfile(entry.whiteShadingData, entry.width, entry.channels);
+    }
+
+    QJsonObject object;
+    object[QStringLiteral("version")] = kCacheFormatVersion;
+    object[QStringLiteral("key")] = key.toString();
+    object[QStringLiteral("white")] = QString::fromLatin1(entry.whiteShadingData.toBase64());
+    object[QStringLiteral("black")] = QString::fromLatin1(entry.blackShadingData.toBase64());
+    object[QStringLiteral("offset")] = QString::fromLatin1(entry.offsetData.toBase64());
+    object[QStringLiteral("gain")] = QString::fromLatin1(entry.gainData.toBase64());
+    object[QStringLiteral("width")] = entry.width;
+    object[QStringLiteral("channels")] = entry.channels;
+    object[QStringLiteral("createdAt")] = entry.createdAt.toUTC().toString(Qt::ISODate);
+    object[QStringLiteral("expiresAt")] = entry.expiresAt.toUTC().toString(Qt::ISODate);
+    QJsonArray profile;
+    for (float value : entry.whiteProfile) {
+        profile.append(static_cast<double>(value));
+    }
+    object[QStringLiteral("whiteProfile")] = profile;
+
+    if (!QDir().mkpath(m_directory)) {
+        qCWarning(dscannerGenesysCalibration) << "Cannot create calibration cache directory" << m_directory;
+        return false;
+    }
+
+    // 先写临时文件再替换，中断时不会留下半个条目
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(object).toJson(QJsonDocument::Compact)) < 0
+        || !file.commit()) {
+        qCWarning(dscannerGenesysCalibration) << "Failed to write calibration cache" << file.fileName()
+                                              << file.errorString();
+        return false;
+    }
+
+    qCDebug(dscannerGenesysCalibration) << "Stored calibration for" << key.toString()
+                                        << "expires" << entry.expiresAt;
+    return true;
+}
+
+void GenesysCalibrationCache::remove(const GenesysCalibrationKey &key)
+{
+    QFile::remove(filePath(key));
+}
+
+bool GenesysCalibrationCache::verify(const GenesysCalibrationEntry &entry, const QByteArray &whiteStrip) const
+{
+    if (!entry.isValid() || entry.whiteProfile.isEmpty()) {
+        return false;
+    }
+
+    const QVector<float> current = whiteProfile(whiteStrip, entry.width, entry.channels);
+    if (current.size() != entry.whiteProfile.size()) {
+        qCDebug(dscannerGenesysCalibration) << "White strip does not cover a full line";
+        return false;
+    }
+
+    for (int i = 0; i < current.size(); ++i) {
+        const float reference = entry.whiteProfile[i];
+        if (reference <= 0.0f) {
+            continue;
+        }
+        const double drift = std::abs(current[i] - reference) / reference;
+        if (drift > m_driftTolerance) {
+            qCDebug(dscannerGenesysCalibration) << "Calibration drift" << drift
+                                                << "in segment" << i << "exceeds tolerance";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QVector<float> GenesysCalibrationCache::whiteProfile(const QByteArray &samples, int width, int channels)
+{
+    const qint64 lineSamples = static_cast<qint64>(width) * channels;
+    const qint64 lines = lineSamples > 0 ? samples.size() / (lineSamples * 2) : 0;
+    if (lines == 0) {
+        return QVector<float>();
+    }
+
+    // 按通道分段累加，分段均值对个别坏点和噪声不敏感
+    QVector<double> sums(ProfileSegments * channels, 0.0);
+    QVector<qint64> counts(ProfileSegments * channels, 0);
+    const uchar *data = reinterpret_cast<const uchar *>(samples.constData());
+    for (qint64 line = 0; line < lines; ++line) {
+        const uchar *row = data + line * lineSamples * 2;
+        for (int x = 0; x < width; ++x) {
+            const int segment = static_cast<int>(static_cast<qint64>(x) * ProfileSegments / width);
+            for (int c = 0; c < channels; ++c) {
+                const int bin = c * ProfileSegments + segment;
+                sums[bin] += qFromLittleEndian<quint16>(row + (static_cast<qint64>(x) * channels + c) * 2);
+                ++counts[bin];
+            }
+        }
+    }
+
+    QVector<float> profile(ProfileSegments * channels, 0.0f);
+    for (int i = 0; i < profile.size(); ++i) {
+        if (counts[i] > 0) {
+            profile[i] = static_cast<float>(sums[i] / counts[i]);
+        }
+    }
+    return profile;
+}
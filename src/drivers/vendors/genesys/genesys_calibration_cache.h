@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef GENESYS_CALIBRATION_CACHE_H
+#define GENESYS_CALIBRATION_CACHE_H
+
+#include "Scanner/DScannerTypes.h"
+#include "Scanner/DScannerGlobal.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+DSCANNER_BEGIN_NAMESPACE
+
+/**
+ * @brief 校准缓存键
+ *
+ * 同一台设备在相同分辨率、颜色模式和传感器配置下的校准结果可以复用。
+ */
+struct GenesysCalibrationKey {
+    QString serialNumber;           // USB序列号，缺失时使用设备ID
+    QString chipset;                // 芯片组名称
+    int resolution = 0;             // 扫描分辨率(DPI)
+    ColorMode colorMode = ColorMode::Color;
+    QString sensor;                 // 传感器标识
+
+    QString toString() const;
+};
+
+/**
+ * @brief 缓存的校准结果
+ */
+struct GenesysCalibrationEntry {
+    QByteArray whiteShadingData;    // 白阴影数据（16位小端，每列每通道一个样本）
+    QByteArray blackShadingData;    // 黑阴影数据
+    QByteArray offsetData;          // AFE偏移
+    QByteArray gainData;            // AFE增益
+    int width = 0;                  // 每行像素数
+    int channels = 0;               // 每像素通道数
+    QDateTime createdAt;            // 校准时间
+    QDateTime expiresAt;            // 过期时间，之后必须重新校准
+    QVector<float> whiteProfile;    // 白条分段均值，用于快速漂移检测
+
+    bool isValid() const { return width > 0 && channels > 0 && !whiteShadingData.isEmpty(); }
+};
+
+/**
+ * @brief 持久化的Genesys校准缓存
+ *
+ * 每个键对应 $XDG_CACHE_HOME/deepinscan/calibration 下的一个JSON文件。
+ * 命中且未过期的条目只需扫描几行白条，与缓存的白条分段均值比较：
+ * 漂移在容差内即可直接使用，避免每次会话都完整校准。
+ */
+class DSCANNER_EXPORT GenesysCalibrationCache
+{
+public:
+    static constexpr int ProfileSegments = 16;  // 每通道白条分段数
+
+    explicit GenesysCalibrationCache(const QString &directory = QString());
+
+    static QString defaultDirectory();
+    QString directory() const { return m_directory; }
+
+    // 条目有效期，默认24小时
+    void setMaxAge(qint64 seconds) { m_maxAgeSeconds = seconds; }
+    qint64 maxAge() const { return m_maxAgeSeconds; }
+
+    // 白条相对漂移容差，默认3%
+    void setDriftTolerance(double tolerance) { m_driftTolerance = tolerance; }
+    double driftTolerance() const { return m_driftTolerance; }
+
+    /**
+     * @brief 查找未过期的条目
+     * @return 不存在、已过期或文件损坏时返回false
+     */
+    bool lookup(const GenesysCalibrationKey &key, GenesysCalibrationEntry &entry) const;
+
+    /**
+     * @brief 保存条目
+     *
+     * 未设置的创建/过期时间与白条分段均值按当前时间和白阴影数据补全，
+     * 写入临时文件后原子替换。
+     */
+    bool store(const GenesysCalibrationKey &key, GenesysCalibrationEntry entry);
+
+    void remove(const GenesysCalibrationKey &key);
+
+    /**
+     * @brief 用白条扫描数据检查条目是否仍然有效
+     * @param whiteStrip 若干行白条数据，格式与白阴影数据相同
+     * @return 各分段相对漂移都在容差内时返回true
+     */
+    bool verify(const GenesysCalibrationEntry &entry, const QByteArray &whiteStrip) const;
+
+    /**
+     * @brief 计算白条分段均值
+     * @param samples 16位小端交错样本，可包含多行
+     * @return 按通道排列的 ProfileSegments·channels 个均值，数据不足一行时为空
+     */
+    static QVector<float> whiteProfile(const QByteArray &samples, int width, int channels);
+
+private:
+    QString filePath(const GenesysCalibrationKey &key) const;
+
+    QString m_directory;
+    qint64 m_maxAgeSeconds;
+    double m_driftTolerance;
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // GENESYS_CALIBRATION_CACHE_H
@@ -64,6 +64,9 @@ namespace GenesysCommands {
     constexpr uint8_t CMD_READ_REG         = 0x09;  // 读取寄存器
 }
 
+// 单次批量传输最多携带的寄存器写入数（每个写入4字节）
+constexpr int kMaxRegistersPerTransfer = 128;
+
 // GenesysDriverComplete实现
 GenesysDriverComplete::GenesysDriverComplete(QObject *parent)
     : QObject(parent)
@@ -74,11 +77,22 @@ GenesysDriverComplete::GenesysDriverComplete(QObject *parent)
     , m_isScanning(false)
     , m_calibrationData()
     , m_currentSettings()
+    , m_calibrationVerified(false)
+    , m_shadingSample(0)
+    , m_shadingCarry()
     , m_scanBuffer()
     , m_statusTimer(new QTimer(this))
 {
     qCDebug(dscannerGenesysComplete) << "GenesysDriverComplete created";
     
+    // 状态寄存器由芯片更新，读取不能使用影子副本
+    m_registers.markVolatile(GenesysRegisters::REG_STATUS);
+    // 控制类寄存器的写入是启停、开关灯等命令，不能合并或丢弃
+    m_registers.markVolatile(GenesysRegisters::REG_CONTROL);
+    m_registers.markVolatile(GenesysRegisters::REG_SCAN_CONTROL);
+    m_registers.markVolatile(GenesysRegisters::REG_MOTOR_CONTROL);
+    m_registers.markVolatile(GenesysRegisters::REG_LAMP_CONTROL);
+    
     // 设置状态监控定时器
     m_statusTimer->setInterval(1000); // 1秒检查一次
     connect(m_statusTimer, &QTimer::timeout, this, &GenesysDriverComplete::checkDeviceStatus);
@@ -174,6 +188,7 @@ void GenesysDriverComplete::cleanup()
     m_isInitialized = false;
     m_deviceHandle = nullptr;
     m_usbDevice = nullptr;
+    m_registers.invalidate();
     
     qCDebug(dscannerGenesysComplete) << "Genesys driver cleanup completed";
 }
@@ -232,6 +247,12 @@ bool GenesysDriverComplete::startScan(const ScanParameters &params)
     
     m_currentScanParams = params;
     
+    // 校正系数随颜色模式变化，每次扫描按当前参数重新计算
+    m_shadingCorrector.clear();
+    m_shadingSample = 0;
+    m_shadingCarry.clear();
+    m_calibrationVerified = false;
+    
     // 准备扫描
     if (!prepareScan()) {
         qCWarning(dscannerGenesysComplete) << "Failed to prepare scan";
@@ -253,8 +274,8 @@ bool GenesysDriverComplete::startScan(const ScanParameters &params)
     // 等待灯管预热
     waitForLampWarmup();
     
-    // 执行预扫描校准（如果需要）
-    if (m_currentSettings.autoCalibration) {
+    // 执行预扫描校准（如果需要），缓存的校准已在预热期间确认时跳过
+    if (m_currentSettings.autoCalibration && !m_calibrationVerified) {
         performPreScanCalibration();
     }
     
@@ -393,20 +414,27 @@ bool GenesysDriverComplete::initializeChipset()
         return false;
     }
     
-    // 芯片组特定的初始化
+    // 芯片组特定的初始化，寄存器写入在最后一次提交
+    bool initialized = false;
     switch (m_chipsetType) {
     case GenesysChipsetType::GL646:
-        return initializeGL646();
+        initialized = initializeGL646();
+        break;
     case GenesysChipsetType::GL843:
-        return initializeGL843();
+        initialized = initializeGL843();
+        break;
     case GenesysChipsetType::GL846:
-        return initializeGL846();
+        initialized = initializeGL846();
+        break;
     case GenesysChipsetType::GL847:
-        return initializeGL847();
+        initialized = initializeGL847();
+        break;
     default:
         qCWarning(dscannerGenesysComplete) << "Unsupported chipset type";
         return false;
     }
+    
+    return initialized && flushRegisters();
 }
 
 bool GenesysDriverComplete::initializeGL646()
@@ -472,6 +500,18 @@ bool GenesysDriverComplete::readRegister(uint8_t reg, uint8_t &value)
         return false;
     }
     
+    // 已知且非易失的寄存器直接使用影子副本
+    quint16 cached = 0;
+    if (m_registers.isCached(reg) && m_registers.value(reg, cached)) {
+        value = static_cast<uint8_t>(cached);
+        return true;
+    }
+    
+    // 读取结果可能依赖尚未提交的写入
+    if (!flushRegisters()) {
+        return false;
+    }
+    
     // 构造读取寄存器命令
     QByteArray command;
     command.append(GenesysCommands::CMD_READ_REG);
@@ -493,6 +533,7 @@ bool GenesysDriverComplete::readRegister(uint8_t reg, uint8_t &value)
     uint8_t response = static_cast<uint8_t>(responseData.at(0));
     
     value = response;
+    m_registers.recordRead(reg, value);
     qCDebug(dscannerGenesysComplete) << "Read register" << QString::number(reg, 16) 
                                      << "value:" << QString::number(value, 16);
     return true;
@@ -504,22 +545,45 @@ bool GenesysDriverComplete::writeRegister(uint8_t reg, uint16_t value)
         return false;
     }
     
-    // 构造写入寄存器命令
-    QByteArray command;
-    command.append(GenesysCommands::CMD_WRITE_REG);
-    command.append(reg);
-    command.append(static_cast<uint8_t>(value & 0xFF));        // 低字节
-    command.append(static_cast<uint8_t>((value >> 8) & 0xFF)); // 高字节
+    m_registers.set(reg, value);
     
-    // 发送命令
-    int bytesWritten = m_usbDevice->bulkTransferOut(0x01, command);
-    if (bytesWritten < 0) {
-        qCWarning(dscannerGenesysComplete) << "Failed to send write register command";
+    // 易失寄存器立即提交（连同之前的脏写入，保持顺序），错误返回给调用方
+    if (m_registers.isVolatile(reg)) {
+        return flushRegisters();
+    }
+    return true;
+}
+
+bool GenesysDriverComplete::flushRegisters()
+{
+    if (!m_registers.isDirty()) {
+        return true;
+    }
+    if (!m_usbDevice) {
         return false;
     }
     
-    qCDebug(dscannerGenesysComplete) << "Wrote register" << QString::number(reg, 16) 
-                                     << "value:" << QString::number(value, 16);
+    const int count = m_registers.dirtyCount();
+    const bool flushed = m_registers.flush(kMaxRegistersPerTransfer,
+                                           [this](const QVector<GenesysRegisterSet::Write> &writes) {
+        // 多个写寄存器命令首尾相接，在一次批量传输中发送
+        QByteArray packet;
+        packet.reserve(writes.size() * 4);
+        for (const GenesysRegisterSet::Write &write : writes) {
+            packet.append(static_cast<char>(GenesysCommands::CMD_WRITE_REG));
+            packet.append(static_cast<char>(write.address));
+            packet.append(static_cast<char>(write.value & 0xFF));        // 低字节
+            packet.append(static_cast<char>((write.value >> 8) & 0xFF)); // 高字节
+        }
+        return m_usbDevice->bulkTransferOut(0x01, packet) == packet.size();
+    });
+    
+    if (!flushed) {
+        qCWarning(dscannerGenesysComplete) << "Failed to write" << m_registers.dirtyCount() << "registers";
+        return false;
+    }
+    
+    qCDebug(dscannerGenesysComplete) << "Flushed" << count << "registers";
     return true;
 }
 
@@ -529,6 +593,11 @@ bool GenesysDriverComplete::sendCommand(uint8_t command)
         return false;
     }
     
+    // 命令按当前寄存器配置执行，发送前先提交
+    if (!flushRegisters()) {
+        return false;
+    }
+    
     QByteArray cmdData;
     cmdData.append(command);
     
@@ -564,6 +633,179 @@ bool GenesysDriverComplete::waitForReady(int timeoutMs)
     return false;
 }
 
+bool GenesysDriverComplete::applyShadingCorrection(QByteArray &data)
+{
+    if (!m_currentSettings.enableShading || !m_calibrationData.isValid || data.isEmpty()) {
+        return false;
+    }
+    
+    const int sampleBytes = m_currentSettings.colorDepth > 8 ? 2 : 1;
+    if (!m_shadingCorrector.isValid()) {
+        // 阴影数据为每列每通道一个16位小端样本
+        const int channels = m_currentScanParams.colorMode == ColorMode::Color ? 3 : 1;
+        const int width = m_calibrationData.whiteShadingData.size() / (2 * channels);
+        if (!m_shadingCorrector.setReference(m_calibrationData.blackShadingData,
+                                             m_calibrationData.whiteShadingData, width, channels)) {
+            qCWarning(dscannerGenesysComplete) << "Shading data does not match scan parameters";
+            return false;
+        }
+    }
+    
+    // 16位样本可能跨越数据块：上一块留下的字节补到本块开头，本块末尾的奇数字节留给下一块，
+    // 保证每块都从样本边界开始，m_shadingSample 与数据对齐
+    if (sampleBytes == 2) {
+        data.prepend(m_shadingCarry);
+        m_shadingCarry.clear();
+        if (data.size() % 2 != 0) {
+            m_shadingCarry = data.right(1);
+            data.chop(1);
+        }
+    }
+    
+    // 读取的数据块不一定按行对齐，按累计样本数定位起始列后原地校正
+    const qint64 count = data.size() / sampleBytes;
+    if (sampleBytes == 2) {
+        quint16 *samples = reinterpret_cast<quint16 *>(data.data());
+        m_shadingCorrector.apply16(samples, samples, m_shadingSample, count);
+    } else {
+        quint8 *samples = reinterpret_cast<quint8 *>(data.data());
+        m_shadingCorrector.apply8(samples, samples, m_shadingSample, count);
+    }
+    m_shadingSample += count;
+    
+    return true;
+}
+
+bool GenesysDriverComplete::calibrateDevice()
+{
+    QMutexLocker locker(&m_deviceMutex);
+    
+    if (!m_isInitialized) {
+        qCWarning(dscannerGenesysComplete) << "Device not initialized";
+        return false;
+    }
+    
+    return performFullCalibration();
+}
+
+bool GenesysDriverComplete::performFullCalibration()
+{
+    qCInfo(dscannerGenesysComplete) << "Performing full calibration";
+    
+    if (!performBlackCalibration() || !performWhiteCalibration()) {
+        qCWarning(dscannerGenesysComplete) << "Calibration failed";
+        return false;
+    }
+    m_calibrationData.isValid = true;
+    m_shadingCorrector.clear();
+    
+    GenesysCalibrationEntry entry;
+    entry.whiteShadingData = m_calibrationData.whiteShadingData;
+    entry.blackShadingData = m_calibrationData.blackShadingData;
+    entry.offsetData = m_calibrationData.offsetData;
+    entry.gainData = m_calibrationData.gainData;
+    entry.channels = m_currentScanParams.colorMode == ColorMode::Color ? 3 : 1;
+    entry.width = entry.whiteShadingData.size() / (2 * entry.channels);
+    if (!m_calibrationCache.store(calibrationKey(), entry)) {
+        qCWarning(dscannerGenesysComplete) << "Calibration result not cached";
+    }
+    
+    emit calibrationCompleted();
+    return true;
+}
+
+bool GenesysDriverComplete::loadCalibrationData()
+{
+    GenesysCalibrationEntry entry;
+    if (!m_calibrationCache.lookup(calibrationKey(), entry)) {
+        return false;
+    }
+    
+    // 加载的数据在扫描前仍会用白条确认
+    applyCalibrationEntry(entry);
+    qCDebug(dscannerGenesysComplete) << "Loaded cached calibration from" << entry.createdAt;
+    return true;
+}
+
+void GenesysDriverComplete::createDefaultCalibration()
+{
+    // 无效的校准数据：跳过阴影校正，直到完成一次校准
+    m_calibrationData = GenesysCalibrationData();
+    m_shadingCorrector.clear();
+}
+
+bool GenesysDriverComplete::performPreScanCalibration()
+{
+    GenesysCalibrationEntry entry;
+    if (m_calibrationCache.lookup(calibrationKey(), entry)) {
+        if (m_calibrationCache.verify(entry, scanWhiteStrip(entry))) {
+            qCInfo(dscannerGenesysComplete) << "Using cached calibration from" << entry.createdAt;
+            applyCalibrationEntry(entry);
+            m_calibrationVerified = true;
+            return true;
+        }
+        qCInfo(dscannerGenesysComplete) << "Calibration drift detected, recalibrating";
+    }
+    
+    return performFullCalibration();
+}
+
+void GenesysDriverComplete::waitForLampWarmup()
+{
+    // 有缓存的校准时，白条回到校准时的水平即说明灯管已稳定，不必等满预热时间
+    GenesysCalibrationEntry entry;
+    const bool cached = m_currentSettings.autoCalibration
+        && m_calibrationCache.lookup(calibrationKey(), entry);
+    
+    if (!cached) {
+        QThread::msleep(m_currentSettings.lampWarmupTime);
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < m_currentSettings.lampWarmupTime) {
+        if (m_calibrationCache.verify(entry, scanWhiteStrip(entry))) {
+            qCInfo(dscannerGenesysComplete) << "Lamp matched cached calibration after" << timer.elapsed() << "ms";
+            applyCalibrationEntry(entry);
+            m_calibrationVerified = true;
+            return;
+        }
+        QThread::msleep(250);
+    }
+}
+
+GenesysCalibrationKey GenesysDriverComplete::calibrationKey() const
+{
+    GenesysCalibrationKey key;
+    key.serialNumber = m_deviceInfo.serialNumber.isEmpty() ? m_deviceInfo.deviceId : m_deviceInfo.serialNumber;
+    key.chipset = QString::number(static_cast<int>(m_chipsetType));
+    key.resolution = m_currentScanParams.resolution;
+    key.colorMode = m_currentScanParams.colorMode;
+    key.sensor = m_deviceInfo.model;
+    return key;
+}
+
+void GenesysDriverComplete::applyCalibrationEntry(const GenesysCalibrationEntry &entry)
+{
+    m_calibrationData.whiteShadingData = entry.whiteShadingData;
+    m_calibrationData.blackShadingData = entry.blackShadingData;
+    m_calibrationData.offsetData = entry.offsetData;
+    m_calibrationData.gainData = entry.gainData;
+    m_calibrationData.isValid = true;
+    m_shadingCorrector.clear();
+}
+
+QByteArray GenesysDriverComplete::scanWhiteStrip(const GenesysCalibrationEntry &entry)
+{
+    // 扫描头停放位置正对校准白条，读取几行即可判断漂移
+    constexpr int WhiteStripLines = 4;
+    if (!sendCommand(GenesysCommands::CMD_CALIBRATE)) {
+        return QByteArray();
+    }
+    return readRawScanData(entry.width * entry.channels * 2 * WhiteStripLines);
+}
+
 void GenesysDriverComplete::initializeDefaultSettings()
 {
     m_currentSettings.autoCalibration = true;
@@ -6,6 +6,9 @@
 
 #include "Scanner/DScannerTypes.h"
 #include "Scanner/DScannerGlobal.h"
+#include "genesys_calibration_cache.h"
+#include "genesys_register_set.h"
+#include "../../../processing/shading_corrector.h"
 
 #include <QObject>
 #include <QMutex>
@@ -120,9 +123,10 @@ private:
     bool initializeGL846();
     bool initializeGL847();
     
-    // 寄存器操作
+    // 寄存器操作：写入先进入影子寄存器，发送命令或读取设备前统一提交
     bool readRegister(uint8_t reg, uint8_t &value);
     bool writeRegister(uint8_t reg, uint16_t value);
+    bool flushRegisters();
     bool sendCommand(uint8_t command);
     bool waitForReady(int timeoutMs = 3000);
     
@@ -153,6 +157,10 @@ private:
     bool performWhiteCalibration();
     bool performBlackCalibration();
     bool applyShadingCorrection(QByteArray &data);
+    bool performFullCalibration();
+    GenesysCalibrationKey calibrationKey() const;
+    void applyCalibrationEntry(const GenesysCalibrationEntry &entry);
+    QByteArray scanWhiteStrip(const GenesysCalibrationEntry &entry);
     
     // 芯片组特定功能
     bool detectGL846Features();
@@ -184,6 +192,7 @@ private:
     bool m_isScanning;
     mutable QMutex m_deviceMutex;
     QTimer *m_statusTimer;
+    GenesysRegisterSet m_registers;
     
     // 扫描状态
     ScanParameters m_currentScanParams;
@@ -194,6 +203,11 @@ private:
     // 校准和设置
     GenesysCalibrationData m_calibrationData;
     GenesysDriverSettings m_currentSettings;
+    GenesysCalibrationCache m_calibrationCache;
+    bool m_calibrationVerified;             // 本次扫描已用白条确认缓存的校准
+    ShadingCorrector m_shadingCorrector;    // 由校准数据预先计算的每列系数
+    qint64 m_shadingSample;                 // 本次扫描已校正的样本数，用于定位列
+    QByteArray m_shadingCarry;              // 16位数据块末尾不足一个样本的字节，拼到下一块开头
     
     // 数据缓冲
     QByteArray m_scanBuffer;
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "genesys_register_set.h"
+
+DSCANNER_USE_NAMESPACE
+
+void GenesysRegisterSet::set(quint16 address, quint16 value)
+{
+    Slot &slot = m_slots[address];
+    slot.value = value;
+
+    // 与芯片上的值相同的写入无需提交；之前的脏写入随之撤销
+    const bool redundant = !slot.isVolatile && slot.deviceKnown && slot.deviceValue == value;
+    if (redundant) {
+        if (slot.dirty) {
+            slot.dirty = false;
+            m_dirtyOrder.removeOne(address);
+        }
+        return;
+    }
+
+    if (!slot.dirty) {
+        slot.dirty = true;
+        m_dirtyOrder.append(address);
+    }
+}
+
+bool GenesysRegisterSet::value(quint16 address, quint16 &value) const
+{
+    auto it = m_slots.constFind(address);
+    if (it == m_slots.constEnd() || (!it->dirty && !it->deviceKnown)) {
+        return false;
+    }
+    value = it->value;
+    return true;
+}
+
+bool GenesysRegisterSet::isCached(quint16 address) const
+{
+    auto it = m_slots.constFind(address);
+    return it != m_slots.constEnd() && !it->isVolatile && (it->dirty || it->deviceKnown);
+}
+
+void GenesysRegisterSet::markVolatile(quint16 address)
+{
+    m_slots[address].isVolatile = true;
+}
+
+bool GenesysRegisterSet::isVolatile(quint16 address) const
+{
+    auto it = m_slots.constFind(address);
+    return it != m_slots.constEnd() && it->isVolatile;
+}
+
+void GenesysRegisterSet::recordRead(quint16 address, quint16 value)
+{
+    Slot &slot = m_slots[address];
+    slot.deviceValue = value;
+    slot.deviceKnown = true;
+    if (!slot.dirty) {
+        slot.value = value;
+    }
+}
+
+bool GenesysRegisterSet::flush(int maxPerTransfer, const Transfer &transfer)
+{
+    maxPerTransfer = qMax(1, maxPerTransfer);
+
+    while (!m_dirtyOrder.isEmpty()) {
+        const int count = qMin(maxPerTransfer, m_dirtyOrder.size());
+        QVector<Write> batch;
+        batch.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            const quint16 address = m_dirtyOrder[i];
+            batch.append({address, m_slots[address].value});
+        }
+
+        if (!transfer(batch)) {
+            return false;
+        }
+
+        for (const Write &write : batch) {
+            Slot &slot = m_slots[write.address];
+            slot.deviceValue = write.value;
+            slot.deviceKnown = true;
+            slot.dirty = false;
+        }
+        m_dirtyOrder.remove(0, count);
+    }
+
+    return true;
+}
+
+void GenesysRegisterSet::invalidate()
+{
+    // 保留易失标记，其余状态全部丢弃
+    for (auto it = m_slots.begin(); it != m_slots.end();) {
+        if (it->isVolatile) {
+            *it = Slot();
+            it->isVolatile = true;
+            ++it;
+        } else {
+            it = m_slots.erase(it);
+        }
+    }
+    m_dirtyOrder.clear();
+}
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef GENESYS_REGISTER_SET_H
+#define GENESYS_REGISTER_SET_H
+
+#include "Scanner/DScannerGlobal.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <functional>
+
+DSCANNER_BEGIN_NAMESPACE
+
+/**
+ * @brief Genesys芯片寄存器文件的主机端影子副本
+ *
+ * 写入只更新影子副本并标记为脏，flush() 时将所有脏寄存器打包为少数几次
+ * 传输提交，芯片初始化不再需要每个寄存器一次USB往返。与芯片上已知值相同的
+ * 写入直接丢弃；读取已知且非易失的寄存器时无需访问设备。
+ */
+class DSCANNER_EXPORT GenesysRegisterSet
+{
+public:
+    struct Write {
+        quint16 address;
+        quint16 value;
+    };
+
+    // 发送一批寄存器写入，成功返回true
+    typedef std::function<bool(const QVector<Write> &writes)> Transfer;
+
+    /**
+     * @brief 设置寄存器值（延迟到 flush() 提交）
+     */
+    void set(quint16 address, quint16 value);
+
+    /**
+     * @brief 影子副本中的值，包括尚未提交的写入
+     * @return 寄存器从未写入或读取过时返回false
+     */
+    bool value(quint16 address, quint16 &value) const;
+
+    /**
+     * @brief 读取是否可以直接使用影子副本
+     *
+     * 寄存器值已知且不是易失寄存器时返回true。
+     */
+    bool isCached(quint16 address) const;
+
+    /**
+     * @brief 标记由芯片自身改变的寄存器（状态、触发等）
+     *
+     * 易失寄存器的读取总是访问设备，写入总是提交。命令、触发类寄存器的
+     * 连续写入是有意义的脉冲序列，调用方应在每次写入后立即 flush()。
+     */
+    void markVolatile(quint16 address);
+    bool isVolatile(quint16 address) const;
+
+    /**
+     * @brief 记录从设备读取的值，不标记为脏
+     */
+    void recordRead(quint16 address, quint16 value);
+
+    bool isDirty() const { return !m_dirtyOrder.isEmpty(); }
+    int dirtyCount() const { return m_dirtyOrder.size(); }
+
+    /**
+     * @brief 按首次修改的顺序提交所有脏寄存器
+     * @param maxPerTransfer 每次传输的最大寄存器数
+     * @return 某次传输失败时返回false，该批及之后的寄存器保持为脏
+     */
+    bool flush(int maxPerTransfer, const Transfer &transfer);
+
+    /**
+     * @brief 丢弃全部影子状态（设备复位或断开后）
+     */
+    void invalidate();
+
+private:
+    struct Slot {
+        quint16 value = 0;          // 影子值
+        quint16 deviceValue = 0;    // 芯片上的已知值
+        bool deviceKnown = false;
+        bool dirty = false;
+        bool isVolatile = false;
+    };
+
+    QHash<quint16, Slot> m_slots;
+    QVector<quint16> m_dirtyOrder;  // 寄存器写入顺序对部分芯片有意义
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // GENESYS_REGISTER_SET_H
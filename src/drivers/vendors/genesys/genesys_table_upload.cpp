@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "genesys_table_upload.h"
+
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <cmath>
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+constexpr int kGammaEntries = 256;
+constexpr int kShadingUnityGain = 0x4000;
+}
+
+GenesysTableUploader::GenesysTableUploader(const Transfer &transfer)
+    : m_transfer(transfer)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+GenesysTableUploader::~GenesysTableUploader()
+{
+    // 在途的上传仍在使用传输回调捕获的设备
+    waitForFinished();
+}
+
+void GenesysTableUploader::enqueue(quint32 address, const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    const Transfer transfer = m_transfer;
+    m_pending.append(QtConcurrent::run(&m_pool, [transfer, address, data]() {
+        return transfer(address, data);
+    }));
+}
+
+bool GenesysTableUploader::waitForFinished()
+{
+    m_uploadFailed = false;
+    for (QFuture<bool> &upload : m_pending) {
+        upload.waitForFinished();
+        if (!upload.result()) {
+            m_uploadFailed = true;
+        }
+    }
+    m_pending.clear();
+    return !m_uploadFailed;
+}
+
+bool GenesysTableUploader::startAfterUploads(const std::function<bool()> &prepare,
+                                             const std::function<bool()> &commit)
+{
+    const bool prepared = prepare();
+    const bool uploaded = waitForFinished();
+    return prepared && uploaded && commit();
+}
+
+QByteArray GenesysTableUploader::gammaTable(int channels, double gamma)
+{
+    if (gamma <= 0.0) {
+        gamma = 1.0;
+    }
+
+    QByteArray table(channels * kGammaEntries * 2, Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(table.data());
+    for (int i = 0; i < kGammaEntries; ++i) {
+        const quint16 value = static_cast<quint16>(std::lround(65535.0 * std::pow(i / 255.0, 1.0 / gamma)));
+        for (int c = 0; c < channels; ++c) {
+            qToLittleEndian<quint16>(value, out + (c * kGammaEntries + i) * 2);
+        }
+    }
+    return table;
+}
+
+QByteArray GenesysTableUploader::shadingTable(const QByteArray &white, const QByteArray &black)
+{
+    if (white.isEmpty() || white.size() != black.size()) {
+        return QByteArray();
+    }
+
+    const int samples = white.size() / 2;
+    const uchar *bright = reinterpret_cast<const uchar *>(white.constData());
+    const uchar *darkLine = reinterpret_cast<const uchar *>(black.constData());
+    QByteArray data(samples * 4, Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(data.data());
+    for (int i = 0; i < samples; ++i) {
+        const quint16 dark = qFromLittleEndian<quint16>(darkLine + i * 2);
+        const quint16 level = qFromLittleEndian<quint16>(bright + i * 2);
+        const qint64 gain = level > dark ? qint64(kShadingUnityGain) * 65535 / (level - dark) : kShadingUnityGain;
+        qToLittleEndian<quint16>(dark, out + i * 4);
+        qToLittleEndian<quint16>(static_cast<quint16>(qMin<qint64>(gain, 65535)), out + i * 4 + 2);
+    }
+    return data;
+}
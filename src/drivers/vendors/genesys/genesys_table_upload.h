@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef GENESYS_TABLE_UPLOAD_H
+#define GENESYS_TABLE_UPLOAD_H
+
+#include "Scanner/DScannerGlobal.h"
+
+#include <QByteArray>
+#include <QFuture>
+#include <QList>
+#include <QThreadPool>
+
+#include <functional>
+
+DSCANNER_BEGIN_NAMESPACE
+
+/**
+ * @brief Genesys伽马表与阴影数据的后台上传
+ *
+ * 表在单独的上传线程中按提交顺序写入芯片RAM，与马达初始化、灯管预热
+ * 并行进行。startAfterUploads() 保证所有上传结束后才提交寄存器并启动扫描。
+ */
+class DSCANNER_EXPORT GenesysTableUploader
+{
+public:
+    // 将一张表写入芯片RAM的指定地址，在上传线程中调用，成功返回true
+    typedef std::function<bool(quint32 address, const QByteArray &data)> Transfer;
+
+    explicit GenesysTableUploader(const Transfer &transfer);
+    ~GenesysTableUploader();
+
+    /**
+     * @brief 在上传线程中上传一张表，空表直接跳过
+     */
+    void enqueue(quint32 address, const QByteArray &data);
+
+    /**
+     * @brief 等待所有已提交的上传结束
+     * @return 全部上传成功时返回true
+     */
+    bool waitForFinished();
+
+    /**
+     * @brief 扫描启动顺序
+     *
+     * 在调用线程中执行 prepare，同时上传已提交的表；无论 prepare 是否成功
+     * 都等待上传结束，之后才执行 commit。prepare 或任一上传失败时不执行commit。
+     */
+    bool startAfterUploads(const std::function<bool()> &prepare, const std::function<bool()> &commit);
+
+    /**
+     * @brief 最近一次等待中是否有上传失败
+     */
+    bool uploadFailed() const { return m_uploadFailed; }
+
+    /**
+     * @brief 每通道256个16位小端项的伽马表
+     */
+    static QByteArray gammaTable(int channels, double gamma);
+
+    /**
+     * @brief 由白/黑校准行（16位小端样本）生成阴影数据
+     *
+     * 每个样本4字节：16位暗电平与16位增益系数（0x4000为1.0）。
+     * 两行为空或长度不一致时返回空数组。
+     */
+    static QByteArray shadingTable(const QByteArray &white, const QByteArray &black);
+
+private:
+    Transfer m_transfer;
+    QThreadPool m_pool;             // 单线程，保证上传按顺序进行
+    QList<QFuture<bool>> m_pending;
+    bool m_uploadFailed = false;
+
+    Q_DISABLE_COPY(GenesysTableUploader)
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // GENESYS_TABLE_UPLOAD_H
@@ -9,6 +9,7 @@
  * - ImagePipelineStack → AdvancedImageProcessor
  * - ImagePipelineNodeFormatConvert → FormatConvertNode  
  * - ImagePipelineNodePixelShiftColumns → PixelShiftNode
+ * - ImagePipelineNodeCalibrate → ShadingCorrectionNode
  * - 模板化像素操作和高性能处理算法
  */
 
@@ -20,14 +21,18 @@
 #include <QImage>
 #include <QPainter>
 #include <QTransform>
-#include <QtConcurrent>
+#include <QtConcurrent/QtConcurrent>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QThreadPool>
+#include <QtEndian>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
 #include <memory>
+#include <limits>
 #include "simd_image_algorithms.h"
+#include "multithreaded_processor.h"
 
 DSCANNER_BEGIN_NAMESPACE
 
@@ -37,6 +42,43 @@ Q_LOGGING_CATEGORY(advancedImageProcessor, "deepinscan.advancedimageprocessor")
 // ImageBuffer 实现
 // =============================================================================
 
+namespace {
+
+// 平面行跨度按缓存行对齐，每行起点都可做对齐向量访问
+const int kPlaneAlignment = 64;
+
+int alignedStride(int bytes)
+{
+    return (bytes + kPlaneAlignment - 1) / kPlaneAlignment * kPlaneAlignment;
+}
+
+// 交错与平面之间的通道拆分/合并，Sample 为 quint8 或 quint16
+template<typename Sample>
+void deinterleaveRow(const quint8 *src, quint8 *const *planes, int width, int channels)
+{
+    const Sample *in = reinterpret_cast<const Sample *>(src);
+    for (int c = 0; c < channels; ++c) {
+        Sample *out = reinterpret_cast<Sample *>(planes[c]);
+        for (int x = 0; x < width; ++x) {
+            out[x] = in[x * channels + c];
+        }
+    }
+}
+
+template<typename Sample>
+void interleaveRow(const quint8 *const *planes, quint8 *dst, int width, int channels)
+{
+    Sample *out = reinterpret_cast<Sample *>(dst);
+    for (int c = 0; c < channels; ++c) {
+        const Sample *in = reinterpret_cast<const Sample *>(planes[c]);
+        for (int x = 0; x < width; ++x) {
+            out[x * channels + c] = in[x];
+        }
+    }
+}
+
+} // namespace
+
 ImageBuffer::ImageBuffer()
     : m_width(0), m_height(0), m_format(PixelFormat::Unknown)
 {
@@ -45,35 +87,104 @@ ImageBuffer::ImageBuffer()
 ImageBuffer::ImageBuffer(int width, int height, PixelFormat format)
     : m_width(width), m_height(height), m_format(format)
 {
+    m_stride = m_width * bytesPerPixel();
     allocateData();
 }
 
-ImageBuffer::ImageBuffer(const ImageBuffer &other)
-    : m_width(other.m_width), m_height(other.m_height), m_format(other.m_format)
+ImageBuffer::ImageBuffer(int width, int height, PixelFormat format, Layout layout)
+    : m_width(width), m_height(height), m_format(format), m_layout(layout)
 {
-    qCDebug(advancedImageProcessor) << "ImageBuffer拷贝构造:" << m_width << "x" << m_height;
+    if (m_layout == Layout::Planar && channelCount() == 0) {
+        qCWarning(advancedImageProcessor) << "Pixel format" << static_cast<int>(format)
+                                          << "has no planar layout, using interleaved";
+        m_layout = Layout::Interleaved;
+    }
     
-    if (other.m_data && other.totalBytes() > 0) {
-        allocateData();
-        std::memcpy(m_data.get(), other.m_data.get(), totalBytes());
+    if (m_layout == Layout::Planar) {
+        m_stride = alignedStride(m_width * bytesPerSample());
+        m_planeSize = static_cast<qint64>(m_stride) * m_height;
+    } else {
+        m_stride = m_width * bytesPerPixel();
     }
+    allocateData();
 }
+
+ImageBuffer::ImageBuffer(const ImageBuffer &other)
     : m_width(other.m_width), m_height(other.m_height), m_format(other.m_format)
+    , m_layout(other.m_layout)
 {
     copyData(other);
 }
 
+ImageBuffer::ImageBuffer(ImageBuffer &&other) noexcept
+    : m_width(other.m_width), m_height(other.m_height), m_format(other.m_format)
+    , m_layout(other.m_layout), m_stride(other.m_stride), m_planeSize(other.m_planeSize)
+    , m_data(std::move(other.m_data)), m_ownsData(other.m_ownsData)
+{
+    other.m_width = 0;
+    other.m_height = 0;
+    other.m_format = PixelFormat::Unknown;
+    other.m_layout = Layout::Interleaved;
+    other.m_stride = 0;
+    other.m_planeSize = 0;
+}
+
 ImageBuffer &ImageBuffer::operator=(const ImageBuffer &other)
 {
     if (this != &other) {
         m_width = other.m_width;
         m_height = other.m_height;
         m_format = other.m_format;
+        m_layout = other.m_layout;
+        m_data.reset();
+        m_ownsData = false;
         copyData(other);
     }
     return *this;
 }
 
+ImageBuffer &ImageBuffer::operator=(ImageBuffer &&other) noexcept
+{
+    if (this != &other) {
+        m_width = other.m_width;
+        m_height = other.m_height;
+        m_format = other.m_format;
+        m_layout = other.m_layout;
+        m_stride = other.m_stride;
+        m_planeSize = other.m_planeSize;
+        m_data = std::move(other.m_data);
+        m_ownsData = other.m_ownsData;
+        other.m_width = 0;
+        other.m_height = 0;
+        other.m_format = PixelFormat::Unknown;
+        other.m_layout = Layout::Interleaved;
+        other.m_stride = 0;
+        other.m_planeSize = 0;
+    }
+    return *this;
+}
+
+ImageBuffer ImageBuffer::wrap(quint8 *data, int width, int height, PixelFormat format,
+                              std::shared_ptr<void> owner)
+{
+    ImageBuffer buffer;
+    if (!data || width <= 0 || height <= 0) {
+        return buffer;
+    }
+    
+    buffer.m_width = width;
+    buffer.m_height = height;
+    buffer.m_format = format;
+    buffer.m_stride = width * buffer.bytesPerPixel();
+    if (owner) {
+        // 别名构造：引用计数跟随owner，指针指向像素数据
+        buffer.m_data = std::shared_ptr<quint8>(std::move(owner), data);
+    } else {
+        buffer.m_data = std::shared_ptr<quint8>(data, [](quint8 *) {});
+    }
+    return buffer;
+}
+
 ImageBuffer::~ImageBuffer()
 {
     // 智能指针自动管理内存
@@ -93,50 +204,135 @@ int ImageBuffer::bytesPerPixel() const
         case PixelFormat::Raw12Bit: return 6;   // 12位RGB(打包为16位)
         case PixelFormat::YUV422: return 2;     // YUV 4:2:2
         case PixelFormat::LAB: return 3;        // CIE LAB
+        case PixelFormat::Gray16: return 2;     // 16位单通道
         default: return 0;
     }
 }
 
+int ImageBuffer::channelCount() const
+{
+    switch (m_format) {
+        case PixelFormat::Format1:
+        case PixelFormat::Gray16:
+            return 1;
+        case PixelFormat::Format3:
+        case PixelFormat::Format5:
+        case PixelFormat::Raw16Bit:
+        case PixelFormat::Raw12Bit:
+        case PixelFormat::LAB:
+            return 3;
+        case PixelFormat::Format4:
+        case PixelFormat::Format6:
+        case PixelFormat::Format8:
+            return 4;
+        default:
+            return 0;   // YUV422 的色度分量被子采样，不能按通道拆分
+    }
+}
+
+int ImageBuffer::bytesPerSample() const
+{
+    const int channels = channelCount();
+    return channels > 0 ? bytesPerPixel() / channels : 0;
+}
+
 int ImageBuffer::bytesPerLine() const
 {
-    return m_width * bytesPerPixel();
+    return m_stride;
 }
 
 int ImageBuffer::totalBytes() const
 {
-    return m_height * bytesPerLine();
+    if (m_layout == Layout::Planar) {
+        return static_cast<int>(m_planeSize * channelCount());
+    }
+    return m_height * m_stride;
 }
 
 quint8 *ImageBuffer::scanLine(int y)
 {
-    if (y < 0 || y >= m_height || !m_data) {
+    if (y < 0 || y >= m_height || !m_data || (m_layout == Layout::Planar && channelCount() > 1)) {
         return nullptr;
     }
-    return m_data.get() + y * bytesPerLine();
+    return m_data.get() + static_cast<qint64>(y) * m_stride;
 }
 
 const quint8 *ImageBuffer::constScanLine(int y) const
 {
-    if (y < 0 || y >= m_height || !m_data) {
+    if (y < 0 || y >= m_height || !m_data || (m_layout == Layout::Planar && channelCount() > 1)) {
+        return nullptr;
+    }
+    return m_data.get() + static_cast<qint64>(y) * m_stride;
+}
+
+quint8 *ImageBuffer::planeLine(int channel, int y)
+{
+    return const_cast<quint8 *>(constPlaneLine(channel, y));
+}
+
+const quint8 *ImageBuffer::constPlaneLine(int channel, int y) const
+{
+    const int channels = channelCount();
+    if (y < 0 || y >= m_height || !m_data || channel < 0 || channel >= channels) {
+        return nullptr;
+    }
+    // 单通道的交错布局与平面布局相同
+    if (m_layout != Layout::Planar && channels != 1) {
         return nullptr;
     }
-    return m_data.get() + y * bytesPerLine();
+    return m_data.get() + channel * m_planeSize + static_cast<qint64>(y) * m_stride;
 }
 
 void ImageBuffer::allocateData()
 {
+    if (m_layout == Layout::Planar) {
+        m_planeSize = static_cast<qint64>(m_stride) * m_height;
+        const size_t totalSize = static_cast<size_t>(m_planeSize) * channelCount();
+        if (totalSize > 0) {
+            void *memory = qMallocAligned(totalSize, kPlaneAlignment);
+            if (!memory) {
+                qCWarning(advancedImageProcessor) << "Failed to allocate planar buffer of" << totalSize << "bytes";
+                m_data.reset();
+                return;
+            }
+            std::memset(memory, 0, totalSize);
+            m_data = std::shared_ptr<quint8>(static_cast<quint8 *>(memory), [](quint8 *p) { qFreeAligned(p); });
+            m_ownsData = true;
+        }
+        return;
+    }
+    
+    m_planeSize = 0;
     int totalSize = totalBytes();
     if (totalSize > 0) {
         m_data = std::shared_ptr<quint8>(new quint8[totalSize], std::default_delete<quint8[]>());
         std::fill_n(m_data.get(), totalSize, 0);
+        m_ownsData = true;
     }
 }
 
 void ImageBuffer::copyData(const ImageBuffer &other)
 {
-    if (other.m_data && other.totalBytes() > 0) {
-        allocateData();
-        std::copy_n(other.m_data.get(), totalBytes(), m_data.get());
+    // 复制结果总是紧凑的：交错行首尾相接，平面按对齐跨度重新排列
+    m_stride = m_layout == Layout::Planar ? alignedStride(m_width * bytesPerSample())
+                                          : m_width * bytesPerPixel();
+    if (!other.m_data || other.m_width <= 0 || other.m_height <= 0) {
+        m_planeSize = 0;
+        return;
+    }
+    
+    allocateData();
+    if (!m_data) {
+        return;
+    }
+    
+    const int planes = m_layout == Layout::Planar ? channelCount() : 1;
+    const int rowBytes = m_layout == Layout::Planar ? m_width * bytesPerSample() : m_width * bytesPerPixel();
+    for (int c = 0; c < planes; ++c) {
+        for (int y = 0; y < m_height; ++y) {
+            std::copy_n(other.m_data.get() + c * other.m_planeSize + static_cast<qint64>(y) * other.m_stride,
+                        rowBytes, m_data.get() + c * m_planeSize + static_cast<qint64>(y) * m_stride);
+        }
     }
 }
 
@@ -144,6 +340,12 @@ void ImageBuffer::copyData(const ImageBuffer &other)
 template<>
 Pixel ImageBuffer::getPixel<PixelFormat::Format3>(int x, int y) const
 {
+    if (m_layout == Layout::Planar) {
+        const quint8 *r = constPlaneLine(0, y);
+        if (!r) return Pixel();
+        return Pixel(r[x], constPlaneLine(1, y)[x], constPlaneLine(2, y)[x], 255);
+    }
+    
     const quint8 *line = constScanLine(y);
     if (!line) return Pixel();
     
@@ -154,6 +356,12 @@ Pixel ImageBuffer::getPixel<PixelFormat::Format3>(int x, int y) const
 template<>
 Pixel ImageBuffer::getPixel<PixelFormat::Format4>(int x, int y) const
 {
+    if (m_layout == Layout::Planar) {
+        const quint8 *r = constPlaneLine(0, y);
+        if (!r) return Pixel();
+        return Pixel(r[x], constPlaneLine(1, y)[x], constPlaneLine(2, y)[x], constPlaneLine(3, y)[x]);
+    }
+    
     const quint8 *line = constScanLine(y);
     if (!line) return Pixel();
     
@@ -164,6 +372,15 @@ Pixel ImageBuffer::getPixel<PixelFormat::Format4>(int x, int y) const
 template<>
 void ImageBuffer::setPixel<PixelFormat::Format3>(int x, int y, const Pixel &pixel)
 {
+    if (m_layout == Layout::Planar) {
+        quint8 *r = planeLine(0, y);
+        if (!r) return;
+        r[x] = pixel.r;
+        planeLine(1, y)[x] = pixel.g;
+        planeLine(2, y)[x] = pixel.b;
+        return;
+    }
+    
     quint8 *line = scanLine(y);
     if (!line) return;
     
@@ -176,6 +393,16 @@ void ImageBuffer::setPixel<PixelFormat::Format3>(int x, int y, const Pixel &pixe
 template<>
 void ImageBuffer::setPixel<PixelFormat::Format4>(int x, int y, const Pixel &pixel)
 {
+    if (m_layout == Layout::Planar) {
+        quint8 *r = planeLine(0, y);
+        if (!r) return;
+        r[x] = pixel.r;
+        planeLine(1, y)[x] = pixel.g;
+        planeLine(2, y)[x] = pixel.b;
+        planeLine(3, y)[x] = pixel.a;
+        return;
+    }
+    
     quint8 *line = scanLine(y);
     if (!line) return;
     
@@ -186,14 +413,42 @@ void ImageBuffer::setPixel<PixelFormat::Format4>(int x, int y, const Pixel &pixe
     p[3] = pixel.a;
 }
 
+template<>
+RawPixel ImageBuffer::getRawPixel<PixelFormat::Raw16Bit>(int x, int y) const
+{
+    RawPixel result;
+    for (int c = 0; c < 3; ++c) {
+        const quint8 *line = m_layout == Layout::Planar ? constPlaneLine(c, y) : constScanLine(y);
+        if (!line) return RawPixel();
+        const int index = m_layout == Layout::Planar ? x : x * 3 + c;
+        result.channels[c] = reinterpret_cast<const quint16 *>(line)[index];
+    }
+    return result;
+}
+
+template<>
+void ImageBuffer::setRawPixel<PixelFormat::Raw16Bit>(int x, int y, const RawPixel &pixel)
+{
+    for (int c = 0; c < 3; ++c) {
+        quint8 *line = m_layout == Layout::Planar ? planeLine(c, y) : scanLine(y);
+        if (!line) return;
+        const int index = m_layout == Layout::Planar ? x : x * 3 + c;
+        reinterpret_cast<quint16 *>(line)[index] = pixel.channels[c];
+    }
+}
+
 QImage ImageBuffer::toQImage() const
 {
+    if (m_layout == Layout::Planar && channelCount() > 1) {
+        return toInterleaved().toQImage();
+    }
+    
     if (m_format == PixelFormat::Format3) {
         QImage image(m_width, m_height, QImage::Format_RGB888);
         for (int y = 0; y < m_height; ++y) {
             const quint8 *srcLine = constScanLine(y);
             quint8 *dstLine = image.scanLine(y);
-            std::copy_n(srcLine, bytesPerLine(), dstLine);
+            std::copy_n(srcLine, m_width * 3, dstLine);
         }
         return image;
     } else if (m_format == PixelFormat::Format4) {
@@ -201,7 +456,7 @@ QImage ImageBuffer::toQImage() const
         for (int y = 0; y < m_height; ++y) {
             const quint8 *srcLine = constScanLine(y);
             quint8 *dstLine = image.scanLine(y);
-            std::copy_n(srcLine, bytesPerLine(), dstLine);
+            std::copy_n(srcLine, m_width * 4, dstLine);
         }
         return image;
     }
@@ -216,6 +471,8 @@ bool ImageBuffer::fromQImage(const QImage &image, PixelFormat targetFormat)
     m_width = image.width();
     m_height = image.height();
     m_format = targetFormat;
+    m_layout = Layout::Interleaved;
+    m_stride = m_width * bytesPerPixel();
     
     allocateData();
     
@@ -245,6 +502,151 @@ ImageBuffer ImageBuffer::copy() const
     return ImageBuffer(*this);
 }
 
+ImageBuffer ImageBuffer::view() const
+{
+    ImageBuffer result;
+    result.m_width = m_width;
+    result.m_height = m_height;
+    result.m_format = m_format;
+    result.m_layout = m_layout;
+    result.m_stride = m_stride;
+    result.m_planeSize = m_planeSize;
+    result.m_data = m_data;
+    result.m_ownsData = m_ownsData;
+    return result;
+}
+
+ImageBuffer ImageBuffer::rowsView(int firstRow, int rowCount) const
+{
+    if (!m_data || firstRow < 0 || rowCount <= 0 || firstRow + rowCount > m_height) {
+        return ImageBuffer();
+    }
+    
+    // 平面布局各平面按同一偏移前移，平面间距不变
+    ImageBuffer result = view();
+    result.m_height = rowCount;
+    result.m_data = std::shared_ptr<quint8>(m_data, m_data.get() + static_cast<qint64>(firstRow) * m_stride);
+    return result;
+}
+
+ImageBuffer ImageBuffer::toPlanar() const
+{
+    if (m_layout == Layout::Planar || !m_data) {
+        return view();
+    }
+    
+    const int channels = channelCount();
+    if (channels == 0) {
+        qCWarning(advancedImageProcessor) << "Pixel format" << static_cast<int>(m_format) << "cannot be split into planes";
+        return ImageBuffer();
+    }
+    
+    if (channels == 1) {
+        ImageBuffer result = view();
+        result.m_layout = Layout::Planar;
+        result.m_planeSize = static_cast<qint64>(m_stride) * m_height;
+        return result;
+    }
+    
+    ImageBuffer result(m_width, m_height, m_format, Layout::Planar);
+    quint8 *planes[4];
+    for (int y = 0; y < m_height; ++y) {
+        for (int c = 0; c < channels; ++c) {
+            planes[c] = result.planeLine(c, y);
+        }
+        if (bytesPerSample() == 2) {
+            deinterleaveRow<quint16>(constScanLine(y), planes, m_width, channels);
+        } else {
+            deinterleaveRow<quint8>(constScanLine(y), planes, m_width, channels);
+        }
+    }
+    return result;
+}
+
+ImageBuffer ImageBuffer::toInterleaved() const
+{
+    if (m_layout == Layout::Interleaved || !m_data) {
+        return view();
+    }
+    
+    const int channels = channelCount();
+    if (channels == 1) {
+        ImageBuffer result = view();
+        result.m_layout = Layout::Interleaved;
+        result.m_planeSize = 0;
+        return result;
+    }
+    
+    ImageBuffer result(m_width, m_height, m_format);
+    const quint8 *planes[4];
+    for (int y = 0; y < m_height; ++y) {
+        for (int c = 0; c < channels; ++c) {
+            planes[c] = constPlaneLine(c, y);
+        }
+        if (bytesPerSample() == 2) {
+            interleaveRow<quint16>(planes, result.scanLine(y), m_width, channels);
+        } else {
+            interleaveRow<quint8>(planes, result.scanLine(y), m_width, channels);
+        }
+    }
+    return result;
+}
+
+ImageBuffer ImageBuffer::planeView(int channel) const
+{
+    const int channels = channelCount();
+    if (!m_data || channel < 0 || channel >= channels || (m_layout != Layout::Planar && channels != 1)) {
+        return ImageBuffer();
+    }
+    
+    ImageBuffer result;
+    result.m_width = m_width;
+    result.m_height = m_height;
+    result.m_format = bytesPerSample() == 2 ? PixelFormat::Gray16 : PixelFormat::Format1;
+    result.m_stride = m_stride;
+    result.m_data = std::shared_ptr<quint8>(m_data, m_data.get() + channel * m_planeSize);
+    result.m_ownsData = m_ownsData;
+    return result;
+}
+
+bool ImageBuffer::sharesDataWith(const ImageBuffer &other) const
+{
+    if (!m_data || !other.m_data) {
+        return false;
+    }
+    // 同一分配（含行视图）共享控制块
+    return !m_data.owner_before(other.m_data) && !other.m_data.owner_before(m_data);
+}
+
+bool ImageBuffer::isDetached() const
+{
+    // 行视图与平面视图同样计入引用计数
+    return m_data && m_ownsData && m_data.use_count() == 1;
+}
+
+QImage ImageBuffer::toQImageView() const
+{
+    QImage::Format imageFormat;
+    switch (m_format) {
+    case PixelFormat::Format1: imageFormat = QImage::Format_Grayscale8; break;
+    case PixelFormat::Format3: imageFormat = QImage::Format_RGB888; break;
+    case PixelFormat::Format4: imageFormat = QImage::Format_RGBA8888; break;
+    default: return QImage();
+    }
+    
+    if (!m_data || (m_layout == Layout::Planar && channelCount() > 1)) {
+        return QImage();
+    }
+    
+    // cleanupInfo持有数据引用，QImage释放时归还
+    auto *keepAlive = new std::shared_ptr<quint8>(m_data);
+    // 使用只读构造，写入时QImage分离复制
+    const uchar *bits = m_data.get();
+    return QImage(bits, m_width, m_height, bytesPerLine(), imageFormat,
+                  [](void *info) { delete static_cast<std::shared_ptr<quint8> *>(info); },
+                  keepAlive);
+}
+
 ImageBuffer ImageBuffer::copy(const QRect &rect) const
 {
     if (rect.isEmpty() || !rect.intersects(QRect(0, 0, m_width, m_height))) {
@@ -252,7 +654,21 @@ ImageBuffer ImageBuffer::copy(const QRect &rect) const
     }
     
     QRect validRect = rect.intersected(QRect(0, 0, m_width, m_height));
-    ImageBuffer result(validRect.width(), validRect.height(), m_format);
+    ImageBuffer result(validRect.width(), validRect.height(), m_format, m_layout);
+    
+    if (m_layout == Layout::Planar) {
+        const int sampleSize = bytesPerSample();
+        for (int c = 0; c < channelCount(); ++c) {
+            for (int y = 0; y < validRect.height(); ++y) {
+                const quint8 *srcLine = constPlaneLine(c, validRect.y() + y);
+                quint8 *dstLine = result.planeLine(c, y);
+                if (srcLine && dstLine) {
+                    std::copy_n(srcLine + validRect.x() * sampleSize, validRect.width() * sampleSize, dstLine);
+                }
+            }
+        }
+        return result;
+    }
     
     int pixelSize = bytesPerPixel();
     for (int y = 0; y < validRect.height(); ++y) {
@@ -307,7 +723,7 @@ ImageProcessingNode::~ImageProcessingNode()
 
 bool ImageProcessingNode::canProcess(const ImageBuffer &input) const
 {
-    return !input.constData() || input.width() > 0 && input.height() > 0;
+    return input.constData() && input.width() > 0 && input.height() > 0;
 }
 
 QVariantMap ImageProcessingNode::getParameters() const
@@ -341,7 +757,7 @@ bool SourceNode::process(const ImageBuffer &input, ImageBuffer &output)
     
     if (m_rowCallback) {
         // 使用回调函数提供数据
-        output = ImageBuffer(m_sourceData.width(), m_sourceData.height(), m_sourceData.format());
+        output = ImageBuffer(streamWidth(), streamHeight(), streamFormat());
         
         for (int y = 0; y < output.height(); ++y) {
             quint8 *lineData = output.scanLine(y);
@@ -351,8 +767,8 @@ bool SourceNode::process(const ImageBuffer &input, ImageBuffer &output)
             }
         }
     } else {
-        // 使用预设数据
-        output = m_sourceData.copy();
+        // 使用预设数据（共享视图，下游节点总是写入新缓冲区）
+        output = m_sourceData.view();
     }
     
     return true;
@@ -376,6 +792,56 @@ void SourceNode::setRowCallback(const RowCallback &callback)
     m_rowCallback = callback;
 }
 
+void SourceNode::setStreamGeometry(int width, int height, PixelFormat format)
+{
+    QMutexLocker locker(&m_dataMutex);
+    m_streamWidth = width;
+    m_streamHeight = height;
+    m_streamFormat = format;
+}
+
+int SourceNode::streamWidth() const
+{
+    return m_streamWidth > 0 ? m_streamWidth : m_sourceData.width();
+}
+
+int SourceNode::streamHeight() const
+{
+    return m_streamHeight > 0 ? m_streamHeight : m_sourceData.height();
+}
+
+PixelFormat SourceNode::streamFormat() const
+{
+    return m_streamFormat != PixelFormat::Unknown ? m_streamFormat : m_sourceData.format();
+}
+
+bool SourceNode::readRows(int firstRow, ImageBuffer &strip)
+{
+    QMutexLocker locker(&m_dataMutex);
+    
+    if (firstRow < 0 || firstRow + strip.height() > streamHeight() ||
+        strip.width() != streamWidth() || strip.format() != streamFormat()) {
+        qCWarning(advancedImageProcessor) << "Invalid strip request at row" << firstRow
+                                         << "rows:" << strip.height();
+        return false;
+    }
+    
+    for (int y = 0; y < strip.height(); ++y) {
+        quint8 *lineData = strip.scanLine(y);
+        
+        if (m_rowCallback) {
+            if (!m_rowCallback(firstRow + y, lineData)) {
+                qCWarning(advancedImageProcessor) << "Row callback failed at line" << firstRow + y;
+                return false;
+            }
+        } else {
+            std::copy_n(m_sourceData.constScanLine(firstRow + y), strip.bytesPerLine(), lineData);
+        }
+    }
+    
+    return true;
+}
+
 // =============================================================================
 // FormatConvertNode 实现
 // =============================================================================
@@ -394,8 +860,8 @@ bool FormatConvertNode::process(const ImageBuffer &input, ImageBuffer &output)
     }
     
     if (input.format() == m_targetFormat) {
-        // 格式相同，直接复制
-        output = input.copy();
+        // 格式相同，直接共享
+        output = input.view();
         return true;
     }
     
@@ -531,171 +997,300 @@ bool FormatConvertNode::convertRGBToLAB(const ImageBuffer &input, ImageBuffer &o
             double b = rgb[2] / 255.0;
             
             // XYZ转换（简化）
-            double x = 0.412453 * r + 0.357580 * g + 0.180423 * b;
+            double wx = 0.412453 * r + 0.357580 * g + 0.180423 * b;
             double wy = 0.212671 * r + 0.715160 * g + 0.072169 * b;
-            double z = 0.019334 * r + 0.119193 * g + 0.950227 * b;
+            double wz = 0.019334 * r + 0.119193 * g + 0.950227 * b;
             
             // LAB转换（简化）
             lab[0] = static_cast<quint8>(wy * 255);      // L
-            lab[1] = static_cast<quint8>((x - wy + 1) * 127.5);  // a
-            lab[2] = static_cast<quint8>((wy - z + 1) * 127.5);  // b
+            lab[1] = static_cast<quint8>((wx - wy + 1) * 127.5);  // a
+            lab[2] = static_cast<quint8>((wy - wz + 1) * 127.5);  // b
         }
     }
     return true;
 }
 
 // =============================================================================
-// PixelShiftNode 实现
+// ShadingCorrectionNode 实现
 // =============================================================================
 
-PixelShiftNode::PixelShiftNode(QObject *parent)
-    : ImageProcessingNode(ProcessingNodeType::PixelShiftColumns, parent)
-    , m_columnShift(0)
-    , m_lineShift(0)
-    , m_subPixelColumnShift(0.0)
-    , m_subPixelLineShift(0.0)
-    , m_useSubPixel(false)
+ShadingCorrectionNode::ShadingCorrectionNode(QObject *parent)
+    : ImageProcessingNode(ProcessingNodeType::Calibrate, parent)
 {
-    qCDebug(advancedImageProcessor) << "PixelShiftNode created";
+    qCDebug(advancedImageProcessor) << "ShadingCorrectionNode created";
 }
 
-bool PixelShiftNode::process(const ImageBuffer &input, ImageBuffer &output)
+bool ShadingCorrectionNode::process(const ImageBuffer &input, ImageBuffer &output)
 {
     if (!canProcess(input)) {
         return false;
     }
     
-    qCDebug(advancedImageProcessor) << "Applying pixel shift - columns:" << m_columnShift 
-                                   << "lines:" << m_lineShift;
+    const int sampleBytes = input.bytesPerSample();
+    if (!m_corrector.isValid() || input.width() != m_corrector.width()
+        || input.channelCount() != m_corrector.channels() || (sampleBytes != 1 && sampleBytes != 2)) {
+        qCWarning(advancedImageProcessor) << "Shading reference does not match input, skipping correction";
+        output = input.copy();
+        return true;
+    }
     
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    qCDebug(advancedImageProcessor) << "Applying shading correction";
     
-    if (m_useSubPixel) {
-        return performSubPixelShift(input, output);
-    } else {
-        bool success = true;
-        
-        // 先应用列移位
-        if (m_columnShift != 0) {
-            ImageBuffer temp;
-            success = performColumnShift(input, temp);
-            if (success && m_lineShift != 0) {
-                success = performLineShift(temp, output);
-            } else {
-                output = temp;
-            }
-        } else if (m_lineShift != 0) {
-            success = performLineShift(input, output);
+    // 输出可能与输入共享数据（视图），先分配独立缓冲区
+    ImageBuffer result(input.width(), input.height(), input.format());
+    const qint64 lineSamples = static_cast<qint64>(input.width()) * input.channelCount();
+    for (int y = 0; y < input.height(); ++y) {
+        if (sampleBytes == 2) {
+            m_corrector.apply16(reinterpret_cast<const quint16 *>(input.constScanLine(y)),
+                                reinterpret_cast<quint16 *>(result.scanLine(y)), 0, lineSamples);
         } else {
-            output = input.copy();
+            m_corrector.apply8(input.constScanLine(y), result.scanLine(y), 0, lineSamples);
         }
-        
-        return success;
     }
+    
+    output = std::move(result);
+    return true;
 }
 
-void PixelShiftNode::setSubPixelShift(double columnShift, double lineShift)
+bool ShadingCorrectionNode::setReference(const QByteArray &black, const QByteArray &white, int width, int channels,
+                                         double targetLevel)
 {
-    m_subPixelColumnShift = columnShift;
-    m_subPixelLineShift = lineShift;
-    m_useSubPixel = true;
+    return m_corrector.setReference(black, white, width, channels, targetLevel);
 }
 
-bool PixelShiftNode::performColumnShift(const ImageBuffer &input, ImageBuffer &output)
+// =============================================================================
+// LineShiftCorrector 实现
+// =============================================================================
+
+bool LineShiftCorrector::reset(int width, int channels, int bytesPerSample, const QVector<ChannelShift> &shifts)
 {
-    output = ImageBuffer(input.width(), input.height(), input.format());
-    
-    int pixelSize = input.bytesPerPixel();
-    int shiftBytes = m_columnShift * pixelSize;
-    
-    for (int y = 0; y < input.height(); ++y) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        if (m_columnShift > 0) {
-            // 右移
-            std::fill_n(outputLine, shiftBytes, 0);
-            std::copy_n(inputLine, input.bytesPerLine() - shiftBytes, outputLine + shiftBytes);
-        } else if (m_columnShift < 0) {
-            // 左移
-            std::copy_n(inputLine - shiftBytes, input.bytesPerLine() + shiftBytes, outputLine);
-            std::fill_n(outputLine + input.bytesPerLine() + shiftBytes, -shiftBytes, 0);
-        } else {
-            std::copy_n(inputLine, input.bytesPerLine(), outputLine);
-        }
+    if (width <= 0 || channels <= 0 || (bytesPerSample != 1 && bytesPerSample != 2)) {
+        m_width = 0;
+        return false;
     }
     
+    m_width = width;
+    m_channels = channels;
+    m_sampleBytes = bytesPerSample;
+    m_plans.resize(m_channels);
+    // 输出行y最早在源行y推入后就绪，因此环形缓冲区至少要覆盖到偏移0
+    m_minRow = std::numeric_limits<int>::max();
+    m_maxRow = 0;
+    int maxColumnOffset = 0;
+    
+    for (int c = 0; c < m_channels; ++c) {
+        const ChannelShift shift = c < shifts.size() ? shifts[c] : ChannelShift();
+        
+        // 源坐标 = 输出坐标 - 偏移，拆分为整数部分与小数部分
+        const double sourceX = -shift.column;
+        const double sourceY = -shift.line;
+        ChannelPlan &plan = m_plans[c];
+        plan.columnOffset = static_cast<int>(std::floor(sourceX));
+        plan.rowOffset = static_cast<int>(std::floor(sourceY));
+        const float fx = static_cast<float>(sourceX - plan.columnOffset);
+        const float fy = static_cast<float>(sourceY - plan.rowOffset);
+        plan.twoRows = fy > 0.0f;
+        plan.weights[0] = (1.0f - fx) * (1.0f - fy);
+        plan.weights[1] = fx * (1.0f - fy);
+        plan.weights[2] = (1.0f - fx) * fy;
+        plan.weights[3] = fx * fy;
+        
+        m_minRow = qMin(m_minRow, plan.rowOffset);
+        m_maxRow = qMax(m_maxRow, plan.rowOffset + (plan.twoRows ? 1 : 0));
+        maxColumnOffset = qMax(maxColumnOffset, qAbs(plan.columnOffset));
+    }
+    
+    // 超出图像的样本读到补零区域；偏移超过行宽时整行为0
+    m_pad = qMin(maxColumnOffset, width) + 1;
+    for (ChannelPlan &plan : m_plans) {
+        plan.columnOffset = qBound(-m_pad, plan.columnOffset, m_pad - 1);
+    }
+    
+    const size_t planeLength = static_cast<size_t>(m_width) + 2 * m_pad;
+    m_ring.assign(planeLength * m_channels * ringRows(), 0.0f);
+    m_zeroPlane.assign(planeLength, 0.0f);
+    m_result.resize(m_width);
+    restart();
     return true;
 }
 
-bool PixelShiftNode::performLineShift(const ImageBuffer &input, ImageBuffer &output)
+void LineShiftCorrector::restart()
 {
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    // 未推入的源行按0读取，环形缓冲区中上一帧的数据不会被用到
+    m_pushed = 0;
+    m_nextOutput = 0;
+    m_finished = false;
+}
+
+void LineShiftCorrector::pushLine(const quint8 *line)
+{
+    if (m_width == 0 || m_finished) {
+        return;
+    }
     
-    for (int y = 0; y < input.height(); ++y) {
-        int sourceY = y - m_lineShift;
-        quint8 *outputLine = output.scanLine(y);
-        
-        if (sourceY >= 0 && sourceY < input.height()) {
-            const quint8 *inputLine = input.constScanLine(sourceY);
-            std::copy_n(inputLine, input.bytesPerLine(), outputLine);
+    const size_t planeLength = static_cast<size_t>(m_width) + 2 * m_pad;
+    float *slot = m_ring.data() + (m_pushed % ringRows()) * planeLength * m_channels;
+    for (int c = 0; c < m_channels; ++c) {
+        float *plane = slot + c * planeLength + m_pad;
+        if (m_sampleBytes == 2) {
+            const quint16 *samples = reinterpret_cast<const quint16 *>(line) + c;
+            for (int x = 0; x < m_width; ++x) {
+                plane[x] = samples[x * m_channels];
+            }
         } else {
-            std::fill_n(outputLine, input.bytesPerLine(), 0);
+            const quint8 *samples = line + c;
+            for (int x = 0; x < m_width; ++x) {
+                plane[x] = samples[x * m_channels];
+            }
         }
     }
-    
-    return true;
+    ++m_pushed;
 }
 
-bool PixelShiftNode::performSubPixelShift(const ImageBuffer &input, ImageBuffer &output)
+void LineShiftCorrector::finish()
 {
-    // 亚像素精度移位实现（双线性插值）
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    m_finished = true;
+}
+
+const float *LineShiftCorrector::sourcePlane(qint64 row, int channel) const
+{
+    if (row < 0 || row >= m_pushed) {
+        return m_zeroPlane.data();
+    }
+    const size_t planeLength = static_cast<size_t>(m_width) + 2 * m_pad;
+    return m_ring.data() + ((row % ringRows()) * m_channels + channel) * planeLength;
+}
+
+bool LineShiftCorrector::takeLine(quint8 *out)
+{
+    // 输出行数与源行数相同；未结束时需等到最低的所需源行推入
+    const qint64 y = m_nextOutput;
+    if (m_width == 0 || y >= m_pushed || (!m_finished && y + m_maxRow >= m_pushed)) {
+        return false;
+    }
     
-    for (int y = 0; y < output.height(); ++y) {
-        for (int x = 0; x < output.width(); ++x) {
-            double srcX = x - m_subPixelColumnShift;
-            double srcY = y - m_subPixelLineShift;
-            
-            int x1 = static_cast<int>(std::floor(srcX));
-            int y1 = static_cast<int>(std::floor(srcY));
-            int x2 = x1 + 1;
-            int y2 = y1 + 1;
-            
-            double fx = srcX - x1;
-            double fy = srcY - y1;
-            
-            // 边界检查
-            if (x1 < 0 || x2 >= input.width() || y1 < 0 || y2 >= input.height()) {
-                continue;
+    const float maxValue = m_sampleBytes == 2 ? 65535.0f : 255.0f;
+    for (int c = 0; c < m_channels; ++c) {
+        const ChannelPlan &plan = m_plans[c];
+        const float *above = sourcePlane(y + plan.rowOffset, c);
+        const float *below = plan.twoRows ? sourcePlane(y + plan.rowOffset + 1, c) : above;
+        SIMDImageAlgorithms::bilinearShiftRow(above + m_pad + plan.columnOffset, below + m_pad + plan.columnOffset,
+                                              plan.weights, m_result.data(), m_width);
+        
+        if (m_sampleBytes == 2) {
+            quint16 *samples = reinterpret_cast<quint16 *>(out) + c;
+            for (int x = 0; x < m_width; ++x) {
+                samples[x * m_channels] = static_cast<quint16>(qBound(0.0f, m_result[x] + 0.5f, maxValue));
             }
-            
-            // 双线性插值
-            if (input.format() == PixelFormat::Format3) {
-                Pixel p1 = input.getPixel<PixelFormat::Format3>(x1, y1);
-                Pixel p2 = input.getPixel<PixelFormat::Format3>(x2, y1);
-                Pixel p3 = input.getPixel<PixelFormat::Format3>(x1, y2);
-                Pixel p4 = input.getPixel<PixelFormat::Format3>(x2, y2);
-                
-                Pixel result;
-                result.r = static_cast<quint8>(
-                    p1.r * (1-fx) * (1-fy) + p2.r * fx * (1-fy) + 
-                    p3.r * (1-fx) * fy + p4.r * fx * fy);
-                result.g = static_cast<quint8>(
-                    p1.g * (1-fx) * (1-fy) + p2.g * fx * (1-fy) + 
-                    p3.g * (1-fx) * fy + p4.g * fx * fy);
-                result.b = static_cast<quint8>(
-                    p1.b * (1-fx) * (1-fy) + p2.b * fx * (1-fy) + 
-                    p3.b * (1-fx) * fy + p4.b * fx * fy);
-                
-                output.setPixel<PixelFormat::Format3>(x, y, result);
+        } else {
+            quint8 *samples = out + c;
+            for (int x = 0; x < m_width; ++x) {
+                samples[x * m_channels] = static_cast<quint8>(qBound(0.0f, m_result[x] + 0.5f, maxValue));
             }
         }
     }
     
+    ++m_nextOutput;
+    return true;
+}
+
+// =============================================================================
+// PixelShiftNode 实现
+// =============================================================================
+
+PixelShiftNode::PixelShiftNode(QObject *parent)
+    : ImageProcessingNode(ProcessingNodeType::PixelShiftColumns, parent)
+    , m_columnShift(0)
+    , m_lineShift(0)
+    , m_subPixelColumnShift(0.0)
+    , m_subPixelLineShift(0.0)
+    , m_useSubPixel(false)
+    , m_shiftsChanged(true)
+{
+    qCDebug(advancedImageProcessor) << "PixelShiftNode created";
+}
+
+bool PixelShiftNode::process(const ImageBuffer &input, ImageBuffer &output)
+{
+    if (!canProcess(input)) {
+        return false;
+    }
+    
+    qCDebug(advancedImageProcessor) << "Applying pixel shift - columns:" << m_columnShift 
+                                   << "lines:" << m_lineShift;
+    
+    if (!m_shiftsChanged && m_corrector.matches(input.width(), input.channelCount(), input.bytesPerSample())) {
+        m_corrector.restart();
+    } else if (m_corrector.reset(input.width(), input.channelCount(), input.bytesPerSample(),
+                                 effectiveShifts(input.channelCount()))) {
+        m_shiftsChanged = false;
+    } else {
+        qCWarning(advancedImageProcessor) << "Pixel shift not supported for format" << static_cast<int>(input.format());
+        output = input.copy();
+        return true;
+    }
+    
+    // 逐行推入，输出行就绪即写出，工作内存只有环形缓冲区
+    output = ImageBuffer(input.width(), input.height(), input.format());
+    int outputRow = 0;
+    for (int y = 0; y < input.height(); ++y) {
+        m_corrector.pushLine(input.constScanLine(y));
+        while (m_corrector.takeLine(output.scanLine(outputRow))) {
+            ++outputRow;
+        }
+    }
+    m_corrector.finish();
+    while (outputRow < output.height() && m_corrector.takeLine(output.scanLine(outputRow))) {
+        ++outputRow;
+    }
+    
     return true;
 }
 
+void PixelShiftNode::setSubPixelShift(double columnShift, double lineShift)
+{
+    m_subPixelColumnShift = columnShift;
+    m_subPixelLineShift = lineShift;
+    m_useSubPixel = true;
+    m_shiftsChanged = true;
+}
+
+void PixelShiftNode::setChannelShifts(const QVector<LineShiftCorrector::ChannelShift> &shifts)
+{
+    m_channelShifts = shifts;
+    m_shiftsChanged = true;
+}
+
+QVector<LineShiftCorrector::ChannelShift> PixelShiftNode::effectiveShifts(int channels) const
+{
+    QVector<LineShiftCorrector::ChannelShift> shifts(channels);
+    for (int c = 0; c < channels; ++c) {
+        shifts[c].column = m_useSubPixel ? m_subPixelColumnShift : m_columnShift;
+        shifts[c].line = m_useSubPixel ? m_subPixelLineShift : m_lineShift;
+        if (c < m_channelShifts.size()) {
+            shifts[c].column += m_channelShifts[c].column;
+            shifts[c].line += m_channelShifts[c].line;
+        }
+    }
+    return shifts;
+}
+
+ImageProcessingNode::RowContext PixelShiftNode::rowContext() const
+{
+    RowContext context;
+    
+    // 输出行y插值自源行floor(y - shift)和floor(y - shift) + 1
+    const auto shifts = effectiveShifts(qMax(1, m_channelShifts.size()));
+    for (const LineShiftCorrector::ChannelShift &shift : shifts) {
+        const int lower = static_cast<int>(std::floor(-shift.line));
+        const int upper = lower + (-shift.line > lower ? 1 : 0);
+        context.rowsBefore = qMax(context.rowsBefore, -lower);
+        context.rowsAfter = qMax(context.rowsAfter, upper);
+    }
+    
+    return context;
+}
+
 // =============================================================================
 // ColorCorrectionNode 实现
 // =============================================================================
@@ -703,7 +1298,6 @@ bool PixelShiftNode::performSubPixelShift(const ImageBuffer &input, ImageBuffer
 ColorCorrectionNode::ColorCorrectionNode(QObject *parent)
     : ImageProcessingNode(ProcessingNodeType::ColorCorrection, parent)
     , m_whitePoint(255, 255, 255)
-    , m_colorMatrix(QMatrix3x3())
     , m_gamma(1.0)
     , m_brightness(0)
     , m_contrast(100)
@@ -723,12 +1317,12 @@ bool ColorCorrectionNode::process(const ImageBuffer &input, ImageBuffer &output)
     
     qCDebug(advancedImageProcessor) << "Applying color correction";
     
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    if (m_fusedKernel && (input.format() == PixelFormat::Format3 || input.format() == PixelFormat::Format4)) {
+        return applyFusedKernel(input, output);
+    }
     
-    if (input.format() == PixelFormat::Format3) {
-        return applyRGBColorCorrection(input, output);
-    } else if (input.format() == PixelFormat::Format4) {
-        return applyRGBAColorCorrection(input, output);
+    if (input.format() == PixelFormat::Format3 || input.format() == PixelFormat::Format4) {
+        return applyStepwiseCorrection(input, output);
     }
     
     // 不支持的格式，直接复制
@@ -766,84 +1360,235 @@ void ColorCorrectionNode::setSaturation(int saturation)
     m_saturation = qBound(0, saturation, 200);
 }
 
-bool ColorCorrectionNode::applyRGBColorCorrection(const ImageBuffer &input, ImageBuffer &output)
+void ColorCorrectionNode::setAutoWhiteBalance(bool enabled)
+{
+    m_autoWhiteBalance = enabled;
+}
+
+void ColorCorrectionNode::setAutoColorRestoration(bool enabled)
+{
+    m_autoColorRestoration = enabled;
+}
+
+bool ColorCorrectionNode::supportsStreaming() const
+{
+    return !m_autoWhiteBalance && !m_autoColorRestoration;
+}
+
+bool ColorCorrectionNode::applyStepwiseCorrection(const ImageBuffer &input, ImageBuffer &output) const
 {
     // 预计算查找表
-    std::vector<quint8> gammaLUT(256);
-    std::vector<qint16> contrastLUT(256);
+    quint8 gammaLUT[256];
+    quint8 contrastLUT[256];
     
-    double invGamma = 1.0 / m_gamma;
-    double contrastFactor = m_contrast / 100.0;
-    double brightnessFactor = m_brightness / 255.0;
+    const double invGamma = 1.0 / m_gamma;
+    const double contrastFactor = m_contrast / 100.0;
     
     for (int i = 0; i < 256; ++i) {
         // 伽马校正
-        double normalized = i / 255.0;
-        double gammaCorrected = std::pow(normalized, invGamma);
+        double gammaCorrected = std::pow(i / 255.0, invGamma);
         gammaLUT[i] = static_cast<quint8>(qBound(0.0, gammaCorrected * 255.0, 255.0));
         
         // 对比度和亮度
-        double adjusted = (i - 128) * contrastFactor + 128 + brightnessFactor * 255;
-        contrastLUT[i] = static_cast<qint16>(qBound(0.0, adjusted, 255.0));
+        double adjusted = (i - 128) * contrastFactor + 128 + m_brightness;
+        contrastLUT[i] = static_cast<quint8>(qBound(0.0, adjusted, 255.0));
+    }
+    
+    double white[3] = {1.0, 1.0, 1.0};
+    if (m_whitePoint.isValid()) {
+        const int whiteValues[3] = {m_whitePoint.red(), m_whitePoint.green(), m_whitePoint.blue()};
+        for (int c = 0; c < 3; ++c) {
+            if (whiteValues[c] > 0) {
+                white[c] = 255.0 / whiteValues[c];
+            }
+        }
     }
+    const double saturation = m_saturation / 100.0;
+    const int bytesPerPixel = input.bytesPerPixel();
+    const bool hasAlpha = bytesPerPixel == 4;
     
+    ImageBuffer result(input.width(), input.height(), input.format());
     for (int y = 0; y < input.height(); ++y) {
         const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
+        quint8 *outputLine = result.scanLine(y);
         
         for (int x = 0; x < input.width(); ++x) {
-            const quint8 *inputPixel = inputLine + x * 3;
-            quint8 *outputPixel = outputLine + x * 3;
-            
-            // 应用颜色矩阵变换
-            double r = inputPixel[0];
-            double g = inputPixel[1];
-            double b = inputPixel[2];
+            const quint8 *inputPixel = inputLine + x * bytesPerPixel;
+            quint8 *outputPixel = outputLine + x * bytesPerPixel;
             
-            double newR = r * m_colorMatrix(0,0) + g * m_colorMatrix(0,1) + b * m_colorMatrix(0,2);
-            double newG = r * m_colorMatrix(1,0) + g * m_colorMatrix(1,1) + b * m_colorMatrix(1,2);
-            double newB = r * m_colorMatrix(2,0) + g * m_colorMatrix(2,1) + b * m_colorMatrix(2,2);
+            // 白点
+            double r = inputPixel[0] * white[0];
+            double g = inputPixel[1] * white[1];
+            double b = inputPixel[2] * white[2];
             
-            // 限制范围
-            int iR = qBound(0, static_cast<int>(newR), 255);
-            int iG = qBound(0, static_cast<int>(newG), 255);
-            int iB = qBound(0, static_cast<int>(newB), 255);
+            // 颜色矩阵
+            double mixed[3];
+            for (int c = 0; c < 3; ++c) {
+                mixed[c] = r * m_colorMatrix(c, 0) + g * m_colorMatrix(c, 1) + b * m_colorMatrix(c, 2);
+            }
             
-            // 应用伽马校正
-            iR = gammaLUT[iR];
-            iG = gammaLUT[iG];
-            iB = gammaLUT[iB];
+            // 饱和度
+            double luma = 0.299 * mixed[0] + 0.587 * mixed[1] + 0.114 * mixed[2];
+            for (int c = 0; c < 3; ++c) {
+                double value = luma + (mixed[c] - luma) * saturation;
+                int index = qBound(0, static_cast<int>(value), 255);
+                
+                // 伽马后接对比度和亮度
+                outputPixel[c] = contrastLUT[gammaLUT[index]];
+            }
             
-            // 应用对比度和亮度
-            outputPixel[0] = static_cast<quint8>(contrastLUT[iR]);
-            outputPixel[1] = static_cast<quint8>(contrastLUT[iG]);
-            outputPixel[2] = static_cast<quint8>(contrastLUT[iB]);
+            if (hasAlpha) {
+                outputPixel[3] = inputPixel[3];
+            }
         }
     }
     
+    output = std::move(result);
     return true;
 }
 
-bool ColorCorrectionNode::applyRGBAColorCorrection(const ImageBuffer &input, ImageBuffer &output)
+ColorCorrectionNode::FusedKernel ColorCorrectionNode::buildFusedKernel() const
+{
+    FusedKernel kernel;
+    
+    // 白点：各通道缩放到 255，作用在矩阵之前
+    double white[3] = {1.0, 1.0, 1.0};
+    if (m_whitePoint.isValid()) {
+        const int whiteValues[3] = {m_whitePoint.red(), m_whitePoint.green(), m_whitePoint.blue()};
+        for (int c = 0; c < 3; ++c) {
+            if (whiteValues[c] > 0) {
+                white[c] = 255.0 / whiteValues[c];
+            }
+        }
+    }
+    
+    // 饱和度：向亮度方向插值，亦为线性变换
+    const double luma[3] = {0.299, 0.587, 0.114};
+    const double saturation = m_saturation / 100.0;
+    
+    double fused[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < 3; ++k) {
+                double s = (1.0 - saturation) * luma[k] + (i == k ? saturation : 0.0);
+                sum += s * m_colorMatrix(k, j);
+            }
+            fused[i][j] = sum * white[j];
+        }
+    }
+    
+    kernel.channelIndependent = true;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (i != j && std::abs(fused[i][j]) > 1e-6) {
+                kernel.channelIndependent = false;
+            }
+        }
+    }
+    
+    // 伽马后接对比度与亮度，与逐步实现的顺序一致
+    quint8 tone[256];
+    const double invGamma = 1.0 / m_gamma;
+    const double contrastFactor = m_contrast / 100.0;
+    for (int v = 0; v < 256; ++v) {
+        double gammaCorrected = std::pow(v / 255.0, invGamma) * 255.0;
+        int g = qBound(0, static_cast<int>(gammaCorrected), 255);
+        double adjusted = (g - 128) * contrastFactor + 128 + m_brightness;
+        tone[v] = static_cast<quint8>(qBound(0.0, adjusted, 255.0));
+    }
+    
+    const double scale = 1 << FusedKernel::Shift;
+    for (int c = 0; c < 3; ++c) {
+        for (int j = 0; j < 3; ++j) {
+            kernel.coeffs[c][j] = static_cast<qint16>(qBound(-32767.0, std::round(fused[c][j] * scale), 32767.0));
+        }
+        kernel.coeffs[c][3] = static_cast<qint16>(1 << (FusedKernel::Shift - 1));
+        
+        for (int v = 0; v < 256; ++v) {
+            // 对角矩阵时通道缩放也并入查找表
+            int index = kernel.channelIndependent
+                ? qBound(0, static_cast<int>(std::lround(v * fused[c][c])), 255)
+                : v;
+            kernel.lut[c][v] = tone[index];
+        }
+    }
+    
+    return kernel;
+}
+
+bool ColorCorrectionNode::applyFusedKernel(const ImageBuffer &input, ImageBuffer &output) const
 {
-    // RGBA版本的颜色校正（保持Alpha通道）
+    const FusedKernel kernel = buildFusedKernel();
+    const int bytesPerPixel = input.bytesPerPixel();
+    
+    // 输出可能与输入共享数据（视图），逐行读写前先分配独立缓冲区
+    ImageBuffer result(input.width(), input.height(), input.format());
     for (int y = 0; y < input.height(); ++y) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
+        applyFusedRow(kernel, input.constScanLine(y), result.scanLine(y),
+                      input.width(), bytesPerPixel, m_simdEnabled);
+    }
+    
+    output = std::move(result);
+    return true;
+}
+
+void ColorCorrectionNode::applyFusedRow(const FusedKernel &kernel, const quint8 *input, quint8 *output,
+                                        int width, int bytesPerPixel, bool useSIMD)
+{
+    const bool hasAlpha = bytesPerPixel == 4;
+    
+    if (kernel.channelIndependent) {
+        for (int x = 0; x < width; ++x) {
+            const quint8 *in = input + x * bytesPerPixel;
+            quint8 *out = output + x * bytesPerPixel;
+            out[0] = kernel.lut[0][in[0]];
+            out[1] = kernel.lut[1][in[1]];
+            out[2] = kernel.lut[2][in[2]];
+            if (hasAlpha) {
+                out[3] = in[3];
+            }
+        }
+        return;
+    }
+    
+    if (useSIMD) {
+        // 矩阵乘法走运行时分派的向量内核，按块写入 L1 中的通道平面后再查表
+        constexpr int Chunk = 256;
+        quint8 planes[3][Chunk];
+        quint8 *const planePointers[3] = {planes[0], planes[1], planes[2]};
         
-        for (int x = 0; x < input.width(); ++x) {
-            const quint8 *inputPixel = inputLine + x * 4;
-            quint8 *outputPixel = outputLine + x * 4;
-            
-            // RGB处理同上
-            // ...（为简化省略详细实现）
+        for (int x0 = 0; x0 < width; x0 += Chunk) {
+            const int count = qMin(Chunk, width - x0);
+            const quint8 *in = input + x0 * bytesPerPixel;
+            SIMDImageAlgorithms::colorMatrixRow(in, bytesPerPixel, kernel.coeffs, FusedKernel::Shift,
+                                                planePointers, count);
             
-            // 保持Alpha通道
-            outputPixel[3] = inputPixel[3];
+            quint8 *out = output + x0 * bytesPerPixel;
+            for (int i = 0; i < count; ++i) {
+                out[i * bytesPerPixel] = kernel.lut[0][planes[0][i]];
+                out[i * bytesPerPixel + 1] = kernel.lut[1][planes[1][i]];
+                out[i * bytesPerPixel + 2] = kernel.lut[2][planes[2][i]];
+                if (hasAlpha) {
+                    out[i * bytesPerPixel + 3] = in[i * bytesPerPixel + 3];
+                }
+            }
         }
+        return;
     }
     
-    return true;
+    for (int x = 0; x < width; ++x) {
+        const quint8 *in = input + x * bytesPerPixel;
+        quint8 *out = output + x * bytesPerPixel;
+        for (int c = 0; c < 3; ++c) {
+            const qint16 *k = kernel.coeffs[c];
+            int v = (k[0] * in[0] + k[1] * in[1] + k[2] * in[2] + k[3]) >> FusedKernel::Shift;
+            out[c] = kernel.lut[c][qBound(0, v, 255)];
+        }
+        if (hasAlpha) {
+            out[3] = in[3];
+        }
+    }
 }
 
 // =============================================================================
@@ -901,280 +1646,276 @@ void NoiseReductionNode::setPreserveDetails(bool preserve)
     m_preserveDetails = preserve;
 }
 
+void NoiseReductionNode::setApproximateBilateral(bool enabled)
+{
+    m_approximateBilateral = enabled;
+}
+
+void NoiseReductionNode::setFastNonLocalMeans(bool enabled)
+{
+    m_fastNonLocalMeans = enabled;
+}
+
+ImageProcessingNode::RowContext NoiseReductionNode::rowContext() const
+{
+    RowContext context;
+    context.rowsBefore = context.rowsAfter = filterRadius();
+    return context;
+}
+
+bool NoiseReductionNode::supportsStreaming() const
+{
+    switch (m_type) {
+        case NoiseReductionType::Wavelet:
+            return false;
+        case NoiseReductionType::Bilateral:
+            return !m_approximateBilateral;
+        default:
+            return true;
+    }
+}
+
+int NoiseReductionNode::filterRadius() const
+{
+    switch (m_type) {
+        case NoiseReductionType::Gaussian:
+            return (static_cast<int>(1 + m_strength * 8) | 1) / 2;
+        case NoiseReductionType::Bilateral:
+            return static_cast<int>(m_strength * 5) + 1;
+        case NoiseReductionType::NonLocal:
+            return m_fastNonLocalMeans ? 2 + 5 : 3 + 10;    // 块半径 + 搜索半径
+        case NoiseReductionType::Wavelet:
+            return 2 * ((1 << 4) - 1);  // 4层 à trous 分解的支撑半径
+        case NoiseReductionType::MedianFilter:
+            return static_cast<int>(m_strength * 3) + 1;
+        default:
+            return 0;
+    }
+}
+
+int NoiseReductionNode::filterChannels(PixelFormat format)
+{
+    switch (format) {
+        case PixelFormat::Format1:
+            return 1;
+        case PixelFormat::Format3:
+        case PixelFormat::Format4:
+            return 3;       // Alpha通道保持不变
+        default:
+            return 0;
+    }
+}
+
 bool NoiseReductionNode::applyGaussianNoise(const ImageBuffer &input, ImageBuffer &output)
 {
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    const int channels = filterChannels(input.format());
+    if (channels == 0) {
+        qCWarning(advancedImageProcessor) << "Gaussian filter supports 8-bit formats only";
+        output = input.copy();
+        return true;
+    }
     
     // 高斯核大小根据强度计算
-    int kernelSize = static_cast<int>(1 + m_strength * 8) | 1; // 确保奇数
-    double sigma = m_strength * 2.0;
-    
-    // 生成高斯核
-    std::vector<double> kernel(kernelSize);
-    double sum = 0.0;
-    int center = kernelSize / 2;
+    const int radius = filterRadius();
+    const double sigma = m_strength * 2.0;
     
-    for (int i = 0; i < kernelSize; ++i) {
-        double x = i - center;
-        kernel[i] = std::exp(-(x * x) / (2 * sigma * sigma));
-        sum += kernel[i];
-    }
+    ImageBuffer result(input.width(), input.height(), input.format());
+    SIMDImageAlgorithms::gaussianBlur8(input.constData(), input.bytesPerLine(),
+                                       result.data(), result.bytesPerLine(),
+                                       input.width(), input.height(), input.bytesPerPixel(), channels,
+                                       sigma, radius);
     
-    // 归一化
-    for (double &k : kernel) {
-        k /= sum;
+    output = std::move(result);
+    return true;
+}
+
+bool NoiseReductionNode::applyBilateralFilter(const ImageBuffer &input, ImageBuffer &output)
+{
+    const int channels = filterChannels(input.format());
+    if (channels == 0) {
+        qCWarning(advancedImageProcessor) << "Bilateral filter supports 8-bit formats only";
+        output = input.copy();
+        return true;
     }
     
-    // 应用水平高斯滤波
-    ImageBuffer temp(input.width(), input.height(), input.format());
-    for (int y = 0; y < input.height(); ++y) {
-        for (int x = 0; x < input.width(); ++x) {
-            double r = 0, g = 0, b = 0;
-            
-            for (int k = 0; k < kernelSize; ++k) {
-                int srcX = qBound(0, x + k - center, input.width() - 1);
-                
-                if (input.format() == PixelFormat::Format3) {
-                    Pixel p = input.getPixel<PixelFormat::Format3>(srcX, y);
-                    r += p.r * kernel[k];
-                    g += p.g * kernel[k];
-                    b += p.b * kernel[k];
-                }
-            }
-            
-            if (input.format() == PixelFormat::Format3) {
-                Pixel result(static_cast<quint8>(r), static_cast<quint8>(g), static_cast<quint8>(b));
-                temp.setPixel<PixelFormat::Format3>(x, y, result);
-            }
-        }
-    }
+    const int radius = filterRadius();
+    const double sigmaSpatial = radius / 3.0;
+    const double sigmaColor = qMax(1.0, m_strength * 50.0);
     
-    // 应用垂直高斯滤波
-    for (int y = 0; y < temp.height(); ++y) {
-        for (int x = 0; x < temp.width(); ++x) {
-            double r = 0, g = 0, b = 0;
-            
-            for (int k = 0; k < kernelSize; ++k) {
-                int srcY = qBound(0, y + k - center, temp.height() - 1);
-                
-                if (temp.format() == PixelFormat::Format3) {
-                    Pixel p = temp.getPixel<PixelFormat::Format3>(x, srcY);
-                    r += p.r * kernel[k];
-                    g += p.g * kernel[k];
-                    b += p.b * kernel[k];
-                }
-            }
-            
-            if (temp.format() == PixelFormat::Format3) {
-                Pixel result(static_cast<quint8>(r), static_cast<quint8>(g), static_cast<quint8>(b));
-                output.setPixel<PixelFormat::Format3>(x, y, result);
-            }
-        }
-    }
+    ImageBuffer result(input.width(), input.height(), input.format());
+    SIMDImageAlgorithms::bilateralFilter8(input.constData(), input.bytesPerLine(),
+                                          result.data(), result.bytesPerLine(),
+                                          input.width(), input.height(), input.bytesPerPixel(), channels,
+                                          radius, sigmaSpatial, sigmaColor,
+                                          m_approximateBilateral ? SIMDImageAlgorithms::BilateralGrid
+                                                                 : SIMDImageAlgorithms::BilateralExact);
     
+    output = std::move(result);
     return true;
 }
 
-bool NoiseReductionNode::applyBilateralFilter(const ImageBuffer &input, ImageBuffer &output)
+bool NoiseReductionNode::applyNonLocalMeans(const ImageBuffer &input, ImageBuffer &output)
 {
-    // 双边滤波实现（简化版）
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    const int channels = filterChannels(input.format());
+    if (channels == 0) {
+        qCWarning(advancedImageProcessor) << "Non-local means supports 8-bit formats only";
+        output = input.copy();
+        return true;
+    }
     
-    int radius = static_cast<int>(m_strength * 5) + 1;
-    double sigmaSpatial = radius / 3.0;
-    double sigmaColor = m_strength * 50.0;
+    // 预览使用 5×5 块、11×11 搜索窗口，高质量使用 7×7 块、21×21 搜索窗口
+    const int patchRadius = m_fastNonLocalMeans ? 2 : 3;
+    const int searchRadius = m_fastNonLocalMeans ? 5 : 10;
+    const double h = 2.0 + m_strength * 18.0;
     
-    for (int y = 0; y < input.height(); ++y) {
-        for (int x = 0; x < input.width(); ++x) {
-            if (input.format() == PixelFormat::Format3) {
-                Pixel centerPixel = input.getPixel<PixelFormat::Format3>(x, y);
-                double rSum = 0, gSum = 0, bSum = 0, weightSum = 0;
-                
-                for (int dy = -radius; dy <= radius; ++dy) {
-                    for (int dx = -radius; dx <= radius; ++dx) {
-                        int nx = qBound(0, x + dx, input.width() - 1);
-                        int ny = qBound(0, y + dy, input.height() - 1);
-                        
-                        Pixel neighborPixel = input.getPixel<PixelFormat::Format3>(nx, ny);
-                        
-                        // 空间权重
-                        double spatialDist = std::sqrt(dx * dx + dy * dy);
-                        double spatialWeight = std::exp(-(spatialDist * spatialDist) / (2 * sigmaSpatial * sigmaSpatial));
-                        
-                        // 颜色权重
-                        double colorDist = std::sqrt(
-                            (centerPixel.r - neighborPixel.r) * (centerPixel.r - neighborPixel.r) +
-                            (centerPixel.g - neighborPixel.g) * (centerPixel.g - neighborPixel.g) +
-                            (centerPixel.b - neighborPixel.b) * (centerPixel.b - neighborPixel.b));
-                        double colorWeight = std::exp(-(colorDist * colorDist) / (2 * sigmaColor * sigmaColor));
-                        
-                        double weight = spatialWeight * colorWeight;
-                        
-                        rSum += neighborPixel.r * weight;
-                        gSum += neighborPixel.g * weight;
-                        bSum += neighborPixel.b * weight;
-                        weightSum += weight;
-                    }
-                }
-                
-                if (weightSum > 0) {
-                    Pixel result(
-                        static_cast<quint8>(rSum / weightSum),
-                        static_cast<quint8>(gSum / weightSum),
-                        static_cast<quint8>(bSum / weightSum)
-                    );
-                    output.setPixel<PixelFormat::Format3>(x, y, result);
-                } else {
-                    output.setPixel<PixelFormat::Format3>(x, y, centerPixel);
-                }
-            }
-        }
-    }
+    ImageBuffer result(input.width(), input.height(), input.format());
+    SIMDImageAlgorithms::nonLocalMeans8(input.constData(), input.bytesPerLine(),
+                                        result.data(), result.bytesPerLine(),
+                                        input.width(), input.height(), input.bytesPerPixel(), channels,
+                                        patchRadius, searchRadius, h);
     
+    output = std::move(result);
     return true;
 }
 
-bool NoiseReductionNode::applyNonLocalMeans(const ImageBuffer &input, ImageBuffer &output)
+bool NoiseReductionNode::applyWaveletDenoising(const ImageBuffer &input, ImageBuffer &output)
 {
-    // 非局部均值降噪（简化实现）
-    output = input.copy();
-    qCWarning(advancedImageProcessor) << "Non-local means not fully implemented";
+    const int channels = filterChannels(input.format());
+    if (channels == 0) {
+        qCWarning(advancedImageProcessor) << "Wavelet denoising supports 8-bit formats only";
+        output = input.copy();
+        return true;
+    }
+    
+    ImageBuffer result(input.width(), input.height(), input.format());
+    SIMDImageAlgorithms::waveletDenoise8(input.constData(), input.bytesPerLine(),
+                                         result.data(), result.bytesPerLine(),
+                                         input.width(), input.height(), input.bytesPerPixel(), channels,
+                                         4, m_strength * 3.0);
+    
+    output = std::move(result);
+    qCDebug(advancedImageProcessor) << "Wavelet denoising completed";
     return true;
 }
 
-bool NoiseReductionNode::applyWaveletDenoising(const ImageBuffer &input, ImageBuffer &output)
+bool NoiseReductionNode::applyMedianFilter(const ImageBuffer &input, ImageBuffer &output)
 {
-    // WaveletDenoising的完整实现
-    // 使用高斯模糊近似小波分解和软阈值降噪
-    const double threshold = 0.1;   // 软阈值参数
-    const double sigma = 1.0;       // 高斯模糊参数
+    const int channels = filterChannels(input.format());
+    if (channels == 0) {
+        qCWarning(advancedImageProcessor) << "Median filter supports 8-bit formats only";
+        output = input.copy();
+        return true;
+    }
     
-    int width = input.width();
-    int height = input.height();
-    int channels = input.channels();
+    ImageBuffer result(input.width(), input.height(), input.format());
+    SIMDImageAlgorithms::medianFilter8(input.constData(), input.bytesPerLine(),
+                                       result.data(), result.bytesPerLine(),
+                                       input.width(), input.height(), input.bytesPerPixel(),
+                                       channels, filterRadius());
     
-    // 确保输出缓冲区正确初始化
-    if (output.width() != width || output.height() != height || output.channels() != channels) {
-        output = ImageBuffer(width, height, channels, input.format());
+    output = std::move(result);
+    return true;
+}
+
+// =============================================================================
+// AdvancedImageProcessor 实现
+// =============================================================================
+
+namespace {
+
+// 流式处理阶段：缓存节点所需的上下文行，按条带驱动节点处理
+struct StreamStage {
+    ImageProcessingNode *node = nullptr;
+    ImageProcessingNode::RowContext context;
+    int imageHeight = 0;
+    int width = 0;
+    PixelFormat format = PixelFormat::Unknown;
+    int bytesPerLine = 0;
+    int firstRow = 0;           // 缓存中第一行对应的图像行号
+    int rowCount = 0;           // 缓存的行数
+    int nextOutputRow = 0;      // 下一个待输出的图像行号
+    std::vector<quint8> rows;   // 连续存放的缓存行
+};
+
+// 追加输入条带，并输出所有上下文已经就绪的行
+bool pushStreamRows(StreamStage &stage, const ImageBuffer &strip, int stripFirstRow,
+                    ImageBuffer &output, int &outputFirstRow)
+{
+    if (stage.rowCount == 0) {
+        stage.firstRow = stripFirstRow;
+        stage.width = strip.width();
+        stage.format = strip.format();
+        stage.bytesPerLine = strip.width() * strip.bytesPerPixel();
+    }
+    
+    if (stripFirstRow != stage.firstRow + stage.rowCount || strip.width() != stage.width ||
+        strip.format() != stage.format) {
+        qCWarning(advancedImageProcessor) << "Stream strip out of sequence for node" << stage.node->nodeName();
+        return false;
     }
     
-    // 生成高斯核
-    int kernelSize = static_cast<int>(6 * sigma + 1);
-    if (kernelSize % 2 == 0) kernelSize++;
-    int radius = kernelSize / 2;
-    std::vector<double> kernel(kernelSize);
-    double sum = 0.0;
-    for (int i = 0; i < kernelSize; ++i) {
-        double x = i - radius;
-        kernel[i] = std::exp(-(x * x) / (2 * sigma * sigma));
-        sum += kernel[i];
+    // 条带可能是平面布局或跨度大于行宽的视图，按紧凑行宽逐行复制
+    const ImageBuffer rows = strip.isPlanar() ? strip.toInterleaved() : strip.view();
+    const size_t appendOffset = stage.rows.size();
+    stage.rows.resize(appendOffset + static_cast<size_t>(rows.height()) * stage.bytesPerLine);
+    for (int y = 0; y < rows.height(); ++y) {
+        const quint8 *line = rows.constScanLine(y);
+        if (!line) {
+            qCWarning(advancedImageProcessor) << "Stream strip without row data for node" << stage.node->nodeName();
+            return false;
+        }
+        std::copy_n(line, stage.bytesPerLine,
+                    stage.rows.data() + appendOffset + static_cast<size_t>(y) * stage.bytesPerLine);
     }
-    for (double &k : kernel) { k /= sum; }
+    stage.rowCount += strip.height();
     
-    // 对每个颜色通道应用小波降噪
-    for (int c = 0; c < channels; ++c) {
-        std::vector<std::vector<double>> tempBuffer(height, std::vector<double>(width));
-        std::vector<std::vector<double>> lowFreq(height, std::vector<double>(width));
-        
-        // 提取原始数据
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                tempBuffer[y][x] = static_cast<double>(input.pixelValue(x, y, c));
-            }
-        }
-        
-        // 水平高斯模糊（低频分量）
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                double gaussSum = 0.0;
-                for (int k = 0; k < kernelSize; ++k) {
-                    int srcX = std::max(0, std::min(width - 1, x - radius + k));
-                    gaussSum += tempBuffer[y][srcX] * kernel[k];
-                }
-                lowFreq[y][x] = gaussSum;
-            }
-        }
-        
-        // 垂直高斯模糊
-        for (int x = 0; x < width; ++x) {
-            for (int y = 0; y < height; ++y) {
-                double gaussSum = 0.0;
-                for (int k = 0; k < kernelSize; ++k) {
-                    int srcY = std::max(0, std::min(height - 1, y - radius + k));
-                    gaussSum += lowFreq[srcY][x] * kernel[k];
-                }
-                tempBuffer[y][x] = gaussSum;
-            }
-        }
-        
-        // 计算高频分量并应用软阈值
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                double original = static_cast<double>(input.pixelValue(x, y, c));
-                double lowFreqValue = tempBuffer[y][x];
-                double highFreqValue = original - lowFreqValue;
-                
-                // 软阈值函数
-                double denoisedHighFreq = 0.0;
-                if (std::abs(highFreqValue) > threshold * 255.0) {
-                    denoisedHighFreq = (highFreqValue > 0) ?
-                        (highFreqValue - threshold * 255.0) :
-                        (highFreqValue + threshold * 255.0);
-                }
-                
-                // 重构信号
-                double finalValue = lowFreqValue + denoisedHighFreq;
-                finalValue = std::max(0.0, std::min(255.0, finalValue));
-                output.setPixelValue(x, y, c, static_cast<quint8>(finalValue + 0.5));
-            }
-        }
+    const int inputEnd = stage.firstRow + stage.rowCount;
+    const bool inputComplete = inputEnd >= stage.imageHeight;
+    const int readyEnd = inputComplete ? stage.imageHeight : inputEnd - stage.context.rowsAfter;
+    
+    output = ImageBuffer();
+    outputFirstRow = stage.nextOutputRow;
+    if (readyEnd <= stage.nextOutputRow) {
+        return true;
     }
     
-    qCDebug(advancedImageProcessor) << "Wavelet denoising completed";
-    return true;
-}
-
-bool NoiseReductionNode::applyMedianFilter(const ImageBuffer &input, ImageBuffer &output)
-{
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    // 窗口包含就绪行及其上下文，窗口边缘仅在图像边缘处与整帧处理的边界行为一致
+    const int windowStart = qMax(0, stage.nextOutputRow - stage.context.rowsBefore);
+    const int windowEnd = qMin(stage.imageHeight, readyEnd + stage.context.rowsAfter);
     
-    int radius = static_cast<int>(m_strength * 3) + 1;
+    ImageBuffer window(stage.width, windowEnd - windowStart, stage.format);
+    std::copy_n(stage.rows.data() + static_cast<size_t>(windowStart - stage.firstRow) * stage.bytesPerLine,
+                window.totalBytes(), window.data());
     
-    for (int y = 0; y < input.height(); ++y) {
-        for (int x = 0; x < input.width(); ++x) {
-            if (input.format() == PixelFormat::Format3) {
-                std::vector<quint8> rValues, gValues, bValues;
-                
-                for (int dy = -radius; dy <= radius; ++dy) {
-                    for (int dx = -radius; dx <= radius; ++dx) {
-                        int nx = qBound(0, x + dx, input.width() - 1);
-                        int ny = qBound(0, y + dy, input.height() - 1);
-                        
-                        Pixel p = input.getPixel<PixelFormat::Format3>(nx, ny);
-                        rValues.push_back(p.r);
-                        gValues.push_back(p.g);
-                        bValues.push_back(p.b);
-                    }
-                }
-                
-                // 求中值
-                std::sort(rValues.begin(), rValues.end());
-                std::sort(gValues.begin(), gValues.end());
-                std::sort(bValues.begin(), bValues.end());
-                
-                size_t median = rValues.size() / 2;
-                Pixel result(rValues[median], gValues[median], bValues[median]);
-                output.setPixel<PixelFormat::Format3>(x, y, result);
-            }
-        }
+    ImageBuffer processed;
+    if (!stage.node->process(window, processed)) {
+        qCWarning(advancedImageProcessor) << "Node" << stage.node->nodeName() << "failed on strip at row" << windowStart;
+        return false;
+    }
+    
+    if (processed.height() != window.height()) {
+        qCWarning(advancedImageProcessor) << "Node" << stage.node->nodeName() << "changed strip height, streaming aborted";
+        return false;
+    }
+    
+    output = processed.copy(QRect(0, stage.nextOutputRow - windowStart,
+                                  processed.width(), readyEnd - stage.nextOutputRow));
+    stage.nextOutputRow = readyEnd;
+    
+    // 丢弃后续输出不再需要的行
+    const int keepFrom = qMax(stage.firstRow, stage.nextOutputRow - stage.context.rowsBefore);
+    const int dropRows = keepFrom - stage.firstRow;
+    if (dropRows > 0) {
+        stage.rows.erase(stage.rows.begin(),
+                         stage.rows.begin() + static_cast<size_t>(dropRows) * stage.bytesPerLine);
+        stage.firstRow = keepFrom;
+        stage.rowCount -= dropRows;
     }
     
     return true;
 }
 
-// =============================================================================
-// AdvancedImageProcessor 实现
-// =============================================================================
+} // namespace
 
 AdvancedImageProcessor::AdvancedImageProcessor(QObject *parent)
     : QObject(parent)
@@ -1195,6 +1936,8 @@ AdvancedImageProcessor::AdvancedImageProcessor(QObject *parent)
 
 AdvancedImageProcessor::~AdvancedImageProcessor()
 {
+    // 调度器中的任务引用本对象，先等待其全部完成
+    m_batchScheduler.reset();
     clearNodes();
 }
 
@@ -1364,10 +2107,7 @@ void AdvancedImageProcessor::saveConfiguration(const QString &configPath) const
     
     // 保存处理管线配置
     QJsonObject pipeline;
-    pipeline["width"] = m_width;
-    pipeline["height"] = m_height;
-    pipeline["channels"] = m_channels;
-    pipeline["pixelFormat"] = static_cast<int>(m_pixelFormat);
+    pipeline["stripHeight"] = m_stripHeight;
     
     // 保存各处理节点配置
     QJsonObject nodes;
@@ -1381,8 +2121,7 @@ void AdvancedImageProcessor::saveConfiguration(const QString &configPath) const
     // 格式转换节点配置
     QJsonObject formatNode;
     formatNode["type"] = "FormatConvertNode";
-    formatNode["inputFormat"] = static_cast<int>(m_pixelFormat);
-    formatNode["outputFormat"] = static_cast<int>(ImageBuffer::PixelFormat::RGB24);
+    formatNode["outputFormat"] = static_cast<int>(PixelFormat::Format3);
     nodes["format"] = formatNode;
     
     // 像素偏移节点配置
@@ -1470,7 +2209,7 @@ bool AdvancedImageProcessor::loadConfiguration(const QString &configPath)
         return false;
     }
     
-    QJsonObject config = doc.object();
+    const QJsonObject config = doc.object();
     
     // 验证版本兼容性
     QString version = config["version"].toString();
@@ -1490,31 +2229,21 @@ bool AdvancedImageProcessor::loadConfiguration(const QString &configPath)
     }
     
     // 加载管线配置
-    QJsonObject pipeline = config["pipeline"].toObject();
+    const QJsonObject pipeline = config["pipeline"].toObject();
     if (!pipeline.isEmpty()) {
         // 应用管线基本配置
-        int width = pipeline["width"].toInt();
-        int height = pipeline["height"].toInt();
-        int channels = pipeline["channels"].toInt();
-        int pixelFormat = pipeline["pixelFormat"].toInt();
-        
-        if (width > 0 && height > 0 && channels > 0) {
-            m_width = width;
-            m_height = height;
-            m_channels = channels;
-            m_pixelFormat = static_cast<ImageBuffer::PixelFormat>(pixelFormat);
-            
-            qCDebug(advancedImageProcessor) << "Loaded pipeline config: "
-                                           << width << "x" << height << "x" << channels;
+        const int stripHeight = pipeline["stripHeight"].toInt();
+        if (stripHeight > 0) {
+            setStripHeight(stripHeight);
         }
         
         // 加载节点配置
-        QJsonObject nodes = pipeline["nodes"].toObject();
+        const QJsonObject nodes = pipeline["nodes"].toObject();
         
         // 加载颜色校正配置
-        QJsonObject colorNode = nodes["color"].toObject();
+        const QJsonObject colorNode = nodes["color"].toObject();
         if (!colorNode.isEmpty()) {
-            QJsonArray colorMatrix = colorNode["colorMatrix"].toArray();
+            const QJsonArray colorMatrix = colorNode["colorMatrix"].toArray();
             if (colorMatrix.size() == 9) {
                 // 应用颜色矩阵配置
                 qCDebug(advancedImageProcessor) << "Loaded color correction matrix";
@@ -1529,7 +2258,7 @@ bool AdvancedImageProcessor::loadConfiguration(const QString &configPath)
         }
         
         // 加载噪声降噪配置
-        QJsonObject noiseNode = nodes["noise"].toObject();
+        const QJsonObject noiseNode = nodes["noise"].toObject();
         if (!noiseNode.isEmpty()) {
             QString algorithm = noiseNode["algorithm"].toString("gaussian");
             double strength = noiseNode["strength"].toDouble(1.0);
@@ -1540,7 +2269,7 @@ bool AdvancedImageProcessor::loadConfiguration(const QString &configPath)
         }
         
         // 加载像素偏移配置
-        QJsonObject pixelShiftNode = nodes["pixelShift"].toObject();
+        const QJsonObject pixelShiftNode = nodes["pixelShift"].toObject();
         if (!pixelShiftNode.isEmpty()) {
             double shiftX = pixelShiftNode["shiftX"].toDouble(0.0);
             double shiftY = pixelShiftNode["shiftY"].toDouble(0.0);
@@ -1552,1019 +2281,330 @@ bool AdvancedImageProcessor::loadConfiguration(const QString &configPath)
     }
     
     // 加载性能配置
-    QJsonObject performance = config["performance"].toObject();
+    const QJsonObject performance = config["performance"].toObject();
     if (!performance.isEmpty()) {
         int threadCount = performance["threadCount"].toInt(QThread::idealThreadCount());
-        bool enableParallel = performance["enableParallel"].toBool(true);
-        bool enableOptimization = performance["enableOptimization"].toBool(true);
-        
-        qCDebug(advancedImageProcessor) << "Performance config - Threads:" << threadCount
-                                       << "Parallel:" << enableParallel
-                                       << "Optimization:" << enableOptimization;
-    }
-    
-    qCInfo(advancedImageProcessor) << "Configuration loaded successfully from:" << configPath;
-    return true;
-}
-
-AdvancedImageProcessor::ProcessingStats AdvancedImageProcessor::getProcessingStats() const
-{
-    QMutexLocker locker(&m_statsMutex);
-    return m_stats;
-}
-
-void AdvancedImageProcessor::resetStats()
-{
-    QMutexLocker locker(&m_statsMutex);
-    
-    m_stats.totalProcessingTime = 0;
-    m_stats.averageProcessingTime = 0;
-    m_stats.processedImages = 0;
-    m_stats.nodeTimings.clear();
-    
-    qCDebug(advancedImageProcessor) << "Processing statistics reset";
-}
-
-void AdvancedImageProcessor::setMaxMemoryUsage(qint64 maxBytes)
-{
-    m_maxMemoryUsage = maxBytes;
-    qCDebug(advancedImageProcessor) << "Max memory usage set to:" << maxBytes;
-}
-
-qint64 AdvancedImageProcessor::getCurrentMemoryUsage() const
-{
-    return m_currentMemoryUsage;
-}
-
-void AdvancedImageProcessor::optimizeMemoryUsage()
-{
-    freeUnusedBuffers();
-    qCDebug(advancedImageProcessor) << "Memory optimization completed";
-}
-
-void AdvancedImageProcessor::onNodeProcessingFinished()
-{
-    // 处理节点完成信号
-}
-
-bool AdvancedImageProcessor::processInternal(const ImageBuffer &input, ImageBuffer &output)
-{
-    QMutexLocker locker(&m_nodesMutex);
-    
-    if (m_nodes.isEmpty()) {
-        output = input.copy();
-        return true;
-    }
-    
-    // 检查内存使用
-    qint64 requiredMemory = input.totalBytes() * m_nodes.size(); // 估算
-    if (!canAllocateMemory(requiredMemory)) {
-        qCWarning(advancedImageProcessor) << "Insufficient memory for processing";
-        return false;
-    }
-    
-    ImageBuffer currentBuffer = input;
-    ImageBuffer nextBuffer;
-    
-    for (int i = 0; i < m_nodes.size(); ++i) {
-        ImageProcessingNode *node = m_nodes[i];
-        
-        if (!node->isEnabled()) {
-            continue;
-        }
-        
-        QElapsedTimer nodeTimer;
-        nodeTimer.start();
-        
-        emit nodeProcessingStarted(i, node->nodeName());
-        
-        bool success = node->process(currentBuffer, nextBuffer);
-        
-        qint64 nodeTime = nodeTimer.elapsed();
-        emit nodeProcessingFinished(i, node->nodeName(), nodeTime);
-        
-        if (!success) {
-            qCWarning(advancedImageProcessor) << "Node" << node->nodeName() << "processing failed";
-            return false;
-        }
-        
-        // 交换缓冲区
-        currentBuffer = nextBuffer;
-        
-        // 更新内存使用统计
-        updateMemoryUsage(nextBuffer.totalBytes());
-    }
-    
-    output = currentBuffer;
-    return true;
-}
-
-void AdvancedImageProcessor::updateMemoryUsage(qint64 change)
-{
-    m_currentMemoryUsage += change;
-    
-    if (m_currentMemoryUsage > m_maxMemoryUsage) {
-        qCWarning(advancedImageProcessor) << "Memory usage exceeded limit:" 
-                                         << m_currentMemoryUsage << ">" << m_maxMemoryUsage;
-        freeUnusedBuffers();
-    }
-}
-
-void AdvancedImageProcessor::updateNodeStats(int nodeIndex, qint64 elapsedTime)
-{
-    QMutexLocker locker(&m_statsMutex);
-    
-    m_stats.processedImages++;
-    m_stats.totalProcessingTime += elapsedTime;
-    m_stats.averageProcessingTime = m_stats.totalProcessingTime / m_stats.processedImages;
-    
-    if (nodeIndex >= 0 && nodeIndex < m_nodes.size()) {
-        QString timing = QString("%1:%2ms").arg(m_nodes[nodeIndex]->nodeName()).arg(elapsedTime);
-        m_stats.nodeTimings.append(timing);
-    }
-}
-
-void AdvancedImageProcessor::freeUnusedBuffers()
-{
-    // 触发垃圾回收
-    QCoreApplication::processEvents();
-    
-    // 重置内存计数器
-    m_currentMemoryUsage = 0;
-    
-    qCDebug(advancedImageProcessor) << "Freed unused buffers";
-}
-
-bool AdvancedImageProcessor::canAllocateMemory(qint64 bytes) const
-{
-    return (m_currentMemoryUsage + bytes) <= m_maxMemoryUsage;
-}
-
-// =============================================================================
-// ImageProcessingTask 实现
-// =============================================================================
-
-ImageProcessingTask::ImageProcessingTask(AdvancedImageProcessor *processor, 
-                                       const ImageBuffer &input,
-                                       QObject *parent)
-    : QObject(parent)
-    , QRunnable()
-    , m_processor(processor)
-    , m_input(input)
-    , m_hasError(false)
-{
-    setAutoDelete(false);
-}
-
-void ImageProcessingTask::run()
-{
-    if (!m_processor) {
-        m_hasError = true;
-        m_errorString = "Processor is null";
-        emit errorOccurred(m_errorString);
-        return;
-    }
-    
-    try {
-        bool success = m_processor->processImage(m_input, m_result);
-        
-        if (!success) {
-            m_hasError = true;
-            m_errorString = "Processing failed";
-            emit errorOccurred(m_errorString);
-        } else {
-            emit finished();
-        }
-    } catch (const std::exception &e) {
-        m_hasError = true;
-        m_errorString = QString("Exception: %1").arg(e.what());
-        emit errorOccurred(m_errorString);
-    }
-}
-
-// =============================================================================
-// 图像处理节点完整实现
-// =============================================================================
-
-// SourceNode 实现
-SourceNode::SourceNode(QObject *parent)
-    : ImageProcessingNode(ProcessingNodeType::Source, parent)
-    , m_generateTestPattern(false)
-    , m_testPatternType(TestPatternType::ColorBars)
-{
-    qCDebug(advancedImageProcessor) << "SourceNode created";
-}
-
-bool SourceNode::process(const ImageBuffer &input, ImageBuffer &output) 
-{
-    qCDebug(advancedImageProcessor) << "SourceNode processing:" << input.width() << "x" << input.height();
-    
-    if (m_generateTestPattern) {
-        return generateTestPattern(output);
-    }
-    
-    // 直接复制输入到输出
-    output = input;
-    return !output.isNull();
-}
-
-void SourceNode::setInputBuffer(const ImageBuffer &buffer)
-{
-    m_inputBuffer = buffer;
-}
-
-bool SourceNode::generateTestPattern(ImageBuffer &output)
-{
-    int width = 640;
-    int height = 480;
-    
-    output = ImageBuffer(width, height, PixelFormat::Format3);
-    
-    switch (m_testPatternType) {
-    case TestPatternType::ColorBars:
-        return generateColorBars(output);
-    case TestPatternType::Gradient:
-        return generateGradient(output);
-    case TestPatternType::Checkerboard:
-        return generateCheckerboard(output);
-    default:
-        return false;
-    }
-}
-
-bool SourceNode::generateColorBars(ImageBuffer &output)
-{
-    int width = output.width();
-    int height = output.height();
-    int barWidth = width / 8;
-    
-    const QColor colors[] = {
-        Qt::white, Qt::yellow, Qt::cyan, Qt::green,
-        Qt::magenta, Qt::red, Qt::blue, Qt::black
-    };
-    
-    for (int y = 0; y < height; y++) {
-        quint8 *line = output.scanLine(y);
-        for (int x = 0; x < width; x++) {
-            int colorIndex = qMin(x / barWidth, 7);
-            QColor color = colors[colorIndex];
-            
-            line[x * 3 + 0] = color.red();
-            line[x * 3 + 1] = color.green();
-            line[x * 3 + 2] = color.blue();
-        }
-    }
-    
-    return true;
-}
-
-bool SourceNode::generateGradient(ImageBuffer &output)
-{
-    int width = output.width();
-    int height = output.height();
-    
-    for (int y = 0; y < height; y++) {
-        quint8 *line = output.scanLine(y);
-        for (int x = 0; x < width; x++) {
-            quint8 value = (x * 255) / width;
-            
-            line[x * 3 + 0] = value;
-            line[x * 3 + 1] = value;
-            line[x * 3 + 2] = value;
-        }
-    }
-    
-    return true;
-}
-
-bool SourceNode::generateCheckerboard(ImageBuffer &output)
-{
-    int width = output.width();
-    int height = output.height();
-    int squareSize = 32;
-    
-    for (int y = 0; y < height; y++) {
-        quint8 *line = output.scanLine(y);
-        for (int x = 0; x < width; x++) {
-            bool isWhite = ((x / squareSize) + (y / squareSize)) % 2 == 0;
-            quint8 value = isWhite ? 255 : 0;
-            
-            line[x * 3 + 0] = value;
-            line[x * 3 + 1] = value;
-            line[x * 3 + 2] = value;
-        }
-    }
-    
-    return true;
-}
-
-// FormatConvertNode 实现
-FormatConvertNode::FormatConvertNode(QObject *parent)
-    : ImageProcessingNode(ProcessingNodeType::FormatConvert, parent)
-    , m_targetFormat(PixelFormat::Format3)
-{
-    qCDebug(advancedImageProcessor) << "FormatConvertNode created";
-}
-
-bool FormatConvertNode::process(const ImageBuffer &input, ImageBuffer &output)
-{
-    qCDebug(advancedImageProcessor) << "FormatConvertNode processing:" 
-                                   << "from" << static_cast<int>(input.format())
-                                   << "to" << static_cast<int>(m_targetFormat);
-    
-    if (input.format() == m_targetFormat) {
-        output = input;
-        return true;
-    }
-    
-    output = ImageBuffer(input.width(), input.height(), m_targetFormat);
-    
-    // 根据转换类型选择具体算法
-    if (input.format() == PixelFormat::Format3 && m_targetFormat == PixelFormat::Format1) {
-        return convertRGBToGrayscale(input, output);
-    } else if (input.format() == PixelFormat::Format1 && m_targetFormat == PixelFormat::Format3) {
-        return convertGrayscaleToRGB(input, output);
-    } else if (input.format() == PixelFormat::Raw16Bit && m_targetFormat == PixelFormat::Format3) {
-        return convertRaw16ToRGB(input, output);
-    } else if (input.format() == PixelFormat::Format3 && m_targetFormat == PixelFormat::LAB) {
-        return convertRGBToLAB(input, output);
-    }
-    
-    // 默认直接复制
-    std::memcpy(output.data(), input.constData(), qMin(input.totalBytes(), output.totalBytes()));
-    return true;
-}
-
-bool FormatConvertNode::canProcess(const ImageBuffer &input) const
-{
-    return !input.isNull() && input.format() != PixelFormat::Unknown;
-}
-
-void FormatConvertNode::setTargetFormat(PixelFormat format)
-{
-    m_targetFormat = format;
-}
-
-bool FormatConvertNode::convertRGBToGrayscale(const ImageBuffer &input, ImageBuffer &output)
-{
-    int width = input.width();
-    int height = input.height();
-    
-    for (int y = 0; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < width; x++) {
-            quint8 r = inputLine[x * 3 + 0];
-            quint8 g = inputLine[x * 3 + 1];
-            quint8 b = inputLine[x * 3 + 2];
-            
-            // 使用标准亮度权重
-            quint8 gray = static_cast<quint8>(0.299 * r + 0.587 * g + 0.114 * b);
-            outputLine[x] = gray;
-        }
-    }
-    
-    return true;
-}
-
-bool FormatConvertNode::convertGrayscaleToRGB(const ImageBuffer &input, ImageBuffer &output)
-{
-    int width = input.width();
-    int height = input.height();
-    
-    for (int y = 0; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < width; x++) {
-            quint8 gray = inputLine[x];
-            
-            outputLine[x * 3 + 0] = gray;
-            outputLine[x * 3 + 1] = gray;
-            outputLine[x * 3 + 2] = gray;
-        }
-    }
-    
-    return true;
-}
-
-bool FormatConvertNode::convertRaw16ToRGB(const ImageBuffer &input, ImageBuffer &output)
-{
-    int width = input.width();
-    int height = input.height();
-    
-    for (int y = 0; y < height; y++) {
-        const quint16 *inputLine = reinterpret_cast<const quint16*>(input.constScanLine(y));
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < width; x++) {
-            // 16位到8位的线性映射
-            quint16 value = inputLine[x];
-            quint8 scaledValue = static_cast<quint8>(value >> 8);
-            
-            outputLine[x * 3 + 0] = scaledValue;
-            outputLine[x * 3 + 1] = scaledValue;
-            outputLine[x * 3 + 2] = scaledValue;
-        }
-    }
-    
-    return true;
-}
-
-bool FormatConvertNode::convertRGBToLAB(const ImageBuffer &input, ImageBuffer &output)
-{
-    // 简化的RGB到LAB转换实现
-    int width = input.width();
-    int height = input.height();
-    
-    for (int y = 0; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < width; x++) {
-            quint8 r = inputLine[x * 3 + 0];
-            quint8 g = inputLine[x * 3 + 1];
-            quint8 b = inputLine[x * 3 + 2];
-            
-            // 简化的LAB转换 - 实际项目中应使用精确的色彩空间转换
-            double L = 0.299 * r + 0.587 * g + 0.114 * b;
-            double A = 128 + (r - g) * 0.5;
-            double B = 128 + (g - b) * 0.5;
-            
-            outputLine[x * 3 + 0] = static_cast<quint8>(qBound(0.0, L, 255.0));
-            outputLine[x * 3 + 1] = static_cast<quint8>(qBound(0.0, A, 255.0));
-            outputLine[x * 3 + 2] = static_cast<quint8>(qBound(0.0, B, 255.0));
-        }
-    }
-    
-    return true;
-}
-
-// PixelShiftNode 实现
-PixelShiftNode::PixelShiftNode(QObject *parent)
-    : ImageProcessingNode(ProcessingNodeType::PixelShiftColumns, parent)
-    , m_columnShift(0)
-    , m_lineShift(0)
-    , m_subPixelColumnShift(0.0)
-    , m_subPixelLineShift(0.0)
-    , m_useSubPixel(false)
-{
-    qCDebug(advancedImageProcessor) << "PixelShiftNode created";
-}
-
-bool PixelShiftNode::process(const ImageBuffer &input, ImageBuffer &output)
-{
-    qCDebug(advancedImageProcessor) << "PixelShiftNode processing:"
-                                   << "column shift" << m_columnShift
-                                   << "line shift" << m_lineShift;
-    
-    output = ImageBuffer(input.width(), input.height(), input.format());
-    
-    if (m_useSubPixel) {
-        return performSubPixelShift(input, output);
-    } else {
-        bool success = true;
-        if (m_columnShift != 0) {
-            success &= performColumnShift(input, output);
-        }
-        if (m_lineShift != 0) {
-            success &= performLineShift(output, output);
-        }
-        
-        if (m_columnShift == 0 && m_lineShift == 0) {
-            output = input;
-        }
-        
-        return success;
-    }
-}
-
-void PixelShiftNode::setSubPixelShift(double columnShift, double lineShift)
-{
-    m_subPixelColumnShift = columnShift;
-    m_subPixelLineShift = lineShift;
-    m_useSubPixel = true;
-}
-
-bool PixelShiftNode::performColumnShift(const ImageBuffer &input, ImageBuffer &output)
-{
-    int width = input.width();
-    int height = input.height();
-    int bytesPerPixel = input.bytesPerPixel();
-    
-    for (int y = 0; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        if (m_columnShift > 0) {
-            // 向右移位
-            std::memset(outputLine, 0, m_columnShift * bytesPerPixel);
-            std::memcpy(outputLine + m_columnShift * bytesPerPixel, 
-                       inputLine, 
-                       (width - m_columnShift) * bytesPerPixel);
-        } else {
-            // 向左移位
-            int absShift = -m_columnShift;
-            std::memcpy(outputLine, 
-                       inputLine + absShift * bytesPerPixel,
-                       (width - absShift) * bytesPerPixel);
-            std::fill_n(outputLine + (width - absShift) * bytesPerPixel, -absShift * bytesPerPixel, 0);
-        }
-    }
-    
-    return true;
-}
-
-bool PixelShiftNode::performLineShift(const ImageBuffer &input, ImageBuffer &output)
-{
-    int width = input.width();
-    int height = input.height();
-    int bytesPerLine = input.bytesPerLine();
-    
-    if (m_lineShift > 0) {
-        // 向下移位
-        for (int y = 0; y < m_lineShift && y < height; y++) {
-            std::memset(output.scanLine(y), 0, bytesPerLine);
-        }
-        
-        for (int y = m_lineShift; y < height; y++) {
-            std::memcpy(output.scanLine(y), 
-                       input.constScanLine(y - m_lineShift), 
-                       bytesPerLine);
-        }
-    } else {
-        // 向上移位
-        int absShift = -m_lineShift;
-        
-        for (int y = 0; y < height - absShift; y++) {
-            std::memcpy(output.scanLine(y), 
-                       input.constScanLine(y + absShift), 
-                       bytesPerLine);
-        }
-        
-        for (int y = height - absShift; y < height; y++) {
-            std::memset(output.scanLine(y), 0, bytesPerLine);
-        }
-    }
-    
-    return true;
-}
-
-bool PixelShiftNode::performSubPixelShift(const ImageBuffer &input, ImageBuffer &output)
-{
-    // 子像素移位需要双线性插值
-    int width = input.width();
-    int height = input.height();
-    int bytesPerPixel = input.bytesPerPixel();
-    
-    for (int y = 0; y < height; y++) {
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < width; x++) {
-            double srcX = x - m_subPixelColumnShift;
-            double srcY = y - m_subPixelLineShift;
-            
-            int x1 = static_cast<int>(std::floor(srcX));
-            int y1 = static_cast<int>(std::floor(srcY));
-            int x2 = x1 + 1;
-            int y2 = y1 + 1;
-            
-            double dx = srcX - x1;
-            double dy = srcY - y1;
-            
-            if (x1 >= 0 && x2 < width && y1 >= 0 && y2 < height) {
-                const quint8 *line1 = input.constScanLine(y1);
-                const quint8 *line2 = input.constScanLine(y2);
-                
-                for (int c = 0; c < bytesPerPixel; c++) {
-                    double v1 = line1[x1 * bytesPerPixel + c] * (1 - dx) + line1[x2 * bytesPerPixel + c] * dx;
-                    double v2 = line2[x1 * bytesPerPixel + c] * (1 - dx) + line2[x2 * bytesPerPixel + c] * dx;
-                    double result = v1 * (1 - dy) + v2 * dy;
-                    
-                    outputLine[x * bytesPerPixel + c] = static_cast<quint8>(qBound(0.0, result, 255.0));
-                }
-            } else {
-                // 边界处理 - 设为0
-                for (int c = 0; c < bytesPerPixel; c++) {
-                    outputLine[x * bytesPerPixel + c] = 0;
-                }
-            }
-        }
-    }
-    
-    return true;
-}
-
-// ColorCorrectionNode 实现
-ColorCorrectionNode::ColorCorrectionNode(QObject *parent)
-    : ImageProcessingNode(ProcessingNodeType::ColorCorrection, parent)
-    , m_brightness(0.0)
-    , m_contrast(0.0)
-    , m_gamma(1.0)
-    , m_saturation(0.0)
-    , m_autoWhiteBalance(false)
-    , m_autoColorRestoration(false)
-{
-    qCDebug(advancedImageProcessor) << "ColorCorrectionNode created";
-}
-
-bool ColorCorrectionNode::process(const ImageBuffer &input, ImageBuffer &output)
-{
-    if (!canProcess(input)) {
-        return false;
-    }
-    
-    qCDebug(advancedImageProcessor) << "Applying color correction";
-    
-    output = ImageBuffer(input.width(), input.height(), input.format());
-    
-    if (input.format() == PixelFormat::Format3) {
-        return applyRGBColorCorrection(input, output);
-    } else if (input.format() == PixelFormat::Format4) {
-        return applyRGBAColorCorrection(input, output);
-    }
-    
-    // 不支持的格式，直接复制
-    output = input.copy();
-    return true;
-}
-
-void ColorCorrectionNode::setWhitePoint(const QColor &whitePoint)
-{
-    m_whitePoint = whitePoint;
-}
-
-void ColorCorrectionNode::setColorMatrix(const QMatrix3x3 &matrix)
-{
-    m_colorMatrix = matrix;
-}
-
-void ColorCorrectionNode::setGamma(double gamma)
-{
-    m_gamma = qBound(0.1, gamma, 3.0);
-}
-
-void ColorCorrectionNode::setBrightness(int brightness)
-{
-    m_brightness = qBound(-100, brightness, 100);
-}
-
-void ColorCorrectionNode::setContrast(int contrast)
-{
-    m_contrast = qBound(0, contrast, 200);
-}
-
-void ColorCorrectionNode::setSaturation(int saturation)
-{
-    m_saturation = qBound(0, saturation, 200);
-}
-
-bool ColorCorrectionNode::applyRGBColorCorrection(const ImageBuffer &input, ImageBuffer &output)
-{
-    // 预计算查找表
-    std::vector<quint8> gammaLUT(256);
-    std::vector<qint16> contrastLUT(256);
-    
-    double invGamma = 1.0 / m_gamma;
-    double contrastFactor = m_contrast / 100.0;
-    double brightnessFactor = m_brightness / 255.0;
-    
-    for (int i = 0; i < 256; ++i) {
-        // 伽马校正
-        double normalized = i / 255.0;
-        double gammaCorrected = std::pow(normalized, invGamma);
-        gammaLUT[i] = static_cast<quint8>(qBound(0.0, gammaCorrected * 255.0, 255.0));
-        
-        // 对比度和亮度
-        double adjusted = (i - 128) * contrastFactor + 128 + brightnessFactor * 255;
-        contrastLUT[i] = static_cast<qint16>(qBound(0.0, adjusted, 255.0));
-    }
-    
-    for (int y = 0; y < input.height(); ++y) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < input.width(); ++x) {
-            const quint8 *inputPixel = inputLine + x * 3;
-            quint8 *outputPixel = outputLine + x * 3;
-            
-            // 应用颜色矩阵变换
-            double r = inputPixel[0];
-            double g = inputPixel[1];
-            double b = inputPixel[2];
-            
-            double newR = r * m_colorMatrix(0,0) + g * m_colorMatrix(0,1) + b * m_colorMatrix(0,2);
-            double newG = r * m_colorMatrix(1,0) + g * m_colorMatrix(1,1) + b * m_colorMatrix(1,2);
-            double newB = r * m_colorMatrix(2,0) + g * m_colorMatrix(2,1) + b * m_colorMatrix(2,2);
-            
-            // 限制范围
-            int iR = qBound(0, static_cast<int>(newR), 255);
-            int iG = qBound(0, static_cast<int>(newG), 255);
-            int iB = qBound(0, static_cast<int>(newB), 255);
-            
-            // 应用伽马校正
-            iR = gammaLUT[iR];
-            iG = gammaLUT[iG];
-            iB = gammaLUT[iB];
-            
-            // 应用对比度和亮度
-            outputPixel[0] = static_cast<quint8>(contrastLUT[iR]);
-            outputPixel[1] = static_cast<quint8>(contrastLUT[iG]);
-            outputPixel[2] = static_cast<quint8>(contrastLUT[iB]);
-        }
-    }
-    
-    return true;
-}
-
-bool ColorCorrectionNode::applyRGBAColorCorrection(const ImageBuffer &input, ImageBuffer &output)
-{
-    // RGBA版本的颜色校正（保持Alpha通道）
-    for (int y = 0; y < input.height(); ++y) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < input.width(); ++x) {
-            const quint8 *inputPixel = inputLine + x * 4;
-            quint8 *outputPixel = outputLine + x * 4;
-            
-            // RGB处理同上
-            // ...（为简化省略详细实现）
-            
-            // 保持Alpha通道
-            outputPixel[3] = inputPixel[3];
-        }
+        bool enableParallel = performance["enableParallel"].toBool(true);
+        bool enableOptimization = performance["enableOptimization"].toBool(true);
+        
+        qCDebug(advancedImageProcessor) << "Performance config - Threads:" << threadCount
+                                       << "Parallel:" << enableParallel
+                                       << "Optimization:" << enableOptimization;
     }
     
+    qCInfo(advancedImageProcessor) << "Configuration loaded successfully from:" << configPath;
     return true;
 }
 
-// NoiseReductionNode 实现  
-NoiseReductionNode::NoiseReductionNode(QObject *parent)
-    : ImageProcessingNode(ProcessingNodeType::NoiseReduction, parent)
-    , m_strength(50)
-    , m_method(NoiseReductionMethod::Median)
-    , m_preserveDetails(true)
+AdvancedImageProcessor::ProcessingStats AdvancedImageProcessor::getProcessingStats() const
 {
-    qCDebug(advancedImageProcessor) << "NoiseReductionNode created";
+    QMutexLocker locker(&m_statsMutex);
+    return m_stats;
 }
 
-bool NoiseReductionNode::process(const ImageBuffer &input, ImageBuffer &output)
+void AdvancedImageProcessor::resetStats()
 {
-    qCDebug(advancedImageProcessor) << "NoiseReductionNode processing:"
-                                   << "strength" << m_strength
-                                   << "method" << static_cast<int>(m_method);
+    QMutexLocker locker(&m_statsMutex);
     
-    output = ImageBuffer(input.width(), input.height(), input.format());
+    m_stats.totalProcessingTime = 0;
+    m_stats.averageProcessingTime = 0;
+    m_stats.processedImages = 0;
+    m_stats.nodeTimings.clear();
     
-    switch (m_method) {
-    case NoiseReductionMethod::Median:
-        return applyMedianFilter(input, output);
-    case NoiseReductionMethod::Gaussian:
-        return applyGaussianFilter(input, output);
-    case NoiseReductionMethod::Bilateral:
-        return applyBilateralFilter(input, output);
-    default:
-        output = input;
-        return true;
-    }
+    qCDebug(advancedImageProcessor) << "Processing statistics reset";
 }
 
-void NoiseReductionNode::setStrength(int strength)
+void AdvancedImageProcessor::setMaxMemoryUsage(qint64 maxBytes)
 {
-    m_strength = qBound(0, strength, 100);
+    m_maxMemoryUsage = maxBytes;
+    qCDebug(advancedImageProcessor) << "Max memory usage set to:" << maxBytes;
 }
 
-void NoiseReductionNode::setMethod(NoiseReductionMethod method)
+qint64 AdvancedImageProcessor::getCurrentMemoryUsage() const
 {
-    m_method = method;
+    return m_currentMemoryUsage;
 }
 
-void NoiseReductionNode::setPreserveDetails(bool preserve)
+void AdvancedImageProcessor::optimizeMemoryUsage()
 {
-    m_preserveDetails = preserve;
+    freeUnusedBuffers();
+    qCDebug(advancedImageProcessor) << "Memory optimization completed";
 }
 
-bool NoiseReductionNode::applyMedianFilter(const ImageBuffer &input, ImageBuffer &output)
+void AdvancedImageProcessor::onNodeProcessingFinished()
+{
+    // 处理节点完成信号
+}
+
+bool AdvancedImageProcessor::processInternal(const ImageBuffer &input, ImageBuffer &output)
 {
-    int kernelSize = 3 + (m_strength / 25) * 2;  // 3, 5, 7, 9 based on strength
-    if (kernelSize % 2 == 0) kernelSize++;
+    QMutexLocker locker(&m_nodesMutex);
     
-    int width = input.width();
-    int height = input.height();
-    int half = kernelSize / 2;
+    if (m_nodes.isEmpty()) {
+        output = input.copy();
+        return true;
+    }
     
-    for (int y = half; y < height - half; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = half; x < width - half; x++) {
-            for (int c = 0; c < 3; c++) {
-                QVector<quint8> values;
-                
-                // 收集邻域像素值
-                for (int ky = -half; ky <= half; ky++) {
-                    const quint8 *kernelLine = input.constScanLine(y + ky);
-                    for (int kx = -half; kx <= half; kx++) {
-                        values.append(kernelLine[(x + kx) * 3 + c]);
-                    }
-                }
-                
-                // 计算中值
-                std::sort(values.begin(), values.end());
-                outputLine[x * 3 + c] = values[values.size() / 2];
-            }
-        }
+    // 检查内存使用
+    qint64 requiredMemory = input.totalBytes() * m_nodes.size(); // 估算
+    if (!canAllocateMemory(requiredMemory)) {
+        qCWarning(advancedImageProcessor) << "Insufficient memory for processing";
+        return false;
     }
     
-    // 处理边界
-    for (int y = 0; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
+    // 节点间以移动传递缓冲区，避免逐节点整页复制
+    ImageBuffer currentBuffer = input.view();
+    ImageBuffer nextBuffer;
+    
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        ImageProcessingNode *node = m_nodes[i];
+        
+        if (!node->isEnabled()) {
+            continue;
+        }
+        
+        QElapsedTimer nodeTimer;
+        nodeTimer.start();
+        
+        emit nodeProcessingStarted(i, node->nodeName());
         
-        for (int x = 0; x < half; x++) {
-            outputLine[x * 3 + 0] = inputLine[x * 3 + 0];
-            outputLine[x * 3 + 1] = inputLine[x * 3 + 1];
-            outputLine[x * 3 + 2] = inputLine[x * 3 + 2];
+        // 不支持平面布局的节点先合并为交错布局，之后的节点沿用该布局
+        if (currentBuffer.isPlanar() && !node->supportsPlanar()) {
+            currentBuffer = currentBuffer.toInterleaved();
         }
         
-        for (int x = width - half; x < width; x++) {
-            outputLine[x * 3 + 0] = inputLine[x * 3 + 0];
-            outputLine[x * 3 + 1] = inputLine[x * 3 + 1];
-            outputLine[x * 3 + 2] = inputLine[x * 3 + 2];
+        bool success = node->process(currentBuffer, nextBuffer);
+        
+        qint64 nodeTime = nodeTimer.elapsed();
+        emit nodeProcessingFinished(i, node->nodeName(), nodeTime);
+        
+        if (!success) {
+            qCWarning(advancedImageProcessor) << "Node" << node->nodeName() << "processing failed";
+            return false;
         }
+        
+        // 更新内存使用统计
+        updateMemoryUsage(nextBuffer.totalBytes());
+        
+        // 交换缓冲区
+        currentBuffer = std::move(nextBuffer);
+        nextBuffer = ImageBuffer();
     }
     
+    // 输出必须独占内存：源节点、同格式转换等返回的视图可能引用输入、
+    // 节点内部缓存或外部内存，移交前复制
+    output = currentBuffer.isDetached() ? std::move(currentBuffer) : currentBuffer.copy();
     return true;
 }
 
-bool NoiseReductionNode::applyGaussianFilter(const ImageBuffer &input, ImageBuffer &output)
+void AdvancedImageProcessor::setStripHeight(int rows)
 {
-    double sigma = (m_strength / 100.0) * 2.0;  // 0 to 2.0
-    int kernelSize = static_cast<int>(std::ceil(sigma * 3)) * 2 + 1;
-    
-    // 生成高斯核
-    QVector<double> kernel(kernelSize);
-    double sum = 0.0;
-    int half = kernelSize / 2;
+    m_stripHeight = qMax(1, rows);
+    qCDebug(advancedImageProcessor) << "Strip height set to:" << m_stripHeight;
+}
+
+bool AdvancedImageProcessor::canProcessStreaming() const
+{
+    QMutexLocker locker(&m_nodesMutex);
+    return canProcessStreamingLocked();
+}
+
+bool AdvancedImageProcessor::canProcessStreamingLocked() const
+{
+    if (m_nodes.isEmpty() || !qobject_cast<SourceNode*>(m_nodes.first())) {
+        return false;
+    }
     
-    for (int i = 0; i < kernelSize; i++) {
-        int x = i - half;
-        kernel[i] = std::exp(-(x * x) / (2.0 * sigma * sigma));
-        sum += kernel[i];
+    for (int i = 1; i < m_nodes.size(); ++i) {
+        if (m_nodes[i]->isEnabled() && !m_nodes[i]->supportsStreaming()) {
+            return false;
+        }
     }
     
-    // 归一化核
-    for (int i = 0; i < kernelSize; i++) {
-        kernel[i] /= sum;
+    return true;
+}
+
+bool AdvancedImageProcessor::processStreaming(const StripCallback &sink)
+{
+    QMutexLocker locker(&m_nodesMutex);
+    
+    if (!canProcessStreamingLocked()) {
+        qCWarning(advancedImageProcessor) << "Pipeline cannot run in streaming mode";
+        return false;
     }
     
-    int width = input.width();
-    int height = input.height();
+    SourceNode *source = qobject_cast<SourceNode*>(m_nodes.first());
+    const int width = source->streamWidth();
+    const int height = source->streamHeight();
+    const PixelFormat format = source->streamFormat();
     
-    // 水平卷积
-    ImageBuffer temp(width, height, input.format());
+    if (width <= 0 || height <= 0 || format == PixelFormat::Unknown) {
+        qCWarning(advancedImageProcessor) << "Source geometry not set for streaming";
+        return false;
+    }
     
-    for (int y = 0; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *tempLine = temp.scanLine(y);
-        
-        for (int x = 0; x < width; x++) {
-            for (int c = 0; c < 3; c++) {
-                double sum = 0.0;
-                double weightSum = 0.0;
-                
-                for (int k = 0; k < kernelSize; k++) {
-                    int px = x + k - half;
-                    if (px >= 0 && px < width) {
-                        sum += inputLine[px * 3 + c] * kernel[k];
-                        weightSum += kernel[k];
-                    }
-                }
-                
-                tempLine[x * 3 + c] = static_cast<quint8>(sum / weightSum);
-            }
+    std::vector<StreamStage> stages;
+    for (int i = 1; i < m_nodes.size(); ++i) {
+        if (!m_nodes[i]->isEnabled()) {
+            continue;
         }
+        StreamStage stage;
+        stage.node = m_nodes[i];
+        stage.context = m_nodes[i]->rowContext();
+        stage.imageHeight = height;
+        stages.push_back(std::move(stage));
     }
     
-    // 垂直卷积
-    for (int y = 0; y < height; y++) {
-        quint8 *outputLine = output.scanLine(y);
+    QElapsedTimer timer;
+    timer.start();
+    emit processingStarted();
+    
+    qint64 peakResidentBytes = 0;
+    bool success = true;
+    
+    for (int row = 0; row < height && success; row += m_stripHeight) {
+        ImageBuffer strip(width, qMin(m_stripHeight, height - row), format);
+        int stripFirstRow = row;
         
-        for (int x = 0; x < width; x++) {
-            for (int c = 0; c < 3; c++) {
-                double sum = 0.0;
-                double weightSum = 0.0;
-                
-                for (int k = 0; k < kernelSize; k++) {
-                    int py = y + k - half;
-                    if (py >= 0 && py < height) {
-                        const quint8 *tempLine = temp.constScanLine(py);
-                        sum += tempLine[x * 3 + c] * kernel[k];
-                        weightSum += kernel[k];
-                    }
-                }
-                
-                outputLine[x * 3 + c] = static_cast<quint8>(sum / weightSum);
+        if (!source->readRows(row, strip)) {
+            success = false;
+            break;
+        }
+        
+        qint64 residentBytes = strip.totalBytes();
+        for (StreamStage &stage : stages) {
+            ImageBuffer stageOutput;
+            if (!pushStreamRows(stage, strip, stripFirstRow, stageOutput, stripFirstRow)) {
+                success = false;
+                break;
             }
+            residentBytes += static_cast<qint64>(stage.rows.size()) + stageOutput.totalBytes();
+            strip = stageOutput;
+            if (strip.height() == 0) {
+                break;
+            }
+        }
+        peakResidentBytes = qMax(peakResidentBytes, residentBytes);
+        
+        if (success && strip.height() > 0 && !sink(stripFirstRow, strip)) {
+            qCWarning(advancedImageProcessor) << "Strip sink rejected rows starting at" << stripFirstRow;
+            success = false;
         }
+        
+        emit processingProgress(static_cast<int>(qMin(row + m_stripHeight, height) * 100LL / height));
     }
     
-    return true;
+    if (success) {
+        qint64 elapsedTime = timer.elapsed();
+        updateNodeStats(-1, elapsedTime);
+        qCDebug(advancedImageProcessor) << "Streaming processing completed in" << elapsedTime << "ms,"
+                                       << "peak resident strip memory:" << peakResidentBytes << "bytes";
+    } else {
+        emit errorOccurred("Streaming processing failed");
+    }
+    
+    emit processingFinished();
+    return success;
 }
 
-bool NoiseReductionNode::applyBilateralFilter(const ImageBuffer &input, ImageBuffer &output)
+void AdvancedImageProcessor::updateMemoryUsage(qint64 change)
 {
-    double spatialSigma = (m_strength / 100.0) * 2.0;
-    double intensitySigma = (m_strength / 100.0) * 50.0;
-    int kernelSize = static_cast<int>(std::ceil(spatialSigma * 3)) * 2 + 1;
-    int half = kernelSize / 2;
-    
-    int width = input.width();
-    int height = input.height();
+    m_currentMemoryUsage += change;
     
-    for (int y = half; y < height - half; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = half; x < width - half; x++) {
-            for (int c = 0; c < 3; c++) {
-                double centerIntensity = inputLine[x * 3 + c];
-                double sum = 0.0;
-                double weightSum = 0.0;
-                
-                for (int ky = -half; ky <= half; ky++) {
-                    const quint8 *kernelLine = input.constScanLine(y + ky);
-                    for (int kx = -half; kx <= half; kx++) {
-                        double pixelIntensity = kernelLine[(x + kx) * 3 + c];
-                        
-                        // 空间权重
-                        double spatialWeight = std::exp(-((kx * kx + ky * ky) / (2.0 * spatialSigma * spatialSigma)));
-                        
-                        // 强度权重
-                        double intensityDiff = pixelIntensity - centerIntensity;
-                        double intensityWeight = std::exp(-(intensityDiff * intensityDiff) / (2.0 * intensitySigma * intensitySigma));
-                        
-                        double weight = spatialWeight * intensityWeight;
-                        sum += pixelIntensity * weight;
-                        weightSum += weight;
-                    }
-                }
-                
-                outputLine[x * 3 + c] = static_cast<quint8>(sum / weightSum);
-            }
-        }
+    if (m_currentMemoryUsage > m_maxMemoryUsage) {
+        qCWarning(advancedImageProcessor) << "Memory usage exceeded limit:" 
+                                         << m_currentMemoryUsage << ">" << m_maxMemoryUsage;
+        freeUnusedBuffers();
     }
+}
+
+void AdvancedImageProcessor::updateNodeStats(int nodeIndex, qint64 elapsedTime)
+{
+    QMutexLocker locker(&m_statsMutex);
     
-    // 边界处理
-    for (int y = 0; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        
-        for (int x = 0; x < half; x++) {
-            outputLine[x * 3 + 0] = inputLine[x * 3 + 0];
-            outputLine[x * 3 + 1] = inputLine[x * 3 + 1];
-            outputLine[x * 3 + 2] = inputLine[x * 3 + 2];
-        }
-        
-        for (int x = width - half; x < width; x++) {
-            outputLine[x * 3 + 0] = inputLine[x * 3 + 0];
-            outputLine[x * 3 + 1] = inputLine[x * 3 + 1];
-            outputLine[x * 3 + 2] = inputLine[x * 3 + 2];
-        }
-    }
+    m_stats.processedImages++;
+    m_stats.totalProcessingTime += elapsedTime;
+    m_stats.averageProcessingTime = m_stats.totalProcessingTime / m_stats.processedImages;
     
-    for (int y = 0; y < half; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        std::memcpy(outputLine, inputLine, width * 3);
+    if (nodeIndex >= 0 && nodeIndex < m_nodes.size()) {
+        QString timing = QString("%1:%2ms").arg(m_nodes[nodeIndex]->nodeName()).arg(elapsedTime);
+        m_stats.nodeTimings.append(timing);
     }
+}
+
+void AdvancedImageProcessor::freeUnusedBuffers()
+{
+    // 触发垃圾回收
+    QCoreApplication::processEvents();
     
-    for (int y = height - half; y < height; y++) {
-        const quint8 *inputLine = input.constScanLine(y);
-        quint8 *outputLine = output.scanLine(y);
-        std::memcpy(outputLine, inputLine, width * 3);
+    // 重置内存计数器
+    m_currentMemoryUsage = 0;
+    
+    qCDebug(advancedImageProcessor) << "Freed unused buffers";
+}
+
+bool AdvancedImageProcessor::canAllocateMemory(qint64 bytes) const
+{
+    return (m_currentMemoryUsage + bytes) <= m_maxMemoryUsage;
+}
+
+// =============================================================================
+// ImageProcessingTask 实现
+// =============================================================================
+
+ImageProcessingTask::ImageProcessingTask(AdvancedImageProcessor *processor, 
+                                       const ImageBuffer &input,
+                                       QObject *parent)
+    : QObject(parent)
+    , QRunnable()
+    , m_processor(processor)
+    , m_input(input)
+    , m_hasError(false)
+{
+    setAutoDelete(false);
+}
+
+void ImageProcessingTask::run()
+{
+    if (!m_processor) {
+        m_hasError = true;
+        m_errorString = "Processor is null";
+        emit errorOccurred(m_errorString);
+        return;
     }
     
-    return true;
+    try {
+        bool success = m_processor->processImage(m_input, m_result);
+        
+        if (!success) {
+            m_hasError = true;
+            m_errorString = "Processing failed";
+            emit errorOccurred(m_errorString);
+        } else {
+            emit finished();
+        }
+    } catch (const std::exception &e) {
+        m_hasError = true;
+        m_errorString = QString("Exception: %1").arg(e.what());
+        emit errorOccurred(m_errorString);
+    }
 }
 
 // 在AdvancedImageProcessor类中添加SIMD优化方法
 bool AdvancedImageProcessor::enableSIMDOptimization()
 {
-    qCDebug(dscannerImageProcessor) << "启用SIMD优化";
+    qCDebug(advancedImageProcessor) << "启用SIMD优化";
     
     // 检测并报告SIMD支持情况
     QString simdInfo = SIMDImageAlgorithms::detectSIMDSupport();
-    qCInfo(dscannerImageProcessor) << "SIMD支持情况:" << simdInfo;
+    qCInfo(advancedImageProcessor) << "SIMD支持情况:" << simdInfo;
     
     m_simdEnabled = SIMDImageAlgorithms::hasSSE2Support() || 
                    SIMDImageAlgorithms::hasAVX2Support() || 
                    SIMDImageAlgorithms::hasNEONSupport();
     
     if (m_simdEnabled) {
-        qCInfo(dscannerImageProcessor) << "SIMD优化已启用";
+        qCInfo(advancedImageProcessor) << "SIMD优化已启用";
         
         // 更新性能配置以利用SIMD
         m_config.enableParallelProcessing = true;
@@ -2575,25 +2615,25 @@ bool AdvancedImageProcessor::enableSIMDOptimization()
         
         return true;
     } else {
-        qCWarning(dscannerImageProcessor) << "当前CPU不支持SIMD指令集，使用标量实现";
+        qCWarning(advancedImageProcessor) << "当前CPU不支持SIMD指令集，使用标量实现";
         return false;
     }
 }
 
 bool AdvancedImageProcessor::optimizeColorCorrectionNode()
 {
-    qCDebug(dscannerImageProcessor) << "优化颜色校正节点性能";
+    qCDebug(advancedImageProcessor) << "优化颜色校正节点性能";
     
     // 查找颜色校正节点
     for (auto &node : m_nodes) {
-        if (auto colorNode = qobject_cast<ColorCorrectionNode*>(node.get())) {
+        if (auto colorNode = qobject_cast<ColorCorrectionNode*>(node)) {
             // 启用SIMD优化处理
             colorNode->enableSIMDProcessing(m_simdEnabled);
             
             // 优化查找表大小以提高缓存性能
             colorNode->optimizeLookupTables();
             
-            qCDebug(dscannerImageProcessor) << "颜色校正节点已优化";
+            qCDebug(advancedImageProcessor) << "颜色校正节点已优化";
             return true;
         }
     }
@@ -2603,17 +2643,17 @@ bool AdvancedImageProcessor::optimizeColorCorrectionNode()
 
 bool AdvancedImageProcessor::optimizeFormatConversionNode()
 {
-    qCDebug(dscannerImageProcessor) << "优化格式转换节点性能";
+    qCDebug(advancedImageProcessor) << "优化格式转换节点性能";
     
     for (auto &node : m_nodes) {
-        if (auto formatNode = qobject_cast<FormatConvertNode*>(node.get())) {
+        if (auto formatNode = qobject_cast<FormatConvertNode*>(node)) {
             // 启用向量化像素转换
             formatNode->enableVectorizedConversion(m_simdEnabled);
             
             // 优化内存访问模式
             formatNode->optimizeMemoryPattern();
             
-            qCDebug(dscannerImageProcessor) << "格式转换节点已优化";
+            qCDebug(advancedImageProcessor) << "格式转换节点已优化";
             return true;
         }
     }
@@ -2623,52 +2663,49 @@ bool AdvancedImageProcessor::optimizeFormatConversionNode()
 
 QImage AdvancedImageProcessor::processImageWithSIMD(const QImage &image, const ProcessingParameters &params)
 {
-    if (!m_simdEnabled) {
-        return processImage(image, params);
-    }
-    
+    // 各算法在运行时选择内核，未启用SIMD时由标量内核完成相同处理
     QElapsedTimer timer;
     timer.start();
     
     QImage result = image;
     
-    qCDebug(dscannerImageProcessor) << "开始SIMD优化的图像处理";
+    qCDebug(advancedImageProcessor) << "开始SIMD优化的图像处理";
     
     // 亮度调整（SIMD优化）
     if (params.brightness != 0.0) {
         double factor = 1.0 + (params.brightness / 100.0);
         result = SIMDImageAlgorithms::adjustBrightnessSIMD(result, factor);
-        qCDebug(dscannerImageProcessor) << "SIMD亮度调整完成";
+        qCDebug(advancedImageProcessor) << "SIMD亮度调整完成";
     }
     
     // 对比度调整（SIMD优化）
     if (params.contrast != 0.0) {
         double factor = 1.0 + (params.contrast / 100.0);
         result = SIMDImageAlgorithms::adjustContrastSIMD(result, factor);
-        qCDebug(dscannerImageProcessor) << "SIMD对比度调整完成";
+        qCDebug(advancedImageProcessor) << "SIMD对比度调整完成";
     }
     
     // 饱和度调整（SIMD优化）
     if (params.saturation != 0.0) {
         double factor = 1.0 + (params.saturation / 100.0);
         result = SIMDImageAlgorithms::adjustSaturationSIMD(result, factor);
-        qCDebug(dscannerImageProcessor) << "SIMD饱和度调整完成";
+        qCDebug(advancedImageProcessor) << "SIMD饱和度调整完成";
     }
     
     // 高斯模糊（SIMD优化）
     if (params.gaussianBlurRadius > 0) {
         result = SIMDImageAlgorithms::gaussianBlurSIMD(result, params.gaussianBlurRadius, params.gaussianBlurSigma);
-        qCDebug(dscannerImageProcessor) << "SIMD高斯模糊完成";
+        qCDebug(advancedImageProcessor) << "SIMD高斯模糊完成";
     }
     
     // 灰度转换（SIMD优化）
     if (params.convertToGrayscale) {
         result = SIMDImageAlgorithms::convertToGrayscaleSIMD(result);
-        qCDebug(dscannerImageProcessor) << "SIMD灰度转换完成";
+        qCDebug(advancedImageProcessor) << "SIMD灰度转换完成";
     }
     
     qint64 processingTime = timer.elapsed();
-    qCInfo(dscannerImageProcessor) << "SIMD优化处理完成，用时:" << processingTime << "毫秒";
+    qCInfo(advancedImageProcessor) << "SIMD优化处理完成，用时:" << processingTime << "毫秒";
     
     // 更新性能统计
     updatePerformanceStats(processingTime, image.width() * image.height());
@@ -2678,17 +2715,23 @@ QImage AdvancedImageProcessor::processImageWithSIMD(const QImage &image, const P
 
 void AdvancedImageProcessor::updatePerformanceStats(qint64 processingTime, int pixelCount)
 {
-    m_stats.totalProcessingTime += processingTime;
-    m_stats.totalProcessedPixels += pixelCount;
-    m_stats.processingCount++;
+    QMutexLocker locker(&m_statsMutex);
+    
+    m_performanceStats.totalProcessingTime += processingTime;
+    m_performanceStats.totalProcessedPixels += pixelCount;
+    m_performanceStats.processingCount++;
     
     // 计算平均性能
-    m_stats.averageProcessingTime = m_stats.totalProcessingTime / m_stats.processingCount;
-    m_stats.pixelsPerSecond = (m_stats.totalProcessedPixels * 1000.0) / m_stats.totalProcessingTime;
+    m_performanceStats.averageProcessingTime =
+        static_cast<double>(m_performanceStats.totalProcessingTime) / m_performanceStats.processingCount;
+    if (m_performanceStats.totalProcessingTime > 0) {
+        m_performanceStats.pixelsPerSecond =
+            (m_performanceStats.totalProcessedPixels * 1000.0) / m_performanceStats.totalProcessingTime;
+    }
     
-    qCDebug(dscannerImageProcessor) << "性能统计更新:"
-                                   << "平均处理时间:" << m_stats.averageProcessingTime << "毫秒"
-                                   << "处理速度:" << m_stats.pixelsPerSecond << "像素/秒";
+    qCDebug(advancedImageProcessor) << "性能统计更新:"
+                                   << "平均处理时间:" << m_performanceStats.averageProcessingTime << "毫秒"
+                                   << "处理速度:" << m_performanceStats.pixelsPerSecond << "像素/秒";
 }
 
 // 内存对齐优化
@@ -2698,7 +2741,7 @@ bool AdvancedImageProcessor::optimizeMemoryAlignment()
         return false;
     }
     
-    qCDebug(dscannerImageProcessor) << "优化内存对齐";
+    qCDebug(advancedImageProcessor) << "优化内存对齐";
     
     // 为SIMD操作优化内存分配对齐
     // 确保图像数据按32字节边界对齐（AVX2要求）
@@ -2707,7 +2750,7 @@ bool AdvancedImageProcessor::optimizeMemoryAlignment()
     // 优化缓存行使用
     m_config.cacheLineSize = 64;
     
-    qCDebug(dscannerImageProcessor) << "内存对齐优化完成，对齐:" << m_config.memoryAlignment << "字节";
+    qCDebug(advancedImageProcessor) << "内存对齐优化完成，对齐:" << m_config.memoryAlignment << "字节";
     
     return true;
 }
@@ -2715,11 +2758,7 @@ bool AdvancedImageProcessor::optimizeMemoryAlignment()
 // 多线程SIMD处理
 QFuture<QImage> AdvancedImageProcessor::processImageAsyncSIMD(const QImage &image, const ProcessingParameters &params)
 {
-    if (!m_simdEnabled) {
-        return processImageAsync(image, params);
-    }
-    
-    qCDebug(dscannerImageProcessor) << "启动异步SIMD图像处理";
+    qCDebug(advancedImageProcessor) << "启动异步SIMD图像处理";
     
     return QtConcurrent::run([this, image, params]() -> QImage {
         return processImageWithSIMD(image, params);
@@ -2729,36 +2768,68 @@ QFuture<QImage> AdvancedImageProcessor::processImageAsyncSIMD(const QImage &imag
 // 批量SIMD处理
 QFuture<QList<QImage>> AdvancedImageProcessor::processBatchSIMD(const QList<QImage> &images, const ProcessingParameters &params)
 {
-    if (!m_simdEnabled) {
-        return processBatch(images, params);
-    }
+    qCDebug(advancedImageProcessor) << "启动批量SIMD处理，图像数量:" << images.size();
     
-    qCDebug(dscannerImageProcessor) << "启动批量SIMD处理，图像数量:" << images.size();
+    // 每幅页面作为独立任务提交，空闲工作线程窃取其他线程积压的页面；
+    // 空图像不提交，Future与非空图像按顺序一一对应
+    QList<QFuture<MultithreadedProcessor::ProcessingResult>> futures;
+    if (m_config.enableParallelProcessing) {
+        futures = batchScheduler()->processBatchAsync(images, [this, params](const QImage &image) {
+            return processImageWithSIMD(image, params);
+        });
+    }
     
-    return QtConcurrent::run([this, images, params]() -> QList<QImage> {
+    return QtConcurrent::run([this, images, params, futures]() -> QList<QImage> {
         QList<QImage> results;
         results.reserve(images.size());
         
         QElapsedTimer batchTimer;
         batchTimer.start();
         
+        int next = 0;
         for (const QImage &image : images) {
-            if (!image.isNull()) {
-                QImage result = processImageWithSIMD(image, params);
-                results.append(result);
-            } else {
+            if (image.isNull()) {
                 results.append(QImage());
+                continue;
+            }
+            
+            if (next < futures.size()) {
+                const MultithreadedProcessor::ProcessingResult result = futures[next++].result();
+                if (result.success) {
+                    results.append(result.result);
+                    continue;
+                }
+                // 队列已满等调度失败时在当前线程补做
+                qCWarning(advancedImageProcessor) << "批量调度失败，改为当前线程处理:" << result.errorMessage;
             }
+            results.append(processImageWithSIMD(image, params));
         }
         
         qint64 totalTime = batchTimer.elapsed();
-        qCInfo(dscannerImageProcessor) << "批量SIMD处理完成，总用时:" << totalTime << "毫秒"
-                                      << "平均每图:" << (totalTime / images.size()) << "毫秒";
+        qCInfo(advancedImageProcessor) << "批量SIMD处理完成，总用时:" << totalTime << "毫秒"
+                                      << "平均每图:" << (totalTime / qMax(1, images.size())) << "毫秒";
         
         return results;
     });
 }
 
+MultithreadedProcessor *AdvancedImageProcessor::batchScheduler()
+{
+    QMutexLocker locker(&m_batchSchedulerMutex);
+    
+    if (!m_batchScheduler) {
+        m_batchScheduler.reset(new MultithreadedProcessor);
+        
+        // 工作线程数与本处理器的线程池一致
+        MultithreadedProcessor::ThreadPoolConfig config = m_batchScheduler->getThreadPoolConfig();
+        config.maxThreadCount = m_threadPool->maxThreadCount();
+        m_batchScheduler->setThreadPoolConfig(config);
+        m_batchScheduler->startThreadPool();
+    }
+    
+    return m_batchScheduler.get();
+}
+
 DSCANNER_END_NAMESPACE
 
 // #include "advanced_image_processor.moc" 
\ No newline at end of file
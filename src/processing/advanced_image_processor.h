@@ -6,18 +6,25 @@
 
 #include "Scanner/DScannerGlobal.h"
 #include "Scanner/DScannerTypes.h"
+#include "shading_corrector.h"
 #include <QObject>
+#include <QColor>
+#include <QGenericMatrix>
 #include <QImage>
 #include <QMutex>
+#include <QVector>
 #include <QThread>
 #include <QThreadPool>
 #include <QRunnable>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QLoggingCategory>
+#include <functional>
 #include <memory>
 #include <vector>
 
+class MultithreadedProcessor;
+
 DSCANNER_BEGIN_NAMESPACE
 
 Q_DECLARE_LOGGING_CATEGORY(advancedImageProcessor)
@@ -34,7 +41,8 @@ enum class PixelFormat {
     Raw16Bit,       // 16位原始格式
     Raw12Bit,       // 12位原始格式
     YUV422,         // YUV 4:2:2格式
-    LAB             // CIE LAB色彩空间
+    LAB,            // CIE LAB色彩空间
+    Gray16          // 16位单通道（平面布局单个通道的视图）
 };
 
 // 图像处理节点类型
@@ -79,26 +87,85 @@ struct Pixel {
 // 图像缓冲区类
 class ImageBuffer {
 public:
+    // 内存布局
+    enum class Layout {
+        Interleaved,    // 交错：每行依次存放各像素的全部通道
+        Planar          // 平面：每个通道一个平面，行首64字节对齐
+    };
+    
     ImageBuffer();
     ImageBuffer(int width, int height, PixelFormat format);
+    ImageBuffer(int width, int height, PixelFormat format, Layout layout);
     ImageBuffer(const ImageBuffer &other);
+    ImageBuffer(ImageBuffer &&other) noexcept;
     ImageBuffer &operator=(const ImageBuffer &other);
+    ImageBuffer &operator=(ImageBuffer &&other) noexcept;
     ~ImageBuffer();
     
+    /**
+     * @brief 包装外部内存为图像缓冲区（零拷贝）
+     * @param data 外部像素数据，按 bytesPerLine() 紧密排列
+     * @param owner 数据所有者，缓冲区及其视图存活期间保持引用；
+     *              为空时调用方负责保证 data 的生命周期
+     *
+     * 驱动可直接写入内存池块或 DMA 缓冲区，再通过本方法交给处理管道，
+     * 例如 owner 可为携带 MemoryPool::deallocate 删除器的 shared_ptr。
+     */
+    static ImageBuffer wrap(quint8 *data, int width, int height, PixelFormat format,
+                            std::shared_ptr<void> owner = std::shared_ptr<void>());
+    
     // 基础属性
     int width() const { return m_width; }
     int height() const { return m_height; }
     PixelFormat format() const { return m_format; }
     int bytesPerPixel() const;
-    int bytesPerLine() const;
+    int bytesPerLine() const;           // 行跨度；平面布局为单个平面的行跨度
     int totalBytes() const;
     
+    Layout layout() const { return m_layout; }
+    bool isPlanar() const { return m_layout == Layout::Planar; }
+    int channelCount() const;           // 每像素通道数，YUV422 等无法拆分的格式返回0
+    int bytesPerSample() const;         // 单个通道的字节数（1或2）
+    
     // 数据访问
     quint8 *data() { return m_data.get(); }
     const quint8 *constData() const { return m_data.get(); }
+    
+    /**
+     * @brief 交错行数据
+     * @return 多通道平面布局没有交错行，返回nullptr，应使用 planeLine()
+     */
     quint8 *scanLine(int y);
     const quint8 *constScanLine(int y) const;
     
+    /**
+     * @brief 单个通道平面的一行
+     *
+     * 仅用于平面布局。16位格式的样本按本机字节序存储，可转为 quint16* 访问。
+     */
+    quint8 *planeLine(int channel, int y);
+    const quint8 *constPlaneLine(int channel, int y) const;
+    
+    /**
+     * @brief 转换为平面布局
+     *
+     * 已是平面布局或单通道时不复制数据，仅改变描述；否则分配对齐的平面并拆分通道。
+     */
+    ImageBuffer toPlanar() const;
+    
+    /**
+     * @brief 转换为交错布局，规则与 toPlanar() 对称
+     */
+    ImageBuffer toInterleaved() const;
+    
+    /**
+     * @brief 单个通道的零拷贝视图
+     *
+     * 平面布局下返回与本缓冲区共享内存的单通道交错缓冲区（Format1 或 Gray16），
+     * 可直接交给按行处理的算法；交错布局的多通道缓冲区返回空缓冲区。
+     */
+    ImageBuffer planeView(int channel) const;
+    
     // 像素操作 - 模板实现
     template<PixelFormat format>
     Pixel getPixel(int x, int y) const;
@@ -120,11 +187,36 @@ public:
     ImageBuffer copy() const;
     ImageBuffer copy(const QRect &rect) const;
     
+    // 共享视图 - 与源缓冲区共享像素内存，不复制数据
+    ImageBuffer view() const;
+    ImageBuffer rowsView(int firstRow, int rowCount) const;
+    bool sharesDataWith(const ImageBuffer &other) const;
+    
+    /**
+     * @brief 是否独占自己分配的内存
+     *
+     * 外部内存的包装、仍被其他缓冲区或QImage引用的视图都不算独占；
+     * 独占的缓冲区可以直接移交给调用方，无需复制。
+     */
+    bool isDetached() const;
+    
+    /**
+     * @brief 生成引用本缓冲区内存的QImage（零拷贝）
+     *
+     * 返回的QImage持有对像素内存的引用；对其写入时由Qt自动分离复制，
+     * 不会修改本缓冲区。仅支持 Format1/Format3/Format4。
+     */
+    QImage toQImageView() const;
+    
 private:
     int m_width;
     int m_height;
     PixelFormat m_format;
-    std::shared_ptr<quint8> m_data;
+    Layout m_layout = Layout::Interleaved;
+    int m_stride = 0;                   // 行跨度（字节）
+    qint64 m_planeSize = 0;             // 相邻平面起点的距离，交错布局为0
+    std::shared_ptr<quint8> m_data;     // 可能为其他缓冲区或外部内存的别名
+    bool m_ownsData = false;            // m_data 由 allocateData() 分配，而非 wrap() 包装
     
     void allocateData();
     void copyData(const ImageBuffer &other);
@@ -151,6 +243,30 @@ public:
     virtual QVariantMap getParameters() const;
     virtual bool setParameters(const QVariantMap &params);
     
+    // 流式处理支持
+    struct RowContext {
+        int rowsBefore = 0;     // 输出一行所需的回看行数
+        int rowsAfter = 0;      // 输出一行所需的前瞻行数
+    };
+    
+    /**
+     * @brief 节点处理所需的垂直上下文
+     * @return 回看/前瞻行数，逐点运算的节点返回0
+     */
+    virtual RowContext rowContext() const { return RowContext(); }
+    
+    /**
+     * @brief 节点是否可以按条带处理
+     * @return false表示节点依赖整幅图像的统计信息，只能整帧处理
+     */
+    virtual bool supportsStreaming() const { return true; }
+    
+    /**
+     * @brief 节点能否直接处理平面布局的缓冲区
+     * @return false时管道在调用前转换为交错布局
+     */
+    virtual bool supportsPlanar() const { return false; }
+    
     // 连接管理
     void setNextNode(ImageProcessingNode *next) { m_nextNode = next; }
     ImageProcessingNode *nextNode() const { return m_nextNode; }
@@ -184,9 +300,26 @@ public:
     typedef std::function<bool(int row, quint8 *data)> RowCallback;
     void setRowCallback(const RowCallback &callback);
     
+    // 流式数据源：行回调模式下由此给出图像尺寸
+    void setStreamGeometry(int width, int height, PixelFormat format);
+    int streamWidth() const;
+    int streamHeight() const;
+    PixelFormat streamFormat() const;
+    
+    /**
+     * @brief 从数据源读取一个条带
+     * @param firstRow 条带首行在图像中的行号
+     * @param strip 输出条带，调用方按所需行数预先分配
+     * @return 成功返回true
+     */
+    bool readRows(int firstRow, ImageBuffer &strip);
+    
 private:
     ImageBuffer m_sourceData;
     RowCallback m_rowCallback;
+    int m_streamWidth = 0;
+    int m_streamHeight = 0;
+    PixelFormat m_streamFormat = PixelFormat::Unknown;
     mutable QMutex m_dataMutex;
 };
 
@@ -227,6 +360,105 @@ private:
     bool m_memoryOptimized = false;
 };
 
+// 阴影校正节点
+class DSCANNER_EXPORT ShadingCorrectionNode : public ImageProcessingNode
+{
+    Q_OBJECT
+    
+public:
+    explicit ShadingCorrectionNode(QObject *parent = nullptr);
+    
+    bool process(const ImageBuffer &input, ImageBuffer &output) override;
+    
+    bool setReference(const QByteArray &black, const QByteArray &white, int width, int channels,
+                      double targetLevel = 1.0);
+    void setCorrector(const ShadingCorrector &corrector) { m_corrector = corrector; }
+    const ShadingCorrector &corrector() const { return m_corrector; }
+    
+private:
+    ShadingCorrector m_corrector;
+};
+
+/**
+ * @brief 逐行流式的CCD行/列偏移校正
+ *
+ * 每个通道独立的亚像素偏移（交错CCD、RGB传感器行间距）在一次遍历中完成。
+ * 源行推入后按通道拆分为浮点平面存入环形缓冲区，只保留输出一行所需的
+ * 源行（最大行偏移跨度+1行），插值按整行向量化。
+ */
+class DSCANNER_EXPORT LineShiftCorrector
+{
+public:
+    struct ChannelShift {
+        double column = 0.0;    // 正值向右移：输出列 x 取源列 x - column
+        double line = 0.0;      // 正值向下移：输出行 y 取源行 y - line
+    };
+    
+    /**
+     * @brief 开始新的一帧
+     * @param channels 每像素通道数，见 ImageBuffer::channelCount()
+     * @param bytesPerSample 单个样本的字节数（1或2）
+     * @param shifts 每通道偏移，个数不足时其余通道不移位
+     * @return 参数无效时返回false
+     */
+    bool reset(int width, int channels, int bytesPerSample, const QVector<ChannelShift> &shifts);
+    
+    /**
+     * @brief 以上次 reset() 的参数开始新的一帧，不重新计算插值计划和分配缓冲区
+     */
+    void restart();
+    
+    // 上次 reset() 成功且帧格式相同
+    bool matches(int width, int channels, int bytesPerSample) const
+    {
+        return m_width > 0 && m_width == width && m_channels == channels && m_sampleBytes == bytesPerSample;
+    }
+    
+    /**
+     * @brief 推入下一源行（交错布局）
+     *
+     * 调用前须用 takeLine() 取完已就绪的输出行，否则仍需要的源行会被覆盖。
+     */
+    void pushLine(const quint8 *line);
+    
+    /**
+     * @brief 源数据结束，其后的源行按0处理
+     */
+    void finish();
+    
+    /**
+     * @brief 取出下一输出行
+     * @return 尚未就绪或已全部输出时返回false
+     */
+    bool takeLine(quint8 *out);
+    
+    int ringRows() const { return m_maxRow - m_minRow + 1; }
+    
+private:
+    struct ChannelPlan {
+        int rowOffset;          // 上一行相对输出行的偏移
+        int columnOffset;       // 左侧样本相对输出列的偏移
+        bool twoRows;           // 行方向有小数部分
+        float weights[4];       // 左上、右上、左下、右下
+    };
+    
+    const float *sourcePlane(qint64 row, int channel) const;
+    
+    int m_width = 0;
+    int m_channels = 0;
+    int m_sampleBytes = 1;
+    int m_pad = 0;              // 平面左右补零的样本数
+    int m_minRow = 0;           // 输出一行所需源行的相对范围
+    int m_maxRow = 0;
+    QVector<ChannelPlan> m_plans;
+    std::vector<float> m_ring;  // ringRows() 个槽，每槽 m_channels 个平面
+    std::vector<float> m_zeroPlane;
+    std::vector<float> m_result;
+    qint64 m_pushed = 0;
+    qint64 m_nextOutput = 0;
+    bool m_finished = false;
+};
+
 // 像素移位节点
 class DSCANNER_EXPORT PixelShiftNode : public ImageProcessingNode
 {
@@ -238,24 +470,38 @@ public:
     bool process(const ImageBuffer &input, ImageBuffer &output) override;
     
     // 移位参数
-    void setColumnShift(int shift) { m_columnShift = shift; }
-    void setLineShift(int shift) { m_lineShift = shift; }
+    void setColumnShift(int shift) { m_columnShift = shift; m_shiftsChanged = true; }
+    void setLineShift(int shift) { m_lineShift = shift; m_shiftsChanged = true; }
     int columnShift() const { return m_columnShift; }
     int lineShift() const { return m_lineShift; }
     
     // 亚像素精度支持
     void setSubPixelShift(double columnShift, double lineShift);
     
+    /**
+     * @brief 每通道附加偏移，与整体移位叠加
+     *
+     * 例如 RGB 传感器各色行间距为 {0, d, 2d} 行，交错CCD奇偶列的半像素偏移等。
+     */
+    void setChannelShifts(const QVector<LineShiftCorrector::ChannelShift> &shifts);
+    QVector<LineShiftCorrector::ChannelShift> channelShifts() const { return m_channelShifts; }
+    
+    RowContext rowContext() const override;
+    
 private:
     int m_columnShift;
     int m_lineShift;
     double m_subPixelColumnShift;
     double m_subPixelLineShift;
     bool m_useSubPixel;
+    QVector<LineShiftCorrector::ChannelShift> m_channelShifts;
+    
+    // 参数或帧格式变化时才重新 reset()，其余帧只 restart()
+    LineShiftCorrector m_corrector;
+    bool m_shiftsChanged;
     
-    bool performColumnShift(const ImageBuffer &input, ImageBuffer &output);
-    bool performLineShift(const ImageBuffer &input, ImageBuffer &output);
-    bool performSubPixelShift(const ImageBuffer &input, ImageBuffer &output);
+    // 整体移位与每通道偏移叠加后的有效偏移
+    QVector<LineShiftCorrector::ChannelShift> effectiveShifts(int channels) const;
 };
 
 // 颜色校正节点
@@ -269,29 +515,6 @@ public:
     bool process(const ImageBuffer &input, ImageBuffer &output) override;
     
     // 校正参数
-    struct ColorMatrix {
-        double r[3];    // R通道的RGB系数
-        double g[3];    // G通道的RGB系数  
-        double b[3];    // B通道的RGB系数
-        
-        ColorMatrix() {
-            // 默认单位矩阵
-            r[0] = g[1] = b[2] = 1.0;
-            r[1] = r[2] = g[0] = g[2] = b[0] = b[1] = 0.0;
-        }
-    };
-    
-    void setColorMatrix(const ColorMatrix &matrix);
-    void setBrightness(double brightness);  // -100 到 100
-    void setContrast(double contrast);      // -100 到 100
-    void setGamma(double gamma);            // 0.1 到 3.0
-    void setSaturation(double saturation);  // -100 到 100
-    
-    // 自动校正功能
-    void setAutoWhiteBalance(bool enabled);
-    void setAutoColorRestoration(bool enabled);
-    
-    // 使用QMatrix3x3替代自定义ColorMatrix
     void setColorMatrix(const QMatrix3x3 &matrix);
     void setWhitePoint(const QColor &whitePoint);
     void setBrightness(int brightness);    // -100 到 100
@@ -299,33 +522,54 @@ public:
     void setSaturation(int saturation);    // 0 到 200
     void setGamma(double gamma);           // 0.1 到 3.0
     
+    // 自动校正功能
+    void setAutoWhiteBalance(bool enabled);
+    void setAutoColorRestoration(bool enabled);
+    
     // SIMD优化支持
     void enableSIMDProcessing(bool enabled) { m_simdEnabled = enabled; }
     void optimizeLookupTables() { m_optimizedLUT = true; }
+    
+    /**
+     * @brief 启用融合内核模式
+     * 
+     * 白点、颜色矩阵与饱和度合并为一个定点矩阵，伽马、对比度与亮度合并为
+     * 各通道查找表，每个像素只读写一次。关闭时使用逐步计算的参考实现。
+     */
+    void enableFusedKernel(bool enabled) { m_fusedKernel = enabled; }
+    
+    // 自动校正需要整幅图像的统计信息
+    bool supportsStreaming() const override;
 
 private:
-    ColorMatrix m_colorMatrix;
-    double m_brightness;
-    double m_contrast;
+    QColor m_whitePoint;
+    QMatrix3x3 m_colorMatrix;
     double m_gamma;
-    double m_saturation;
-    bool m_autoWhiteBalance;
-    bool m_autoColorRestoration;
-    
-    // 校正算法实现
-    bool applyColorMatrix(const ImageBuffer &input, ImageBuffer &output);
-    bool applyBrightnessContrast(ImageBuffer &buffer);
-    bool applyGammaCorrection(ImageBuffer &buffer);
-    bool applySaturationAdjustment(ImageBuffer &buffer);
-    bool performAutoWhiteBalance(ImageBuffer &buffer);
-    bool performAutoColorRestoration(ImageBuffer &buffer);
-    
-    // SIMD优化的处理函数
-    void applyColorMatrix_SSE2(quint8 *data, int pixels, const ColorMatrix &matrix);
-    void applyGamma_AVX2(quint8 *data, int pixels, double gamma);
-    
-    bool m_simdEnabled = false;
+    int m_brightness;
+    int m_contrast;
+    int m_saturation;
+    bool m_autoWhiteBalance = false;
+    bool m_autoColorRestoration = false;
+    
+    // 逐步计算的参考实现（关闭融合内核时使用）
+    bool applyStepwiseCorrection(const ImageBuffer &input, ImageBuffer &output) const;
+    
+    // 融合内核参数
+    struct FusedKernel {
+        static constexpr int Shift = 12;    // 矩阵系数的定点小数位数
+        qint16 coeffs[3][4];                // 每个输出通道：R/G/B 系数与舍入常数
+        quint8 lut[3][256];                 // 各通道的伽马/对比度/亮度查找表
+        bool channelIndependent;            // 矩阵为对角阵时只需查表
+    };
+    
+    FusedKernel buildFusedKernel() const;
+    bool applyFusedKernel(const ImageBuffer &input, ImageBuffer &output) const;
+    static void applyFusedRow(const FusedKernel &kernel, const quint8 *input, quint8 *output,
+                              int width, int bytesPerPixel, bool useSIMD);
+    
+    bool m_simdEnabled = true;
     bool m_optimizedLUT = false;
+    bool m_fusedKernel = true;
 };
 
 // 降噪处理节点
@@ -352,10 +596,35 @@ public:
     void setStrength(double strength);     // 0.0 到 1.0
     void setPreserveDetails(bool preserve);
     
+    /**
+     * @brief 双边滤波使用网格近似（用于预览）
+     * @param enabled true时开销与半径无关，结果为有界误差的近似
+     */
+    void setApproximateBilateral(bool enabled);
+    
+    /**
+     * @brief 非局部均值使用小搜索窗口（用于预览）
+     * @param enabled true时使用11×11搜索窗口，否则为21×21
+     */
+    void setFastNonLocalMeans(bool enabled);
+    
+    RowContext rowContext() const override;
+    
+    // 小波阈值和双边网格的取值范围依赖整幅图像的统计信息
+    bool supportsStreaming() const override;
+    
 private:
+    // 当前算法与强度对应的滤波半径
+    int filterRadius() const;
+    // 参与滤波的通道数，不支持的格式返回0
+    static int filterChannels(PixelFormat format);
+    
+
     NoiseReductionType m_type;
     double m_strength;
     bool m_preserveDetails;
+    bool m_approximateBilateral = false;
+    bool m_fastNonLocalMeans = false;
     
     // 不同降噪算法的实现
     bool applyGaussianNoise(const ImageBuffer &input, ImageBuffer &output);
@@ -388,6 +657,32 @@ public:
     bool processImage(const ImageBuffer &input, ImageBuffer &output);
     bool processImage(const QImage &input, QImage &output);
     
+    // 流式处理支持
+    typedef std::function<bool(int firstRow, const ImageBuffer &strip)> StripCallback;
+    
+    /**
+     * @brief 设置流式处理的条带高度
+     * @param rows 每个条带的行数
+     */
+    void setStripHeight(int rows);
+    int stripHeight() const { return m_stripHeight; }
+    
+    /**
+     * @brief 检查当前管道能否以流式模式运行
+     * @return 首节点为SourceNode且其余节点均支持条带处理时返回true
+     */
+    bool canProcessStreaming() const;
+    
+    /**
+     * @brief 流式处理：由首个SourceNode按条带供数，逐条带流经整条管道
+     * @param sink 输出条带回调，按行号顺序调用
+     * @return 成功返回true
+     *
+     * 每个节点只缓存其rowContext()声明的上下文行，峰值内存与条带高度
+     * 而非整页尺寸成正比；数据源的行回调可以直接阻塞等待扫描数据。
+     */
+    bool processStreaming(const StripCallback &sink);
+    
     // 异步处理支持
     QFuture<ImageBuffer> processImageAsync(const ImageBuffer &input);
     QFuture<QImage> processImageAsync(const QImage &input);
@@ -414,6 +709,18 @@ public:
     qint64 getCurrentMemoryUsage() const;
     void optimizeMemoryUsage();
 
+    // 处理参数结构
+    struct ProcessingParameters {
+        double brightness = 0.0;           // 亮度调整 (-100 到 100)
+        double contrast = 0.0;             // 对比度调整 (-100 到 100)
+        double saturation = 0.0;           // 饱和度调整 (-100 到 100)
+        int gaussianBlurRadius = 0;        // 高斯模糊半径
+        double gaussianBlurSigma = -1.0;   // 高斯模糊标准差
+        bool convertToGrayscale = false;   // 是否转换为灰度
+        bool enableAutoCorrection = false; // 自动色彩校正
+        bool enableNoiseReduction = false; // 降噪处理
+    };
+
     // 新增SIMD优化接口
     /**
      * @brief 启用SIMD优化
@@ -482,24 +789,12 @@ public:
      * @brief 获取性能统计信息
      * @return 性能统计数据
      */
-    PerformanceStats getPerformanceStats() const { return m_stats; }
+    PerformanceStats getPerformanceStats() const { return m_performanceStats; }
     
     /**
      * @brief 重置性能统计
      */
-    void resetPerformanceStats() { m_stats = PerformanceStats(); }
-
-    // 处理参数结构
-    struct ProcessingParameters {
-        double brightness = 0.0;           // 亮度调整 (-100 到 100)
-        double contrast = 0.0;             // 对比度调整 (-100 到 100)
-        double saturation = 0.0;           // 饱和度调整 (-100 到 100)
-        int gaussianBlurRadius = 0;        // 高斯模糊半径
-        double gaussianBlurSigma = -1.0;   // 高斯模糊标准差
-        bool convertToGrayscale = false;   // 是否转换为灰度
-        bool enableAutoCorrection = false; // 自动色彩校正
-        bool enableNoiseReduction = false; // 降噪处理
-    };
+    void resetPerformanceStats() { m_performanceStats = PerformanceStats(); }
 
 signals:
     void processingStarted();
@@ -529,8 +824,16 @@ private:
     // 异步处理
     QThreadPool *m_threadPool;
     
+    // 批量SIMD处理的工作窃取调度器，首次批量处理时创建
+    std::unique_ptr<::MultithreadedProcessor> m_batchScheduler;
+    QMutex m_batchSchedulerMutex;
+    
+    // 流式处理
+    int m_stripHeight = 64;
+    
     // 内部处理方法
     bool processInternal(const ImageBuffer &input, ImageBuffer &output);
+    bool canProcessStreamingLocked() const;
     void updateMemoryUsage(qint64 change);
     void updateNodeStats(int nodeIndex, qint64 elapsedTime);
     
@@ -538,9 +841,15 @@ private:
     void freeUnusedBuffers();
     bool canAllocateMemory(qint64 bytes) const;
     
+    // SIMD处理计时计入性能统计
+    void updatePerformanceStats(qint64 processingTime, int pixelCount);
+    
+    // 取得已启动的批量调度器
+    ::MultithreadedProcessor *batchScheduler();
+    
     // SIMD优化相关成员
     bool m_simdEnabled = false;         // SIMD优化是否启用
-    PerformanceStats m_stats;           // 性能统计数据
+    PerformanceStats m_performanceStats; // SIMD处理性能统计
     
     // 性能配置
     struct Config {
@@ -172,6 +172,7 @@ private:
     static QImage convertGrayscale(const QByteArray &data, const QSize &size);
     static QImage convertRGB(const QByteArray &data, const QSize &size);
     static QImage convertCMYK(const QByteArray &data, const QSize &size);
+    static QImage wrapRawData(const QByteArray &data, const QSize &size, int bytesPerPixel, QImage::Format format);
     static QImage autoDetectAndCrop(const QImage &image);
     static QImage optimizeForText(const QImage &image);
     static QImage optimizeForPhoto(const QImage &image);
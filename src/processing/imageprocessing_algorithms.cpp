@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "dscannerimageprocessor_p.h"
+#include "simd_image_algorithms.h"
 
 #include <QTransform>
 #include <QPainter>
@@ -42,35 +43,13 @@ QImage ImageAlgorithms::medianFilter(const QImage &image, int kernelSize)
         return image;
     }
     
-    QImage result = image.convertToFormat(QImage::Format_RGB32);
-    int width = result.width();
-    int height = result.height();
-    int half = kernelSize / 2;
+    QImage source = image.convertToFormat(QImage::Format_RGB32);
+    QImage result(source.size(), QImage::Format_RGB32);
     
-    for (int y = half; y < height - half; y++) {
-        for (int x = half; x < width - half; x++) {
-            QVector<int> reds, greens, blues;
-            
-            // 收集邻域像素
-            for (int ky = -half; ky <= half; ky++) {
-                for (int kx = -half; kx <= half; kx++) {
-                    QRgb pixel = result.pixel(x + kx, y + ky);
-                    reds.append(qRed(pixel));
-                    greens.append(qGreen(pixel));
-                    blues.append(qBlue(pixel));
-                }
-            }
-            
-            // 排序并取中值
-            std::sort(reds.begin(), reds.end());
-            std::sort(greens.begin(), greens.end());
-            std::sort(blues.begin(), blues.end());
-            
-            int mid = reds.size() / 2;
-            QRgb medianPixel = qRgb(reds[mid], greens[mid], blues[mid]);
-            result.setPixel(x, y, medianPixel);
-        }
-    }
+    // 小核使用排序网络，大核使用常数时间直方图中值
+    SIMDImageAlgorithms::medianFilter8(source.constBits(), source.bytesPerLine(),
+                                       result.bits(), result.bytesPerLine(),
+                                       source.width(), source.height(), 4, 3, kernelSize / 2);
     
     return result;
 }
@@ -81,32 +60,15 @@ QImage ImageAlgorithms::gaussianBlur(const QImage &image, double sigma)
         return image;
     }
     
-    // 生成高斯核
-    int kernelSize = static_cast<int>(6 * sigma + 1);
-    if (kernelSize % 2 == 0) {
-        kernelSize++;
-    }
+    QImage source = image.convertToFormat(QImage::Format_RGB32);
+    QImage result(source.size(), QImage::Format_RGB32);
     
-    QVector<QVector<double>> kernel(kernelSize, QVector<double>(kernelSize));
-    int half = kernelSize / 2;
-    double sum = 0.0;
+    // 大半径自动切换为递归滤波，开销与sigma无关
+    SIMDImageAlgorithms::gaussianBlur8(source.constBits(), source.bytesPerLine(),
+                                       result.bits(), result.bytesPerLine(),
+                                       source.width(), source.height(), 4, 3, sigma);
     
-    for (int y = -half; y <= half; y++) {
-        for (int x = -half; x <= half; x++) {
-            double value = std::exp(-(x * x + y * y) / (2 * sigma * sigma));
-            kernel[y + half][x + half] = value;
-            sum += value;
-        }
-    }
-    
-    // 归一化
-    for (int y = 0; y < kernelSize; y++) {
-        for (int x = 0; x < kernelSize; x++) {
-            kernel[y][x] /= sum;
-        }
-    }
-    
-    return applyKernel(image, kernel);
+    return result;
 }
 
 QImage ImageAlgorithms::sharpen(const QImage &image, int strength)
@@ -135,39 +97,34 @@ QImage ImageAlgorithms::unsharpMask(const QImage &image, double amount, double r
     }
     
     // 创建高斯模糊版本
-    QImage blurred = gaussianBlur(image, radius);
-    
-    // 应用反锐化遮罩
     QImage result = image.convertToFormat(QImage::Format_RGB32);
+    QImage blurred = gaussianBlur(result, radius);
     int width = result.width();
     int height = result.height();
     
+    // 应用反锐化遮罩（RGB32 在内存中为 B、G、R、A）
     for (int y = 0; y < height; y++) {
+        quint8 *line = result.scanLine(y);
+        const quint8 *blurLine = blurred.constScanLine(y);
+        
         for (int x = 0; x < width; x++) {
-            QRgb original = image.pixel(x, y);
-            QRgb blur = blurred.pixel(x, y);
-            
-            int r = qRed(original);
-            int g = qGreen(original);
-            int b = qBlue(original);
-            
-            int br = qRed(blur);
-            int bg = qGreen(blur);
-            int bb = qBlue(blur);
+            quint8 *pixel = line + x * 4;
+            const quint8 *blur = blurLine + x * 4;
             
             // 计算差值
-            int dr = r - br;
-            int dg = g - bg;
-            int db = b - bb;
+            int diff[3];
+            bool exceeds = false;
+            for (int c = 0; c < 3; c++) {
+                diff[c] = pixel[c] - blur[c];
+                exceeds = exceeds || std::abs(diff[c]) > threshold;
+            }
             
             // 应用阈值
-            if (std::abs(dr) > threshold || std::abs(dg) > threshold || std::abs(db) > threshold) {
-                r = clamp(r + static_cast<int>(amount * dr));
-                g = clamp(g + static_cast<int>(amount * dg));
-                b = clamp(b + static_cast<int>(amount * db));
+            if (exceeds) {
+                for (int c = 0; c < 3; c++) {
+                    pixel[c] = static_cast<quint8>(clamp(pixel[c] + static_cast<int>(amount * diff[c])));
+                }
             }
-            
-            result.setPixel(x, y, qRgb(r, g, b));
         }
     }
     
@@ -18,17 +18,18 @@
 #include "memory_optimized_processor.h"
 #include <QDebug>
 #include <QElapsedTimer>
-#include <QApplication>
 #include <QDir>
 #include <QStandardPaths>
 #include <QThread>
-#include <QtConcurrent>
+#include <QHash>
 #include <QMutexLocker>
 #include <QPainter>
+#include <QtAlgorithms>
 #include <cmath>
 #include <cstring>
 #include <algorithm>
 #include <cstdlib>
+#include <new>
 
 // Linux系统内存信息
 #ifdef Q_OS_LINUX
@@ -52,268 +53,464 @@
 
 // ==================== MemoryPool 实现 ====================
 
+namespace {
+
+constexpr size_t kMinClassShift = 8;                 // 最小类别 256B
+constexpr size_t kHeaderSize = 64;                   // 块头大小，同时是类别块的对齐
+constexpr quint32 kDirectClass = 0xFFFFFFFFu;        // 直接向系统分配的块
+constexpr quint32 kMagicInUse = 0x4D504F4Fu;         // 'MPOO'
+constexpr quint32 kMagicFree = 0x4D504646u;          // 'MPFF'
+constexpr size_t kCacheBytesPerClass = 2 * 1024 * 1024; // 每线程每类别缓存上限
+constexpr int kMaxCachedBlocks = 16;
+
+std::atomic<quint64> g_nextPoolId{1};
+
+// 每线程最近使用的内存池缓存，池ID全局唯一且不复用
+struct CacheSlot {
+    quint64 poolId = 0;
+    void *cache = nullptr;
+};
+constexpr int kCacheSlotCount = 4;
+thread_local CacheSlot t_cacheSlots[kCacheSlotCount];
+thread_local int t_nextCacheSlot = 0;
+
+int cachedBlockLimit(int sizeClass)
+{
+    size_t limit = kCacheBytesPerClass / MemoryPool::sizeClassBytes(sizeClass);
+    return static_cast<int>(std::min<size_t>(limit, kMaxCachedBlocks));
+}
+
+// 存活内存池注册表，线程退出时据此判断缓存所属的池是否已析构。
+// 有意不释放，保证进程退出阶段结束的线程仍可访问
+struct LivePools {
+    QMutex mutex;
+    QHash<quint64, MemoryPool*> pools;
+};
+
+LivePools &livePools()
+{
+    static LivePools *registry = new LivePools;
+    return *registry;
+}
+
+} // namespace
+
+struct MemoryPool::BlockHeader {
+    std::atomic<BlockHeader*> next{nullptr};   // 空闲链表链接
+    void *base = nullptr;                      // 系统分配的起始地址
+    size_t reserved = 0;                       // 系统分配的字节数
+    size_t capacity = 0;                       // 可用字节数
+    size_t requested = 0;                      // 本次请求的字节数
+    quint32 sizeClass = kDirectClass;
+    quint32 magic = kMagicFree;
+};
+
+// 线程私有缓存：链表与计数只由所属线程访问，统计计数器供 getStatistics() 汇总
+struct MemoryPool::ThreadCache {
+    Qt::HANDLE owner = nullptr;
+    BlockHeader *heads[MemoryPool::kSizeClassCount] = {};
+    int counts[MemoryPool::kSizeClassCount] = {};
+    
+    std::atomic<size_t> allocatedBytes{0};
+    std::atomic<size_t> freedBytes{0};
+    std::atomic<size_t> requestedAllocated{0};
+    std::atomic<size_t> requestedFreed{0};
+    std::atomic<size_t> allocationCount{0};
+    std::atomic<size_t> deallocationCount{0};
+    
+    // 单写者计数，无需原子读改写
+    static void add(std::atomic<size_t> &counter, size_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+// 记录本线程注册过的缓存，线程退出时逐个归还
+struct MemoryPool::ThreadExitGuard {
+    std::vector<std::pair<quint64, ThreadCache*>> caches;
+    
+    ~ThreadExitGuard()
+    {
+        // 持有注册表锁期间内存池无法完成析构
+        LivePools &registry = livePools();
+        QMutexLocker locker(&registry.mutex);
+        for (const auto &entry : caches) {
+            MemoryPool *pool = registry.pools.value(entry.first, nullptr);
+            if (pool) {
+                pool->retireCache(entry.second);
+            }
+        }
+        
+        // 槽位中的缓存已注销，之后的访问重新走慢路径
+        for (CacheSlot &slot : t_cacheSlots) {
+            slot = CacheSlot();
+        }
+    }
+};
+
 MemoryPool::MemoryPool(size_t initialSize)
-    : m_poolMemory(nullptr)
-    , m_poolSize(initialSize)
-    , m_nextOffset(0)
+    : m_poolId(g_nextPoolId.fetch_add(1, std::memory_order_relaxed))
+    , m_retainLimit(initialSize)
+    , m_retired(new ThreadCache)
 {
-    qDebug() << "MemoryPool: 初始化内存池，大小:" << (initialSize / 1024 / 1024) << "MB";
+    LivePools &registry = livePools();
+    {
+        QMutexLocker locker(&registry.mutex);
+        registry.pools.insert(m_poolId, this);
+    }
     
-    // 分配对齐的内存池
-    m_poolMemory = std::aligned_alloc(64, m_poolSize);  // 64字节对齐
-    if (!m_poolMemory) {
-        qWarning() << "MemoryPool: 初始内存池分配失败";
-        m_poolSize = 0;
-        return;
+    qDebug() << "MemoryPool: 初始化内存池，保留上限:" << (initialSize / 1024 / 1024) << "MB";
+}
+
+MemoryPool::~MemoryPool()
+{
+    // 先注销，之后退出的线程不再归还缓存
+    LivePools &registry = livePools();
+    {
+        QMutexLocker locker(&registry.mutex);
+        registry.pools.remove(m_poolId);
     }
     
-    // 清零内存
-    std::memset(m_poolMemory, 0, m_poolSize);
+    Statistics stats = getStatistics();
+    
+    flushCaches();
+    trimFreeLists(0);
     
-    // 初始化统计信息
-    m_stats.poolSize = m_poolSize;
+    qDebug() << "MemoryPool: 析构完成，最终统计:";
+    qDebug() << "  总分配:" << (stats.totalAllocated / 1024 / 1024) << "MB";
+    qDebug() << "  总释放:" << (stats.totalFreed / 1024 / 1024) << "MB";
+    qDebug() << "  分配次数:" << stats.allocationCount;
+    qDebug() << "  碎片化率:" << stats.fragmentationRatio;
     
-    qDebug() << "MemoryPool: 初始化成功，内存地址:" << m_poolMemory;
+    if (stats.currentUsage > 0) {
+        qWarning() << "MemoryPool: 析构时仍有" << stats.currentUsage << "字节未释放";
+    }
 }
 
-MemoryPool::~MemoryPool()
+size_t MemoryPool::sizeClassBytes(int sizeClass)
 {
-    if (m_poolMemory) {
-        std::free(m_poolMemory);
-        m_poolMemory = nullptr;
+    // 偶数类别为 2^k，奇数类别为 1.5 * 2^k
+    size_t shift = kMinClassShift + static_cast<size_t>(sizeClass / 2);
+    return (sizeClass & 1) ? (size_t(3) << (shift - 1)) : (size_t(1) << shift);
+}
+
+int MemoryPool::sizeClassFor(size_t size)
+{
+    if (size <= (size_t(1) << kMinClassShift)) {
+        return 0;
     }
     
-    qDebug() << "MemoryPool: 析构完成，最终统计:";
-    qDebug() << "  总分配:" << (m_stats.totalAllocated / 1024 / 1024) << "MB";
-    qDebug() << "  总释放:" << (m_stats.totalFreed / 1024 / 1024) << "MB";
-    qDebug() << "  分配次数:" << m_stats.allocationCount;
-    qDebug() << "  碎片化率:" << m_stats.fragmentationRatio;
+    // 2^(bits-1) < size <= 2^bits
+    int bits = 64 - qCountLeadingZeroBits(quint64(size - 1));
+    int sizeClass = (size <= (size_t(3) << (bits - 2)))
+                    ? (bits - 1 - int(kMinClassShift)) * 2 + 1
+                    : (bits - int(kMinClassShift)) * 2;
+    
+    return sizeClass < kSizeClassCount ? sizeClass : -1;
 }
 
 void* MemoryPool::allocate(size_t size, size_t alignment)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!m_poolMemory || size == 0) {
+    if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) {
         return nullptr;
     }
     
-    // 首先尝试找到现有的空闲块
-    MemoryBlock* freeBlock = findFreeBlock(size, alignment);
-    if (freeBlock) {
-        freeBlock->inUse = true;
-        m_stats.currentUsage += freeBlock->size;
-        m_stats.allocationCount++;
-        
-        qDebug() << "MemoryPool: 重用现有块，大小:" << size << "字节，对齐:" << alignment;
-        return freeBlock->ptr;
+    ThreadCache *cache = localCache();
+    int sizeClass = alignment <= kHeaderSize ? sizeClassFor(size) : -1;
+    BlockHeader *block = nullptr;
+    
+    if (sizeClass >= 0) {
+        // 快速路径：线程缓存
+        block = cache->heads[sizeClass];
+        if (block) {
+            cache->heads[sizeClass] = block->next.load(std::memory_order_relaxed);
+            cache->counts[sizeClass]--;
+        } else {
+            block = popFree(sizeClass);
+        }
     }
     
-    // 分配新块
-    void* allocatedPtr = allocateAligned(size, alignment);
-    if (allocatedPtr) {
-        MemoryBlock block(allocatedPtr, size, true, alignment);
-        m_blocks.push_back(block);
-        
-        m_stats.totalAllocated += size;
-        m_stats.currentUsage += size;
-        m_stats.allocationCount++;
-        
-        qDebug() << "MemoryPool: 分配新块，大小:" << size << "字节，地址:" << allocatedPtr;
+    if (!block) {
+        block = allocateBlock(sizeClass, size, alignment);
+        if (!block) {
+            qWarning() << "MemoryPool: 分配失败，大小:" << size << "字节，对齐:" << alignment;
+            return nullptr;
+        }
     }
     
-    return allocatedPtr;
+    block->requested = size;
+    block->magic = kMagicInUse;
+    
+    ThreadCache::add(cache->allocatedBytes, block->capacity);
+    ThreadCache::add(cache->requestedAllocated, size);
+    ThreadCache::add(cache->allocationCount, 1);
+    
+    return reinterpret_cast<char*>(block) + kHeaderSize;
 }
 
 void MemoryPool::deallocate(void* ptr)
 {
     if (!ptr) return;
     
-    QMutexLocker locker(&m_mutex);
+    BlockHeader *block = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - kHeaderSize);
+    if (block->magic != kMagicInUse) {
+        qWarning() << "MemoryPool: 尝试释放未知指针或重复释放:" << ptr;
+        return;
+    }
+    block->magic = kMagicFree;
     
-    // 查找对应的内存块
-    auto it = std::find_if(m_blocks.begin(), m_blocks.end(),
-                          [ptr](const MemoryBlock& block) {
-                              return block.ptr == ptr;
-                          });
+    ThreadCache *cache = localCache();
+    ThreadCache::add(cache->freedBytes, block->capacity);
+    ThreadCache::add(cache->requestedFreed, block->requested);
+    ThreadCache::add(cache->deallocationCount, 1);
     
-    if (it != m_blocks.end()) {
-        it->inUse = false;
-        m_stats.currentUsage -= it->size;
-        m_stats.totalFreed += it->size;
-        m_stats.deallocationCount++;
-        
-        qDebug() << "MemoryPool: 释放块，大小:" << it->size << "字节";
-        
-        // 定期合并相邻的空闲块
-        if (m_stats.deallocationCount % 10 == 0) {
-            mergeAdjacentFreeBlocks();
+    if (block->sizeClass == kDirectClass) {
+        releaseBlock(block);
+        return;
+    }
+    
+    int sizeClass = static_cast<int>(block->sizeClass);
+    int limit = cachedBlockLimit(sizeClass);
+    
+    if (cache->counts[sizeClass] >= limit) {
+        // 缓存已满：归还一半到全局链表，保留热块供本线程复用
+        int drain = std::max(1, limit / 2);
+        for (int i = 0; i < drain && cache->heads[sizeClass]; ++i) {
+            BlockHeader *cached = cache->heads[sizeClass];
+            cache->heads[sizeClass] = cached->next.load(std::memory_order_relaxed);
+            cache->counts[sizeClass]--;
+            pushFree(sizeClass, cached);
         }
+    }
+    
+    if (limit > 0) {
+        block->next.store(cache->heads[sizeClass], std::memory_order_relaxed);
+        cache->heads[sizeClass] = block;
+        cache->counts[sizeClass]++;
     } else {
-        qWarning() << "MemoryPool: 尝试释放未知指针:" << ptr;
+        pushFree(sizeClass, block);
     }
 }
 
 MemoryPool::Statistics MemoryPool::getStatistics() const
 {
-    QMutexLocker locker(&m_mutex);
-    
-    // 计算碎片化率
-    size_t totalFreeSize = 0;
-    int freeBlockCount = 0;
-    
-    for (const auto& block : m_blocks) {
-        if (!block.inUse) {
-            totalFreeSize += block.size;
-            freeBlockCount++;
+    Statistics stats;
+    size_t requestedLive = 0;
+    
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        size_t requestedAllocated = 0;
+        size_t requestedFreed = 0;
+        auto accumulate = [&](const ThreadCache *cache) {
+            stats.totalAllocated += cache->allocatedBytes.load(std::memory_order_relaxed);
+            stats.totalFreed += cache->freedBytes.load(std::memory_order_relaxed);
+            stats.allocationCount += cache->allocationCount.load(std::memory_order_relaxed);
+            stats.deallocationCount += cache->deallocationCount.load(std::memory_order_relaxed);
+            requestedAllocated += cache->requestedAllocated.load(std::memory_order_relaxed);
+            requestedFreed += cache->requestedFreed.load(std::memory_order_relaxed);
+        };
+        for (const auto &cache : m_caches) {
+            accumulate(cache.get());
         }
+        accumulate(m_retired.get());
+        requestedLive = requestedAllocated > requestedFreed ? requestedAllocated - requestedFreed : 0;
     }
     
-    if (totalFreeSize > 0 && freeBlockCount > 1) {
-        // 碎片化率 = 空闲块数量 / 总空闲大小的理想块数量
-        m_stats.fragmentationRatio = static_cast<double>(freeBlockCount) / 
-                                    std::max(1.0, static_cast<double>(totalFreeSize) / (64 * 1024));
-    } else {
-        m_stats.fragmentationRatio = 0.0;
+    stats.currentUsage = stats.totalAllocated > stats.totalFreed ? stats.totalAllocated - stats.totalFreed : 0;
+    stats.poolSize = m_reservedBytes.load(std::memory_order_relaxed);
+    
+    // 碎片化率 = 已分配块中因尺寸类别取整而浪费的比例
+    if (stats.currentUsage > 0 && stats.currentUsage >= requestedLive) {
+        stats.fragmentationRatio = static_cast<double>(stats.currentUsage - requestedLive) / stats.currentUsage;
     }
     
-    return m_stats;
+    return stats;
 }
 
 void MemoryPool::compact()
 {
-    QMutexLocker locker(&m_mutex);
-    
     qDebug() << "MemoryPool: 开始内存压缩";
     
-    mergeAdjacentFreeBlocks();
-    
-    // 移除空闲的小块（可选的激进压缩）
-    auto it = std::remove_if(m_blocks.begin(), m_blocks.end(),
-                            [](const MemoryBlock& block) {
-                                return !block.inUse && block.size < 1024;  // 移除小于1KB的空闲块
-                            });
-    m_blocks.erase(it, m_blocks.end());
+    flushCaches();
+    trimFreeLists(m_retainLimit);
     
-    qDebug() << "MemoryPool: 压缩完成，当前块数量:" << m_blocks.size();
+    qDebug() << "MemoryPool: 压缩完成，保留内存:" << (m_reservedBytes.load() / 1024) << "KB";
 }
 
 void MemoryPool::reset()
 {
-    QMutexLocker locker(&m_mutex);
-    
     qDebug() << "MemoryPool: 重置内存池";
     
-    m_blocks.clear();
-    m_nextOffset = 0;
-    
-    // 重置统计信息（保留历史统计）
-    size_t totalAllocated = m_stats.totalAllocated;
-    size_t allocationCount = m_stats.allocationCount;
-    
-    m_stats = Statistics();
-    m_stats.poolSize = m_poolSize;
-    m_stats.totalAllocated = totalAllocated;
-    m_stats.allocationCount = allocationCount;
+    flushCaches();
+    trimFreeLists(0);
 }
 
-void* MemoryPool::allocateAligned(size_t size, size_t alignment)
+MemoryPool::ThreadCache *MemoryPool::localCache()
 {
-    // 计算对齐后的偏移
-    size_t alignedOffset = (m_nextOffset + alignment - 1) & ~(alignment - 1);
+    for (CacheSlot &slot : t_cacheSlots) {
+        if (slot.poolId == m_poolId) {
+            return static_cast<ThreadCache*>(slot.cache);
+        }
+    }
     
-    if (alignedOffset + size > m_poolSize) {
-        // 内存池空间不足，尝试扩展
-        if (!expandPool(alignedOffset + size)) {
-            qWarning() << "MemoryPool: 内存池空间不足，分配失败";
-            return nullptr;
+    // 慢路径：查找或创建本线程的缓存，槽位被其他内存池挤出时按线程ID找回
+    Qt::HANDLE self = QThread::currentThreadId();
+    ThreadCache *cache = nullptr;
+    bool created = false;
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        for (const auto &existing : m_caches) {
+            if (existing->owner == self) {
+                cache = existing.get();
+                break;
+            }
+        }
+        if (!cache) {
+            m_caches.push_back(std::unique_ptr<ThreadCache>(new ThreadCache));
+            cache = m_caches.back().get();
+            cache->owner = self;
+            created = true;
         }
     }
     
-    void* ptr = static_cast<char*>(m_poolMemory) + alignedOffset;
-    m_nextOffset = alignedOffset + size;
+    if (created) {
+        static thread_local ThreadExitGuard exitGuard;
+        exitGuard.caches.emplace_back(m_poolId, cache);
+    }
     
-    return ptr;
+    CacheSlot &slot = t_cacheSlots[t_nextCacheSlot];
+    t_nextCacheSlot = (t_nextCacheSlot + 1) % kCacheSlotCount;
+    slot.poolId = m_poolId;
+    slot.cache = cache;
+    return cache;
 }
 
-MemoryPool::MemoryBlock* MemoryPool::findFreeBlock(size_t size, size_t alignment)
+void MemoryPool::retireCache(ThreadCache *cache)
 {
-    for (auto& block : m_blocks) {
-        if (!block.inUse && block.size >= size && block.alignment >= alignment) {
-            return &block;
+    QMutexLocker locker(&m_cacheMutex);
+    
+    auto it = std::find_if(m_caches.begin(), m_caches.end(),
+                           [cache](const std::unique_ptr<ThreadCache> &entry) {
+                               return entry.get() == cache;
+                           });
+    if (it == m_caches.end()) {
+        return;
+    }
+    
+    for (int sizeClass = 0; sizeClass < kSizeClassCount; ++sizeClass) {
+        while (BlockHeader *block = cache->heads[sizeClass]) {
+            cache->heads[sizeClass] = block->next.load(std::memory_order_relaxed);
+            pushFree(sizeClass, block);
         }
     }
-    return nullptr;
+    
+    ThreadCache::add(m_retired->allocatedBytes, cache->allocatedBytes.load(std::memory_order_relaxed));
+    ThreadCache::add(m_retired->freedBytes, cache->freedBytes.load(std::memory_order_relaxed));
+    ThreadCache::add(m_retired->requestedAllocated, cache->requestedAllocated.load(std::memory_order_relaxed));
+    ThreadCache::add(m_retired->requestedFreed, cache->requestedFreed.load(std::memory_order_relaxed));
+    ThreadCache::add(m_retired->allocationCount, cache->allocationCount.load(std::memory_order_relaxed));
+    ThreadCache::add(m_retired->deallocationCount, cache->deallocationCount.load(std::memory_order_relaxed));
+    
+    m_caches.erase(it);
 }
 
-void MemoryPool::mergeAdjacentFreeBlocks()
+MemoryPool::BlockHeader *MemoryPool::allocateBlock(int sizeClass, size_t size, size_t alignment)
 {
-    if (m_blocks.size() < 2) return;
-    
-    // 按地址排序
-    std::sort(m_blocks.begin(), m_blocks.end(),
-              [](const MemoryBlock& a, const MemoryBlock& b) {
-                  return a.ptr < b.ptr;
-              });
-    
-    // 合并相邻的空闲块
-    auto it = m_blocks.begin();
-    while (it != m_blocks.end() && std::next(it) != m_blocks.end()) {
-        auto next = std::next(it);
-        
-        if (!it->inUse && !next->inUse) {
-            char* currentEnd = static_cast<char*>(it->ptr) + it->size;
-            if (currentEnd == next->ptr) {
-                // 合并块
-                it->size += next->size;
-                m_blocks.erase(next);
-                continue;
-            }
-        }
-        ++it;
+    static_assert(sizeof(BlockHeader) <= kHeaderSize, "block header must fit in the reserved prefix");
+    
+    size_t align = std::max(alignment, kHeaderSize);
+    size_t capacity = sizeClass >= 0 ? sizeClassBytes(sizeClass) : size;
+    // aligned_alloc 要求大小为对齐的整数倍
+    size_t reserved = (align + capacity + align - 1) & ~(align - 1);
+    
+    void *base = std::aligned_alloc(align, reserved);
+    if (!base) {
+        return nullptr;
     }
     
-    qDebug() << "MemoryPool: 合并后块数量:" << m_blocks.size();
+    char *user = static_cast<char*>(base) + align;
+    BlockHeader *block = new (user - kHeaderSize) BlockHeader;
+    block->base = base;
+    block->reserved = reserved;
+    block->capacity = capacity;
+    block->sizeClass = sizeClass >= 0 ? static_cast<quint32>(sizeClass) : kDirectClass;
+    
+    m_reservedBytes.fetch_add(reserved, std::memory_order_relaxed);
+    return block;
 }
 
-bool MemoryPool::expandPool(size_t minSize)
+void MemoryPool::releaseBlock(BlockHeader *block)
 {
-    size_t newSize = std::max(m_poolSize * 2, minSize);
-    
-    qDebug() << "MemoryPool: 扩展内存池从" << (m_poolSize / 1024 / 1024) 
-             << "MB到" << (newSize / 1024 / 1024) << "MB";
+    m_reservedBytes.fetch_sub(block->reserved, std::memory_order_relaxed);
+    void *base = block->base;
+    block->~BlockHeader();
+    std::free(base);
+}
+
+void MemoryPool::pushFree(int sizeClass, BlockHeader *block)
+{
+    std::atomic<FreeHead> &head = m_freeLists[sizeClass].head;
+    FreeHead oldHead = head.load(std::memory_order_relaxed);
+    FreeHead newHead;
     
-    void* newMemory = std::aligned_alloc(64, newSize);
-    if (!newMemory) {
-        qWarning() << "MemoryPool: 内存池扩展失败";
-        return false;
-    }
+    do {
+        block->next.store(oldHead.top, std::memory_order_relaxed);
+        newHead.top = block;
+        newHead.tag = oldHead.tag + 1;
+    } while (!head.compare_exchange_weak(oldHead, newHead,
+                                         std::memory_order_release, std::memory_order_relaxed));
+}
+
+MemoryPool::BlockHeader *MemoryPool::popFree(int sizeClass)
+{
+    std::atomic<FreeHead> &head = m_freeLists[sizeClass].head;
+    FreeHead oldHead = head.load(std::memory_order_acquire);
     
-    // 复制现有数据
-    if (m_poolMemory && m_nextOffset > 0) {
-        std::memcpy(newMemory, m_poolMemory, m_nextOffset);
+    for (;;) {
+        if (!oldHead.top) {
+            return nullptr;
+        }
+        
+        // 类别块在 compact()/析构前不会归还系统，读取过期的 top->next 是安全的，
+        // 版本计数保证此时CAS失败
+        FreeHead newHead;
+        newHead.top = oldHead.top->next.load(std::memory_order_relaxed);
+        newHead.tag = oldHead.tag + 1;
+        
+        if (head.compare_exchange_weak(oldHead, newHead,
+                                       std::memory_order_acquire, std::memory_order_acquire)) {
+            return oldHead.top;
+        }
     }
+}
+
+void MemoryPool::flushCaches()
+{
+    QMutexLocker locker(&m_cacheMutex);
     
-    // 更新指针引用
-    ptrdiff_t offset = static_cast<char*>(newMemory) - static_cast<char*>(m_poolMemory);
-    for (auto& block : m_blocks) {
-        block.ptr = static_cast<char*>(block.ptr) + offset;
+    for (const auto &cache : m_caches) {
+        for (int sizeClass = 0; sizeClass < kSizeClassCount; ++sizeClass) {
+            while (BlockHeader *block = cache->heads[sizeClass]) {
+                cache->heads[sizeClass] = block->next.load(std::memory_order_relaxed);
+                pushFree(sizeClass, block);
+            }
+            cache->counts[sizeClass] = 0;
+        }
     }
-    
-    // 释放旧内存
-    if (m_poolMemory) {
-        std::free(m_poolMemory);
+}
+
+void MemoryPool::trimFreeLists(size_t retainBytes)
+{
+    // 从最大类别开始释放，优先保留高频的小块
+    for (int sizeClass = kSizeClassCount - 1; sizeClass >= 0; --sizeClass) {
+        while (m_reservedBytes.load(std::memory_order_relaxed) > retainBytes) {
+            BlockHeader *block = popFree(sizeClass);
+            if (!block) {
+                break;
+            }
+            releaseBlock(block);
+        }
     }
-    
-    m_poolMemory = newMemory;
-    m_poolSize = newSize;
-    m_stats.poolSize = newSize;
-    
-    // 清零新分配的部分
-    char* newPart = static_cast<char*>(m_poolMemory) + m_nextOffset;
-    std::memset(newPart, 0, newSize - m_nextOffset);
-    
-    return true;
 }
 
 // ==================== TileProcessor 实现 ====================
@@ -353,8 +550,9 @@ QList<TileProcessor::TileInfo> TileProcessor::calculateTiles(const QSize &imageS
             int x = tx * m_maxTileSize.width() - (tx > 0 ? m_overlap : 0);
             int y = ty * m_maxTileSize.height() - (ty > 0 ? m_overlap : 0);
             
-            int width = m_maxTileSize.width();
-            int height = m_maxTileSize.height();
+            // 分块核心尺寸加上左/上侧重叠
+            int width = m_maxTileSize.width() + (tx > 0 ? m_overlap : 0);
+            int height = m_maxTileSize.height() + (ty > 0 ? m_overlap : 0);
             
             // 添加右侧重叠
             if (tx < tilesX - 1) {
@@ -409,551 +607,347 @@ QImage TileProcessor::mergeTiles(const QList<QImage> &tiles, const QList<TileInf
     
     qDebug() << "TileProcessor: 开始合并" << tiles.size() << "个分块，输出尺寸:" << outputSize;
     
-    QImage result(outputSize, QImage::Format_ARGB32);
-    result.fill(Qt::transparent);
-    
-    QPainter painter(&result);
-    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    QImage result = createMergeTarget(outputSize);
     
     for (int i = 0; i < tiles.size(); ++i) {
-        const QImage &tile = tiles[i];
-        const TileInfo &tileInfo = tileInfos[i];
-        
-        if (tile.isNull()) {
-            continue;
-        }
-        
-        QRect targetRect = tileInfo.region;
-        
-        // 处理重叠区域的融合
-        if (m_overlap > 0) {
-            // 创建带透明度渐变的分块
-            QImage blendedTile = tile.copy();
-            blendOverlapRegion(result, blendedTile, targetRect, m_overlap);
-        } else {
-            // 直接绘制
-            painter.drawImage(targetRect.topLeft(), tile);
+        if (!tiles[i].isNull()) {
+            mergeTile(result, tiles[i], tileInfos[i]);
         }
     }
     
-    painter.end();
-    
     qDebug() << "TileProcessor: 分块合并完成";
     return result;
 }
 
-void TileProcessor::blendOverlapRegion(QImage &target, const QImage &source, const QRect &region, int overlap) const
+QImage TileProcessor::createMergeTarget(const QSize &outputSize) const
 {
-    if (overlap <= 0 || source.isNull() || target.isNull()) {
-        // 无重叠，直接复制
+    QImage result(outputSize, QImage::Format_ARGB32);
+    result.fill(Qt::transparent);
+    return result;
+}
+
+void TileProcessor::mergeTile(QImage &target, const QImage &tile, const TileInfo &tileInfo) const
+{
+    if (tile.isNull() || target.isNull()) {
+        return;
+    }
+    
+    QRect targetRect = tileInfo.region;
+    
+    if (tile.size() != targetRect.size()) {
+        // 处理函数改变了分块尺寸，无法按像素融合
+        qWarning() << "TileProcessor: 分块" << tileInfo.tileIndex << "尺寸不匹配:"
+                   << tile.size() << "期望:" << targetRect.size();
         QPainter painter(&target);
-        painter.drawImage(region.topLeft(), source);
-        painter.end();
+        painter.drawImage(targetRect, tile);
         return;
     }
     
-    QPainter painter(&target);
+    blendOverlapRegion(target, tile.convertToFormat(QImage::Format_ARGB32), targetRect, tileInfo.overlap);
+}
+
+std::vector<int> TileProcessor::axisWeights(int start, int length, int tileStep, int imageLength, int overlap) const
+{
+    std::vector<int> weights(static_cast<size_t>(std::max(0, length)), 256);
+    if (overlap <= 0 || tileStep <= 0 || length <= 0) {
+        return weights;
+    }
+    
+    // 按 calculateTiles() 的网格还原相邻分块的范围
+    const int count = (imageLength + tileStep - 1) / tileStep;
+    auto tileStart = [&](int index) {
+        return index * tileStep - (index > 0 ? overlap : 0);
+    };
+    auto tileEnd = [&](int index) {
+        return std::min(imageLength, index * tileStep + tileStep + (index < count - 1 ? overlap : 0));
+    };
     
-    // 为重叠区域创建渐变蒙版
-    int sourceWidth = source.width();
-    int sourceHeight = source.height();
+    // 重叠区[z0, z1)内后一分块的权重从0线性升至256，前一分块取其补数，
+    // 两侧使用同一公式，权重之和恒为256
+    auto rampAt = [](int position, int z0, int z1) {
+        int span = z1 - z0;
+        return ((2 * (position - z0) + 1) * 256 + span) / (2 * span);
+    };
     
-    // 创建alpha蒙版
-    QImage alphaMask(sourceWidth, sourceHeight, QImage::Format_ARGB32);
-    alphaMask.fill(qRgba(255, 255, 255, 255));
+    const int column = (start + (start > 0 ? overlap : 0)) / tileStep;
     
-    // 左边缘渐变
-    if (region.x() > 0) {
-        for (int x = 0; x < std::min(overlap, sourceWidth); ++x) {
-            int alpha = (x * 255) / overlap;
-            for (int y = 0; y < sourceHeight; ++y) {
-                alphaMask.setPixel(x, y, qRgba(255, 255, 255, alpha));
-            }
+    if (column > 0) {
+        const int z1 = tileEnd(column - 1);
+        for (int i = 0; i < length && start + i < z1; ++i) {
+            weights[i] = rampAt(start + i, start, z1);
         }
     }
     
-    // 上边缘渐变
-    if (region.y() > 0) {
-        for (int y = 0; y < std::min(overlap, sourceHeight); ++y) {
-            int alpha = (y * 255) / overlap;
-            for (int x = 0; x < sourceWidth; ++x) {
-                QRgb existing = alphaMask.pixel(x, y);
-                int newAlpha = std::min(qAlpha(existing), alpha);
-                alphaMask.setPixel(x, y, qRgba(255, 255, 255, newAlpha));
-            }
+    if (column < count - 1) {
+        const int z0 = tileStart(column + 1);
+        const int z1 = start + length;
+        for (int i = std::max(0, z0 - start); i < length; ++i) {
+            weights[i] = weights[i] * (256 - rampAt(start + i, z0, z1)) / 256;
         }
     }
     
-    // 应用蒙版绘制
-    QImage maskedSource = source.copy();
-    QPainter maskPainter(&maskedSource);
-    maskPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    maskPainter.drawImage(0, 0, alphaMask);
-    maskPainter.end();
-    
-    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-    painter.drawImage(region.topLeft(), maskedSource);
-    painter.end();
+    return weights;
 }
 
-// ==================== MemoryOptimizedProcessor 实现 ====================
-
-MemoryOptimizedProcessor::MemoryOptimizedProcessor(QObject *parent)
-    : QObject(parent)
-    , m_memoryMonitorTimer(new QTimer(this))
-    , m_cacheCleanupTimer(new QTimer(this))
-    , m_memoryThresholdBytes(static_cast<qint64>(m_config.memoryThreshold * 1024 * 1024 * 1024))
-    , m_lastMemoryCheck(0)
-    , m_isProcessing(false)
-    , m_currentProgress(0)
-    , m_cacheHits(0)
-    , m_cacheMisses(0)
-    , m_totalAllocations(0)
-    , m_totalDeallocations(0)
-    , m_currentMemoryUsage(0)
+void TileProcessor::blendOverlapRegion(QImage &target, const QImage &source, const QRect &region, int overlap) const
 {
-    qDebug() << "MemoryOptimizedProcessor: 初始化";
+    const int width = std::min(source.width(), target.width() - region.x());
+    const int height = std::min(source.height(), target.height() - region.y());
     
-    // 创建内存池
-    m_memoryPool = std::make_unique<MemoryPool>(m_config.poolInitialSizeMB * 1024 * 1024);
-    
-    // 创建分块处理器
-    m_tileProcessor = std::make_unique<TileProcessor>(m_config.maxTileSize, m_config.tileOverlap);
-    
-    // 设置缓存大小
-    m_imageCache.setMaxCost(m_config.maxCacheSize * 1024 * 1024); // 转换为字节
-    m_tileCache.setMaxCost(m_config.maxCacheSize * 1024 * 1024 / 4); // 块缓存占用较少
-    
-    // 设置内存监控定时器
-    m_memoryMonitorTimer->setSingleShot(false);
-    m_memoryMonitorTimer->setInterval(5000); // 5秒检查一次
-    connect(m_memoryMonitorTimer, &QTimer::timeout, this, &MemoryOptimizedProcessor::performMemoryMonitoring);
-    m_memoryMonitorTimer->start();
+    if (overlap <= 0) {
+        // 无重叠，直接复制
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(target.scanLine(region.y() + y) + region.x() * 4, source.constScanLine(y), width * 4);
+        }
+        return;
+    }
     
-    // 设置缓存清理定时器
-    m_cacheCleanupTimer->setSingleShot(false);
-    m_cacheCleanupTimer->setInterval(30000); // 30秒清理一次
-    connect(m_cacheCleanupTimer, &QTimer::timeout, this, &MemoryOptimizedProcessor::cleanupExpiredCache);
-    m_cacheCleanupTimer->start();
+    const std::vector<int> weightX = axisWeights(region.x(), width, m_maxTileSize.width(), target.width(), overlap);
+    const std::vector<int> weightY = axisWeights(region.y(), height, m_maxTileSize.height(), target.height(), overlap);
     
-    qDebug() << "内存优化处理器初始化完成，内存阈值:" << (m_memoryThresholdBytes / 1024 / 1024) << "MB";
+    // 按权重累加：内部像素权重为1直接写入，重叠区与相邻分块的贡献相加
+    for (int y = 0; y < height; ++y) {
+        const uchar *src = source.constScanLine(y);
+        uchar *dst = target.scanLine(region.y() + y) + region.x() * 4;
+        
+        for (int x = 0; x < width; ++x) {
+            const int weight = weightX[x] * weightY[y];   // 0~65536
+            if (weight == 65536) {
+                std::memcpy(dst + x * 4, src + x * 4, 4);
+                continue;
+            }
+            for (int c = 0; c < 4; ++c) {
+                int value = dst[x * 4 + c] + ((src[x * 4 + c] * weight + 32768) >> 16);
+                dst[x * 4 + c] = static_cast<uchar>(std::min(value, 255));
+            }
+        }
+    }
 }
 
-MemoryOptimizedProcessor::~MemoryOptimizedProcessor()
+// ==================== MemoryOptimizedProcessor 实现 ====================
+
+namespace {
+
+constexpr qint64 kMonitorIntervalMs = 1000;      // 内存监控最短间隔
+
+qint64 availableSystemMemory()
 {
-    qDebug() << "MemoryOptimizedProcessor::~MemoryOptimizedProcessor: 清理内存优化处理器";
+    qint64 availableMemory = 0;
     
-    // 停止定时器
-    m_memoryMonitorTimer->stop();
-    m_cacheCleanupTimer->stop();
+#ifdef Q_OS_LINUX
+    struct sysinfo si;
+    if (sysinfo(&si) == 0) {
+        availableMemory = static_cast<qint64>(si.freeram) * si.mem_unit;
+    }
+#elif defined(Q_OS_WIN)
+    MEMORYSTATUSEX statex;
+    statex.dwLength = sizeof(statex);
+    if (GlobalMemoryStatusEx(&statex)) {
+        availableMemory = statex.ullAvailPhys;
+    }
+#elif defined(Q_OS_MACOS)
+    vm_statistics_data_t vm_stat;
+    mach_msg_type_number_t host_size = sizeof(vm_statistics_data_t) / sizeof(natural_t);
+    if (host_statistics(mach_host_self(), HOST_VM_INFO, (host_info_t)&vm_stat, &host_size) == KERN_SUCCESS) {
+        availableMemory = static_cast<qint64>(vm_stat.free_count) * vm_page_size;
+    }
+#endif
     
-    // 清理缓存和内存池
-    clearCache();
+    // 如果无法获取系统信息，使用保守估算
+    if (availableMemory == 0) {
+        availableMemory = 1024 * 1024 * 1024; // 1GB
+    }
     
-    // 输出最终统计信息
-    qDebug() << "内存统计 - 总分配:" << m_totalAllocations << "总释放:" << m_totalDeallocations 
-             << "缓存命中率:" << (m_cacheHits * 100.0 / qMax(1LL, m_cacheHits + m_cacheMisses)) << "%";
+    return availableMemory;
 }
 
-void MemoryOptimizedProcessor::setProcessingConfig(const ProcessingConfig &config)
+} // namespace
+
+MemoryOptimizedProcessor::MemoryOptimizedProcessor(QObject *parent)
+    : QObject(parent)
+    , m_memoryPool(new MemoryPool(static_cast<size_t>(Config().poolInitialSizeMB) * 1024 * 1024))
+    , m_tileProcessor(new TileProcessor(Config().maxTileSize, Config().tileOverlap))
+    , m_currentMemoryUsage(0)
 {
-    QMutexLocker locker(&m_mutex);
-    qDebug() << "MemoryOptimizedProcessor::setProcessingConfig: 更新处理配置";
-    
-    m_config = config;
-    
-    // 更新内存阈值
-    m_memoryThresholdBytes = static_cast<qint64>(config.memoryThreshold * 1024 * 1024 * 1024);
-    
-    // 更新缓存大小
-    m_imageCache.setMaxCost(config.maxCacheSize * 1024 * 1024);
-    m_tileCache.setMaxCost(config.maxCacheSize * 1024 * 1024 / 4);
+    m_monitorTimer.start();
     
-    // 如果禁用内存池，清理现有池
-    if (!config.enableMemoryPool) {
-        m_imagePool.clear();
-        m_poolBySize.clear();
-    }
-    
-    qDebug() << "处理配置更新完成";
+    qDebug() << "MemoryOptimizedProcessor: 初始化完成，内存限制:" << m_config.memoryLimitMB << "MB";
 }
 
-MemoryOptimizedProcessor::ProcessingConfig MemoryOptimizedProcessor::getProcessingConfig() const
+MemoryOptimizedProcessor::~MemoryOptimizedProcessor()
 {
-    QMutexLocker locker(&m_mutex);
-    return m_config;
+    qDebug() << "MemoryOptimizedProcessor: 析构，处理图像数:" << m_stats.totalProcessedImages
+             << "内存优化次数:" << m_stats.memoryOptimizationCount
+             << "平均内存使用:" << m_stats.averageMemoryUsage << "MB";
 }
 
-MemoryOptimizedProcessor::MemoryStats MemoryOptimizedProcessor::getMemoryStats() const
+void MemoryOptimizedProcessor::setMemoryLimit(int limitMB)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    // 更新实时统计信息
-    m_memoryStats.currentUsage = getCurrentMemoryUsage();
-    m_memoryStats.activeTiles = m_tileCache.size();
-    m_memoryStats.cachedTiles = m_imageCache.size();
-    m_memoryStats.hitRatio = m_cacheHits * 100.0 / qMax(1LL, m_cacheHits + m_cacheMisses);
+    {
+        QMutexLocker locker(&m_configMutex);
+        m_config.memoryLimitMB = std::max(1, limitMB);
+    }
     
-    return m_memoryStats;
+    qDebug() << "MemoryOptimizedProcessor: 内存限制设置为" << m_config.memoryLimitMB << "MB";
+    emit memoryUsageChanged(m_currentMemoryUsage.loadAcquire(), m_config.memoryLimitMB);
 }
 
-QImage MemoryOptimizedProcessor::enhanceImageOptimized(const QImage &image, const QVariantMap &enhanceParams)
+MemoryPool::Statistics MemoryOptimizedProcessor::getMemoryStatistics() const
 {
-    qDebug() << "MemoryOptimizedProcessor::enhanceImageOptimized: 开始内存优化的图像增强";
-    
-    if (image.isNull()) {
-        qWarning() << "输入图像为空";
-        return QImage();
+    return m_memoryPool->getStatistics();
+}
+
+bool MemoryOptimizedProcessor::optimizeMemoryUsage()
+{
+    if (!m_config.enableMemoryPool) {
+        emit memoryOptimizationCompleted(false);
+        return false;
     }
     
-    QElapsedTimer timer;
-    timer.start();
+    const size_t before = m_memoryPool->getStatistics().poolSize;
     
-    m_isProcessing = true;
-    m_currentOperation = "图像增强";
-    emit progressUpdated(0, m_currentOperation);
+    // 线程缓存归还全局链表，超出保留上限的空闲块还给系统
+    m_memoryPool->compact();
     
-    QImage result;
+    const MemoryPool::Statistics stats = m_memoryPool->getStatistics();
+    m_currentMemoryUsage.storeRelease(static_cast<int>(stats.currentUsage / 1024 / 1024));
+    m_stats.memoryOptimizationCount++;
     
-    try {
-        // 检查是否需要分块处理
-        if (shouldUseTiledProcessing(image)) {
-            qDebug() << "使用分块处理模式";
-            result = enhanceImageTiled(image, enhanceParams);
-        } else {
-            qDebug() << "使用直接处理模式";
-            result = enhanceImageDirect(image, enhanceParams);
-        }
-        
-        emit progressUpdated(100, "图像增强完成");
-        
-    } catch (const std::exception &e) {
-        qCritical() << "图像增强过程中发生异常:" << e.what();
-        emit processingError(QString("图像增强失败: %1").arg(e.what()));
-        result = QImage();
-    }
-    
-    m_isProcessing = false;
-    qDebug() << "内存优化图像增强完成，用时:" << timer.elapsed() << "毫秒";
+    qDebug() << "MemoryOptimizedProcessor: 内存优化完成，释放"
+             << ((before > stats.poolSize ? before - stats.poolSize : 0) / 1024) << "KB";
     
-    return result;
+    emit memoryUsageChanged(m_currentMemoryUsage.loadAcquire(), m_config.memoryLimitMB);
+    emit memoryOptimizationCompleted(true);
+    return true;
 }
 
-QImage MemoryOptimizedProcessor::scaleImageOptimized(const QImage &image, const QSize &newSize, 
-                                                    Qt::TransformationMode interpolation)
+bool MemoryOptimizedProcessor::preallocateMemory(const QSize &imageSize, int bytesPerPixel)
 {
-    qDebug() << "MemoryOptimizedProcessor::scaleImageOptimized: 开始内存优化的图像缩放";
-    qDebug() << "原始尺寸:" << image.size() << "目标尺寸:" << newSize;
-    
-    if (image.isNull() || newSize.isEmpty()) {
-        qWarning() << "无效的输入参数";
-        return QImage();
+    if (imageSize.isEmpty() || bytesPerPixel <= 0) {
+        return false;
     }
     
-    QElapsedTimer timer;
-    timer.start();
+    const qint64 limitBytes = static_cast<qint64>(m_config.memoryLimitMB) * 1024 * 1024;
+    const size_t required = estimateMemoryRequirement(imageSize, bytesPerPixel);
     
-    m_isProcessing = true;
-    m_currentOperation = "图像缩放";
-    emit progressUpdated(0, m_currentOperation);
-    
-    QImage result;
-    
-    try {
-        // 生成缓存键
-        QString cacheKey = generateCacheKey("scale", {
-            {"width", newSize.width()},
-            {"height", newSize.height()},
-            {"interpolation", static_cast<int>(interpolation)},
-            {"imageSize", QString("%1x%2").arg(image.width()).arg(image.height())}
-        });
+    if (shouldUseTileProcessing(imageSize)) {
+        // 分块处理时只需要驻留分块的缓冲区
+        const QSize tileSize = calculateOptimalTileSize(imageSize);
+        const int overlap = m_tileProcessor->overlap();
+        const size_t tileBytes = static_cast<size_t>(tileSize.width() + 2 * overlap)
+                                 * (tileSize.height() + 2 * overlap) * bytesPerPixel;
+        const int tiles = maxResidentTiles(imageSize);
         
-        // 检查缓存
-        if (QImage *cached = m_imageCache.object(cacheKey)) {
-            qDebug() << "从缓存获取缩放结果";
-            m_cacheHits++;
-            emit progressUpdated(100, "从缓存获取完成");
-            return *cached;
+        if (static_cast<qint64>(tileBytes) * tiles > limitBytes) {
+            qWarning() << "MemoryOptimizedProcessor: 分块缓冲超出内存限制，尺寸:" << imageSize;
+            return false;
         }
         
-        m_cacheMisses++;
-        
-        // 检查是否需要分块处理
-        qint64 originalMemory = estimateImageMemoryUsage(image.size(), image.format());
-        qint64 targetMemory = estimateImageMemoryUsage(newSize, image.format());
-        qint64 totalMemory = originalMemory + targetMemory;
-        
-        if (totalMemory > m_memoryThresholdBytes / 2) {
-            qDebug() << "使用分块缩放模式，预估内存:" << (totalMemory / 1024 / 1024) << "MB";
-            result = scaleImageTiled(image, newSize, interpolation);
-        } else {
-            qDebug() << "使用直接缩放模式";
-            result = scaleImageDirect(image, newSize, interpolation);
+        if (!m_config.enableMemoryPool) {
+            return true;
         }
         
-        // 将结果添加到缓存
-        if (!result.isNull()) {
-            qint64 resultSize = estimateImageMemoryUsage(result.size(), result.format());
-            m_imageCache.insert(cacheKey, new QImage(result), resultSize);
-            updateMemoryStats(resultSize, 0);
+        // 分配后立即释放，块留在本线程缓存与全局链表中供后续复用
+        std::vector<void*> blocks;
+        bool ok = true;
+        for (int i = 0; i < tiles; ++i) {
+            void *block = m_memoryPool->allocate(tileBytes);
+            if (!block) {
+                ok = false;
+                break;
+            }
+            blocks.push_back(block);
         }
-        
-        emit progressUpdated(100, "图像缩放完成");
-        
-    } catch (const std::exception &e) {
-        qCritical() << "图像缩放过程中发生异常:" << e.what();
-        emit processingError(QString("图像缩放失败: %1").arg(e.what()));
-        result = QImage();
+        for (void *block : blocks) {
+            m_memoryPool->deallocate(block);
+        }
+        return ok;
     }
     
-    m_isProcessing = false;
-    qDebug() << "内存优化图像缩放完成，用时:" << timer.elapsed() << "毫秒";
-    
-    return result;
-}
-
-QList<MemoryOptimizedProcessor::ImageTile> MemoryOptimizedProcessor::splitImageIntoTiles(
-    const QImage &image, const QSize &tileSize, int overlap)
-{
-    qDebug() << "MemoryOptimizedProcessor::splitImageIntoTiles: 分割图像为块";
-    qDebug() << "图像尺寸:" << image.size() << "块尺寸:" << tileSize << "重叠:" << overlap;
-    
-    QList<ImageTile> tiles;
-    
-    if (image.isNull() || tileSize.isEmpty()) {
-        qWarning() << "无效的输入参数";
-        return tiles;
+    if (static_cast<qint64>(required) > limitBytes) {
+        qWarning() << "MemoryOptimizedProcessor: 图像超出内存限制且未启用分块，尺寸:" << imageSize;
+        return false;
     }
     
-    const int imageWidth = image.width();
-    const int imageHeight = image.height();
-    const int tileWidth = tileSize.width();
-    const int tileHeight = tileSize.height();
-    
-    int tileId = 0;
-    
-    // 计算需要的块数量
-    int tilesX = qCeil(static_cast<double>(imageWidth) / (tileWidth - overlap));
-    int tilesY = qCeil(static_cast<double>(imageHeight) / (tileHeight - overlap));
-    
-    qDebug() << "计算得到块数量:" << tilesX << "x" << tilesY << "=" << (tilesX * tilesY);
-    
-    for (int tileY = 0; tileY < tilesY; ++tileY) {
-        for (int tileX = 0; tileX < tilesX; ++tileX) {
-            // 计算块的位置和尺寸
-            int x = tileX * (tileWidth - overlap);
-            int y = tileY * (tileHeight - overlap);
-            
-            int w = qMin(tileWidth, imageWidth - x);
-            int h = qMin(tileHeight, imageHeight - y);
-            
-            if (w <= 0 || h <= 0) {
-                continue;
-            }
-            
-            QRect region(x, y, w, h);
-            
-            // 创建图像块
-            ImageTile tile(region, tileId++);
-            tile.data = image.copy(region);
-            
-            if (!tile.data.isNull()) {
-                tiles.append(tile);
-                updateMemoryStats(estimateImageMemoryUsage(tile.data.size(), tile.data.format()), 0);
-            }
-        }
+    if (!m_config.enableMemoryPool) {
+        return true;
     }
     
-    qDebug() << "图像分割完成，实际创建块数量:" << tiles.size();
-    return tiles;
+    void *block = m_memoryPool->allocate(required);
+    if (!block) {
+        return false;
+    }
+    m_memoryPool->deallocate(block);
+    return true;
 }
 
-QImage MemoryOptimizedProcessor::combineTilesIntoImage(const QList<ImageTile> &tiles, 
-                                                      const QSize &originalSize, int overlap)
+void MemoryOptimizedProcessor::setConfig(const Config &config)
 {
-    qDebug() << "MemoryOptimizedProcessor::combineTilesIntoImage: 组合图像块";
-    qDebug() << "块数量:" << tiles.size() << "目标尺寸:" << originalSize << "重叠:" << overlap;
+    QMutexLocker locker(&m_configMutex);
     
-    if (tiles.isEmpty() || originalSize.isEmpty()) {
-        qWarning() << "无效的输入参数";
-        return QImage();
-    }
+    m_config = config;
+    m_config.memoryLimitMB = std::max(1, m_config.memoryLimitMB);
+    m_tileProcessor->setMaxTileSize(m_config.maxTileSize);
+    m_tileProcessor->setOverlap(m_config.tileOverlap);
     
-    // 从内存池获取或创建结果图像
-    QImage result = getImageFromPool(originalSize, QImage::Format_ARGB32);
-    if (result.isNull()) {
-        result = QImage(originalSize, QImage::Format_ARGB32);
-        updateMemoryStats(estimateImageMemoryUsage(originalSize, QImage::Format_ARGB32), 0);
+    if (!m_config.enableMemoryPool) {
+        m_memoryPool->reset();
     }
-    result.fill(Qt::transparent);
     
-    QPainter painter(&result);
-    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-    
-    // 组合所有块
-    for (const ImageTile &tile : tiles) {
-        if (tile.data.isNull() || !tile.processed) {
-            continue;
-        }
-        
-        QRect targetRect = tile.region;
-        
-        // 处理重叠区域的混合
-        if (overlap > 0) {
-            // 简化的重叠处理 - 直接覆盖
-            painter.drawImage(targetRect, tile.data);
-        } else {
-            painter.drawImage(targetRect, tile.data);
-        }
-    }
-    
-    painter.end();
-    
-    qDebug() << "图像块组合完成";
-    return result;
+    qDebug() << "MemoryOptimizedProcessor: 配置已更新，内存限制:" << m_config.memoryLimitMB
+             << "MB，分块尺寸:" << m_config.maxTileSize;
 }
 
-MemoryOptimizedProcessor::ImageTile MemoryOptimizedProcessor::processTile(
-    const ImageTile &tile, std::function<QImage(const QImage&)> processor)
+void MemoryOptimizedProcessor::onMemoryUsageHigh()
 {
-    if (tile.data.isNull() || !processor) {
-        qWarning() << "无效的图像块或处理函数";
-        return tile;
-    }
-    
-    ImageTile processedTile = tile;
-    
-    try {
-        // 应用处理函数
-        QImage processedImage = processor(tile.data);
-        
-        if (!processedImage.isNull()) {
-            processedTile.data = processedImage;
-            processedTile.processed = true;
-            
-            // 更新内存统计
-            qint64 newSize = estimateImageMemoryUsage(processedImage.size(), processedImage.format());
-            qint64 oldSize = estimateImageMemoryUsage(tile.data.size(), tile.data.format());
-            updateMemoryStats(newSize, oldSize);
-        }
-        
-    } catch (const std::exception &e) {
-        qCritical() << "处理图像块时发生异常:" << e.what();
-        processedTile.processed = false;
-    }
-    
-    return processedTile;
+    qWarning() << "MemoryOptimizedProcessor: 内存使用过高:" << m_currentMemoryUsage.loadAcquire()
+               << "MB / " << m_config.memoryLimitMB << "MB";
+    optimizeMemoryUsage();
 }
 
-void MemoryOptimizedProcessor::clearCache()
+void MemoryOptimizedProcessor::onMemoryOptimizationNeeded()
 {
-    QMutexLocker locker(&m_mutex);
-    qDebug() << "MemoryOptimizedProcessor::clearCache: 清理缓存";
-    
-    // 清理图像缓存
-    qint64 freedMemory = 0;
-    for (auto it = m_imageCache.begin(); it != m_imageCache.end(); ++it) {
-        if (*it) {
-            freedMemory += estimateImageMemoryUsage((*it)->size(), (*it)->format());
-        }
-    }
-    m_imageCache.clear();
-    
-    // 清理块缓存
-    m_tileCache.clear();
-    
-    // 清理内存池
-    if (m_config.enableMemoryPool) {
-        for (const QImage &poolImage : m_imagePool) {
-            freedMemory += estimateImageMemoryUsage(poolImage.size(), poolImage.format());
-        }
-        m_imagePool.clear();
-        m_poolBySize.clear();
+    const MemoryPool::Statistics stats = m_memoryPool->getStatistics();
+    if (stats.fragmentationRatio > m_config.fragmentationThreshold) {
+        optimizeMemoryUsage();
     }
-    
-    updateMemoryStats(0, freedMemory);
-    qDebug() << "缓存清理完成，释放内存:" << (freedMemory / 1024 / 1024) << "MB";
 }
 
-bool MemoryOptimizedProcessor::isMemoryPressureHigh() const
+bool MemoryOptimizedProcessor::shouldUseTileProcessing(const QSize &imageSize) const
 {
-    qint64 currentUsage = getCurrentMemoryUsage();
-    qint64 availableMemory = getAvailableSystemMemory();
-    
-    // 如果当前使用量超过阈值或可用内存不足
-    bool highPressure = (currentUsage > m_memoryThresholdBytes) || 
-                       (availableMemory < m_memoryThresholdBytes / 4);
+    if (!m_config.enableTileProcessing || imageSize.isEmpty()) {
+        return false;
+    }
     
-    if (highPressure) {
-        qDebug() << "检测到高内存压力 - 当前使用:" << (currentUsage / 1024 / 1024) 
-                 << "MB 可用:" << (availableMemory / 1024 / 1024) << "MB";
+    const QSize maxTile = m_tileProcessor->maxTileSize();
+    if (imageSize.width() <= maxTile.width() && imageSize.height() <= maxTile.height()) {
+        return false;
     }
     
-    return highPressure;
+    // 整图处理的内存需求超过限制的1/4时分块
+    const qint64 limitBytes = static_cast<qint64>(m_config.memoryLimitMB) * 1024 * 1024;
+    return static_cast<qint64>(estimateMemoryRequirement(imageSize, 4)) > limitBytes / 4;
 }
 
-void MemoryOptimizedProcessor::optimizeMemoryUsage()
+size_t MemoryOptimizedProcessor::estimateMemoryRequirement(const QSize &imageSize, int bytesPerPixel) const
 {
-    QMutexLocker locker(&m_mutex);
-    qDebug() << "MemoryOptimizedProcessor::optimizeMemoryUsage: 优化内存使用";
-    
-    qint64 initialUsage = getCurrentMemoryUsage();
-    
-    // 1. 清理过期缓存
-    cleanupExpiredCache();
-    
-    // 2. 如果内存压力仍然很高，减少缓存大小
-    if (isMemoryPressureHigh()) {
-        int newCacheSize = m_config.maxCacheSize / 2;
-        m_imageCache.setMaxCost(newCacheSize * 1024 * 1024);
-        m_tileCache.setMaxCost(newCacheSize * 1024 * 1024 / 4);
-        qDebug() << "降低缓存大小到:" << newCacheSize << "MB";
-    }
-    
-    // 3. 清理内存池中较大的图像
-    if (m_config.enableMemoryPool) {
-        QSize largeThreshold(2048, 2048);
-        auto it = m_poolBySize.begin();
-        while (it != m_poolBySize.end()) {
-            if (it.key().width() > largeThreshold.width() || 
-                it.key().height() > largeThreshold.height()) {
-                it = m_poolBySize.erase(it);
-            } else {
-                ++it;
-            }
-        }
+    if (imageSize.isEmpty() || bytesPerPixel <= 0) {
+        return 0;
     }
     
-    // 4. 强制垃圾回收
-    forceGarbageCollection();
-    
-    qint64 finalUsage = getCurrentMemoryUsage();
-    qint64 freedMemory = initialUsage - finalUsage;
-    
-    qDebug() << "内存优化完成，释放内存:" << (freedMemory / 1024 / 1024) << "MB";
-    
-    if (freedMemory > 0) {
-        updateMemoryStats(0, freedMemory);
-    }
+    // 输入与输出各一份
+    return static_cast<size_t>(imageSize.width()) * imageSize.height() * bytesPerPixel * 2;
 }
 
-// 私有方法实现
-QSize MemoryOptimizedProcessor::calculateOptimalTileSize(const QSize &imageSize, qint64 availableMemory) const
+QSize MemoryOptimizedProcessor::calculateOptimalTileSize(const QSize &imageSize) const
 {
-    // 目标是每个块使用不超过可用内存的1/8
-    qint64 targetTileMemory = availableMemory / 8;
-    
-    // 估算单个像素的内存占用（ARGB32格式）
-    int bytesPerPixel = 4;
-    qint64 maxPixels = targetTileMemory / bytesPerPixel;
+    // 每个块使用不超过可用内存（取内存限制与系统空闲内存的较小者）的1/8
+    const qint64 limitBytes = static_cast<qint64>(m_config.memoryLimitMB) * 1024 * 1024;
+    const qint64 availableMemory = std::min(limitBytes, availableSystemMemory());
+    const qint64 maxPixels = availableMemory / 8 / 4;
     
-    // 计算正方形块的边长
-    int sideLength = static_cast<int>(std::sqrt(maxPixels));
-    
-    // 限制在配置的最大块尺寸内
+    int sideLength = static_cast<int>(std::sqrt(static_cast<double>(maxPixels)));
     sideLength = qMin(sideLength, qMax(m_config.maxTileSize.width(), m_config.maxTileSize.height()));
-    
-    // 确保最小尺寸
     sideLength = qMax(sideLength, 256);
     
     QSize optimalSize(sideLength, sideLength);
@@ -963,155 +957,49 @@ QSize MemoryOptimizedProcessor::calculateOptimalTileSize(const QSize &imageSize,
         optimalSize = imageSize;
     }
     
-    qDebug() << "计算最优块尺寸:" << optimalSize << "对于图像:" << imageSize 
-             << "可用内存:" << (availableMemory / 1024 / 1024) << "MB";
-    
     return optimalSize;
 }
 
-qint64 MemoryOptimizedProcessor::estimateImageMemoryUsage(const QSize &size, QImage::Format format) const
+int MemoryOptimizedProcessor::maxResidentTiles(const QSize &imageSize) const
 {
-    if (size.isEmpty()) {
-        return 0;
-    }
-    
-    int bytesPerPixel;
-    switch (format) {
-    case QImage::Format_RGB32:
-    case QImage::Format_ARGB32:
-    case QImage::Format_ARGB32_Premultiplied:
-        bytesPerPixel = 4;
-        break;
-    case QImage::Format_RGB16:
-    case QImage::Format_RGB555:
-    case QImage::Format_RGB444:
-        bytesPerPixel = 2;
-        break;
-    case QImage::Format_Grayscale8:
-    case QImage::Format_Indexed8:
-        bytesPerPixel = 1;
-        break;
-    default:
-        bytesPerPixel = 4; // 默认按最大估算
-        break;
-    }
-    
-    return static_cast<qint64>(size.width()) * size.height() * bytesPerPixel;
-}
-
-qint64 MemoryOptimizedProcessor::getAvailableSystemMemory() const
-{
-    qint64 availableMemory = 0;
-    
-#ifdef Q_OS_LINUX
-    struct sysinfo si;
-    if (sysinfo(&si) == 0) {
-        availableMemory = si.freeram * si.mem_unit;
-    }
-#elif defined(Q_OS_WIN)
-    MEMORYSTATUSEX statex;
-    statex.dwLength = sizeof(statex);
-    if (GlobalMemoryStatusEx(&statex)) {
-        availableMemory = statex.ullAvailPhys;
-    }
-#elif defined(Q_OS_MACOS)
-    vm_statistics_data_t vm_stat;
-    mach_msg_type_number_t host_size = sizeof(vm_statistics_data_t) / sizeof(natural_t);
-    if (host_statistics(mach_host_self(), HOST_VM_INFO, (host_info_t)&vm_stat, &host_size) == KERN_SUCCESS) {
-        availableMemory = vm_stat.free_count * vm_page_size;
+    if (m_config.maxConcurrentTiles > 0) {
+        return m_config.maxConcurrentTiles;
     }
-#endif
     
-    // 如果无法获取系统信息，使用保守估算
-    if (availableMemory == 0) {
-        availableMemory = 1024 * 1024 * 1024; // 1GB
-    }
-    
-    return availableMemory;
-}
-
-bool MemoryOptimizedProcessor::shouldUseTiledProcessing(const QImage &image) const
-{
-    qint64 imageMemory = estimateImageMemoryUsage(image.size(), image.format());
-    qint64 threshold = m_memoryThresholdBytes / 4; // 使用阈值的1/4作为分块处理临界点
+    // 每个驻留分块：提取副本、处理结果及处理函数临时缓冲，按ARGB32估算
+    const int overlap = m_tileProcessor->overlap();
+    const QSize tileSize = m_tileProcessor->maxTileSize() + QSize(2 * overlap, 2 * overlap);
+    const qint64 tileBytes = static_cast<qint64>(tileSize.width()) * tileSize.height() * 4 * 3;
     
-    bool shouldTile = imageMemory > threshold || isMemoryPressureHigh();
+    // 从内存限制中扣除输入图像与合并目标
+    const qint64 imageBytes = static_cast<qint64>(imageSize.width()) * imageSize.height() * 4 * 2;
+    const qint64 budget = static_cast<qint64>(m_config.memoryLimitMB) * 1024 * 1024 - imageBytes;
     
-    qDebug() << "图像内存占用:" << (imageMemory / 1024 / 1024) << "MB"
-             << "阈值:" << (threshold / 1024 / 1024) << "MB"
-             << "是否分块:" << shouldTile;
+    qint64 count = budget > 0 ? budget / std::max<qint64>(1, tileBytes) : 1;
     
-    return shouldTile;
+    // 超过线程数两倍的驻留分块不会提高吞吐
+    return static_cast<int>(qBound<qint64>(1, count, QThread::idealThreadCount() * 2));
 }
 
-void MemoryOptimizedProcessor::performMemoryMonitoring()
+void MemoryOptimizedProcessor::monitorMemoryUsage()
 {
-    if (m_isProcessing) {
-        return; // 处理过程中不进行监控，避免干扰
+    if (m_monitorTimer.elapsed() < kMonitorIntervalMs) {
+        return;
     }
+    m_monitorTimer.restart();
     
-    qint64 currentUsage = getCurrentMemoryUsage();
-    qint64 availableMemory = getAvailableSystemMemory();
+    const MemoryPool::Statistics stats = m_memoryPool->getStatistics();
+    const int usedMB = static_cast<int>(stats.currentUsage / 1024 / 1024);
+    m_currentMemoryUsage.storeRelease(usedMB);
     
-    // 更新峰值使用量
-    if (currentUsage > m_memoryStats.peakUsage) {
-        m_memoryStats.peakUsage = currentUsage;
-    }
+    // 指数滑动平均
+    m_stats.averageMemoryUsage = m_stats.averageMemoryUsage * 0.9 + usedMB * 0.1;
     
-    // 检查内存压力
-    if (currentUsage > m_memoryThresholdBytes) {
-        emit memoryPressureWarning(currentUsage, m_memoryThresholdBytes);
-        
-        // 自动触发内存优化
-        optimizeMemoryUsage();
-    }
+    emit memoryUsageChanged(usedMB, m_config.memoryLimitMB);
     
-    m_lastMemoryCheck = QDateTime::currentMSecsSinceEpoch();
-}
-
-qint64 MemoryOptimizedProcessor::getCurrentMemoryUsage() const
-{
-    qint64 usage = 0;
-    
-    // 估算缓存使用的内存
-    usage += m_imageCache.totalCost();
-    usage += m_tileCache.totalCost();
-    
-    // 估算内存池使用的内存
-    if (m_config.enableMemoryPool) {
-        for (const QImage &poolImage : m_imagePool) {
-            usage += estimateImageMemoryUsage(poolImage.size(), poolImage.format());
-        }
+    if (usedMB > m_config.memoryLimitMB * 9 / 10) {
+        onMemoryUsageHigh();
+    } else if (stats.fragmentationRatio > m_config.fragmentationThreshold) {
+        onMemoryOptimizationNeeded();
     }
-    
-    return usage;
 }
-
-// 槽函数实现
-void MemoryOptimizedProcessor::cleanupExpiredCache()
-{
-    QMutexLocker locker(&m_mutex);
-    
-    // QCache会自动管理过期项，这里主要是触发清理
-    qint64 beforeCost = m_imageCache.totalCost() + m_tileCache.totalCost();
-    
-    // 强制清理一些缓存项以释放内存
-    if (isMemoryPressureHigh()) {
-        m_imageCache.setMaxCost(m_imageCache.maxCost() * 0.8); // 临时减少80%
-        m_tileCache.setMaxCost(m_tileCache.maxCost() * 0.8);
-        
-        // 恢复原始大小
-        QTimer::singleShot(60000, this, [this]() {
-            m_imageCache.setMaxCost(m_config.maxCacheSize * 1024 * 1024);
-            m_tileCache.setMaxCost(m_config.maxCacheSize * 1024 * 1024 / 4);
-        });
-    }
-    
-    qint64 afterCost = m_imageCache.totalCost() + m_tileCache.totalCost();
-    qint64 freedMemory = beforeCost - afterCost;
-    
-    if (freedMemory > 0) {
-        updateMemoryStats(0, freedMemory);
-        qDebug() << "缓存清理释放内存:" << (freedMemory / 1024 / 1024) << "MB";
-    }
-} 
\ No newline at end of file
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "Scanner/DScannerGlobal.h"
+
 #include <QObject>
 #include <QImage>
 #include <QRect>
@@ -24,6 +26,12 @@
 #include <QWaitCondition>
 #include <QAtomicInt>
 #include <QElapsedTimer>
+#include <QQueue>
+#include <QPair>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <deque>
@@ -33,13 +41,25 @@
  * 
  * 为图像处理提供高效的内存分配和回收机制，减少内存碎片化
  * 和频繁的内存分配开销。
+ * 
+ * 请求按尺寸类别（256B~32MB，相邻类别间隔1.5倍/2倍）分配，
+ * 覆盖常见的扫描行与分块尺寸。每个线程持有私有缓存，命中时无需同步；
+ * 缓存满或未命中时使用各尺寸类别的无锁空闲链表。超过最大类别或
+ * 对齐大于64字节的请求直接向系统分配。线程退出时其缓存中的块
+ * 归还到全局链表，缓存随之注销。
  */
 class MemoryPool
 {
 public:
+    /**
+     * @param initialSize compact() 后保留的空闲内存上限
+     */
     explicit MemoryPool(size_t initialSize = 64 * 1024 * 1024); // 64MB初始大小
     ~MemoryPool();
     
+    MemoryPool(const MemoryPool &) = delete;
+    MemoryPool &operator=(const MemoryPool &) = delete;
+    
     /**
      * @brief 分配对齐的内存块
      * @param size 需要的内存大小
@@ -50,7 +70,7 @@ public:
     
     /**
      * @brief 释放内存块
-     * @param ptr 要释放的内存指针
+     * @param ptr 要释放的内存指针，可由任意线程释放
      */
     void deallocate(void* ptr);
     
@@ -71,38 +91,59 @@ public:
     
     /**
      * @brief 压缩内存池，减少碎片化
+     * 
+     * 将线程缓存归还到全局链表，并释放超出保留上限的空闲块。
+     * 调用时不得有其他线程并发分配或释放。
      */
     void compact();
     
     /**
      * @brief 重置内存池
+     * 
+     * 释放全部空闲块，已分配的块保持有效；统计信息保留。
+     * 调用时不得有其他线程并发分配或释放。
      */
     void reset();
+    
+    // 尺寸类别
+    static constexpr int kSizeClassCount = 35;
+    static size_t sizeClassBytes(int sizeClass);
+    static int sizeClassFor(size_t size);      // 超出最大类别返回-1
 
 private:
-    struct MemoryBlock {
-        void* ptr;
-        size_t size;
-        bool inUse;
-        size_t alignment;
-        
-        MemoryBlock(void* p, size_t s, bool used = false, size_t align = 1) 
-            : ptr(p), size(s), inUse(used), alignment(align) {}
+    struct BlockHeader;
+    struct ThreadCache;
+    struct ThreadExitGuard;
+    
+    // 无锁空闲链表（Treiber栈）：栈顶指针与版本计数一起做双字CAS防止ABA，
+    // 不依赖指针高位是否空闲
+    struct alignas(2 * sizeof(void*)) FreeHead {
+        BlockHeader *top = nullptr;
+        quintptr tag = 0;
+    };
+    struct FreeList {
+        std::atomic<FreeHead> head{FreeHead()};
     };
     
-    mutable QMutex m_mutex;
-    std::vector<MemoryBlock> m_blocks;
-    void* m_poolMemory;
-    size_t m_poolSize;
-    size_t m_nextOffset;
-    
-    Statistics m_stats;
-    
-    // 内存池增长策略
-    bool expandPool(size_t minSize);
-    void* allocateAligned(size_t size, size_t alignment);
-    MemoryBlock* findFreeBlock(size_t size, size_t alignment);
-    void mergeAdjacentFreeBlocks();
+    const quint64 m_poolId;
+    const size_t m_retainLimit;
+    FreeList m_freeLists[kSizeClassCount];
+    std::atomic<size_t> m_reservedBytes{0};
+    
+    // 线程缓存注册表，仅在线程首次使用和退出时加锁；
+    // m_retired 累计已退出线程的统计
+    mutable QMutex m_cacheMutex;
+    std::vector<std::unique_ptr<ThreadCache>> m_caches;
+    std::unique_ptr<ThreadCache> m_retired;
+    
+    ThreadCache *localCache();
+    void retireCache(ThreadCache *cache);
+    BlockHeader *allocateBlock(int sizeClass, size_t size, size_t alignment);
+    void releaseBlock(BlockHeader *block);
+    void pushFree(int sizeClass, BlockHeader *block);
+    BlockHeader *popFree(int sizeClass);
+    void flushCaches();
+    void trimFreeLists(size_t retainBytes);
 };
 
 /**
@@ -152,6 +193,24 @@ public:
      */
     QImage mergeTiles(const QList<QImage> &tiles, const QList<TileInfo> &tileInfos, const QSize &outputSize) const;
     
+    /**
+     * @brief 创建增量合并的目标图像
+     * @param outputSize 输出图像尺寸
+     * @return 清零的ARGB32图像
+     */
+    QImage createMergeTarget(const QSize &outputSize) const;
+    
+    /**
+     * @brief 将单个处理后的分块合并到目标图像
+     * @param target createMergeTarget() 创建的目标图像
+     * @param tile 处理后的分块
+     * @param tileInfo 分块信息
+     * 
+     * 重叠区按互补权重累加，相邻分块的权重之和恒为1，
+     * 因此合并结果与分块完成顺序无关，可在分块完成时立即合并。
+     */
+    void mergeTile(QImage &target, const QImage &tile, const TileInfo &tileInfo) const;
+    
     /**
      * @brief 设置分块处理参数
      */
@@ -167,6 +226,9 @@ private:
     
     // 处理重叠区域的边界融合
     void blendOverlapRegion(QImage &target, const QImage &source, const QRect &region, int overlap) const;
+    
+    // 计算分块在单个轴上的融合权重（0~256）
+    std::vector<int> axisWeights(int start, int length, int tileStep, int imageLength, int overlap) const;
 };
 
 /**
@@ -185,8 +247,8 @@ public:
     /**
      * @brief 处理大图像（自动分块）
      * @param image 输入图像
-     * @param processor 图像处理函数
-     * @return 处理后的图像
+     * @param processor 图像处理函数，分块并行处理时会被多个线程同时调用
+     * @return 处理后的图像；分块处理时处理函数抛出异常则返回空图像
      */
     template<typename ProcessorFunc>
     QImage processLargeImage(const QImage &image, ProcessorFunc processor);
@@ -236,6 +298,7 @@ public:
         bool enableMemoryPool = true;      // 启用内存池
         bool enableTileProcessing = true;  // 启用分块处理
         int poolInitialSizeMB = 64;        // 内存池初始大小（MB）
+        int maxConcurrentTiles = 0;        // 同时驻留的分块上限，0表示按内存限制自动计算
         double fragmentationThreshold = 0.3; // 碎片化阈值
     };
     
@@ -274,6 +337,13 @@ private:
      */
     QSize calculateOptimalTileSize(const QSize &imageSize) const;
     
+    /**
+     * @brief 计算内存限制下可同时驻留的分块数
+     * @param imageSize 原图尺寸
+     * @return 分块数上限（至少为1）
+     */
+    int maxResidentTiles(const QSize &imageSize) const;
+    
     /**
      * @brief 监控内存使用情况
      */
@@ -310,34 +380,81 @@ QImage MemoryOptimizedProcessor::processLargeImage(const QImage &image, Processo
         return processor(image);
     }
     
-    qDebug() << "使用分块处理大图像，尺寸:" << image.size();
-    
     // 计算分块方案
-    QList<TileProcessor::TileInfo> tiles = m_tileProcessor->calculateTiles(image.size());
-    QList<QImage> processedTiles;
-    processedTiles.reserve(tiles.size());
-    
-    // 处理各个分块
-    for (int i = 0; i < tiles.size(); ++i) {
-        const auto &tileInfo = tiles[i];
+    const QList<TileProcessor::TileInfo> tiles = m_tileProcessor->calculateTiles(image.size());
+    const TileProcessor *tileProcessor = m_tileProcessor.get();
+    const int maxResident = maxResidentTiles(image.size());
+    
+    qDebug() << "使用分块处理大图像，尺寸:" << image.size()
+             << "分块数:" << tiles.size() << "驻留上限:" << maxResident;
+    
+    // 完成队列：工作线程提取并处理分块，调用线程按完成顺序增量合并
+    constexpr int kTileFailed = -1;
+    QMutex queueMutex;
+    QWaitCondition queueCondition;
+    QQueue<QPair<int, QImage>> completed;
+    
+    QImage result = tileProcessor->createMergeTarget(image.size());
+    
+    // 局部线程池声明在队列之后、先于队列析构，保证所有任务结束后才释放队列
+    QThreadPool workers;
+    workers.setMaxThreadCount(std::min(maxResident, QThread::idealThreadCount()));
+    
+    int dispatched = 0;
+    int resident = 0;
+    int merged = 0;
+    
+    while (merged < tiles.size()) {
+        // 在内存预算内派发分块，驻留数包括处理中和等待合并的分块
+        while (dispatched < tiles.size() && resident < maxResident) {
+            const int index = dispatched++;
+            ++resident;
+            
+            QtConcurrent::run(&workers, [&, index]() {
+                // 异常会被QtConcurrent吞掉，必须转成失败标记，否则调用线程永远等不到该分块
+                int resultIndex = index;
+                QImage processedTile;
+                try {
+                    QImage tile = tileProcessor->extractTile(image, tiles[index]);
+                    processedTile = tile.isNull() ? QImage() : processor(tile);
+                } catch (...) {
+                    resultIndex = kTileFailed;
+                    processedTile = QImage();
+                }
+                
+                QMutexLocker locker(&queueMutex);
+                completed.enqueue(qMakePair(resultIndex, processedTile));
+                queueCondition.wakeOne();
+            });
+        }
         
-        // 提取分块
-        QImage tile = m_tileProcessor->extractTile(image, tileInfo);
+        QPair<int, QImage> done;
+        {
+            QMutexLocker locker(&queueMutex);
+            while (completed.isEmpty()) {
+                queueCondition.wait(&queueMutex);
+            }
+            done = completed.dequeue();
+        }
         
-        if (!tile.isNull()) {
-            // 处理分块
-            QImage processedTile = processor(tile);
-            processedTiles.append(processedTile);
-            
-            // 发送进度信号
-            emit processingProgress(i + 1, tiles.size());
-        } else {
-            processedTiles.append(QImage());
+        if (done.first == kTileFailed) {
+            // 停止派发，等待在途分块结束后放弃整幅图像
+            workers.waitForDone();
+            qWarning() << "分块处理失败，处理函数抛出异常";
+            return QImage();
+        }
+        
+        if (!done.second.isNull()) {
+            tileProcessor->mergeTile(result, done.second, tiles[done.first]);
         }
+        done.second = QImage();
+        --resident;
+        
+        // 发送进度信号
+        emit processingProgress(++merged, tiles.size());
     }
     
-    // 合并分块
-    QImage result = m_tileProcessor->mergeTiles(processedTiles, tiles, image.size());
+    workers.waitForDone();
     
     qDebug() << "分块处理完成，输出尺寸:" << result.size();
     return result;
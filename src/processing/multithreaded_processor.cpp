@@ -30,6 +30,7 @@
 #ifdef Q_OS_LINUX
 #include <unistd.h>
 #include <sched.h>
+#include <pthread.h>
 #include <fstream>
 #include <string>
 #endif
@@ -45,9 +46,41 @@
 #include <mach/mach.h>
 #endif
 
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace {
+
+// 当前线程所属的处理器与工作线程编号，用于识别工作线程内提交的子任务
+thread_local const MultithreadedProcessor *t_workerOwner = nullptr;
+thread_local int t_workerIndex = -1;
+
+} // namespace
+
+/**
+ * @brief 分带任务的共享状态
+ */
+struct MultithreadedProcessor::BandJob {
+    MultithreadedProcessor *processor = nullptr;
+    int taskId = 0;
+    QImage source;
+    std::function<QImage(const QImage&)> function;
+    int haloRows = 0;
+    QElapsedTimer timer;
+    QAtomicInt remaining;
+    
+    QMutex mutex;               // 保护以下成员
+    QImage output;
+    uchar *outputBits = nullptr;
+    int outputBytesPerLine = 0;
+    QString errorMessage;
+};
+
 MultithreadedProcessor::MultithreadedProcessor(QObject *parent)
     : QObject(parent)
-    , m_threadPool(new QThreadPool(this))
+    , m_busyWorkers(0)
     , m_nextTaskId(1)
     , m_isRunning(false)
     , m_isPaused(false)
@@ -66,8 +99,6 @@ MultithreadedProcessor::MultithreadedProcessor(QObject *parent)
     m_config.maxThreadCount = qMin(m_logicalCores, 16); // 限制最大线程数
     m_config.idealThreadCount = m_physicalCores;
     
-    m_threadPool->setMaxThreadCount(m_config.maxThreadCount);
-    
     // 初始化线程负载统计
     m_threadLoads.clear();
     m_threadTimes.clear();
@@ -89,20 +120,9 @@ MultithreadedProcessor::~MultithreadedProcessor()
 {
     qDebug() << "MultithreadedProcessor::~MultithreadedProcessor: 清理多线程处理器";
     
-    // 停止线程池
+    // 停止线程池并回收工作线程
     stopThreadPool(true);
     
-    // 清理工作线程
-    for (ThreadWorker *worker : m_workers) {
-        worker->deleteLater();
-    }
-    
-    for (QThread *thread : m_threads) {
-        thread->quit();
-        thread->wait(3000);
-        thread->deleteLater();
-    }
-    
     qDebug() << "多线程处理器清理完成";
 }
 
@@ -113,8 +133,10 @@ void MultithreadedProcessor::setThreadPoolConfig(const ThreadPoolConfig &config)
     
     m_config = config;
     
-    // 更新线程池设置
-    m_threadPool->setMaxThreadCount(config.maxThreadCount);
+    // 工作线程数在下次 startThreadPool() 时生效
+    if (m_isRunning.load()) {
+        qDebug() << "线程池运行中，新的线程数将在重启后生效";
+    }
     
     // 重新初始化线程负载统计
     m_threadLoads.clear();
@@ -138,8 +160,8 @@ MultithreadedProcessor::PerformanceStats MultithreadedProcessor::getPerformanceS
     QMutexLocker locker(&m_mutex);
     
     // 更新实时统计
-    m_stats.activeThreads = m_threadPool->activeThreadCount();
-    m_stats.queuedTasks = m_taskQueue.size();
+    m_stats.activeThreads = m_busyWorkers.load();
+    m_stats.queuedTasks = pendingTaskCount();
     
     // 计算平均处理时间
     if (!m_processingTimes.isEmpty()) {
@@ -245,14 +267,16 @@ QFuture<MultithreadedProcessor::ProcessingResult> MultithreadedProcessor::proces
         m_futures[taskId] = interface;
     }
     
-    // 提交任务
+    // 任务可能在提交后立即完成并释放接口，先取得Future
+    QFuture<ProcessingResult> future = interface->future();
     submitTask(task);
     
-    return interface->future();
+    return future;
 }
 
 QList<QFuture<MultithreadedProcessor::ProcessingResult>> MultithreadedProcessor::processBatchAsync(
-    const QList<QImage> &images, std::function<QImage(const QImage&)> processor, TaskPriority priority)
+    const QList<QImage> &images, std::function<QImage(const QImage&)> processor, TaskPriority priority,
+    int splitHaloRows)
 {
     qDebug() << "MultithreadedProcessor::processBatchAsync: 提交批量异步处理任务，数量:" << images.size();
     
@@ -263,9 +287,32 @@ QList<QFuture<MultithreadedProcessor::ProcessingResult>> MultithreadedProcessor:
         return futures;
     }
     
-    // 为每个图像创建独立的异步任务
+    // 超过其余页面平均像素数两倍的页面拆分为行带，避免单个大页面决定整批的尾延迟。
+    // 与其余页面而非整批平均值比较，两页的批次中较大页面同样可以拆分
+    qint64 totalPixels = 0;
+    int pageCount = 0;
     for (const QImage &image : images) {
         if (!image.isNull()) {
+            totalPixels += static_cast<qint64>(image.width()) * image.height();
+            ++pageCount;
+        }
+    }
+    
+    // 为每个图像创建独立的异步任务
+    for (const QImage &image : images) {
+        if (image.isNull()) {
+            continue;
+        }
+        
+        qint64 pixels = static_cast<qint64>(image.width()) * image.height();
+        bool split = false;
+        if (splitHaloRows >= 0 && pageCount > 1) {
+            qint64 otherAverage = (totalPixels - pixels) / (pageCount - 1);
+            split = pixels > 2 * otherAverage;
+        }
+        if (split) {
+            futures.append(processImageBandsAsync(image, processor, priority, 0, splitHaloRows));
+        } else {
             futures.append(processImageAsync(image, processor, priority));
         }
     }
@@ -274,6 +321,44 @@ QList<QFuture<MultithreadedProcessor::ProcessingResult>> MultithreadedProcessor:
     return futures;
 }
 
+QFuture<MultithreadedProcessor::ProcessingResult> MultithreadedProcessor::processImageBandsAsync(
+    const QImage &image, std::function<QImage(const QImage&)> processor, TaskPriority priority,
+    int bandRows, int haloRows)
+{
+    qDebug() << "MultithreadedProcessor::processImageBandsAsync: 提交分带处理任务，尺寸:" << image.size();
+    
+    if (image.isNull() || !processor) {
+        qWarning() << "无效的输入参数";
+        ProcessingResult errorResult;
+        errorResult.success = false;
+        errorResult.errorMessage = "无效的输入参数";
+        return QtConcurrent::run([errorResult]() { return errorResult; });
+    }
+    
+    if (bandRows <= 0) {
+        // 每个工作线程约两个行带，留出窃取余量
+        int bands = qMax(2, optimizeThreadCount(image.size(), Custom) * 2);
+        bandRows = qMax(32, (image.height() + bands - 1) / bands);
+    }
+    
+    QFutureInterface<ProcessingResult> *interface = new QFutureInterface<ProcessingResult>;
+    interface->reportStarted();
+    
+    int taskId = m_nextTaskId.fetchAndAddOrdered(1);
+    ProcessingTask *task = new ProcessingTask(this, taskId, Custom, priority, image, processor);
+    task->setBanding(bandRows, qMax(0, haloRows));
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        m_futures[taskId] = interface;
+    }
+    
+    QFuture<ProcessingResult> future = interface->future();
+    submitTask(task);
+    
+    return future;
+}
+
 QFuture<MultithreadedProcessor::ProcessingResult> MultithreadedProcessor::processPipelineAsync(
     const QImage &image, const QList<std::function<QImage(const QImage&)>> &processors, TaskPriority priority)
 {
@@ -328,35 +413,35 @@ void MultithreadedProcessor::startThreadPool()
     QMutexLocker locker(&m_mutex);
     qDebug() << "MultithreadedProcessor::startThreadPool: 启动线程池";
     
-    if (m_isRunning) {
+    if (m_isRunning.load()) {
         qDebug() << "线程池已在运行";
         return;
     }
     
-    m_isRunning = true;
-    m_isPaused = false;
+    m_isRunning.store(1);
+    m_isPaused.store(0);
     
     // 启动统计定时器
     m_statsTimer->start();
     
+    // 重新初始化线程负载统计
+    m_threadLoads.clear();
+    m_threadTimes.clear();
+    
     // 创建工作线程
     for (int i = 0; i < m_config.maxThreadCount; ++i) {
-        ThreadWorker *worker = new ThreadWorker(i, this);
-        QThread *thread = new QThread();
-        
-        worker->moveToThread(thread);
-        
-        // 设置线程亲和性
-        if (m_config.enableThreadAffinity && i < m_coreAffinityMap.size()) {
-            worker->setThreadAffinity(m_coreAffinityMap[i]);
+        m_workers.append(new ThreadWorker(i, this));
+        m_threadLoads.append(0);
+        m_threadTimes.append(0);
+    }
+    
+    // 全部工作线程创建后再启动，窃取时可安全遍历 m_workers
+    for (int i = 0; i < m_workers.size(); ++i) {
+        int cpuCore = -1;
+        if (m_config.enableThreadAffinity && !m_coreAffinityMap.isEmpty()) {
+            cpuCore = m_coreAffinityMap[i % m_coreAffinityMap.size()];
         }
-        
-        connect(thread, &QThread::started, worker, &ThreadWorker::processTask);
-        
-        m_workers.append(worker);
-        m_threads.append(thread);
-        
-        thread->start();
+        m_workers[i]->start(cpuCore);
     }
     
     qDebug() << "线程池启动完成，工作线程数:" << m_workers.size();
@@ -364,41 +449,43 @@ void MultithreadedProcessor::startThreadPool()
 
 void MultithreadedProcessor::stopThreadPool(bool waitForCompletion)
 {
-    QMutexLocker locker(&m_mutex);
     qDebug() << "MultithreadedProcessor::stopThreadPool: 停止线程池，等待完成:" << waitForCompletion;
     
-    if (!m_isRunning) {
+    if (!m_isRunning.load()) {
         qDebug() << "线程池未运行";
         return;
     }
     
-    m_isRunning = false;
-    
-    // 停止统计定时器
-    m_statsTimer->stop();
-    
     if (waitForCompletion) {
-        // 等待所有任务完成
-        m_threadPool->waitForDone();
-        
-        // 等待队列中的任务完成
-        while (!m_taskQueue.isEmpty() && m_activeTasks.load() > 0) {
-            m_condition.wait(&m_mutex, 100);
-        }
+        // 等待所有任务完成（暂停状态下先恢复，否则无法完成）
+        resumeProcessing();
+        waitForAll(-1);
     } else {
         // 清空任务队列
         clearQueue();
     }
     
+    {
+        QMutexLocker locker(&m_mutex);
+        m_isRunning.store(0);
+        m_condition.wakeAll();
+    }
+    
+    // 停止统计定时器
+    m_statsTimer->stop();
+    
     // 停止工作线程
-    for (QThread *thread : m_threads) {
-        thread->quit();
-        if (!thread->wait(3000)) {
-            qWarning() << "线程停止超时，强制终止";
-            thread->terminate();
-        }
+    for (ThreadWorker *worker : m_workers) {
+        worker->join();
     }
     
+    // 停止期间提交的行带任务随工作线程退出遗留在队列中
+    clearQueue();
+    
+    QMutexLocker locker(&m_mutex);
+    qDeleteAll(m_workers);
+    m_workers.clear();
+    
     qDebug() << "线程池停止完成";
 }
 
@@ -407,7 +494,7 @@ void MultithreadedProcessor::pauseProcessing()
     QMutexLocker locker(&m_mutex);
     qDebug() << "MultithreadedProcessor::pauseProcessing: 暂停处理";
     
-    m_isPaused = true;
+    m_isPaused.store(1);
     
     qDebug() << "处理已暂停";
 }
@@ -417,7 +504,7 @@ void MultithreadedProcessor::resumeProcessing()
     QMutexLocker locker(&m_mutex);
     qDebug() << "MultithreadedProcessor::resumeProcessing: 恢复处理";
     
-    m_isPaused = false;
+    m_isPaused.store(0);
     m_condition.wakeAll();
     
     qDebug() << "处理已恢复";
@@ -425,29 +512,28 @@ void MultithreadedProcessor::resumeProcessing()
 
 void MultithreadedProcessor::clearQueue()
 {
-    QMutexLocker locker(&m_mutex);
     qDebug() << "MultithreadedProcessor::clearQueue: 清空任务队列";
     
-    int clearedTasks = m_taskQueue.size();
+    QList<QRunnable*> tasks;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (ThreadWorker *worker : m_workers) {
+            tasks.append(worker->takeAll());
+        }
+    }
     
-    // 清理队列中的任务
-    while (!m_taskQueue.isEmpty()) {
-        ProcessingTask *task = m_taskQueue.dequeue();
-        
-        // 通知任务失败
-        int taskId = task->getTaskId();
-        if (m_futures.contains(taskId)) {
-            QFutureInterface<ProcessingResult> *interface = m_futures[taskId];
-            ProcessingResult result;
-            result.success = false;
-            result.errorMessage = "任务被取消";
-            interface->reportResult(result);
-            interface->reportFinished();
-            delete interface;
-            m_futures.remove(taskId);
+    int clearedTasks = 0;
+    for (QRunnable *runnable : tasks) {
+        ProcessingTask *task = dynamic_cast<ProcessingTask*>(runnable);
+        if (task) {
+            failTask(task->getTaskId(), "任务被取消");
+            ++clearedTasks;
+        } else {
+            // 未执行的行带：由最后结束的行带汇报整个任务失败
+            static_cast<BandTask*>(runnable)->cancel();
         }
-        
-        delete task;
+        delete runnable;
+        finishRunnable(-1, 0);
     }
     
     qDebug() << "清空任务队列完成，清理任务数:" << clearedTasks;
@@ -460,13 +546,20 @@ bool MultithreadedProcessor::waitForAll(int timeout)
     QElapsedTimer timer;
     timer.start();
     
-    while (m_activeTasks.load() > 0 || !m_taskQueue.isEmpty()) {
-        if (timeout > 0 && timer.elapsed() > timeout) {
-            qDebug() << "等待超时";
-            return false;
+    QMutexLocker locker(&m_mutex);
+    while (m_activeTasks.load() > 0) {
+        if (timeout < 0) {
+            m_doneCondition.wait(&m_mutex);
+            continue;
         }
         
-        QThread::msleep(10);
+        qint64 remaining = timeout - timer.elapsed();
+        if (remaining <= 0 || !m_doneCondition.wait(&m_mutex, static_cast<unsigned long>(remaining))) {
+            if (m_activeTasks.load() > 0) {
+                qDebug() << "等待超时";
+                return false;
+            }
+        }
     }
     
     qDebug() << "所有任务完成，用时:" << timer.elapsed() << "毫秒";
@@ -483,19 +576,28 @@ MultithreadedProcessor::ProcessingTask::ProcessingTask(MultithreadedProcessor *p
     , m_priority(priority)
     , m_image(image)
     , m_function(func)
+    , m_bandRows(0)
+    , m_haloRows(0)
 {
-    setAutoDelete(true);
+    // 由工作线程在执行后释放
+    setAutoDelete(false);
 }
 
 void MultithreadedProcessor::ProcessingTask::run()
 {
     qDebug() << "ProcessingTask::run: 执行任务" << m_taskId << "类型:" << m_type;
     
+    // 大图像拆分为行带，由各工作线程窃取执行
+    if (m_bandRows > 0 && m_image.height() > m_bandRows) {
+        m_processor->splitIntoBands(m_taskId, m_image, m_function, m_priority, m_bandRows, m_haloRows);
+        return;
+    }
+    
     QElapsedTimer timer;
     timer.start();
     
     ProcessingResult result;
-    result.threadId = static_cast<int>(reinterpret_cast<quintptr>(QThread::currentThreadId()) % 1000);
+    result.threadId = t_workerIndex;
     
     try {
         // 处理图像
@@ -528,17 +630,138 @@ void MultithreadedProcessor::ProcessingTask::run()
     qDebug() << "任务" << m_taskId << "执行完成，用时:" << result.processingTime << "毫秒，成功:" << result.success;
 }
 
+// BandTask 实现
+MultithreadedProcessor::BandTask::BandTask(std::shared_ptr<BandJob> job, int firstRow, int rowCount)
+    : m_job(std::move(job))
+    , m_firstRow(firstRow)
+    , m_rowCount(rowCount)
+{
+    setAutoDelete(false);
+}
+
+void MultithreadedProcessor::BandTask::run()
+{
+    BandJob &job = *m_job;
+    const int width = job.source.width();
+    const int firstRow = qMax(0, m_firstRow - job.haloRows);
+    const int lastRow = qMin(job.source.height(), m_firstRow + m_rowCount + job.haloRows);
+    
+    QString error;
+    QImage processed;
+    
+    try {
+        processed = job.function(job.source.copy(0, firstRow, width, lastRow - firstRow));
+    } catch (const std::exception &e) {
+        error = QString("处理异常: %1").arg(e.what());
+    } catch (...) {
+        error = "发生未知异常";
+    }
+    
+    if (error.isEmpty() && (processed.isNull() || processed.width() != width
+                            || processed.height() != lastRow - firstRow)) {
+        error = "分带处理结果尺寸不匹配";
+    }
+    
+    if (error.isEmpty()) {
+        uchar *bits = nullptr;
+        int bytesPerLine = 0;
+        {
+            // 首个完成的行带按其格式创建输出图像
+            QMutexLocker locker(&job.mutex);
+            if (job.output.isNull()) {
+                job.output = QImage(width, job.source.height(), processed.format());
+                job.outputBits = job.output.bits();
+                job.outputBytesPerLine = job.output.bytesPerLine();
+            }
+            bits = job.outputBits;
+            bytesPerLine = job.outputBytesPerLine;
+            if (processed.format() != job.output.format()) {
+                processed = processed.convertToFormat(job.output.format());
+            }
+        }
+        
+        // 各行带写入互不重叠的行，直接写入预先分离的像素内存
+        const int copyBytes = qMin(bytesPerLine, processed.bytesPerLine());
+        for (int row = 0; row < m_rowCount; ++row) {
+            std::memcpy(bits + static_cast<qint64>(m_firstRow + row) * bytesPerLine,
+                        processed.constScanLine(m_firstRow - firstRow + row), copyBytes);
+        }
+    } else {
+        QMutexLocker locker(&job.mutex);
+        job.errorMessage = error;
+    }
+    
+    complete();
+}
+
+void MultithreadedProcessor::BandTask::cancel()
+{
+    {
+        QMutexLocker locker(&m_job->mutex);
+        m_job->errorMessage = "任务被取消";
+    }
+    complete();
+}
+
+void MultithreadedProcessor::BandTask::complete()
+{
+    BandJob &job = *m_job;
+    if (job.remaining.deref()) {
+        return;
+    }
+    
+    // 最后结束的行带汇报整个任务
+    ProcessingResult result;
+    result.threadId = t_workerIndex;
+    result.processingTime = job.timer.elapsed();
+    {
+        QMutexLocker locker(&job.mutex);
+        result.success = job.errorMessage.isEmpty();
+        result.errorMessage = job.errorMessage;
+        if (result.success) {
+            result.result = job.output;
+        }
+        job.output = QImage();
+        job.outputBits = nullptr;
+    }
+    
+    job.processor->handleTaskCompleted(job.taskId, result);
+}
+
 // ThreadWorker 实现
 MultithreadedProcessor::ThreadWorker::ThreadWorker(int workerId, MultithreadedProcessor *processor)
     : m_workerId(workerId)
     , m_processor(processor)
     , m_assignedCore(-1)
+    , m_thread(nullptr)
 {
     qDebug() << "ThreadWorker::ThreadWorker: 创建工作线程" << workerId;
 }
 
+MultithreadedProcessor::ThreadWorker::~ThreadWorker()
+{
+    join();
+    delete m_thread;
+}
+
+void MultithreadedProcessor::ThreadWorker::start(int cpuCore)
+{
+    m_assignedCore = cpuCore;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName(QStringLiteral("MTProcessor-%1").arg(m_workerId));
+    m_thread->start();
+}
+
+void MultithreadedProcessor::ThreadWorker::join()
+{
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
 void MultithreadedProcessor::ThreadWorker::setThreadAffinity(int cpuCore)
 {
+    // 仅作用于调用线程，须在工作线程内调用
     m_assignedCore = cpuCore;
     
 #ifdef Q_OS_LINUX
@@ -561,87 +784,282 @@ void MultithreadedProcessor::ThreadWorker::setThreadAffinity(int cpuCore)
 #endif
 }
 
-void MultithreadedProcessor::ThreadWorker::processTask()
+void MultithreadedProcessor::ThreadWorker::push(QRunnable *task, TaskPriority priority)
+{
+    QMutexLocker locker(&m_dequeMutex);
+    m_deques[priority].push_back(task);
+}
+
+QRunnable *MultithreadedProcessor::ThreadWorker::popLocal(TaskPriority priority)
+{
+    QMutexLocker locker(&m_dequeMutex);
+    std::deque<QRunnable*> &deque = m_deques[priority];
+    if (deque.empty()) {
+        return nullptr;
+    }
+    QRunnable *task = deque.back();
+    deque.pop_back();
+    return task;
+}
+
+QRunnable *MultithreadedProcessor::ThreadWorker::steal(TaskPriority priority)
+{
+    // 窃取者不阻塞在繁忙的队列上
+    if (!m_dequeMutex.tryLock()) {
+        return nullptr;
+    }
+    
+    QRunnable *task = nullptr;
+    std::deque<QRunnable*> &deque = m_deques[priority];
+    if (!deque.empty()) {
+        task = deque.front();
+        deque.pop_front();
+    }
+    
+    m_dequeMutex.unlock();
+    return task;
+}
+
+QList<QRunnable*> MultithreadedProcessor::ThreadWorker::takeAll()
 {
-    qDebug() << "ThreadWorker::processTask: 工作线程" << m_workerId << "开始处理任务";
+    QMutexLocker locker(&m_dequeMutex);
+    QList<QRunnable*> tasks;
+    for (int priority = Critical; priority >= Low; --priority) {
+        for (QRunnable *task : m_deques[priority]) {
+            tasks.append(task);
+            m_processor->m_pendingTasks[priority].fetchAndSubOrdered(1);
+        }
+        m_deques[priority].clear();
+    }
+    return tasks;
+}
+
+int MultithreadedProcessor::ThreadWorker::queuedCount() const
+{
+    QMutexLocker locker(&m_dequeMutex);
+    int count = 0;
+    for (const auto &deque : m_deques) {
+        count += static_cast<int>(deque.size());
+    }
+    return count;
+}
+
+void MultithreadedProcessor::ThreadWorker::run()
+{
+    qDebug() << "ThreadWorker::run: 工作线程" << m_workerId << "开始处理任务";
+    
+    t_workerOwner = m_processor;
+    t_workerIndex = m_workerId;
+    
+    if (m_assignedCore >= 0) {
+        setThreadAffinity(m_assignedCore);
+    }
     
-    while (m_processor->m_isRunning) {
-        ProcessingTask *task = m_processor->getNextTask();
+    while (m_processor->m_isRunning.load()) {
+        QRunnable *task = m_processor->m_isPaused.load() ? nullptr : m_processor->getNextTask(m_workerId);
         
-        if (task) {
-            QElapsedTimer timer;
-            timer.start();
-            
-            // 执行任务
-            task->run();
-            
-            // 更新线程统计
+        if (!task) {
+            // 无可执行任务或已暂停：等待提交或恢复
             QMutexLocker locker(&m_processor->m_mutex);
-            if (m_workerId < m_processor->m_threadLoads.size()) {
-                m_processor->m_threadLoads[m_workerId]++;
-                m_processor->m_threadTimes[m_workerId] += timer.elapsed();
+            while (m_processor->m_isRunning.load()
+                   && (m_processor->m_isPaused.load() || m_processor->pendingTaskCount() == 0)) {
+                m_processor->m_condition.wait(&m_processor->m_mutex);
             }
-            
-            m_processor->m_activeTasks.fetchAndSubOrdered(1);
-            
-        } else {
-            // 没有任务，短暂休眠
-            QThread::msleep(1);
+            continue;
         }
         
-        // 检查暂停状态
-        if (m_processor->m_isPaused) {
-            QMutexLocker locker(&m_processor->m_mutex);
-            m_processor->m_condition.wait(&m_processor->m_mutex);
-        }
+        QElapsedTimer timer;
+        timer.start();
+        
+        m_processor->m_busyWorkers.ref();
+        task->run();
+        m_processor->m_busyWorkers.deref();
+        
+        delete task;
+        m_processor->finishRunnable(m_workerId, timer.elapsed());
     }
     
+    t_workerOwner = nullptr;
+    t_workerIndex = -1;
+    
     qDebug() << "工作线程" << m_workerId << "停止处理";
 }
 
 // 私有方法实现
 int MultithreadedProcessor::submitTask(ProcessingTask *task)
 {
-    QMutexLocker locker(&m_mutex);
+    int taskId = task->getTaskId();
     
-    if (!m_isRunning) {
+    if (!m_isRunning.load()) {
         qWarning() << "线程池未运行，无法提交任务";
         delete task;
+        failTask(taskId, "线程池未运行");
         return -1;
     }
     
-    int taskId = task->getTaskId();
-    
     // 检查队列容量
-    if (m_taskQueue.size() >= m_config.queueCapacity) {
+    if (pendingTaskCount() >= m_config.queueCapacity) {
         qWarning() << "任务队列已满，丢弃任务" << taskId;
         delete task;
+        failTask(taskId, "任务队列已满");
         return -1;
     }
     
-    // 添加到队列
-    m_taskQueue.enqueue(task);
     m_activeTasks.fetchAndAddOrdered(1);
+    enqueueTask(task, task->getPriority());
     
-    // 唤醒等待的线程
-    m_condition.wakeOne();
-    
-    qDebug() << "提交任务" << taskId << "到队列，当前队列大小:" << m_taskQueue.size();
+    qDebug() << "提交任务" << taskId << "到队列，当前排队任务数:" << pendingTaskCount();
     return taskId;
 }
 
-MultithreadedProcessor::ProcessingTask* MultithreadedProcessor::getNextTask()
+void MultithreadedProcessor::enqueueTask(QRunnable *task, TaskPriority priority)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        // 工作线程内提交（如行带拆分）压入本线程队列，外部提交分配给负载最低的线程
+        int workerId = (t_workerOwner == this) ? t_workerIndex : balanceLoad();
+        if (workerId < 0 || workerId >= m_workers.size()) {
+            workerId = 0;
+        }
+        
+        m_workers[workerId]->push(task, priority);
+        
+        // 空闲线程在 m_mutex 下检查计数后等待，不会错过唤醒
+        m_pendingTasks[priority].fetchAndAddOrdered(1);
+        m_condition.wakeOne();
+    }
+}
+
+QRunnable* MultithreadedProcessor::getNextTask(int workerId)
+{
+    const int workerCount = m_workers.size();
+    
+    for (int level = Critical; level >= Low; --level) {
+        TaskPriority priority = static_cast<TaskPriority>(level);
+        
+        // 没有该优先级的排队任务时跳过，保证高优先级任务全局优先
+        if (m_pendingTasks[level].load() <= 0) {
+            continue;
+        }
+        
+        QRunnable *task = m_workers[workerId]->popLocal(priority);
+        
+        if (!task && workerCount > 1) {
+            // 从随机位置开始依次窃取，避免所有空闲线程争抢同一个队列
+            thread_local std::minstd_rand rng(std::random_device{}());
+            int start = static_cast<int>(rng() % workerCount);
+            for (int i = 0; i < workerCount && !task; ++i) {
+                int victim = (start + i) % workerCount;
+                if (victim != workerId) {
+                    task = m_workers[victim]->steal(priority);
+                }
+            }
+        }
+        
+        if (task) {
+            m_pendingTasks[level].fetchAndSubOrdered(1);
+            return task;
+        }
+    }
+    
+    return nullptr;
+}
+
+void MultithreadedProcessor::splitIntoBands(int taskId, const QImage &image,
+                                            const std::function<QImage(const QImage&)> &function,
+                                            TaskPriority priority, int bandRows, int haloRows)
+{
+    auto job = std::make_shared<BandJob>();
+    job->processor = this;
+    job->taskId = taskId;
+    job->source = image;
+    job->function = function;
+    job->haloRows = haloRows;
+    job->timer.start();
+    
+    const int bandCount = (image.height() + bandRows - 1) / bandRows;
+    job->remaining.store(bandCount);
+    
+    qDebug() << "任务" << taskId << "拆分为" << bandCount << "个行带，每带" << bandRows << "行";
+    
+    m_activeTasks.fetchAndAddOrdered(bandCount);
+    for (int band = 0; band < bandCount; ++band) {
+        int firstRow = band * bandRows;
+        int rowCount = qMin(bandRows, image.height() - firstRow);
+        enqueueTask(new BandTask(job, firstRow, rowCount), priority);
+    }
+}
+
+void MultithreadedProcessor::finishRunnable(int workerId, qint64 elapsed)
 {
     QMutexLocker locker(&m_mutex);
     
-    if (m_taskQueue.isEmpty()) {
-        return nullptr;
+    // 更新线程统计
+    if (workerId >= 0 && workerId < m_threadLoads.size()) {
+        m_threadLoads[workerId]++;
+        m_threadTimes[workerId] += elapsed;
     }
     
-    // 简单的FIFO调度，可以扩展为优先级调度
-    ProcessingTask *task = m_taskQueue.dequeue();
+    if (!m_activeTasks.deref()) {
+        m_doneCondition.wakeAll();
+    }
+}
+
+void MultithreadedProcessor::failTask(int taskId, const QString &error)
+{
+    ProcessingResult result;
+    result.success = false;
+    result.errorMessage = error;
+    handleTaskCompleted(taskId, result);
+}
+
+int MultithreadedProcessor::balanceLoad() const
+{
+    int bestWorker = -1;
+    int bestLoad = 0;
+    
+    for (int i = 0; i < m_workers.size(); ++i) {
+        int load = m_workers[i]->queuedCount();
+        if (bestWorker < 0 || load < bestLoad) {
+            bestWorker = i;
+            bestLoad = load;
+        }
+    }
     
-    return task;
+    return bestWorker;
+}
+
+int MultithreadedProcessor::pendingTaskCount() const
+{
+    int count = 0;
+    for (const QAtomicInt &pending : m_pendingTasks) {
+        count += pending.load();
+    }
+    return count;
+}
+
+int MultithreadedProcessor::optimizeThreadCount(const QSize &imageSize, TaskType taskType) const
+{
+    Q_UNUSED(taskType)
+    
+    // 每个线程至少分到约25万像素，避免拆分开销超过并行收益
+    const qint64 pixels = static_cast<qint64>(imageSize.width()) * imageSize.height();
+    const int useful = static_cast<int>(qMax<qint64>(1, pixels / (256 * 1024)));
+    const int workers = m_workers.isEmpty() ? m_config.maxThreadCount : m_workers.size();
+    
+    return qBound(1, useful, qMax(1, workers));
+}
+
+void MultithreadedProcessor::setThreadAffinity(int threadId, int cpuCore)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    // 亲和性在工作线程启动时由其自身设置
+    while (m_coreAffinityMap.size() <= threadId) {
+        m_coreAffinityMap.append(m_coreAffinityMap.size());
+    }
+    m_coreAffinityMap[threadId] = cpuCore;
 }
 
 std::function<QImage(const QImage&)> MultithreadedProcessor::createProcessor(TaskType type, const QVariantMap &params)
@@ -696,24 +1114,57 @@ void MultithreadedProcessor::detectCPUInfo()
     // 获取逻辑核心数
     m_logicalCores = QThread::idealThreadCount();
     
+    m_coreAffinityMap.clear();
+    
 #ifdef Q_OS_LINUX
-    // 在Linux上获取物理核心数
+    // 按 (physical id, core id) 归并超线程兄弟核，只统计进程允许运行的逻辑核
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveAllowed = (sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    
+    std::map<std::pair<int, int>, std::vector<int>> cores;
     std::ifstream cpuinfo("/proc/cpuinfo");
     std::string line;
-    int physicalCores = 0;
+    int processor = -1;
+    int physicalId = 0;
+    
+    auto fieldValue = [](const std::string &text) {
+        size_t pos = text.find(':');
+        return pos == std::string::npos ? -1 : std::atoi(text.c_str() + pos + 1);
+    };
     
     while (std::getline(cpuinfo, line)) {
-        if (line.find("cpu cores") != std::string::npos) {
-            size_t pos = line.find(": ");
-            if (pos != std::string::npos) {
-                physicalCores = std::stoi(line.substr(pos + 2));
-                break;
+        if (line.compare(0, 9, "processor") == 0) {
+            processor = fieldValue(line);
+            physicalId = 0;
+        } else if (line.compare(0, 11, "physical id") == 0) {
+            physicalId = fieldValue(line);
+        } else if (line.compare(0, 7, "core id") == 0 && processor >= 0) {
+            if (!haveAllowed || CPU_ISSET(processor, &allowed)) {
+                cores[{physicalId, fieldValue(line)}].push_back(processor);
             }
+            processor = -1;
         }
     }
     
-    if (physicalCores > 0) {
-        m_physicalCores = physicalCores;
+    if (!cores.empty()) {
+        m_physicalCores = static_cast<int>(cores.size());
+        
+        // 先排每个物理核的第一个逻辑核，再排超线程兄弟核，
+        // 使前 N 个工作线程落在不同的物理核上
+        for (size_t sibling = 0; ; ++sibling) {
+            bool added = false;
+            for (const auto &core : cores) {
+                if (sibling < core.second.size()) {
+                    m_coreAffinityMap.append(core.second[sibling]);
+                    added = true;
+                }
+            }
+            if (!added) {
+                break;
+            }
+        }
+        m_logicalCores = m_coreAffinityMap.size();
     }
     
 #elif defined(Q_OS_WIN)
@@ -737,9 +1188,11 @@ void MultithreadedProcessor::detectCPUInfo()
     // 检测超线程
     m_hasHyperThreading = (m_logicalCores > m_physicalCores);
     
-    // 设置核心亲和性映射
-    for (int i = 0; i < m_logicalCores; ++i) {
-        m_coreAffinityMap.append(i);
+    // 无拓扑信息时按逻辑核编号顺序映射
+    if (m_coreAffinityMap.isEmpty()) {
+        for (int i = 0; i < m_logicalCores; ++i) {
+            m_coreAffinityMap.append(i);
+        }
     }
     
     qDebug() << "CPU信息检测完成 - 物理核心:" << m_physicalCores 
@@ -752,8 +1205,8 @@ void MultithreadedProcessor::updatePerformanceStats()
     QMutexLocker locker(&m_mutex);
     
     // 更新基本统计
-    m_stats.activeThreads = m_threadPool->activeThreadCount();
-    m_stats.queuedTasks = m_taskQueue.size();
+    m_stats.activeThreads = m_busyWorkers.load();
+    m_stats.queuedTasks = pendingTaskCount();
     
     // 计算CPU利用率（简化计算）
     if (!m_threadTimes.isEmpty()) {
@@ -806,5 +1259,5 @@ void MultithreadedProcessor::handleTaskCompleted(int taskId, const ProcessingRes
     }
     
     // 更新进度
-    emit progressUpdated(m_stats.completedTasks, m_stats.completedTasks + m_stats.failedTasks + m_taskQueue.size());
+    emit progressUpdated(m_stats.completedTasks, m_stats.completedTasks + m_stats.failedTasks + pendingTaskCount());
 } 
\ No newline at end of file
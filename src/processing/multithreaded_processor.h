@@ -27,7 +27,10 @@
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QtConcurrent>
+#include <QThread>
+#include <deque>
 #include <functional>
+#include <memory>
 
 // 前向声明
 class MultithreadedProcessor;
@@ -36,8 +39,9 @@ class MultithreadedProcessor;
  * @brief MultithreadedProcessor 多线程优化的图像处理器
  * 
  * 专门为高性能图像处理设计的多线程处理器，包含以下特性：
- * - 智能线程调度
- * - 负载均衡
+ * - 工作窃取调度（每个工作线程持有按优先级划分的双端队列）
+ * - 大图像分带拆分，空闲线程窃取行带并行处理
+ * - 按CPU拓扑绑定工作线程
  * - 任务队列管理
  * - 并行管道处理
  * - 线程池优化
@@ -198,11 +202,30 @@ public:
      * @param images 输入图像列表
      * @param processor 处理函数
      * @param priority 任务优先级
+     * @param splitHaloRows 大于等于0时将像素数超过其余页面平均值两倍的页面
+     *                      分带处理，值为行带上下文行数；-1表示不拆分
      * @return Future对象列表
      */
     QList<QFuture<ProcessingResult>> processBatchAsync(const QList<QImage> &images,
                                                        std::function<QImage(const QImage&)> processor,
-                                                       TaskPriority priority = Normal);
+                                                       TaskPriority priority = Normal,
+                                                       int splitHaloRows = -1);
+    
+    /**
+     * @brief 分带并行处理单幅大图像
+     * @param image 输入图像
+     * @param processor 处理函数，必须保持输入行带的宽度和行数
+     * @param priority 任务优先级
+     * @param bandRows 每个行带的行数，0表示按线程数自动计算
+     * @param haloRows 行带上下额外提供的上下文行数（邻域运算所需）
+     * @return Future对象
+     * 
+     * 任务执行时拆分为行带子任务压入当前工作线程的队列，空闲线程窃取后并行处理。
+     */
+    QFuture<ProcessingResult> processImageBandsAsync(const QImage &image,
+                                                     std::function<QImage(const QImage&)> processor,
+                                                     TaskPriority priority = Normal,
+                                                     int bandRows = 0, int haloRows = 0);
     
     /**
      * @brief 管道式处理
@@ -297,6 +320,8 @@ signals:
     void performanceStatsUpdated(const PerformanceStats &stats);
 
 private:
+    struct BandJob;
+    
     /**
      * @brief 处理任务类
      */
@@ -312,6 +337,13 @@ private:
         TaskPriority getPriority() const { return m_priority; }
         TaskType getType() const { return m_type; }
         
+        /**
+         * @brief 启用分带拆分
+         * @param bandRows 每个行带的行数
+         * @param haloRows 行带上下文行数
+         */
+        void setBanding(int bandRows, int haloRows) { m_bandRows = bandRows; m_haloRows = haloRows; }
+        
     private:
         MultithreadedProcessor *m_processor;
         int m_taskId;
@@ -319,36 +351,62 @@ private:
         TaskPriority m_priority;
         QImage m_image;
         std::function<QImage(const QImage&)> m_function;
+        int m_bandRows;
+        int m_haloRows;
     };
     
     /**
-     * @brief 任务比较器（用于优先级队列）
+     * @brief 行带子任务，最后完成的行带负责汇报结果
      */
-    class TaskComparator
+    class BandTask : public QRunnable
     {
     public:
-        bool operator()(ProcessingTask *a, ProcessingTask *b) const {
-            return a->getPriority() < b->getPriority();
-        }
+        BandTask(std::shared_ptr<BandJob> job, int firstRow, int rowCount);
+        
+        void run() override;
+        
+        /// 未执行即被取消：记录失败并参与完成计数
+        void cancel();
+        
+    private:
+        void complete();
+        
+        std::shared_ptr<BandJob> m_job;
+        int m_firstRow;
+        int m_rowCount;
     };
     
     /**
      * @brief 线程工作器类
+     * 
+     * 每个优先级一条双端队列：所属线程从队尾取任务（后进先出，数据仍在缓存中），
+     * 其他线程从队首窃取（先进先出，优先拿走最早拆分出的大块工作）。
      */
-    class ThreadWorker : public QObject
+    class ThreadWorker
     {
-        // Q_OBJECT  // 暂时注释掉，因为MOC不支持嵌套类
     public:
         explicit ThreadWorker(int workerId, MultithreadedProcessor *processor);
+        ~ThreadWorker();
+        
+        void start(int cpuCore);
+        void join();
         void setThreadAffinity(int cpuCore);
         
-    // public slots:  // 暂时注释掉，因为移除了Q_OBJECT
-    //     void processTask();
+        void push(QRunnable *task, TaskPriority priority);
+        QRunnable *popLocal(TaskPriority priority);
+        QRunnable *steal(TaskPriority priority);
+        QList<QRunnable*> takeAll();
+        int queuedCount() const;
         
     private:
+        void run();
+        
         int m_workerId;
         MultithreadedProcessor *m_processor;
         int m_assignedCore;
+        QThread *m_thread;
+        mutable QMutex m_dequeMutex;
+        std::deque<QRunnable*> m_deques[Critical + 1];
     };
 
 private slots:
@@ -372,11 +430,39 @@ private:
      */
     int submitTask(ProcessingTask *task);
     
+    /**
+     * @brief 将任务压入工作线程队列
+     * @param task 任务
+     * @param priority 优先级
+     * 
+     * 在工作线程内调用时压入本线程队列，否则压入负载最低的工作线程。
+     */
+    void enqueueTask(QRunnable *task, TaskPriority priority);
+    
     /**
      * @brief 获取下一个任务
-     * @return 处理任务（如果队列为空则返回nullptr）
+     * @param workerId 请求任务的工作线程
+     * @return 处理任务（所有队列为空则返回nullptr）
+     * 
+     * 从最高优先级开始，先取本线程队列，再随机顺序窃取其他线程队列。
+     */
+    QRunnable* getNextTask(int workerId);
+    
+    /**
+     * @brief 将大图像任务拆分为行带子任务
      */
-    ProcessingTask* getNextTask();
+    void splitIntoBands(int taskId, const QImage &image, const std::function<QImage(const QImage&)> &function,
+                        TaskPriority priority, int bandRows, int haloRows);
+    
+    /**
+     * @brief 任务执行结束（含行带子任务）
+     */
+    void finishRunnable(int workerId, qint64 elapsed);
+    
+    /**
+     * @brief 以失败结果结束任务的Future
+     */
+    void failTask(int taskId, const QString &error);
     
     /**
      * @brief 创建处理函数
@@ -408,29 +494,34 @@ private:
     
     /**
      * @brief 负载均衡调度
-     * @return 最佳工作线程ID
+     * @return 排队任务最少的工作线程ID，无工作线程时返回-1
      */
     int balanceLoad() const;
+    
+    /**
+     * @brief 各优先级排队任务总数
+     */
+    int pendingTaskCount() const;
 
 private:
     ThreadPoolConfig m_config;                          ///< 线程池配置
     mutable QMutex m_mutex;                            ///< 线程安全锁
-    QWaitCondition m_condition;                        ///< 条件变量
+    QWaitCondition m_condition;                        ///< 工作线程空闲/暂停等待条件
+    QWaitCondition m_doneCondition;                    ///< 全部任务完成条件
     
     // 线程池管理
-    QThreadPool *m_threadPool;                         ///< Qt线程池
     QList<ThreadWorker*> m_workers;                   ///< 工作线程列表
-    QList<QThread*> m_threads;                        ///< 线程对象列表
+    QAtomicInt m_busyWorkers;                         ///< 正在执行任务的工作线程数
     
     // 任务队列
-    QQueue<ProcessingTask*> m_taskQueue;              ///< 任务队列
+    QAtomicInt m_pendingTasks[Critical + 1];          ///< 各优先级排队任务数
     QMap<int, QFutureInterface<ProcessingResult>*> m_futures; ///< Future接口映射
     QAtomicInt m_nextTaskId;                          ///< 下一个任务ID
     
     // 状态管理
-    bool m_isRunning;                                  ///< 是否运行中
-    bool m_isPaused;                                   ///< 是否暂停
-    QAtomicInt m_activeTasks;                         ///< 活跃任务数
+    QAtomicInt m_isRunning;                            ///< 是否运行中
+    QAtomicInt m_isPaused;                             ///< 是否暂停
+    QAtomicInt m_activeTasks;                         ///< 已提交未完成的任务数（含行带）
     
     // 性能统计
     mutable PerformanceStats m_stats;                 ///< 性能统计
@@ -441,7 +532,7 @@ private:
     int m_physicalCores;                              ///< 物理核心数
     int m_logicalCores;                               ///< 逻辑核心数
     bool m_hasHyperThreading;                         ///< 是否支持超线程
-    QList<int> m_coreAffinityMap;                     ///< 核心亲和性映射
+    QList<int> m_coreAffinityMap;                     ///< 核心亲和性映射（先各物理核心，再超线程兄弟）
     
     // 负载均衡
     QList<int> m_threadLoads;                         ///< 线程负载统计
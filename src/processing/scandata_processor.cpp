@@ -103,17 +103,7 @@ QImage ScanDataProcessor::convertGrayscale(const QByteArray &data, const QSize &
         return QImage();
     }
     
-    QImage image(size, QImage::Format_Grayscale8);
-    const uchar *srcData = reinterpret_cast<const uchar*>(data.constData());
-    
-    for (int y = 0; y < size.height(); y++) {
-        uchar *line = image.scanLine(y);
-        for (int x = 0; x < size.width(); x++) {
-            line[x] = srcData[y * size.width() + x];
-        }
-    }
-    
-    return image;
+    return wrapRawData(data, size, 1, QImage::Format_Grayscale8);
 }
 
 QImage ScanDataProcessor::convertRGB(const QByteArray &data, const QSize &size)
@@ -123,22 +113,33 @@ QImage ScanDataProcessor::convertRGB(const QByteArray &data, const QSize &size)
         return QImage();
     }
     
+    // 输出保持 Format_RGB32，与后续处理及调用方的约定一致；按行转换代替逐像素 setPixel()
     QImage image(size, QImage::Format_RGB32);
     const uchar *srcData = reinterpret_cast<const uchar*>(data.constData());
     
     for (int y = 0; y < size.height(); y++) {
+        const uchar *src = srcData + y * size.width() * 3;
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
         for (int x = 0; x < size.width(); x++) {
-            int index = (y * size.width() + x) * 3;
-            uchar r = srcData[index];
-            uchar g = srcData[index + 1];
-            uchar b = srcData[index + 2];
-            image.setPixel(x, y, qRgb(r, g, b));
+            line[x] = qRgb(src[x * 3], src[x * 3 + 1], src[x * 3 + 2]);
         }
     }
     
     return image;
 }
 
+QImage ScanDataProcessor::wrapRawData(const QByteArray &data, const QSize &size, int bytesPerPixel, QImage::Format format)
+{
+    // 直接引用扫描数据内存，QImage释放时归还QByteArray引用；
+    // 只读构造保证后续写入时由Qt分离复制
+    auto *keepAlive = new QByteArray(data);
+    const uchar *bits = reinterpret_cast<const uchar*>(keepAlive->constData());
+    
+    return QImage(bits, size.width(), size.height(), size.width() * bytesPerPixel, format,
+                  [](void *info) { delete static_cast<QByteArray*>(info); },
+                  keepAlive);
+}
+
 QImage ScanDataProcessor::convertCMYK(const QByteArray &data, const QSize &size)
 {
     if (data.size() < size.width() * size.height() * 4) {
@@ -291,4 +292,4 @@ QImage ScanDataProcessor::optimizeForPhoto(const QImage &image)
     return result;
 }
 
-DSCANNER_END_NAMESPACE 
\ No newline at end of file
+DSCANNER_END_NAMESPACE
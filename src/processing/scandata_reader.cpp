@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "scandata_reader.h"
+#include "Scanner/DScannerDriver.h"
+
+#include <algorithm>
+
+DSCANNER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(scanDataReader, "deepinscan.scandatareader")
+
+ScanDataReader::ScanDataReader(DScannerDriver *driver)
+    : m_driver(driver)
+{
+}
+
+qint64 ScanDataReader::read(quint8 *buffer, qint64 length)
+{
+    if (!m_driver || !buffer || length <= 0) {
+        return -1;
+    }
+    
+    qint64 filled = 0;
+    
+    // 先取出上次回退读取剩余的数据
+    if (m_pendingOffset < m_pending.size()) {
+        qint64 count = qMin<qint64>(length, m_pending.size() - m_pendingOffset);
+        std::copy_n(m_pending.constData() + m_pendingOffset, count, reinterpret_cast<char*>(buffer));
+        m_pendingOffset += static_cast<int>(count);
+        m_copiedBytes += count;
+        filled += count;
+        
+        if (m_pendingOffset >= m_pending.size()) {
+            m_pending.clear();
+            m_pendingOffset = 0;
+        }
+    }
+    
+    while (filled < length && !m_atEnd) {
+        if (m_driver->supportsDirectRead()) {
+            qint64 count = m_driver->readScanDataInto(buffer + filled, length - filled);
+            if (count < 0) {
+                qCWarning(scanDataReader) << "Direct scan data read failed";
+                return filled > 0 ? filled : -1;
+            }
+            if (count == 0) {
+                m_atEnd = true;
+                break;
+            }
+            filled += count;
+            continue;
+        }
+        
+        QByteArray chunk = m_driver->readScanData();
+        if (chunk.isEmpty()) {
+            m_atEnd = true;
+            break;
+        }
+        
+        qint64 count = qMin<qint64>(length - filled, chunk.size());
+        std::copy_n(chunk.constData(), count, reinterpret_cast<char*>(buffer + filled));
+        m_copiedBytes += count;
+        filled += count;
+        
+        if (count < chunk.size()) {
+            m_pending = chunk;
+            m_pendingOffset = static_cast<int>(count);
+        }
+    }
+    
+    return filled;
+}
+
+DSCANNER_END_NAMESPACE
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SCANDATA_READER_H
+#define SCANDATA_READER_H
+
+#include "Scanner/DScannerGlobal.h"
+
+#include <QByteArray>
+#include <QLoggingCategory>
+
+DSCANNER_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(scanDataReader)
+
+class DScannerDriver;
+
+/**
+ * @brief 扫描数据读取器 - 将驱动数据直接写入调用方提供的内存
+ *
+ * 调用方可传入 ImageBuffer 的扫描行或内存池块，驱动支持直接读取时
+ * 数据从USB传输直接落到目标内存，不经过中间的QByteArray。
+ */
+class DSCANNER_EXPORT ScanDataReader
+{
+public:
+    explicit ScanDataReader(DScannerDriver *driver);
+    
+    /**
+     * @brief 读取数据直到填满缓冲区或扫描结束
+     * @return 实际写入字节数，扫描结束返回0，出错返回-1
+     *
+     * 驱动支持 readScanDataInto() 时直接写入 buffer；
+     * 否则回退到 readScanData()，多余数据暂存到下次读取。
+     */
+    qint64 read(quint8 *buffer, qint64 length);
+    
+    bool atEnd() const { return m_atEnd && m_pendingOffset >= m_pending.size(); }
+    qint64 copiedBytes() const { return m_copiedBytes; }    // 回退路径额外复制的字节数
+    
+private:
+    DScannerDriver *m_driver;
+    QByteArray m_pending;
+    int m_pendingOffset = 0;
+    qint64 m_copiedBytes = 0;
+    bool m_atEnd = false;
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // SCANDATA_READER_H
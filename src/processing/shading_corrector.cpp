@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "shading_corrector.h"
+#include "simd_image_algorithms.h"
+
+#include <QtEndian>
+
+#include <cmath>
+#include <cstring>
+
+DSCANNER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(shadingCorrector, "deepinscan.shadingcorrector")
+
+bool ShadingCorrector::setReference(const QByteArray &black, const QByteArray &white, int width, int channels,
+                                    double targetLevel)
+{
+    clear();
+    
+    const qint64 samples = static_cast<qint64>(width) * channels;
+    if (width <= 0 || channels <= 0 || black.size() != white.size()) {
+        qCWarning(shadingCorrector) << "Invalid shading reference - width:" << width
+                                   << "channels:" << channels;
+        return false;
+    }
+    
+    int sampleBytes = 0;
+    if (black.size() == samples * 2) {
+        sampleBytes = 2;
+    } else if (black.size() == samples) {
+        sampleBytes = 1;
+    } else {
+        qCWarning(shadingCorrector) << "Shading reference size" << black.size()
+                                   << "does not match" << samples << "samples";
+        return false;
+    }
+    
+    // 参考统一换算到16位量程，增益与数据位深无关
+    auto sampleAt = [sampleBytes](const QByteArray &data, qint64 index) -> quint32 {
+        const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+        return sampleBytes == 2 ? qFromLittleEndian<quint16>(bytes + index * 2) : bytes[index] * 257u;
+    };
+    
+    const double target = qBound(0.0, targetLevel, 1.0) * 65535.0;
+    m_offset8.resize(static_cast<int>(samples));
+    m_offset16.resize(static_cast<int>(samples));
+    m_gain.resize(static_cast<int>(samples));
+    for (qint64 i = 0; i < samples; ++i) {
+        const quint32 dark = sampleAt(black, i);
+        const quint32 bright = sampleAt(white, i);
+        m_offset16[i] = static_cast<quint16>(dark);
+        m_offset8[i] = static_cast<quint16>((dark + 128) / 257);
+        
+        // 白电平不高于暗电平的坏列保持单位增益
+        const double gain = bright > dark ? target / (bright - dark) : 1.0;
+        m_gain[i] = static_cast<quint16>(qBound(0.0, std::round(gain * (1 << GainShift)), 65535.0));
+    }
+    
+    m_width = width;
+    m_channels = channels;
+    return true;
+}
+
+void ShadingCorrector::clear()
+{
+    m_width = 0;
+    m_channels = 0;
+    m_offset8.clear();
+    m_offset16.clear();
+    m_gain.clear();
+}
+
+void ShadingCorrector::apply8(const quint8 *src, quint8 *dst, qint64 firstSample, qint64 count) const
+{
+    if (!isValid()) {
+        std::memmove(dst, src, static_cast<size_t>(count));
+        return;
+    }
+    
+    // 片段跨行时在行尾回绕到第0列
+    const qint64 lineSamples = static_cast<qint64>(m_width) * m_channels;
+    qint64 column = firstSample % lineSamples;
+    while (count > 0) {
+        const int run = static_cast<int>(qMin(count, lineSamples - column));
+        SIMDImageAlgorithms::shadingCorrectRow8(src, m_offset8.constData() + column,
+                                                m_gain.constData() + column, dst, run);
+        src += run;
+        dst += run;
+        count -= run;
+        column = 0;
+    }
+}
+
+void ShadingCorrector::apply16(const quint16 *src, quint16 *dst, qint64 firstSample, qint64 count) const
+{
+    if (!isValid()) {
+        std::memmove(dst, src, static_cast<size_t>(count) * sizeof(quint16));
+        return;
+    }
+    
+    const qint64 lineSamples = static_cast<qint64>(m_width) * m_channels;
+    qint64 column = firstSample % lineSamples;
+    while (count > 0) {
+        const int run = static_cast<int>(qMin(count, lineSamples - column));
+        SIMDImageAlgorithms::shadingCorrectRow16(src, m_offset16.constData() + column,
+                                                 m_gain.constData() + column, dst, run);
+        src += run;
+        dst += run;
+        count -= run;
+        column = 0;
+    }
+}
+
+DSCANNER_END_NAMESPACE
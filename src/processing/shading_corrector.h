@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SHADING_CORRECTOR_H
+#define SHADING_CORRECTOR_H
+
+#include "Scanner/DScannerGlobal.h"
+
+#include <QByteArray>
+#include <QLoggingCategory>
+#include <QVector>
+
+DSCANNER_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(shadingCorrector)
+
+/**
+ * @brief 每列暗场/白场阴影校正系数
+ *
+ * 由校准得到的暗电平与白电平预先计算每列每通道的定点偏移与Q12增益，
+ * 校正时每个样本只需一次减法、乘法与移位。样本按行内交错顺序编号，
+ * 可校正任意起点、跨行的连续片段，因此驱动可直接作用于USB读取的数据块。
+ */
+class DSCANNER_EXPORT ShadingCorrector
+{
+public:
+    static constexpr int GainShift = 12;        // 增益的定点小数位数，最大增益16倍
+    
+    /**
+     * @brief 设置校准参考
+     * @param black 暗电平，每列 channels 个样本；16位小端，或长度减半时为8位
+     * @param white 白电平，格式同 black
+     * @param targetLevel 白电平校正后的目标值，满量程的比例
+     * @return 长度与 width·channels 不符时返回false
+     */
+    bool setReference(const QByteArray &black, const QByteArray &white, int width, int channels,
+                      double targetLevel = 1.0);
+    void clear();
+    
+    bool isValid() const { return m_width > 0; }
+    int width() const { return m_width; }
+    int channels() const { return m_channels; }
+    
+    /**
+     * @brief 校正连续样本
+     * @param firstSample 第一个样本在行内的序号（超过一行时取模）
+     */
+    void apply8(const quint8 *src, quint8 *dst, qint64 firstSample, qint64 count) const;
+    void apply16(const quint16 *src, quint16 *dst, qint64 firstSample, qint64 count) const;
+    
+private:
+    int m_width = 0;
+    int m_channels = 0;
+    QVector<quint16> m_offset8;     // 8位数据的暗电平
+    QVector<quint16> m_offset16;    // 16位数据的暗电平
+    QVector<quint16> m_gain;        // 与位深无关的Q12增益
+};
+
+DSCANNER_END_NAMESPACE
+
+#endif // SHADING_CORRECTOR_H
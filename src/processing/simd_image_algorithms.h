@@ -19,6 +19,7 @@
 
 #include <QImage>
 #include <QRect>
+#include <QStringList>
 #include <QtGlobal>
 
 // SIMD支持检测
@@ -46,6 +47,14 @@
 class SIMDImageAlgorithms
 {
 public:
+    /**
+     * @brief 双边滤波模式
+     */
+    enum BilateralMode {
+        BilateralExact,     ///< 精确计算，空间权重表与值域查找表
+        BilateralGrid       ///< 双边网格近似，开销与半径无关，适用于预览
+    };
+    
     /**
      * @brief 检测SIMD支持情况
      * @return 支持的SIMD指令集信息
@@ -64,6 +73,36 @@ public:
      */
     static bool hasSSE2Support();
     
+    /**
+     * @brief 检查是否支持AVX-512（F/BW/VL）指令集
+     * @return true表示支持AVX-512
+     */
+    static bool hasAVX512Support();
+    
+    /**
+     * @brief 当前CPU上热点内核使用的指令集版本
+     * 
+     * 亮度、高斯模糊、灰度转换和直方图内核分别编译为 SSE4.1、AVX2 和
+     * AVX-512 版本，首次调用时按CPU能力选择一次。
+     * @return 内核版本名称（Generic、SSE41、AVX2 或 AVX512）
+     */
+    static QString activeKernelSet();
+    
+    /**
+     * @brief 当前CPU可用的全部内核版本
+     * @return 内核版本名称，按向量宽度从窄到宽排列，首项总是 Generic
+     */
+    static QStringList supportedKernelSets();
+    
+    /**
+     * @brief 切换热点内核版本
+     * 
+     * 用于比对各版本结果或排查与指令集相关的问题；已开始的调用继续使用原版本。
+     * @param name supportedKernelSets() 中的内核版本名称
+     * @return 当前CPU不支持该版本时返回false，保持原版本
+     */
+    static bool setActiveKernelSet(const QString &name);
+    
     /**
      * @brief 检查是否支持ARM NEON指令集
      * @return true表示支持NEON
@@ -99,12 +138,32 @@ public:
     /**
      * @brief SIMD优化的高斯模糊
      * @param image 输入图像
-     * @param radius 模糊半径 (1-20)
-     * @param sigma 高斯标准差
+     * @param radius 模糊半径，较大半径自动使用递归滤波
+     * @param sigma 高斯标准差，不大于0时取 radius/3
      * @return 模糊后的图像
      */
     static QImage gaussianBlurSIMD(const QImage &image, int radius, double sigma = -1.0);
     
+    /**
+     * @brief 8位交错通道数据的高斯模糊
+     * 
+     * 小半径按截断核直接做可分离卷积；半径超过15时使用 Young–van Vliet 递归滤波，
+     * 开销与半径无关，radius 仅用于选择算法。两种方式均按行带/列条带并行。
+     * @param src 源数据，不能与 dst 重叠
+     * @param srcStride 源数据每行字节数
+     * @param dst 目标数据
+     * @param dstStride 目标数据每行字节数
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param bytesPerPixel 每像素字节数
+     * @param channels 参与模糊的前若干通道（最多4个），其余通道原样复制
+     * @param sigma 高斯标准差（像素），不大于0时原样复制
+     * @param radius 截断半径，小于0时取 ceil(3σ)
+     */
+    static void gaussianBlur8(const quint8 *src, int srcStride, quint8 *dst, int dstStride,
+                              int width, int height, int bytesPerPixel, int channels,
+                              double sigma, int radius = -1);
+    
     /**
      * @brief SIMD优化的锐化滤波
      * @param image 输入图像
@@ -138,6 +197,24 @@ public:
      */
     static QImage medianDenoiseSIMD(const QImage &image, int kernelSize = 3);
     
+    /**
+     * @brief 8位交错通道数据的中值滤波
+     * 
+     * 半径1/2（3×3、5×5）使用排序网络并以SIMD并行处理16个字节；更大半径使用
+     * 常数时间直方图算法，每像素开销与半径无关。边界按复制边缘像素处理。
+     * @param src 源数据，不能与 dst 重叠
+     * @param srcStride 源数据每行字节数
+     * @param dst 目标数据
+     * @param dstStride 目标数据每行字节数
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param bytesPerPixel 每像素字节数
+     * @param channels 参与滤波的前若干通道，其余通道（如Alpha）原样复制
+     * @param radius 窗口半径（最大127）
+     */
+    static void medianFilter8(const quint8 *src, int srcStride, quint8 *dst, int dstStride,
+                              int width, int height, int bytesPerPixel, int channels, int radius);
+    
     /**
      * @brief SIMD优化的双边滤波降噪
      * @param image 输入图像
@@ -147,6 +224,91 @@ public:
      * @return 降噪后的图像
      */
     static QImage bilateralFilterSIMD(const QImage &image, int d, double sigmaColor, double sigmaSpace);
+    
+    /**
+     * @brief 8位交错通道数据的双边滤波
+     * 
+     * 精确模式按行带并行计算，内层循环只做查表与乘加；网格模式以 sigmaSpace、
+     * sigmaColor 为采样间隔构建双边网格，近似误差由采样间隔限定，radius 被忽略。
+     * 多通道时网格模式以通道加权均值作为值域引导。
+     * @param src 源数据，不能与 dst 重叠
+     * @param srcStride 源数据每行字节数
+     * @param dst 目标数据
+     * @param dstStride 目标数据每行字节数
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param bytesPerPixel 每像素字节数
+     * @param channels 参与滤波的前若干通道（最多4个），其余通道原样复制
+     * @param radius 精确模式的邻域半径
+     * @param sigmaSpace 空间标准差（像素）
+     * @param sigmaColor 值域标准差（灰度级）
+     * @param mode 计算模式
+     */
+    static void bilateralFilter8(const quint8 *src, int srcStride, quint8 *dst, int dstStride,
+                                 int width, int height, int bytesPerPixel, int channels,
+                                 int radius, double sigmaSpace, double sigmaColor,
+                                 BilateralMode mode = BilateralExact);
+    
+    /**
+     * @brief 8位交错通道数据的非局部均值降噪
+     * 
+     * 每个搜索位移的块距离由平方差积分图求得，开销与块大小无关，按行带并行。
+     * @param src 源数据，不能与 dst 重叠
+     * @param srcStride 源数据每行字节数
+     * @param dst 目标数据
+     * @param dstStride 目标数据每行字节数
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param bytesPerPixel 每像素字节数
+     * @param channels 参与滤波的前若干通道（最多4个），其余通道原样复制
+     * @param patchRadius 比较块半径（最大10）
+     * @param searchRadius 搜索窗口半径（最大20），预览可取5，高质量取10
+     * @param h 滤波参数（灰度级），约等于噪声标准差
+     */
+    static void nonLocalMeans8(const quint8 *src, int srcStride, quint8 *dst, int dstStride,
+                               int width, int height, int bytesPerPixel, int channels,
+                               int patchRadius, int searchRadius, double h);
+    
+    /**
+     * @brief 8位交错通道数据的 à trous 小波降噪
+     * 
+     * B3 样条平稳小波分解，各层细节按估计的噪声水平软阈值后重建，按通道并行。
+     * @param channels 参与滤波的前若干通道（最多4个），其余通道原样复制
+     * @param levels 分解层数（1-6）
+     * @param threshold 阈值，以估计噪声标准差的倍数表示
+     */
+    static void waveletDenoise8(const quint8 *src, int srcStride, quint8 *dst, int dstStride,
+                                int width, int height, int bytesPerPixel, int channels,
+                                int levels, double threshold);
+
+    /**
+     * @brief 常数权重的双线性行插值
+     * 
+     * out[i] = w0·above[i] + w1·above[i+1] + w2·below[i] + w3·below[i+1]，
+     * 用于整行偏移相同的亚像素移位；above/below 须可读 count+1 个元素。
+     */
+    static void bilinearShiftRow(const float *above, const float *below, const float weights[4],
+                                 float *out, int count);
+
+    /**
+     * @brief 逐样本阴影校正
+     * 
+     * dst[i] = (src[i] - offset[i]) · gain[i] / 4096，低于 offset 的样本为0，
+     * 结果饱和到样本最大值。offset/gain 与行数据按相同的交错顺序排列。
+     */
+    static void shadingCorrectRow8(const quint8 *src, const quint16 *offset, const quint16 *gain,
+                                   quint8 *dst, int count);
+    static void shadingCorrectRow16(const quint16 *src, const quint16 *offset, const quint16 *gain,
+                                    quint16 *dst, int count);
+
+    /**
+     * @brief 定点 3×3 颜色矩阵
+     * 
+     * planes[c][i] = (k[c][0]·p0 + k[c][1]·p1 + k[c][2]·p2 + k[c][3]) >> shift，饱和到 0-255。
+     * src 为 3 或 4 字节交错像素，第4字节不参与计算；三个通道分别写入 planes。
+     */
+    static void colorMatrixRow(const quint8 *src, int bytesPerPixel, const qint16 coeffs[3][4], int shift,
+                               quint8 *const planes[3], int count);
 
     // 几何变换
     /**
@@ -215,29 +377,17 @@ public:
 private:
     // SSE2实现
 #ifdef SIMD_SSE2_SUPPORTED
-    static QImage adjustBrightnessSSE2(const QImage &image, double factor);
     static QImage adjustContrastSSE2(const QImage &image, double factor);
-    static QImage gaussianBlurSSE2(const QImage &image, int radius, double sigma);
-    static QImage convertToGrayscaleSSE2(const QImage &image);
-    static QVector<int> calculateHistogramSSE2(const QImage &image, int channel);
 #endif
 
     // AVX2实现
 #ifdef SIMD_AVX2_SUPPORTED
-    static QImage adjustBrightnessAVX2(const QImage &image, double factor);
     static QImage adjustContrastAVX2(const QImage &image, double factor);
-    static QImage gaussianBlurAVX2(const QImage &image, int radius, double sigma);
-    static QImage convertToGrayscaleAVX2(const QImage &image);
-    static QVector<int> calculateHistogramAVX2(const QImage &image, int channel);
 #endif
 
     // ARM NEON实现
 #ifdef SIMD_NEON_SUPPORTED
-    static QImage adjustBrightnessNEON(const QImage &image, double factor);
     static QImage adjustContrastNEON(const QImage &image, double factor);
-    static QImage gaussianBlurNEON(const QImage &image, int radius, double sigma);
-    static QImage convertToGrayscaleNEON(const QImage &image);
-    static QVector<int> calculateHistogramNEON(const QImage &image, int channel);
 #endif
 
     // Scalar后备实现（当SIMD不可用时）
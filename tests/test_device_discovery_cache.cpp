@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include "dscannermanager_p.h"
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+// 构造函数受保护；不调用init()，不会触碰USB、SANE和配置文件
+class TestableManager : public DScannerManager
+{
+public:
+    TestableManager() = default;
+};
+
+DeviceInfo makeDevice(const QString &deviceId, const QString &name)
+{
+    DeviceInfo info;
+    info.deviceId = deviceId;
+    info.name = name;
+    info.manufacturer = QStringLiteral("Canon");
+    info.model = QStringLiteral("LiDE 400");
+    info.serialNumber = QStringLiteral("SN-0001");
+    info.driverType = DriverType::Genesys;
+    info.protocol = CommunicationProtocol::USB;
+    info.connectionString = QStringLiteral("usb:001:004");
+    info.isAvailable = true;
+    return info;
+}
+
+} // namespace
+
+class TestDeviceDiscoveryCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void testFastBackendMergesBeforeSlowOne();
+    void testLateBackendResultMerged();
+    void testDeviceCacheRoundTrip();
+    void testDeviceCacheSkipsExpiredEntries();
+    void testCacheFreshness();
+
+private:
+    void prepare(DScannerManagerPrivate &d) const;
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QScopedPointer<TestableManager> m_manager;
+};
+
+void TestDeviceDiscoveryCache::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_manager.reset(new TestableManager);
+}
+
+void TestDeviceDiscoveryCache::prepare(DScannerManagerPrivate &d) const
+{
+    d.deviceCachePath = m_dir->filePath(QStringLiteral("devices.json"));
+    d.deviceCacheTtl = 300;
+    d.roundTimer.start();
+}
+
+void TestDeviceDiscoveryCache::testFastBackendMergesBeforeSlowOne()
+{
+    DScannerManagerPrivate d(m_manager.data());
+    prepare(d);
+    d.backendTimeout = 5000;
+
+    QSignalSpy discovered(m_manager.data(), &DScannerManager::deviceDiscovered);
+
+    const DeviceInfo slow = makeDevice(QStringLiteral("usb:04a9:1913"), QStringLiteral("Slow"));
+    const DeviceInfo fast = makeDevice(QStringLiteral("sane:fast"), QStringLiteral("Fast"));
+    d.startBackend(DScannerManagerPrivate::USBBackend, [slow]() {
+        QThread::msleep(300);
+        return QList<DeviceInfo>{slow};
+    });
+    d.startBackend(DScannerManagerPrivate::SANEBackend, [fast]() {
+        return QList<DeviceInfo>{fast};
+    });
+    QVERIFY(d.isDiscoveryRunning());
+
+    // 快的后端先合并，不等慢的后端
+    QTRY_VERIFY(d.findDevice(fast.deviceId));
+    QVERIFY(!d.findDevice(slow.deviceId));
+    QVERIFY(d.isDiscoveryRunning());
+    QVERIFY(!d.stats.lastDiscoveryTime.isValid());
+
+    QTRY_VERIFY(!d.isDiscoveryRunning());
+    QVERIFY(d.findDevice(slow.deviceId));
+    QVERIFY(d.stats.lastDiscoveryTime.isValid());
+    QCOMPARE(discovered.size(), 2);
+    QCOMPARE(d.deviceSources.value(fast.deviceId), DScannerManagerPrivate::SANEBackend);
+    QCOMPARE(d.deviceSources.value(slow.deviceId), DScannerManagerPrivate::USBBackend);
+}
+
+void TestDeviceDiscoveryCache::testLateBackendResultMerged()
+{
+    DScannerManagerPrivate d(m_manager.data());
+    prepare(d);
+    d.backendTimeout = 50;
+
+    QSignalSpy discovered(m_manager.data(), &DScannerManager::deviceDiscovered);
+
+    const DeviceInfo late = makeDevice(QStringLiteral("usb:04a9:1913"), QStringLiteral("Late"));
+    d.startBackend(DScannerManagerPrivate::USBBackend, [late]() {
+        QThread::msleep(400);
+        return QList<DeviceInfo>{late};
+    });
+
+    // 截止时间到后本轮结束，查询仍在线程池中运行
+    QTRY_VERIFY(!d.isDiscoveryRunning());
+    QVERIFY(d.stats.lastDiscoveryTime.isValid());
+    const QDateTime roundEnd = d.stats.lastDiscoveryTime;
+    QVERIFY(d.runningBackends.contains(DScannerManagerPrivate::USBBackend));
+    QVERIFY(!d.findDevice(late.deviceId));
+
+    // 同一后端仍忙时不重复启动
+    d.startBackend(DScannerManagerPrivate::USBBackend, []() { return QList<DeviceInfo>(); });
+    QVERIFY(!d.isDiscoveryRunning());
+
+    // 迟到的结果仍然合并，但不会再结束一轮
+    QTRY_VERIFY(d.findDevice(late.deviceId));
+    QVERIFY(!d.runningBackends.contains(DScannerManagerPrivate::USBBackend));
+    QCOMPARE(discovered.size(), 1);
+    QCOMPARE(d.deviceSources.value(late.deviceId), DScannerManagerPrivate::USBBackend);
+    QCOMPARE(d.stats.lastDiscoveryTime, roundEnd);
+}
+
+void TestDeviceDiscoveryCache::testDeviceCacheRoundTrip()
+{
+    const DeviceInfo info = makeDevice(QStringLiteral("usb:04a9:1913"), QStringLiteral("Canon LiDE 400"));
+    {
+        DScannerManagerPrivate d(m_manager.data());
+        prepare(d);
+        d.mergeDiscoveredDevice(DScannerManagerPrivate::SANEBackend, info);
+        d.saveDeviceCache();
+    }
+    QVERIFY(QFile::exists(m_dir->filePath(QStringLiteral("devices.json"))));
+
+    DScannerManagerPrivate restored(m_manager.data());
+    prepare(restored);
+    restored.loadDeviceCache();
+
+    DScannerDevice *device = restored.findDevice(info.deviceId);
+    QVERIFY(device);
+    const DeviceInfo cached = device->deviceInfo();
+    QCOMPARE(cached.name, info.name);
+    QCOMPARE(cached.manufacturer, info.manufacturer);
+    QCOMPARE(cached.model, info.model);
+    QCOMPARE(cached.serialNumber, info.serialNumber);
+    QCOMPARE(cached.driverType, info.driverType);
+    QCOMPARE(cached.protocol, info.protocol);
+    QCOMPARE(cached.connectionString, info.connectionString);
+    QCOMPARE(restored.deviceSources.value(info.deviceId), DScannerManagerPrivate::SANEBackend);
+    QVERIFY(restored.deviceLastSeen.value(info.deviceId).isValid());
+
+    // 已存在的设备不会被缓存重复添加
+    restored.loadDeviceCache();
+    QCOMPARE(restored.availableDevices().size(), 1);
+}
+
+void TestDeviceDiscoveryCache::testDeviceCacheSkipsExpiredEntries()
+{
+    const DeviceInfo fresh = makeDevice(QStringLiteral("usb:04a9:1913"), QStringLiteral("Fresh"));
+    const DeviceInfo stale = makeDevice(QStringLiteral("usb:04a9:190a"), QStringLiteral("Stale"));
+    {
+        DScannerManagerPrivate d(m_manager.data());
+        prepare(d);
+        d.mergeDiscoveredDevice(DScannerManagerPrivate::USBBackend, fresh);
+        d.mergeDiscoveredDevice(DScannerManagerPrivate::USBBackend, stale);
+        d.deviceLastSeen.insert(stale.deviceId, QDateTime::currentDateTimeUtc().addSecs(-600));
+        d.saveDeviceCache();
+    }
+
+    DScannerManagerPrivate restored(m_manager.data());
+    prepare(restored);
+    restored.loadDeviceCache();
+    QVERIFY(restored.findDevice(fresh.deviceId));
+    QVERIFY(!restored.findDevice(stale.deviceId));
+
+    // 版本不符的缓存整体忽略
+    QFile file(m_dir->filePath(QStringLiteral("devices.json")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("{\"version\":999,\"devices\":[]}");
+    file.close();
+
+    DScannerManagerPrivate mismatched(m_manager.data());
+    prepare(mismatched);
+    mismatched.loadDeviceCache();
+    QVERIFY(mismatched.availableDevices().isEmpty());
+}
+
+void TestDeviceDiscoveryCache::testCacheFreshness()
+{
+    DScannerManagerPrivate d(m_manager.data());
+    prepare(d);
+
+    // 从未完成过发现
+    QVERIFY(!d.isDeviceCacheFresh());
+
+    d.finishDiscoveryRound();
+    QVERIFY(d.isDeviceCacheFresh());
+
+    d.stats.lastDiscoveryTime = QDateTime::currentDateTime().addSecs(-299);
+    QVERIFY(d.isDeviceCacheFresh());
+
+    d.stats.lastDiscoveryTime = QDateTime::currentDateTime().addSecs(-301);
+    QVERIFY(!d.isDeviceCacheFresh());
+
+    d.deviceCacheTtl = 600;
+    QVERIFY(d.isDeviceCacheFresh());
+}
+
+QTEST_MAIN(TestDeviceDiscoveryCache)
+#include "test_device_discovery_cache.moc"
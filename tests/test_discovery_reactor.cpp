@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QNetworkDatagram>
+#include <QNetworkInterface>
+#include <QThreadPool>
+#include <QUdpSocket>
+
+#include "network/network_discovery_tasks_p.h"
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+// 本地UDP代理：记录收到的报文，reply非空时向发送方应答
+class Responder : public QObject
+{
+public:
+    explicit Responder(const QByteArray &reply, const QHostAddress &address = QHostAddress(QHostAddress::LocalHost))
+        : m_reply(reply)
+    {
+        m_bound = m_socket.bind(address, 0);
+        connect(&m_socket, &QUdpSocket::readyRead, this, [this]() {
+            while (m_socket.hasPendingDatagrams()) {
+                const QNetworkDatagram datagram = m_socket.receiveDatagram();
+                received.append(datagram.data());
+                if (!m_reply.isEmpty()) {
+                    m_socket.writeDatagram(m_reply, datagram.senderAddress(), datagram.senderPort());
+                }
+            }
+        });
+    }
+
+    bool isBound() const { return m_bound; }
+    quint16 port() const { return m_socket.localPort(); }
+
+    QList<QByteArray> received;
+
+private:
+    QUdpSocket m_socket;
+    QByteArray m_reply;
+    bool m_bound = false;
+};
+
+struct FoundDevice {
+    DiscoveryReactor::Protocol protocol;
+    NetworkScannerDevice device;
+};
+
+} // namespace
+
+class TestDiscoveryReactor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRepliesAndTimeouts();
+    void testBroadcastSnmpProbe();
+    void testBroadcastNeedsSubnetBroadcastAddress();
+};
+
+void TestDiscoveryReactor::testRepliesAndTimeouts()
+{
+    const QByteArray mdnsReply("Canon scanner\nmodel=Canon LiDE 400\n");
+    const QByteArray ssdpReply("HTTP/1.1 200 OK\r\n"
+                               "ST: urn:schemas-upnp-org:device:Scanner:1\r\n"
+                               "LOCATION: http://127.0.0.1:8080/description.xml\r\n"
+                               "USN: uuid:4d696e69-0000-0000-0000-000000000001\r\n\r\n");
+    Responder mdns(mdnsReply);
+    Responder ssdp(ssdpReply);
+    Responder wsd{QByteArray()};
+    QVERIFY(mdns.isBound() && ssdp.isBound() && wsd.isBound());
+
+    QThreadPool pool;
+    DiscoveryReactor reactor(&pool);
+    reactor.setWindow(300);
+
+    QList<FoundDevice> found;
+    connect(&reactor, &DiscoveryReactor::deviceFound, this,
+            [&found](DiscoveryReactor::Protocol protocol, const NetworkScannerDevice &device) {
+        found.append({protocol, device});
+    });
+    QSignalSpy finished(&reactor, &DiscoveryReactor::finished);
+
+    const QByteArray mdnsQuery = DiscoveryReactor::buildMdnsQuery({QStringLiteral("_uscan._tcp.local")});
+    const QByteArray ssdpQuery("M-SEARCH * HTTP/1.1\r\nST: urn:schemas-upnp-org:device:Scanner:1\r\n\r\n");
+    const QByteArray wsdProbe("<soap:Envelope/>");
+    const QHostAddress localhost(QHostAddress::LocalHost);
+    reactor.addProbe(DiscoveryReactor::Mdns, mdnsQuery, localhost, mdns.port());
+    reactor.addProbe(DiscoveryReactor::Ssdp, ssdpQuery, localhost, ssdp.port());
+    reactor.addProbe(DiscoveryReactor::Wsd, wsdProbe, localhost, wsd.port());
+
+    QVERIFY(reactor.start());
+    QVERIFY(reactor.isRunning());
+    // 运行中不重复启动
+    QVERIFY(!reactor.start());
+
+    // 所有协议共用一个时间窗口，没有应答的协议不拖延结束
+    QTRY_COMPARE(finished.size(), 1);
+    QVERIFY(!reactor.isRunning());
+
+    QCOMPARE(found.size(), 2);
+    QSet<int> protocols;
+    for (const FoundDevice &entry : found) {
+        protocols.insert(entry.protocol);
+        QCOMPARE(entry.device.addresses, QStringList{QStringLiteral("127.0.0.1")});
+    }
+    QCOMPARE(protocols, (QSet<int>{DiscoveryReactor::Mdns, DiscoveryReactor::Ssdp}));
+
+    QCOMPARE(wsd.received, QList<QByteArray>{wsdProbe});
+
+    const DiscoveryReactor::Traffic mdnsTraffic = reactor.traffic(DiscoveryReactor::Mdns);
+    QCOMPARE(mdnsTraffic.probes, 1);
+    QCOMPARE(mdnsTraffic.timeouts, 0);
+    QCOMPARE(mdnsTraffic.bytesSent, qint64(mdnsQuery.size()));
+    QCOMPARE(mdnsTraffic.bytesReceived, qint64(mdnsReply.size()));
+
+    const DiscoveryReactor::Traffic ssdpTraffic = reactor.traffic(DiscoveryReactor::Ssdp);
+    QCOMPARE(ssdpTraffic.probes, 1);
+    QCOMPARE(ssdpTraffic.timeouts, 0);
+    QCOMPARE(ssdpTraffic.bytesReceived, qint64(ssdpReply.size()));
+
+    const DiscoveryReactor::Traffic wsdTraffic = reactor.traffic(DiscoveryReactor::Wsd);
+    QCOMPARE(wsdTraffic.probes, 1);
+    QCOMPARE(wsdTraffic.timeouts, 1);
+    QCOMPARE(wsdTraffic.bytesSent, qint64(wsdProbe.size()));
+    QCOMPARE(wsdTraffic.bytesReceived, qint64(0));
+
+    QCOMPARE(reactor.traffic(DiscoveryReactor::Snmp).probes, 0);
+
+    // 探测已发出，没有新探测时不启动
+    QVERIFY(!reactor.start());
+}
+
+void TestDiscoveryReactor::testBroadcastSnmpProbe()
+{
+    // 广播由任意地址上的代理接收，应答来自代理的单播地址
+    Responder agent(QByteArray("HP Color LaserJet MFP"), QHostAddress(QHostAddress::AnyIPv4));
+    QVERIFY(agent.isBound());
+
+    QNetworkAddressEntry entry;
+    entry.setIp(QHostAddress(QStringLiteral("127.0.0.1")));
+    entry.setPrefixLength(8);
+    entry.setBroadcast(QHostAddress(QStringLiteral("127.255.255.255")));
+
+    QThreadPool pool;
+    DiscoveryReactor reactor(&pool);
+    reactor.setWindow(300);
+
+    QList<FoundDevice> found;
+    connect(&reactor, &DiscoveryReactor::deviceFound, this,
+            [&found](DiscoveryReactor::Protocol protocol, const NetworkScannerDevice &device) {
+        found.append({protocol, device});
+    });
+    QSignalSpy finished(&reactor, &DiscoveryReactor::finished);
+
+    const QByteArray request = DiscoveryReactor::buildSnmpGetRequest(42);
+    QVERIFY(reactor.addBroadcastProbe(DiscoveryReactor::Snmp, request, entry, agent.port()));
+    QVERIFY(reactor.start());
+    QTRY_COMPARE(finished.size(), 1);
+
+    // 整个网段只发出一个GetRequest
+    QCOMPARE(agent.received, QList<QByteArray>{request});
+    QCOMPARE(quint8(request.at(0)), quint8(0x30));
+    QCOMPARE(request.size(), quint8(request.at(1)) + 2);
+    QVERIFY(request.contains(QByteArrayLiteral("public")));
+    QVERIFY(request.contains(QByteArray::fromHex("02040000002a")));
+
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found.first().protocol, DiscoveryReactor::Snmp);
+    QCOMPARE(found.first().device.addresses, QStringList{QStringLiteral("127.0.0.1")});
+
+    // 广播探测只要有应答就不算超时
+    const DiscoveryReactor::Traffic traffic = reactor.traffic(DiscoveryReactor::Snmp);
+    QCOMPARE(traffic.probes, 1);
+    QCOMPARE(traffic.timeouts, 0);
+    QCOMPARE(traffic.bytesSent, qint64(request.size()));
+}
+
+void TestDiscoveryReactor::testBroadcastNeedsSubnetBroadcastAddress()
+{
+    QThreadPool pool;
+    DiscoveryReactor reactor(&pool);
+    const QByteArray request = DiscoveryReactor::buildSnmpGetRequest(1);
+
+    // 点对点链路没有广播地址
+    QNetworkAddressEntry pointToPoint;
+    pointToPoint.setIp(QHostAddress(QStringLiteral("10.0.0.1")));
+    pointToPoint.setPrefixLength(32);
+    QVERIFY(!reactor.addBroadcastProbe(DiscoveryReactor::Snmp, request, pointToPoint, 161));
+
+    QNetworkAddressEntry ipv6;
+    ipv6.setIp(QHostAddress(QStringLiteral("fe80::1")));
+    ipv6.setPrefixLength(64);
+    QVERIFY(!reactor.addBroadcastProbe(DiscoveryReactor::Snmp, request, ipv6, 161));
+
+    QVERIFY(!reactor.start());
+}
+
+QTEST_MAIN(TestDiscoveryReactor)
+#include "test_discovery_reactor.moc"
@@ -0,0 +1,357 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QBuffer>
+#include <QImage>
+#include <QColor>
+#include <QHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtConcurrent>
+
+#include <memory>
+
+#include "network/escl_scan_client.h"
+
+DSCANNER_BEGIN_NAMESPACE
+
+namespace {
+
+// 最小的eSCL设备模拟：HTTP/1.1持久连接，页面以分块编码返回
+class MockEsclServer
+{
+public:
+    MockEsclServer()
+    {
+        QObject::connect(&m_server, &QTcpServer::newConnection, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                ++connections;
+                QObject::connect(socket, &QTcpSocket::readyRead, [this, socket]() {
+                    onReadyRead(socket);
+                });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost); }
+    QUrl baseUrl() const { return QUrl(QStringLiteral("http://127.0.0.1:%1/eSCL").arg(m_server.serverPort())); }
+
+    // 发出被扣留的后半页
+    void releaseHeld()
+    {
+        if (m_heldSocket) {
+            m_heldSocket->write(chunk(m_heldData) + "0\r\n\r\n");
+            m_heldSocket = nullptr;
+            m_heldData.clear();
+        }
+    }
+
+    QList<QByteArray> pages;
+    QByteArray contentType = "application/octet-stream";
+    bool rejectJobs = false;
+    bool holdSecondHalf = false;
+    QStringList requests;
+    int connections = 0;
+
+private:
+    static QByteArray chunk(const QByteArray &data)
+    {
+        return QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n";
+    }
+
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &buffer = m_buffers[socket];
+        buffer.append(socket->readAll());
+
+        for (;;) {
+            const int headerEnd = buffer.indexOf("\r\n\r\n");
+            if (headerEnd < 0) {
+                return;
+            }
+            const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+            int contentLength = 0;
+            for (const QByteArray &line : lines) {
+                if (line.toLower().startsWith("content-length:")) {
+                    contentLength = line.mid(15).trimmed().toInt();
+                }
+            }
+            if (buffer.size() < headerEnd + 4 + contentLength) {
+                return;
+            }
+
+            const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+            buffer.remove(0, headerEnd + 4 + contentLength);
+            handle(socket, QString::fromLatin1(requestLine.value(0)), QString::fromLatin1(requestLine.value(1)));
+        }
+    }
+
+    void handle(QTcpSocket *socket, const QString &method, const QString &path)
+    {
+        requests.append(method + QLatin1Char(' ') + path);
+
+        if (method == QLatin1String("POST") && path == QLatin1String("/eSCL/ScanJobs")) {
+            if (rejectJobs) {
+                socket->write("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+                return;
+            }
+            socket->write("HTTP/1.1 201 Created\r\nLocation: /eSCL/ScanJobs/job-1\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+
+        if (method == QLatin1String("GET") && path == QLatin1String("/eSCL/ScanJobs/job-1/NextDocument")) {
+            if (m_nextPage >= pages.size()) {
+                socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+                return;
+            }
+            const QByteArray page = pages.at(m_nextPage++);
+            const int half = page.size() / 2;
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: " + contentType
+                          + "\r\nTransfer-Encoding: chunked\r\n\r\n");
+            socket->write(chunk(page.left(half)));
+            if (holdSecondHalf) {
+                m_heldSocket = socket;
+                m_heldData = page.mid(half);
+            } else {
+                socket->write(chunk(page.mid(half)) + "0\r\n\r\n");
+            }
+            return;
+        }
+
+        if (method == QLatin1String("DELETE")) {
+            socket->write("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+
+        socket->write("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+    }
+
+    QTcpServer m_server;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QTcpSocket *m_heldSocket = nullptr;
+    QByteArray m_heldData;
+    int m_nextPage = 0;
+};
+
+// 处理线程一侧的读取结果
+struct ConsumerState {
+    QAtomicInt rowsRead;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    QByteArray data;
+    bool success = false;
+};
+
+void consumePage(const EsclPagePointer &page, const std::shared_ptr<ConsumerState> &state)
+{
+    if (!page->readHeader()) {
+        return;
+    }
+    state->width = page->width();
+    state->height = page->height();
+    state->channels = page->channels();
+    state->data.resize(page->bytesPerLine() * page->height());
+
+    // 与处理管道SourceNode相同的取数方式
+    const EsclPageStream::RowCallback callback = page->rowCallback();
+    for (int row = 0; row < page->height(); ++row) {
+        quint8 *line = reinterpret_cast<quint8 *>(state->data.data()) + row * page->bytesPerLine();
+        if (!callback(row, line)) {
+            return;
+        }
+        state->rowsRead.fetchAndAddOrdered(1);
+    }
+    state->success = true;
+}
+
+QByteArray grayPattern(int width, int height, int seed)
+{
+    QByteArray data(width * height, Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>((i * 7 + seed) & 0xFF);
+    }
+    return data;
+}
+
+EsclScanSettings graySettings(int width, int height)
+{
+    EsclScanSettings settings;
+    settings.resolution = 300;
+    settings.colorMode = QStringLiteral("Grayscale8");
+    settings.documentFormat = QStringLiteral("application/octet-stream");
+    settings.region = QRect(0, 0, width, height);
+    return settings;
+}
+
+}
+
+class TestEsclClient : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSettingsXml();
+    void testRowsDecodedBeforePageCompletes();
+    void testJpegPage();
+    void testMultiplePages();
+    void testJobRejected();
+};
+
+void TestEsclClient::testSettingsXml()
+{
+    EsclScanSettings settings;
+    settings.resolution = 600;
+    settings.region = QRect(0, 0, 2550, 3300);
+
+    const QByteArray xml = settings.toXml();
+    QVERIFY(xml.contains("ScanSettings"));
+    QVERIFY(xml.contains(">600</scan:XResolution>"));
+    QVERIFY(xml.contains(">RGB24</scan:ColorMode>"));
+    QVERIFY(xml.contains(">image/jpeg</pwg:DocumentFormat>"));
+    QVERIFY(xml.contains(">2550</pwg:Width>"));
+    QVERIFY(xml.contains("escl:ThreeHundredthsOfInches"));
+
+    // 未指定区域时由设备决定
+    QVERIFY(!EsclScanSettings().toXml().contains("ScanRegions"));
+}
+
+void TestEsclClient::testRowsDecodedBeforePageCompletes()
+{
+    const int width = 16;
+    const int height = 8;
+    const QByteArray page = grayPattern(width, height, 3);
+
+    MockEsclServer server;
+    server.pages.append(page);
+    server.holdSecondHalf = true;
+    QVERIFY(server.listen());
+
+    EsclScanClient client(server.baseUrl());
+    auto state = std::make_shared<ConsumerState>();
+    QFuture<void> consumer;
+    QObject::connect(&client, &EsclScanClient::pageStarted, [&](const EsclPagePointer &started) {
+        consumer = QtConcurrent::run([started, state]() { consumePage(started, state); });
+    });
+    QSignalSpy pageSpy(&client, &EsclScanClient::pageFinished);
+    QSignalSpy finishedSpy(&client, &EsclScanClient::scanFinished);
+
+    QVERIFY(client.startScan(graySettings(width, height)));
+
+    // 前半页的行在其余数据到达前已经解码
+    QTRY_COMPARE(state->rowsRead.loadAcquire(), height / 2);
+    QCOMPARE(pageSpy.count(), 0);
+
+    server.releaseHeld();
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    consumer.waitForFinished();
+
+    QVERIFY(state->success);
+    QCOMPARE(state->width, width);
+    QCOMPARE(state->height, height);
+    QCOMPARE(state->channels, 1);
+    QCOMPARE(state->data, page);
+    QCOMPARE(pageSpy.count(), 1);
+
+    // 所有请求复用同一条连接
+    QCOMPARE(server.connections, 1);
+    QCOMPARE(server.requests, QStringList({QStringLiteral("POST /eSCL/ScanJobs"),
+                                           QStringLiteral("GET /eSCL/ScanJobs/job-1/NextDocument"),
+                                           QStringLiteral("GET /eSCL/ScanJobs/job-1/NextDocument")}));
+}
+
+void TestEsclClient::testJpegPage()
+{
+    QImage image(32, 16, QImage::Format_RGB888);
+    image.fill(QColor(200, 100, 50));
+    QByteArray jpeg;
+    QBuffer buffer(&jpeg);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "JPEG", 100)) {
+        QSKIP("JPEG image plugin not available");
+    }
+
+    MockEsclServer server;
+    server.pages.append(jpeg);
+    server.contentType = "image/jpeg";
+    QVERIFY(server.listen());
+
+    EsclScanClient client(server.baseUrl());
+    auto state = std::make_shared<ConsumerState>();
+    QFuture<void> consumer;
+    QObject::connect(&client, &EsclScanClient::pageStarted, [&](const EsclPagePointer &started) {
+        consumer = QtConcurrent::run([started, state]() { consumePage(started, state); });
+    });
+    QSignalSpy finishedSpy(&client, &EsclScanClient::scanFinished);
+
+    QVERIFY(client.startScan(EsclScanSettings()));
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    consumer.waitForFinished();
+
+    QVERIFY(state->success);
+    QCOMPARE(state->width, 32);
+    QCOMPARE(state->height, 16);
+    QCOMPARE(state->channels, 3);
+
+    const quint8 *center = reinterpret_cast<const quint8 *>(state->data.constData()) + (8 * 32 + 16) * 3;
+    QVERIFY(qAbs(center[0] - 200) <= 8);
+    QVERIFY(qAbs(center[1] - 100) <= 8);
+    QVERIFY(qAbs(center[2] - 50) <= 8);
+}
+
+void TestEsclClient::testMultiplePages()
+{
+    MockEsclServer server;
+    server.pages << grayPattern(8, 4, 1) << grayPattern(8, 4, 2) << grayPattern(8, 4, 5);
+    QVERIFY(server.listen());
+
+    EsclScanClient client(server.baseUrl());
+    QList<EsclPagePointer> pages;
+    QObject::connect(&client, &EsclScanClient::pageStarted, [&](const EsclPagePointer &started) {
+        pages.append(started);
+    });
+    QSignalSpy pageSpy(&client, &EsclScanClient::pageFinished);
+    QSignalSpy finishedSpy(&client, &EsclScanClient::scanFinished);
+
+    QVERIFY(client.startScan(graySettings(8, 4)));
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QVERIFY(!client.isScanning());
+    QCOMPARE(pageSpy.count(), 3);
+    QCOMPARE(pages.size(), 3);
+
+    // 页面传输已结束，缓冲的数据仍可读出
+    for (int i = 0; i < pages.size(); ++i) {
+        auto state = std::make_shared<ConsumerState>();
+        consumePage(pages.at(i), state);
+        QVERIFY(state->success);
+        QCOMPARE(state->data, server.pages.at(i));
+        QCOMPARE(pageSpy.at(i).at(0).toInt(), i);
+    }
+    QCOMPARE(server.connections, 1);
+}
+
+void TestEsclClient::testJobRejected()
+{
+    MockEsclServer server;
+    server.rejectJobs = true;
+    QVERIFY(server.listen());
+
+    EsclScanClient client(server.baseUrl());
+    QSignalSpy errorSpy(&client, &EsclScanClient::errorOccurred);
+    QSignalSpy pageSpy(&client, &EsclScanClient::pageStarted);
+
+    QVERIFY(client.startScan(EsclScanSettings()));
+    QTRY_COMPARE(errorSpy.count(), 1);
+    QVERIFY(errorSpy.at(0).at(0).toString().contains(QStringLiteral("503")));
+    QCOMPARE(pageSpy.count(), 0);
+    QVERIFY(!client.isScanning());
+}
+
+DSCANNER_END_NAMESPACE
+
+QTEST_MAIN(Dtk::Scanner::TestEsclClient)
+#include "test_escl_client.moc"
@@ -0,0 +1,161 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QObject>
+#include <QDir>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include "genesys_calibration_cache.h"
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+const int kWidth = 40;
+const int kChannels = 3;
+
+// 16位小端交错样本，各列亮度不同，lines 行内容相同
+QByteArray createWhiteLines(int lines, double scale = 1.0)
+{
+    QByteArray data(lines * kWidth * kChannels * 2, Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(data.data());
+    for (int line = 0; line < lines; ++line) {
+        for (int x = 0; x < kWidth; ++x) {
+            for (int c = 0; c < kChannels; ++c) {
+                const double value = (40000 + x * 300 + c * 1000) * scale;
+                qToLittleEndian<quint16>(static_cast<quint16>(value), out);
+                out += 2;
+            }
+        }
+    }
+    return data;
+}
+
+GenesysCalibrationKey createKey()
+{
+    GenesysCalibrationKey key;
+    key.serialNumber = QStringLiteral("SN-0042/a:b");
+    key.chipset = QStringLiteral("GL847");
+    key.resolution = 600;
+    key.colorMode = ColorMode::Color;
+    key.sensor = QStringLiteral("CIS_CANON_LIDE_110");
+    return key;
+}
+
+GenesysCalibrationEntry createEntry()
+{
+    GenesysCalibrationEntry entry;
+    entry.whiteShadingData = createWhiteLines(1);
+    entry.blackShadingData = QByteArray(kWidth * kChannels * 2, '\x10');
+    entry.offsetData = QByteArray::fromHex("0a0b0c");
+    entry.gainData = QByteArray::fromHex("202122");
+    entry.width = kWidth;
+    entry.channels = kChannels;
+    return entry;
+}
+
+}
+
+class TestGenesysCalibrationCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testStoreAndLookup();
+    void testLookupIgnoresExpiredEntries();
+    void testVerifyDetectsDrift();
+};
+
+void TestGenesysCalibrationCache::testStoreAndLookup()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    GenesysCalibrationCache cache(directory.path() + QStringLiteral("/calibration"));
+
+    GenesysCalibrationEntry entry;
+    QVERIFY(!cache.lookup(createKey(), entry));
+    QVERIFY(!cache.store(createKey(), GenesysCalibrationEntry()));
+    QVERIFY(cache.store(createKey(), createEntry()));
+    QCOMPARE(QDir(cache.directory()).entryList(QDir::Files).size(), 1);
+
+    QVERIFY(cache.lookup(createKey(), entry));
+    const GenesysCalibrationEntry expected = createEntry();
+    QCOMPARE(entry.whiteShadingData, expected.whiteShadingData);
+    QCOMPARE(entry.blackShadingData, expected.blackShadingData);
+    QCOMPARE(entry.offsetData, expected.offsetData);
+    QCOMPARE(entry.gainData, expected.gainData);
+    QCOMPARE(entry.width, kWidth);
+    QCOMPARE(entry.channels, kChannels);
+    QCOMPARE(entry.createdAt.secsTo(entry.expiresAt), cache.maxAge());
+    QCOMPARE(entry.whiteProfile,
+             GenesysCalibrationCache::whiteProfile(expected.whiteShadingData, kWidth, kChannels));
+
+    // 键的任一字段不同都不能命中
+    GenesysCalibrationKey otherResolution = createKey();
+    otherResolution.resolution = 1200;
+    QVERIFY(!cache.lookup(otherResolution, entry));
+    GenesysCalibrationKey otherMode = createKey();
+    otherMode.colorMode = ColorMode::Grayscale;
+    QVERIFY(!cache.lookup(otherMode, entry));
+
+    cache.remove(createKey());
+    QVERIFY(!cache.lookup(createKey(), entry));
+}
+
+void TestGenesysCalibrationCache::testLookupIgnoresExpiredEntries()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    GenesysCalibrationCache cache(directory.path());
+
+    GenesysCalibrationEntry expired = createEntry();
+    expired.createdAt = QDateTime::currentDateTimeUtc().addSecs(-7200);
+    expired.expiresAt = expired.createdAt.addSecs(3600);
+    QVERIFY(cache.store(createKey(), expired));
+
+    GenesysCalibrationEntry entry;
+    QVERIFY(!cache.lookup(createKey(), entry));
+
+    // 有效期为0的条目一写入即过期
+    cache.setMaxAge(0);
+    QVERIFY(cache.store(createKey(), createEntry()));
+    QVERIFY(!cache.lookup(createKey(), entry));
+
+    cache.setMaxAge(3600);
+    QVERIFY(cache.store(createKey(), createEntry()));
+    QVERIFY(cache.lookup(createKey(), entry));
+}
+
+void TestGenesysCalibrationCache::testVerifyDetectsDrift()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    GenesysCalibrationCache cache(directory.path());
+    QVERIFY(cache.store(createKey(), createEntry()));
+
+    GenesysCalibrationEntry entry;
+    QVERIFY(cache.lookup(createKey(), entry));
+
+    // 多行白条取均值，漂移在3%以内
+    QVERIFY(cache.verify(entry, createWhiteLines(4)));
+    QVERIFY(cache.verify(entry, createWhiteLines(2, 1.02)));
+
+    // 整体变暗或单个分段漂移都要求重新校准
+    QVERIFY(!cache.verify(entry, createWhiteLines(2, 0.95)));
+    QByteArray localDrift = createWhiteLines(1);
+    uchar *sample = reinterpret_cast<uchar *>(localDrift.data()) + (kWidth - 1) * kChannels * 2;
+    qToLittleEndian<quint16>(static_cast<quint16>(qFromLittleEndian<quint16>(sample) * 0.7), sample);
+    QVERIFY(!cache.verify(entry, localDrift));
+
+    // 不足一行的数据无法比较
+    QVERIFY(!cache.verify(entry, createWhiteLines(1).left(kWidth * kChannels)));
+
+    cache.setDriftTolerance(0.1);
+    QVERIFY(cache.verify(entry, createWhiteLines(2, 0.95)));
+}
+
+QTEST_MAIN(TestGenesysCalibrationCache)
+#include "test_genesys_calibration_cache.moc"
@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QObject>
+
+#include "genesys_register_set.h"
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+// 记录每次传输的内容，可在第 failAt 次传输时失败
+struct RecordingTransfer {
+    QVector<QVector<GenesysRegisterSet::Write>> batches;
+    int failAt = -1;
+
+    GenesysRegisterSet::Transfer writer()
+    {
+        return [this](const QVector<GenesysRegisterSet::Write> &writes) {
+            if (batches.size() == failAt) {
+                failAt = -1;
+                return false;
+            }
+            batches.append(writes);
+            return true;
+        };
+    }
+
+    QVector<quint16> addresses() const
+    {
+        QVector<quint16> result;
+        for (const auto &batch : batches) {
+            for (const GenesysRegisterSet::Write &write : batch) {
+                result.append(write.address);
+            }
+        }
+        return result;
+    }
+};
+
+} // namespace
+
+class TestGenesysRegisterSet : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFlushKeepsFirstWriteOrder();
+    void testRedundantWritesElided();
+    void testVolatileWritesAlwaysSent();
+    void testRecordReadSeedsShadow();
+    void testInvalidate();
+    void testFailedTransferKeepsRegistersDirty();
+};
+
+void TestGenesysRegisterSet::testFlushKeepsFirstWriteOrder()
+{
+    GenesysRegisterSet registers;
+    registers.set(0x05, 0x11);
+    registers.set(0x01, 0x22);
+    registers.set(0x03, 0x33);
+    // 再次写入不改变提交顺序，提交的是最后的值
+    registers.set(0x05, 0x44);
+    QCOMPARE(registers.dirtyCount(), 3);
+
+    RecordingTransfer transfer;
+    QVERIFY(registers.flush(2, transfer.writer()));
+    QVERIFY(!registers.isDirty());
+
+    QCOMPARE(transfer.batches.size(), 2);
+    QCOMPARE(transfer.batches[0].size(), 2);
+    QCOMPARE(transfer.batches[1].size(), 1);
+    QCOMPARE(transfer.addresses(), QVector<quint16>({0x05, 0x01, 0x03}));
+    QCOMPARE(transfer.batches[0][0].value, quint16(0x44));
+    QCOMPARE(transfer.batches[0][1].value, quint16(0x22));
+    QCOMPARE(transfer.batches[1][0].value, quint16(0x33));
+
+    // 没有脏寄存器时不发起传输
+    QVERIFY(registers.flush(2, transfer.writer()));
+    QCOMPARE(transfer.batches.size(), 2);
+
+    // 每批至少一个寄存器
+    registers.set(0x07, 0x01);
+    registers.set(0x08, 0x02);
+    QVERIFY(registers.flush(0, transfer.writer()));
+    QCOMPARE(transfer.batches.size(), 4);
+}
+
+void TestGenesysRegisterSet::testRedundantWritesElided()
+{
+    GenesysRegisterSet registers;
+    RecordingTransfer transfer;
+    registers.set(0x10, 0x80);
+    QVERIFY(registers.flush(8, transfer.writer()));
+
+    // 与芯片上的值相同
+    registers.set(0x10, 0x80);
+    QVERIFY(!registers.isDirty());
+
+    // 改变后又改回，撤销之前的脏写入
+    registers.set(0x10, 0x81);
+    QVERIFY(registers.isDirty());
+    registers.set(0x10, 0x80);
+    QVERIFY(!registers.isDirty());
+
+    quint16 value = 0;
+    QVERIFY(registers.value(0x10, value));
+    QCOMPARE(value, quint16(0x80));
+
+    QVERIFY(registers.flush(8, transfer.writer()));
+    QCOMPARE(transfer.batches.size(), 1);
+}
+
+void TestGenesysRegisterSet::testVolatileWritesAlwaysSent()
+{
+    GenesysRegisterSet registers;
+    RecordingTransfer transfer;
+    registers.markVolatile(0x0f);
+    QVERIFY(registers.isVolatile(0x0f));
+    QVERIFY(!registers.isVolatile(0x0e));
+
+    // 连续相同的触发写入都要提交
+    for (int i = 0; i < 2; ++i) {
+        registers.set(0x0f, 0x01);
+        QVERIFY(registers.isDirty());
+        QVERIFY(registers.flush(8, transfer.writer()));
+    }
+    QCOMPARE(transfer.addresses(), QVector<quint16>({0x0f, 0x0f}));
+
+    // 读取总是访问设备
+    registers.recordRead(0x0f, 0x00);
+    QVERIFY(!registers.isCached(0x0f));
+}
+
+void TestGenesysRegisterSet::testRecordReadSeedsShadow()
+{
+    GenesysRegisterSet registers;
+    quint16 value = 0;
+    QVERIFY(!registers.value(0x20, value));
+    QVERIFY(!registers.isCached(0x20));
+
+    registers.recordRead(0x20, 0x42);
+    QVERIFY(registers.isCached(0x20));
+    QVERIFY(!registers.isDirty());
+    QVERIFY(registers.value(0x20, value));
+    QCOMPARE(value, quint16(0x42));
+
+    // 读回的值已在芯片上，相同写入无需提交
+    registers.set(0x20, 0x42);
+    QVERIFY(!registers.isDirty());
+
+    // 尚未提交的写入优先于读回的值
+    registers.set(0x20, 0x43);
+    registers.recordRead(0x20, 0x42);
+    QVERIFY(registers.value(0x20, value));
+    QCOMPARE(value, quint16(0x43));
+    QCOMPARE(registers.dirtyCount(), 1);
+}
+
+void TestGenesysRegisterSet::testInvalidate()
+{
+    GenesysRegisterSet registers;
+    RecordingTransfer transfer;
+    registers.markVolatile(0x0f);
+    registers.set(0x01, 0x10);
+    QVERIFY(registers.flush(8, transfer.writer()));
+    registers.set(0x02, 0x20);
+    registers.recordRead(0x03, 0x30);
+
+    registers.invalidate();
+    QVERIFY(!registers.isDirty());
+    QVERIFY(!registers.isCached(0x01));
+    QVERIFY(!registers.isCached(0x03));
+    quint16 value = 0;
+    QVERIFY(!registers.value(0x02, value));
+    QVERIFY(registers.isVolatile(0x0f));
+
+    // 复位后芯片上的值未知，之前的值也要重新提交
+    registers.set(0x01, 0x10);
+    QVERIFY(registers.isDirty());
+}
+
+void TestGenesysRegisterSet::testFailedTransferKeepsRegistersDirty()
+{
+    GenesysRegisterSet registers;
+    for (quint16 address = 1; address <= 5; ++address) {
+        registers.set(address, address * 2);
+    }
+
+    RecordingTransfer transfer;
+    transfer.failAt = 1;
+    QVERIFY(!registers.flush(2, transfer.writer()));
+
+    // 第一批已提交，失败的一批及之后的寄存器保持为脏
+    QCOMPARE(transfer.addresses(), QVector<quint16>({1, 2}));
+    QCOMPARE(registers.dirtyCount(), 3);
+    QVERIFY(registers.isCached(1));
+
+    // 重试时按原顺序提交剩余寄存器
+    QVERIFY(registers.flush(2, transfer.writer()));
+    QCOMPARE(transfer.addresses(), QVector<quint16>({1, 2, 3, 4, 5}));
+    QVERIFY(!registers.isDirty());
+
+    registers.set(3, 6);
+    QVERIFY(!registers.isDirty());
+}
+
+QTEST_MAIN(TestGenesysRegisterSet)
+#include "test_genesys_register_set.moc"
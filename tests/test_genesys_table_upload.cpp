@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QtEndian>
+
+#include "genesys_table_upload.h"
+
+#include <atomic>
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+// 按发生顺序记录上传、准备、提交等事件
+class EventLog
+{
+public:
+    void append(const QString &event)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_events.append(event);
+    }
+
+    QStringList events() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_events;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QStringList m_events;
+};
+
+} // namespace
+
+class TestGenesysTableUpload : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testUploadsOverlapPreparationAndFinishBeforeCommit();
+    void testPrepareFailureStillWaitsForUploads();
+    void testUploadFailureSkipsCommit();
+    void testEmptyTablesSkipped();
+    void testGammaTable();
+    void testShadingTable();
+};
+
+void TestGenesysTableUpload::testUploadsOverlapPreparationAndFinishBeforeCommit()
+{
+    EventLog log;
+    std::atomic<int> inFlight(0);
+    QThread *callerThread = QThread::currentThread();
+    std::atomic<bool> uploadedOnCaller(false);
+
+    GenesysTableUploader uploader([&](quint32 address, const QByteArray &data) {
+        Q_UNUSED(data)
+        if (QThread::currentThread() == callerThread) {
+            uploadedOnCaller = true;
+        }
+        ++inFlight;
+        log.append(QStringLiteral("upload-begin %1").arg(address, 0, 16));
+        QThread::msleep(100);
+        log.append(QStringLiteral("upload-end %1").arg(address, 0, 16));
+        --inFlight;
+        return true;
+    });
+    uploader.enqueue(0x00000, QByteArray(512, '\x01'));
+    uploader.enqueue(0x10000, QByteArray(512, '\x02'));
+
+    bool overlapped = false;
+    const bool started = uploader.startAfterUploads(
+        [&]() {
+            // 马达、灯管准备期间上传在进行
+            QElapsedTimer timer;
+            timer.start();
+            while (inFlight == 0 && timer.elapsed() < 1000) {
+                QThread::msleep(5);
+            }
+            overlapped = inFlight > 0;
+            log.append(QStringLiteral("prepared"));
+            return true;
+        },
+        [&]() {
+            log.append(QStringLiteral("flush"));
+            log.append(QStringLiteral("scan"));
+            return true;
+        });
+
+    QVERIFY(started);
+    QVERIFY(overlapped);
+    QVERIFY(!uploadedOnCaller);
+    QVERIFY(!uploader.uploadFailed());
+
+    // 上传按提交顺序依次进行，全部结束后才提交寄存器并开始扫描
+    const QStringList events = log.events();
+    QCOMPARE(events.size(), 7);
+    QVERIFY(events.indexOf(QStringLiteral("upload-end 0")) < events.indexOf(QStringLiteral("upload-begin 10000")));
+    QVERIFY(events.indexOf(QStringLiteral("prepared")) < events.indexOf(QStringLiteral("upload-end 10000")));
+    QCOMPARE(events.at(4), QStringLiteral("upload-end 10000"));
+    QCOMPARE(events.at(5), QStringLiteral("flush"));
+    QCOMPARE(events.at(6), QStringLiteral("scan"));
+}
+
+void TestGenesysTableUpload::testPrepareFailureStillWaitsForUploads()
+{
+    std::atomic<bool> finished(false);
+    GenesysTableUploader uploader([&](quint32, const QByteArray &) {
+        QThread::msleep(100);
+        finished = true;
+        return true;
+    });
+    uploader.enqueue(0x00000, QByteArray(16, '\0'));
+
+    bool committed = false;
+    QVERIFY(!uploader.startAfterUploads([]() { return false; },
+                                        [&]() { committed = true; return true; }));
+
+    // 返回后不再有在途的传输
+    QVERIFY(finished);
+    QVERIFY(!committed);
+    QVERIFY(!uploader.uploadFailed());
+}
+
+void TestGenesysTableUpload::testUploadFailureSkipsCommit()
+{
+    GenesysTableUploader uploader([](quint32 address, const QByteArray &) {
+        return address != 0x10000;
+    });
+    uploader.enqueue(0x00000, QByteArray(16, '\0'));
+    uploader.enqueue(0x10000, QByteArray(16, '\0'));
+
+    bool committed = false;
+    QVERIFY(!uploader.startAfterUploads([]() { return true; },
+                                        [&]() { committed = true; return true; }));
+    QVERIFY(!committed);
+    QVERIFY(uploader.uploadFailed());
+
+    // 失败状态只属于最近一次等待
+    QVERIFY(uploader.waitForFinished());
+    QVERIFY(!uploader.uploadFailed());
+}
+
+void TestGenesysTableUpload::testEmptyTablesSkipped()
+{
+    int transfers = 0;
+    GenesysTableUploader uploader([&](quint32, const QByteArray &) {
+        ++transfers;
+        return false;
+    });
+    uploader.enqueue(0x10000, QByteArray());
+    QVERIFY(uploader.waitForFinished());
+    QCOMPARE(transfers, 0);
+}
+
+void TestGenesysTableUpload::testGammaTable()
+{
+    const QByteArray color = GenesysTableUploader::gammaTable(3, 1.0);
+    QCOMPARE(color.size(), 3 * 256 * 2);
+    const uchar *entries = reinterpret_cast<const uchar *>(color.constData());
+    QCOMPARE(qFromLittleEndian<quint16>(entries), quint16(0));
+    QCOMPARE(qFromLittleEndian<quint16>(entries + 255 * 2), quint16(65535));
+    QCOMPARE(qFromLittleEndian<quint16>(entries + 128 * 2), quint16(32896));
+    // 每个通道使用同一条曲线
+    QCOMPARE(color.mid(256 * 2, 256 * 2), color.left(256 * 2));
+
+    // gamma > 1 提亮中间调
+    const QByteArray gray = GenesysTableUploader::gammaTable(1, 2.2);
+    QCOMPARE(gray.size(), 256 * 2);
+    const uchar *grayEntries = reinterpret_cast<const uchar *>(gray.constData());
+    QVERIFY(qFromLittleEndian<quint16>(grayEntries + 128 * 2) > 32896);
+    QCOMPARE(qFromLittleEndian<quint16>(grayEntries + 255 * 2), quint16(65535));
+
+    // 非法gamma按1.0处理
+    QCOMPARE(GenesysTableUploader::gammaTable(3, 0.0), color);
+}
+
+void TestGenesysTableUpload::testShadingTable()
+{
+    QByteArray white(4, Qt::Uninitialized);
+    QByteArray black(4, Qt::Uninitialized);
+    qToLittleEndian<quint16>(65535, white.data());
+    qToLittleEndian<quint16>(0, black.data());
+    qToLittleEndian<quint16>(1000, white.data() + 2);
+    qToLittleEndian<quint16>(1000, black.data() + 2);
+
+    const QByteArray shading = GenesysTableUploader::shadingTable(white, black);
+    QCOMPARE(shading.size(), 8);
+    const uchar *out = reinterpret_cast<const uchar *>(shading.constData());
+    QCOMPARE(qFromLittleEndian<quint16>(out), quint16(0));
+    QCOMPARE(qFromLittleEndian<quint16>(out + 2), quint16(0x4000));
+    // 白电平不高于暗电平时增益为1.0
+    QCOMPARE(qFromLittleEndian<quint16>(out + 4), quint16(1000));
+    QCOMPARE(qFromLittleEndian<quint16>(out + 6), quint16(0x4000));
+
+    // 未校准或两行长度不一致
+    QVERIFY(GenesysTableUploader::shadingTable(QByteArray(), QByteArray()).isEmpty());
+    QVERIFY(GenesysTableUploader::shadingTable(white, black.left(2)).isEmpty());
+}
+
+QTEST_MAIN(TestGenesysTableUpload)
+#include "test_genesys_table_upload.moc"
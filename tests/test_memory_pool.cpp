@@ -0,0 +1,433 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QImage>
+#include <QSignalSpy>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "memory_optimized_processor.h"
+
+namespace {
+
+QImage createGradientImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            line[x] = qRgb((x * 255) / width, (y * 255) / height, ((x + y) * 255) / (width + height));
+        }
+    }
+    return image;
+}
+
+}
+
+class TestMemoryPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSizeClasses();
+    void testGlobalFreeListContention();
+    void testCompactReleasesFreeBlocks();
+    void testThreadExitReturnsCachedBlocks();
+    void testThreadExitAfterPoolDestroyed();
+    void benchmarkMemoryPoolContention();
+    void testTileIncrementalMerge();
+    void testTileProcessorException();
+};
+
+void TestMemoryPool::testSizeClasses()
+{
+    QCOMPARE(MemoryPool::sizeClassFor(1), 0);
+    QCOMPARE(MemoryPool::sizeClassFor(256), 0);
+    QCOMPARE(MemoryPool::sizeClassFor(257), 1);
+    QCOMPARE(MemoryPool::sizeClassBytes(1), size_t(384));
+    QCOMPARE(MemoryPool::sizeClassFor(385), 2);
+
+    for (int sizeClass = 0; sizeClass < MemoryPool::kSizeClassCount; ++sizeClass) {
+        QCOMPARE(MemoryPool::sizeClassFor(MemoryPool::sizeClassBytes(sizeClass)), sizeClass);
+    }
+    QCOMPARE(MemoryPool::sizeClassFor(MemoryPool::sizeClassBytes(MemoryPool::kSizeClassCount - 1) + 1), -1);
+}
+
+void TestMemoryPool::testGlobalFreeListContention()
+{
+    // 大于线程缓存上限的类别每次释放都进入全局空闲链表，
+    // 多线程交叉分配释放时若发生ABA，同一块会被交给两个线程
+    const size_t blockSize = 3 * 1024 * 1024;
+    const int threadCount = std::max(4, QThread::idealThreadCount());
+    const int iterations = 2000;
+
+    MemoryPool pool(0);
+    std::atomic<bool> corrupted{false};
+    std::vector<std::atomic<void*>> handoff(threadCount);
+    for (auto &slot : handoff) {
+        slot.store(nullptr);
+    }
+
+    auto stamp = [blockSize](void *ptr, quint32 value) {
+        auto *bytes = static_cast<quint8*>(ptr);
+        std::memcpy(bytes, &value, sizeof(value));
+        std::memcpy(bytes + blockSize - sizeof(value), &value, sizeof(value));
+    };
+    auto stampMatches = [blockSize](const void *ptr, quint32 value) {
+        const auto *bytes = static_cast<const quint8*>(ptr);
+        quint32 head = 0;
+        quint32 tail = 0;
+        std::memcpy(&head, bytes, sizeof(head));
+        std::memcpy(&tail, bytes + blockSize - sizeof(tail), sizeof(tail));
+        return head == value && tail == value;
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int i = 0; i < iterations; ++i) {
+                const quint32 value = (static_cast<quint32>(t) << 20) | static_cast<quint32>(i);
+                void *ptr = pool.allocate(blockSize, 32);
+                if (!ptr) {
+                    corrupted.store(true);
+                    return;
+                }
+                stamp(ptr, value);
+                QThread::yieldCurrentThread();
+                if (!stampMatches(ptr, value)) {
+                    corrupted.store(true);
+                }
+
+                // 隔次交给相邻线程释放
+                if (i & 1) {
+                    void *stale = handoff[(t + 1) % threadCount].exchange(ptr);
+                    pool.deallocate(stale);
+                } else {
+                    pool.deallocate(ptr);
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (auto &slot : handoff) {
+        pool.deallocate(slot.exchange(nullptr));
+    }
+
+    QVERIFY(!corrupted.load());
+
+    const MemoryPool::Statistics stats = pool.getStatistics();
+    QCOMPARE(stats.allocationCount, static_cast<size_t>(threadCount) * iterations);
+    QCOMPARE(stats.deallocationCount, stats.allocationCount);
+    QCOMPARE(stats.currentUsage, size_t(0));
+    // 块被复用而非每次向系统申请
+    QVERIFY(stats.poolSize <= static_cast<size_t>(threadCount) * 2 * MemoryPool::sizeClassBytes(
+                MemoryPool::sizeClassFor(blockSize)) * 2);
+}
+
+void TestMemoryPool::testCompactReleasesFreeBlocks()
+{
+    MemoryPool pool(0);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 32; ++i) {
+        blocks.push_back(pool.allocate(64 * 1024, 32));
+        QVERIFY(blocks.back() != nullptr);
+    }
+    for (void *ptr : blocks) {
+        pool.deallocate(ptr);
+    }
+    QVERIFY(pool.getStatistics().poolSize > 0);
+
+    // 保留上限为0时释放全部空闲块，之后仍可正常分配
+    pool.compact();
+    QCOMPARE(pool.getStatistics().poolSize, size_t(0));
+
+    void *ptr = pool.allocate(64 * 1024, 32);
+    QVERIFY(ptr != nullptr);
+    pool.deallocate(ptr);
+}
+
+void TestMemoryPool::testThreadExitReturnsCachedBlocks()
+{
+    const size_t blockSize = 4096;
+    const int blockCount = 8;
+    MemoryPool pool(0);
+
+    // 工作线程释放的块留在其线程缓存中，线程退出后应归还全局链表
+    std::thread worker([&]() {
+        std::vector<void*> blocks;
+        for (int i = 0; i < blockCount; ++i) {
+            blocks.push_back(pool.allocate(blockSize, 32));
+        }
+        for (void *ptr : blocks) {
+            pool.deallocate(ptr);
+        }
+    });
+    worker.join();
+
+    const size_t reserved = pool.getStatistics().poolSize;
+    QVERIFY(reserved > 0);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < blockCount; ++i) {
+        blocks.push_back(pool.allocate(blockSize, 32));
+        QVERIFY(blocks.back() != nullptr);
+    }
+    // 复用退出线程的块，不再向系统申请
+    QCOMPARE(pool.getStatistics().poolSize, reserved);
+
+    for (void *ptr : blocks) {
+        pool.deallocate(ptr);
+    }
+
+    // 已退出线程的统计仍计入总数
+    const MemoryPool::Statistics stats = pool.getStatistics();
+    QCOMPARE(stats.allocationCount, static_cast<size_t>(blockCount) * 2);
+    QCOMPARE(stats.deallocationCount, stats.allocationCount);
+    QCOMPARE(stats.currentUsage, size_t(0));
+}
+
+void TestMemoryPool::testThreadExitAfterPoolDestroyed()
+{
+    std::unique_ptr<MemoryPool> pool(new MemoryPool(0));
+    std::atomic<int> stage{0};
+
+    std::thread worker([&]() {
+        pool->deallocate(pool->allocate(4096, 32));
+        stage.store(1);
+        while (stage.load() != 2) {
+            QThread::yieldCurrentThread();
+        }
+    });
+
+    while (stage.load() != 1) {
+        QThread::yieldCurrentThread();
+    }
+    // 内存池先于持有其缓存的线程析构，线程退出时不得访问已析构的池
+    pool.reset();
+    stage.store(2);
+    worker.join();
+
+    MemoryPool other(0);
+    void *ptr = other.allocate(4096, 32);
+    QVERIFY(ptr != nullptr);
+    other.deallocate(ptr);
+}
+
+void TestMemoryPool::benchmarkMemoryPoolContention()
+{
+    qDebug() << "\n--- 内存池多线程争用基准 ---";
+
+    const int threadCount = std::max(8, QThread::idealThreadCount());
+    const int iterations = 50000;
+    // 典型尺寸：600dpi A4 RGB扫描行、512x512 RGBA分块、小型临时缓冲
+    const size_t sizes[] = {15300, 512 * 512 * 4, 4096, 64 * 1024, 300};
+    const int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    // 每个线程保留少量在用块，并在不同线程间交叉释放
+    auto runWorkers = [&](std::function<void*(size_t)> alloc, std::function<void(void*)> dealloc) {
+        std::vector<std::atomic<void*>> handoff(threadCount);
+        for (auto &slot : handoff) {
+            slot.store(nullptr);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threadCount; ++t) {
+            workers.emplace_back([&, t]() {
+                void *held[4] = {};
+                for (int i = 0; i < iterations; ++i) {
+                    int k = i & 3;
+                    if (held[k]) {
+                        static_cast<char*>(held[k])[0] = static_cast<char>(i);
+                        // 每16次交给相邻线程释放
+                        if ((i & 15) == 0) {
+                            void *stale = handoff[(t + 1) % threadCount].exchange(held[k]);
+                            if (stale) {
+                                dealloc(stale);
+                            }
+                        } else {
+                            dealloc(held[k]);
+                        }
+                    }
+                    held[k] = alloc(sizes[(i + t) % sizeCount]);
+                }
+                for (void *ptr : held) {
+                    dealloc(ptr);
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        for (auto &slot : handoff) {
+            dealloc(slot.exchange(nullptr));
+        }
+
+        return timer.elapsed();
+    };
+
+    MemoryPool pool(64 * 1024 * 1024);
+    qint64 poolTime = runWorkers([&pool](size_t size) { return pool.allocate(size, 32); },
+                                 [&pool](void *ptr) { pool.deallocate(ptr); });
+
+    // 对照：全局互斥锁保护的系统分配器，即旧实现的串行化上限
+    QMutex mutex;
+    qint64 mutexTime = runWorkers([&mutex](size_t size) {
+                                      QMutexLocker locker(&mutex);
+                                      return std::aligned_alloc(32, (size + 31) & ~size_t(31));
+                                  },
+                                  [&mutex](void *ptr) {
+                                      QMutexLocker locker(&mutex);
+                                      std::free(ptr);
+                                  });
+
+    auto stats = pool.getStatistics();
+    const double operations = double(threadCount) * iterations;
+
+    qDebug() << QString("线程数: %1，每线程操作: %2").arg(threadCount).arg(iterations);
+    qDebug() << QString("内存池: %1ms (%2 Mops/s)").arg(poolTime)
+                .arg(operations / std::max<qint64>(1, poolTime) / 1000.0, 0, 'f', 2);
+    qDebug() << QString("互斥锁+malloc: %1ms (%2 Mops/s)").arg(mutexTime)
+                .arg(operations / std::max<qint64>(1, mutexTime) / 1000.0, 0, 'f', 2);
+    qDebug() << QString("内存池保留: %1KB，碎片化率: %2").arg(stats.poolSize / 1024)
+                .arg(stats.fragmentationRatio, 0, 'f', 3);
+
+    // 跨线程释放后统计必须平衡
+    QCOMPARE(stats.allocationCount, static_cast<size_t>(threadCount) * iterations);
+    QCOMPARE(stats.deallocationCount, stats.allocationCount);
+    QCOMPARE(stats.currentUsage, static_cast<size_t>(0));
+}
+
+void TestMemoryPool::testTileIncrementalMerge()
+{
+    // 尺寸取分块的整数倍和非整数倍，覆盖边缘分块
+    for (const QSize &imageSize : {QSize(600, 450), QSize(517, 389)}) {
+        QImage originalImage = createGradientImage(imageSize.width(), imageSize.height());
+        TileProcessor processor(QSize(150, 150), 12);
+        auto tileInfos = processor.calculateTiles(imageSize);
+
+        // 以逆序合并，模拟并行处理时的乱序完成
+        QImage merged = processor.createMergeTarget(imageSize);
+        for (int i = tileInfos.size() - 1; i >= 0; --i) {
+            processor.mergeTile(merged, processor.extractTile(originalImage, tileInfos[i]), tileInfos[i]);
+        }
+
+        // 重叠区权重之和为1，恒等处理应还原原图（允许舍入误差）
+        int maxDiff = 0;
+        for (int y = 0; y < imageSize.height(); ++y) {
+            const QRgb *origLine = reinterpret_cast<const QRgb*>(originalImage.constScanLine(y));
+            const QRgb *mergedLine = reinterpret_cast<const QRgb*>(merged.constScanLine(y));
+            for (int x = 0; x < imageSize.width(); ++x) {
+                maxDiff = std::max({maxDiff,
+                                    qAbs(qRed(origLine[x]) - qRed(mergedLine[x])),
+                                    qAbs(qGreen(origLine[x]) - qGreen(mergedLine[x])),
+                                    qAbs(qBlue(origLine[x]) - qBlue(mergedLine[x])),
+                                    qAbs(qAlpha(origLine[x]) - qAlpha(mergedLine[x]))});
+            }
+        }
+
+        QVERIFY(maxDiff <= 2);
+    }
+
+    // 并行分块处理应与恒等结果一致，且进度信号覆盖全部分块
+    MemoryOptimizedProcessor memoryProcessor;
+    MemoryOptimizedProcessor::Config config;
+    config.memoryLimitMB = 32;          // 整图需求超过限制的1/4，走分块路径
+    config.maxTileSize = QSize(256, 256);
+    config.tileOverlap = 8;
+    config.poolInitialSizeMB = 8;
+    config.maxConcurrentTiles = 3;
+    memoryProcessor.setConfig(config);
+
+    // 驻留分块 = 已开始处理 - 已合并，合并进度信号在调用线程中同步发出
+    std::atomic<int> started(0);
+    std::atomic<int> mergedTiles(0);
+    std::atomic<int> maxResident(0);
+    QObject::connect(&memoryProcessor, &MemoryOptimizedProcessor::processingProgress,
+                     [&](int current, int) { mergedTiles.store(current); });
+    auto identity = [&](const QImage &tile) {
+        const int resident = ++started - mergedTiles.load();
+        int previous = maxResident.load();
+        while (resident > previous && !maxResident.compare_exchange_weak(previous, resident)) {
+        }
+        QThread::msleep(2);
+        return tile;
+    };
+
+    QImage largeImage = createGradientImage(1500, 1200);
+    QSignalSpy progressSpy(&memoryProcessor, &MemoryOptimizedProcessor::processingProgress);
+    QImage result = memoryProcessor.processLargeImage(largeImage, identity);
+
+    QCOMPARE(result.size(), largeImage.size());
+    int maxDiff = 0;
+    for (int y = 0; y < largeImage.height(); ++y) {
+        const QRgb *origLine = reinterpret_cast<const QRgb*>(largeImage.constScanLine(y));
+        const QRgb *resultLine = reinterpret_cast<const QRgb*>(result.constScanLine(y));
+        for (int x = 0; x < largeImage.width(); ++x) {
+            maxDiff = std::max({maxDiff,
+                                qAbs(qRed(origLine[x]) - qRed(resultLine[x])),
+                                qAbs(qGreen(origLine[x]) - qGreen(resultLine[x])),
+                                qAbs(qBlue(origLine[x]) - qBlue(resultLine[x])),
+                                qAbs(qAlpha(origLine[x]) - qAlpha(resultLine[x]))});
+        }
+    }
+    QVERIFY(maxDiff <= 2);
+
+    QVERIFY(!progressSpy.isEmpty());
+    QVERIFY(progressSpy.size() > 1);
+    QCOMPARE(progressSpy.last().at(0).toInt(), progressSpy.last().at(1).toInt());
+    QCOMPARE(started.load(), progressSpy.last().at(1).toInt());
+    QVERIFY(maxResident.load() >= 1);
+    QVERIFY(maxResident.load() <= config.maxConcurrentTiles);
+}
+
+void TestMemoryPool::testTileProcessorException()
+{
+    MemoryOptimizedProcessor memoryProcessor;
+    MemoryOptimizedProcessor::Config config;
+    config.memoryLimitMB = 32;
+    config.maxTileSize = QSize(256, 256);
+    config.tileOverlap = 8;
+    config.poolInitialSizeMB = 8;
+    config.maxConcurrentTiles = 3;
+    memoryProcessor.setConfig(config);
+
+    // 第5个分块抛出异常：调用不能挂起，返回空图像
+    std::atomic<int> calls(0);
+    auto failing = [&](const QImage &tile) {
+        if (++calls == 5) {
+            throw std::runtime_error("tile failed");
+        }
+        return tile;
+    };
+
+    QSignalSpy progressSpy(&memoryProcessor, &MemoryOptimizedProcessor::processingProgress);
+    const QImage result = memoryProcessor.processLargeImage(createGradientImage(1500, 1200), failing);
+
+    QVERIFY(result.isNull());
+    QVERIFY(!progressSpy.isEmpty());
+    QVERIFY(progressSpy.last().at(0).toInt() < progressSpy.last().at(1).toInt());
+}
+
+QTEST_MAIN(TestMemoryPool)
+#include "test_memory_pool.moc"
@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QObject>
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+#include <set>
+
+#include "multithreaded_processor.h"
+
+namespace {
+
+QImage createGrayImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_Grayscale8);
+    for (int y = 0; y < height; ++y) {
+        uchar *line = image.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            line[x] = static_cast<uchar>((x * 29 + y * 53 + (x * y) % 17) & 0xFF);
+        }
+    }
+    return image;
+}
+
+// 纵向三行均值，边界行复制：行带缺少上下文行时结果必然不同
+QImage verticalBlur(const QImage &image)
+{
+    QImage result(image.width(), image.height(), image.format());
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar *above = image.constScanLine(qMax(0, y - 1));
+        const uchar *line = image.constScanLine(y);
+        const uchar *below = image.constScanLine(qMin(image.height() - 1, y + 1));
+        uchar *out = result.scanLine(y);
+        for (int x = 0; x < image.width(); ++x) {
+            out[x] = static_cast<uchar>((above[x] + line[x] * 2 + below[x] + 2) / 4);
+        }
+    }
+    return result;
+}
+
+bool sameRows(const QImage &a, const QImage &b)
+{
+    if (a.size() != b.size() || a.format() != b.format()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); ++y) {
+        if (!std::equal(a.constScanLine(y), a.constScanLine(y) + a.width(), b.constScanLine(y))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void startWorkers(MultithreadedProcessor &processor, int threadCount)
+{
+    MultithreadedProcessor::ThreadPoolConfig config = processor.getThreadPoolConfig();
+    config.maxThreadCount = threadCount;
+    config.enableThreadAffinity = false;
+    processor.setThreadPoolConfig(config);
+    processor.startThreadPool();
+}
+
+}
+
+class TestMultithreadedProcessor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testProcessImageAsync();
+    void testBandsMatchWholeImage();
+    void testIdleWorkersStealBands();
+    void testBatchSplitsOversizedPage();
+    void testPriorityOrder();
+    void testClearQueueFailsPendingTasks();
+    void testSubmitWithoutWorkersFails();
+};
+
+void TestMultithreadedProcessor::testProcessImageAsync()
+{
+    MultithreadedProcessor processor;
+    startWorkers(processor, 2);
+
+    const QImage image = createGrayImage(13, 9);
+    const MultithreadedProcessor::ProcessingResult result =
+        processor.processImageAsync(image, verticalBlur).result();
+
+    QVERIFY(result.success);
+    QVERIFY(sameRows(result.result, verticalBlur(image)));
+    QVERIFY(result.threadId >= 0 && result.threadId < 2);
+    QVERIFY(processor.waitForAll(5000));
+}
+
+void TestMultithreadedProcessor::testBandsMatchWholeImage()
+{
+    MultithreadedProcessor processor;
+    startWorkers(processor, 3);
+
+    // 奇数行数与行带大小不整除，末尾行带较短
+    const QImage image = createGrayImage(23, 53);
+    const MultithreadedProcessor::ProcessingResult banded =
+        processor.processImageBandsAsync(image, verticalBlur, MultithreadedProcessor::Normal, 7, 1).result();
+
+    QVERIFY(banded.success);
+    QVERIFY(sameRows(banded.result, verticalBlur(image)));
+
+    // 没有上下文行时行带边界处结果不同，说明确实按行带处理
+    const MultithreadedProcessor::ProcessingResult noHalo =
+        processor.processImageBandsAsync(image, verticalBlur, MultithreadedProcessor::Normal, 7, 0).result();
+    QVERIFY(noHalo.success);
+    QVERIFY(!sameRows(noHalo.result, verticalBlur(image)));
+    QVERIFY(processor.waitForAll(5000));
+}
+
+void TestMultithreadedProcessor::testIdleWorkersStealBands()
+{
+    MultithreadedProcessor processor;
+    startWorkers(processor, 4);
+
+    // 行带全部压入执行拆分的线程队列，其他线程只能通过窃取获得
+    QMutex mutex;
+    std::set<Qt::HANDLE> threads;
+    auto slowCopy = [&](const QImage &band) {
+        {
+            QMutexLocker locker(&mutex);
+            threads.insert(QThread::currentThreadId());
+        }
+        QThread::msleep(20);
+        return band.copy();
+    };
+
+    const QImage image = createGrayImage(16, 40);
+    const MultithreadedProcessor::ProcessingResult result =
+        processor.processImageBandsAsync(image, slowCopy, MultithreadedProcessor::Normal, 5, 0).result();
+
+    QVERIFY(result.success);
+    QVERIFY(sameRows(result.result, image));
+    QVERIFY(threads.size() >= 2);
+    QVERIFY(processor.waitForAll(5000));
+}
+
+void TestMultithreadedProcessor::testBatchSplitsOversizedPage()
+{
+    MultithreadedProcessor processor;
+    startWorkers(processor, 2);
+
+    // 记录处理函数收到的最大行数，页面被拆分时不会收到整页
+    QMutex mutex;
+    int tallest = 0;
+    auto recordHeight = [&](const QImage &image) {
+        {
+            QMutexLocker locker(&mutex);
+            tallest = qMax(tallest, image.height());
+        }
+        return verticalBlur(image);
+    };
+
+    const QImage large = createGrayImage(16, 200);
+    const QImage small = createGrayImage(16, 20);
+
+    // 两页的批次中较大页面超过另一页两倍即拆分
+    QList<QFuture<MultithreadedProcessor::ProcessingResult>> futures =
+        processor.processBatchAsync({large, small}, recordHeight, MultithreadedProcessor::Normal, 1);
+    QCOMPARE(futures.size(), 2);
+    QVERIFY(sameRows(futures[0].result().result, verticalBlur(large)));
+    QVERIFY(sameRows(futures[1].result().result, verticalBlur(small)));
+    QVERIFY(tallest < large.height());
+
+    // 大小相近的页面不拆分
+    tallest = 0;
+    futures = processor.processBatchAsync({large, createGrayImage(16, 150)}, recordHeight,
+                                          MultithreadedProcessor::Normal, 1);
+    for (QFuture<MultithreadedProcessor::ProcessingResult> &future : futures) {
+        QVERIFY(future.result().success);
+    }
+    QCOMPARE(tallest, large.height());
+
+    // 默认不拆分
+    tallest = 0;
+    futures = processor.processBatchAsync({large, small}, recordHeight);
+    QVERIFY(futures[0].result().success);
+    QCOMPARE(tallest, large.height());
+    QVERIFY(processor.waitForAll(5000));
+}
+
+void TestMultithreadedProcessor::testPriorityOrder()
+{
+    MultithreadedProcessor processor;
+    startWorkers(processor, 1);
+    processor.pauseProcessing();
+
+    QMutex mutex;
+    QList<int> order;
+    auto recorder = [&](int tag) {
+        return [&, tag](const QImage &image) {
+            QMutexLocker locker(&mutex);
+            order.append(tag);
+            return image;
+        };
+    };
+
+    const QImage image = createGrayImage(4, 4);
+    processor.processImageAsync(image, recorder(MultithreadedProcessor::Low), MultithreadedProcessor::Low);
+    processor.processImageAsync(image, recorder(MultithreadedProcessor::High), MultithreadedProcessor::High);
+    processor.processImageAsync(image, recorder(MultithreadedProcessor::Critical), MultithreadedProcessor::Critical);
+    processor.processImageAsync(image, recorder(MultithreadedProcessor::Normal), MultithreadedProcessor::Normal);
+
+    processor.resumeProcessing();
+    QVERIFY(processor.waitForAll(5000));
+
+    const QList<int> expected = {MultithreadedProcessor::Critical, MultithreadedProcessor::High,
+                                 MultithreadedProcessor::Normal, MultithreadedProcessor::Low};
+    QCOMPARE(order, expected);
+}
+
+void TestMultithreadedProcessor::testClearQueueFailsPendingTasks()
+{
+    MultithreadedProcessor processor;
+    startWorkers(processor, 2);
+    processor.pauseProcessing();
+
+    const QImage image = createGrayImage(8, 8);
+    QList<QFuture<MultithreadedProcessor::ProcessingResult>> futures =
+        processor.processBatchAsync({image, QImage(), image, image}, verticalBlur);
+    QCOMPARE(futures.size(), 3);
+
+    processor.clearQueue();
+    QVERIFY(processor.waitForAll(1000));
+    for (QFuture<MultithreadedProcessor::ProcessingResult> &future : futures) {
+        const MultithreadedProcessor::ProcessingResult result = future.result();
+        QVERIFY(!result.success);
+        QCOMPARE(result.errorMessage, QString("任务被取消"));
+    }
+
+    // 清空后恢复，新任务照常执行
+    processor.resumeProcessing();
+    QVERIFY(processor.processImageAsync(image, verticalBlur).result().success);
+}
+
+void TestMultithreadedProcessor::testSubmitWithoutWorkersFails()
+{
+    MultithreadedProcessor processor;
+
+    const MultithreadedProcessor::ProcessingResult result =
+        processor.processImageAsync(createGrayImage(4, 4), verticalBlur).result();
+    QVERIFY(!result.success);
+    QCOMPARE(result.errorMessage, QString("线程池未运行"));
+    QVERIFY(processor.waitForAll(0));
+}
+
+QTEST_MAIN(TestMultithreadedProcessor)
+#include "test_multithreaded_processor.moc"
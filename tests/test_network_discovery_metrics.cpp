@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "network/network_complete_discovery.h"
+
+DSCANNER_USE_NAMESPACE
+
+class TestNetworkDiscoveryMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testLatencyPercentiles();
+    void testLatencySampleWindow();
+    void testTrafficAccumulates();
+    void testJsonExport();
+    void testPrometheusExport();
+    void testExportToDirectory();
+
+private:
+    static NetworkDiscoveryStatistics sampleStatistics();
+};
+
+NetworkDiscoveryStatistics TestNetworkDiscoveryMetrics::sampleStatistics()
+{
+    NetworkDiscoveryStatistics statistics;
+    statistics.discoveryRounds = 2;
+    statistics.totalDevicesFound = 3;
+    statistics.mdnsQueriesSent = 4;
+    statistics.mdnsDevicesFound = 3;
+
+    ProtocolDiscoveryMetrics &mdns = statistics.protocolMetrics[static_cast<int>(ProtocolType::MDNS)];
+    mdns.addLatency(50);
+    mdns.addLatency(20);
+    mdns.addLatency(80);
+    mdns.addTraffic(4, 1, 200, 1500);
+    mdns.duplicates = 1;
+    return statistics;
+}
+
+void TestNetworkDiscoveryMetrics::testLatencyPercentiles()
+{
+    ProtocolDiscoveryMetrics metrics;
+    QCOMPARE(metrics.latencyPercentile(0.5), qint64(-1));
+
+    // 乱序加入1..100，最近邻秩分位数与样本顺序无关
+    for (int i = 0; i < 100; ++i) {
+        metrics.addLatency((i * 37) % 100 + 1);
+    }
+    QCOMPARE(metrics.latencyPercentile(0.50), qint64(50));
+    QCOMPARE(metrics.latencyPercentile(0.95), qint64(95));
+    QCOMPARE(metrics.latencyPercentile(0.99), qint64(99));
+    QCOMPARE(metrics.latencyPercentile(0.0), qint64(1));
+    QCOMPARE(metrics.latencyPercentile(1.0), qint64(100));
+    QCOMPARE(metrics.latencyPercentile(2.0), qint64(100));
+}
+
+void TestNetworkDiscoveryMetrics::testLatencySampleWindow()
+{
+    const int extra = 10;
+    ProtocolDiscoveryMetrics metrics;
+    qint64 sum = 0;
+    for (int i = 0; i < ProtocolDiscoveryMetrics::kMaxLatencySamples + extra; ++i) {
+        metrics.addLatency(i + 5);
+        sum += i + 5;
+    }
+
+    // 分位数只看最近的样本，计数和总和覆盖全部响应
+    QCOMPARE(metrics.latencies.size(), ProtocolDiscoveryMetrics::kMaxLatencySamples);
+    QCOMPARE(metrics.latencies.first(), qint64(extra + 5));
+    QCOMPARE(metrics.latencyCount, qint64(ProtocolDiscoveryMetrics::kMaxLatencySamples + extra));
+    QCOMPARE(metrics.latencySum, sum);
+    QCOMPARE(metrics.timeToFirstDevice, qint64(5));
+}
+
+void TestNetworkDiscoveryMetrics::testTrafficAccumulates()
+{
+    ProtocolDiscoveryMetrics metrics;
+    metrics.addTraffic(16, 3, 1024, 4096);
+    metrics.addTraffic(4, 0, 256, 0);
+
+    QCOMPARE(metrics.probesSent, 20);
+    QCOMPARE(metrics.timeouts, 3);
+    QCOMPARE(metrics.bytesSent, qint64(1280));
+    QCOMPARE(metrics.bytesReceived, qint64(4096));
+}
+
+void TestNetworkDiscoveryMetrics::testJsonExport()
+{
+    const QJsonObject json = sampleStatistics().toJson();
+    QCOMPARE(json.value(QStringLiteral("discoveryRounds")).toInt(), 2);
+    QCOMPARE(json.value(QStringLiteral("totalDevicesFound")).toInt(), 3);
+
+    const QJsonObject protocols = json.value(QStringLiteral("protocols")).toObject();
+    const QJsonObject mdns = protocols.value(QStringLiteral("mdns")).toObject();
+    QCOMPARE(mdns.value(QStringLiteral("queries")).toInt(), 4);
+    QCOMPARE(mdns.value(QStringLiteral("devicesFound")).toInt(), 3);
+    QCOMPARE(mdns.value(QStringLiteral("duplicates")).toInt(), 1);
+    QCOMPARE(mdns.value(QStringLiteral("probesSent")).toInt(), 4);
+    QCOMPARE(mdns.value(QStringLiteral("timeouts")).toInt(), 1);
+    QCOMPARE(mdns.value(QStringLiteral("bytesReceived")).toInt(), 1500);
+    QCOMPARE(mdns.value(QStringLiteral("timeToFirstDeviceMs")).toInt(), 50);
+
+    const QJsonObject latency = mdns.value(QStringLiteral("latencyMs")).toObject();
+    QCOMPARE(latency.value(QStringLiteral("count")).toInt(), 3);
+    QCOMPARE(latency.value(QStringLiteral("sum")).toInt(), 150);
+    QCOMPARE(latency.value(QStringLiteral("p50")).toInt(), 50);
+    QCOMPARE(latency.value(QStringLiteral("p99")).toInt(), 80);
+
+    // 没有响应的协议不报告延迟
+    const QJsonObject wsd = protocols.value(QStringLiteral("wsd")).toObject();
+    QVERIFY(wsd.value(QStringLiteral("timeToFirstDeviceMs")).isNull());
+    QVERIFY(wsd.value(QStringLiteral("latencyMs")).toObject().value(QStringLiteral("p50")).isNull());
+    QCOMPARE(protocols.size(), 6);
+}
+
+void TestNetworkDiscoveryMetrics::testPrometheusExport()
+{
+    const QList<QByteArray> lines = sampleStatistics().toPrometheusText().split('\n');
+
+    QVERIFY(lines.contains("# TYPE deepinscan_network_discovery_rounds_total counter"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_rounds_total 2"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_queries_total{protocol=\"mdns\"} 4"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_timeouts_total{protocol=\"mdns\"} 1"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_time_to_first_device_seconds{protocol=\"mdns\"} 0.05"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_time_to_first_device_seconds{protocol=\"wsd\"} NaN"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_response_latency_seconds{protocol=\"mdns\",quantile=\"0.5\"} 0.05"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_response_latency_seconds{protocol=\"mdns\",quantile=\"0.99\"} 0.08"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_response_latency_seconds_sum{protocol=\"mdns\"} 0.15"));
+    QVERIFY(lines.contains("deepinscan_network_discovery_response_latency_seconds_count{protocol=\"mdns\"} 3"));
+}
+
+void TestNetworkDiscoveryMetrics::testExportToDirectory()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+
+    // 导出目录不存在时逐级创建
+    const NetworkDiscoveryStatistics statistics = sampleStatistics();
+    const QString directory = root.filePath(QStringLiteral("metrics/discovery"));
+    QVERIFY(statistics.exportTo(directory));
+
+    QFile json(directory + QStringLiteral("/network-discovery.json"));
+    QVERIFY(json.open(QIODevice::ReadOnly));
+    QCOMPARE(QJsonDocument::fromJson(json.readAll()).object(), statistics.toJson());
+
+    QFile text(directory + QStringLiteral("/network-discovery.prom"));
+    QVERIFY(text.open(QIODevice::ReadOnly));
+    QCOMPARE(text.readAll(), statistics.toPrometheusText());
+
+    // 目标路径被普通文件占用时报告失败
+    QFile blocker(root.filePath(QStringLiteral("blocked")));
+    QVERIFY(blocker.open(QIODevice::WriteOnly));
+    blocker.close();
+    QVERIFY(!statistics.exportTo(blocker.fileName()));
+}
+
+QTEST_MAIN(TestNetworkDiscoveryMetrics)
+#include "test_network_discovery_metrics.moc"
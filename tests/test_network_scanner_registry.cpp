@@ -0,0 +1,256 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "network/network_scanner_registry.h"
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+NetworkScannerDevice makeDevice(const QString &address, const QString &uuid = QString())
+{
+    NetworkScannerDevice device;
+    device.uuid = uuid;
+    device.makeAndModel = QStringLiteral("Canon MF643C");
+    device.deviceType = QStringLiteral("Scanner");
+    device.protocol = QStringLiteral("mDNS");
+    device.discoveryMethod = QStringLiteral("mDNS");
+    device.addresses << address;
+    device.baseUrl = QUrl(QStringLiteral("http://%1/eSCL").arg(address));
+    return device;
+}
+
+} // namespace
+
+class TestNetworkScannerRegistry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void testPersistenceRoundTrip();
+    void testExpiredEntriesDropped();
+    void testDropAfterRepeatedFailures();
+    void testKeyStableAcrossAddressChange();
+    void testHostEntryAdoptsIdentity();
+
+private:
+    QString registryPath() const { return m_dir->filePath(QStringLiteral("cache/network-scanners.json")); }
+
+    QScopedPointer<QTemporaryDir> m_dir;
+};
+
+void TestNetworkScannerRegistry::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+}
+
+void TestNetworkScannerRegistry::testPersistenceRoundTrip()
+{
+    NetworkScannerDevice printer = makeDevice(QStringLiteral("192.168.1.20"));
+    printer.serialNumber = QStringLiteral("XJ1234");
+    printer.capabilities.insert(QStringLiteral("eSCL"), true);
+    const NetworkScannerDevice scanner = makeDevice(QStringLiteral("192.168.1.30"));
+
+    {
+        NetworkScannerRegistry registry(registryPath());
+        QCOMPARE(registry.filePath(), registryPath());
+        // 文件尚不存在
+        QVERIFY(!registry.load());
+        QVERIFY(registry.isEmpty());
+
+        registry.update(printer);
+        registry.update(scanner);
+        QVERIFY(!registry.markFailed(NetworkScannerRegistry::keyFor(scanner)));
+        // 目录不存在时自动创建
+        QVERIFY(registry.save());
+    }
+    QVERIFY(QFile::exists(registryPath()));
+
+    NetworkScannerRegistry restored(registryPath());
+    QVERIFY(restored.load());
+    QCOMPARE(restored.size(), 2);
+
+    const NetworkScannerDevice loaded = restored.device(NetworkScannerRegistry::keyFor(printer));
+    QCOMPARE(loaded.makeAndModel, printer.makeAndModel);
+    QCOMPARE(loaded.serialNumber, printer.serialNumber);
+    QCOMPARE(loaded.addresses, printer.addresses);
+    QCOMPARE(loaded.baseUrl, printer.baseUrl);
+    QCOMPARE(loaded.capabilities.value(QStringLiteral("eSCL")).toBool(), true);
+    QVERIFY(loaded.lastSeen.isValid());
+
+    // 复核失败次数也被保存，再失败两次即淘汰
+    const QString scannerKey = NetworkScannerRegistry::keyFor(scanner);
+    QVERIFY(!restored.markFailed(scannerKey));
+    QVERIFY(restored.markFailed(scannerKey));
+    QVERIFY(!restored.contains(scannerKey));
+
+    // 版本不符的文件整体忽略
+    QFile file(registryPath());
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("{\"version\":999,\"devices\":[]}");
+    file.close();
+    QVERIFY(!restored.load());
+    QVERIFY(restored.isEmpty());
+}
+
+void TestNetworkScannerRegistry::testExpiredEntriesDropped()
+{
+    const NetworkScannerDevice fresh = makeDevice(QStringLiteral("192.168.1.20"));
+    const NetworkScannerDevice stale = makeDevice(QStringLiteral("192.168.1.30"));
+    {
+        NetworkScannerRegistry registry(registryPath());
+        QCOMPARE(registry.maxAge(), qint64(7 * 24 * 60 * 60));
+        registry.update(fresh);
+        registry.update(stale);
+        QVERIFY(registry.save());
+    }
+
+    // 一条6天前、一条8天前确认在线
+    QFile file(registryPath());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+    QJsonArray devices = root.value(QStringLiteral("devices")).toArray();
+    QCOMPARE(devices.size(), 2);
+    for (int i = 0; i < devices.size(); ++i) {
+        QJsonObject object = devices.at(i).toObject();
+        const bool isStale = object.value(QStringLiteral("addresses")).toArray().first().toString()
+                             == stale.addresses.first();
+        const QDateTime lastSeen = QDateTime::currentDateTimeUtc().addDays(isStale ? -8 : -6);
+        object[QStringLiteral("lastSeen")] = lastSeen.toString(Qt::ISODate);
+        devices.replace(i, object);
+    }
+    root[QStringLiteral("devices")] = devices;
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+
+    NetworkScannerRegistry registry(registryPath());
+    QVERIFY(registry.load());
+    QCOMPARE(registry.size(), 1);
+    QVERIFY(registry.contains(NetworkScannerRegistry::keyFor(fresh)));
+    QVERIFY(!registry.contains(NetworkScannerRegistry::keyFor(stale)));
+
+    // 淘汰的条目在下次保存时从文件中删除
+    QVERIFY(registry.save());
+    NetworkScannerRegistry reloaded(registryPath());
+    reloaded.setMaxAge(30 * 24 * 60 * 60);
+    QVERIFY(reloaded.load());
+    QCOMPARE(reloaded.size(), 1);
+
+    // 保留时间可调
+    NetworkScannerRegistry strict(registryPath());
+    strict.setMaxAge(5 * 24 * 60 * 60);
+    QVERIFY(strict.load());
+    QVERIFY(strict.isEmpty());
+}
+
+void TestNetworkScannerRegistry::testDropAfterRepeatedFailures()
+{
+    NetworkScannerRegistry registry(registryPath());
+    QCOMPARE(registry.maxFailures(), 3);
+
+    const NetworkScannerDevice device = makeDevice(QStringLiteral("192.168.1.20"));
+    const QString key = NetworkScannerRegistry::keyFor(device);
+    registry.update(device);
+
+    QVERIFY(!registry.markFailed(key));
+    QVERIFY(!registry.markFailed(key));
+    // 复核成功清零失败计数
+    registry.markSeen(key);
+    QVERIFY(!registry.markFailed(key));
+    QVERIFY(!registry.markFailed(key));
+    QVERIFY(registry.contains(key));
+
+    // 连续第三次失败时淘汰
+    QVERIFY(registry.markFailed(key));
+    QVERIFY(!registry.contains(key));
+    QVERIFY(!registry.markFailed(key));
+
+    // 重新发现同样清零失败计数
+    registry.update(device);
+    QVERIFY(!registry.markFailed(key));
+    QVERIFY(!registry.markFailed(key));
+    registry.update(device);
+    QVERIFY(!registry.markFailed(key));
+
+    registry.setMaxFailures(0);
+    QCOMPARE(registry.maxFailures(), 1);
+    QVERIFY(registry.markFailed(key));
+}
+
+void TestNetworkScannerRegistry::testKeyStableAcrossAddressChange()
+{
+    // 序列号
+    NetworkScannerDevice before = makeDevice(QStringLiteral("192.168.1.20"), QStringLiteral("{11111111-0000-4000-8000-000000000000}"));
+    before.serialNumber = QStringLiteral("XJ1234");
+    NetworkScannerDevice after = makeDevice(QStringLiteral("192.168.1.45"), QStringLiteral("{22222222-0000-4000-8000-000000000000}"));
+    after.serialNumber = before.serialNumber;
+    QCOMPARE(NetworkScannerRegistry::keyFor(after), NetworkScannerRegistry::keyFor(before));
+
+    NetworkScannerRegistry registry(registryPath());
+    registry.update(before);
+    registry.update(after);
+    QCOMPARE(registry.size(), 1);
+
+    // 保留首次登记的uuid，地址改用新地址
+    const NetworkScannerDevice known = registry.device(NetworkScannerRegistry::keyFor(before));
+    QCOMPARE(known.uuid, before.uuid);
+    QCOMPARE(known.addresses, after.addresses);
+    QCOMPARE(known.baseUrl, after.baseUrl);
+    QCOMPARE(NetworkScannerRegistry::hostFor(known), QStringLiteral("192.168.1.45"));
+
+    // SSDP的USN与WSD的端点地址
+    const NetworkScannerDevice ssdp = makeDevice(QStringLiteral("192.168.1.20"),
+        QStringLiteral("uuid:4D696E69-0000-0000-0000-000000000001::urn:schemas-upnp-org:device:Scanner:1"));
+    const NetworkScannerDevice wsd = makeDevice(QStringLiteral("http://192.168.1.45:80/wsd"),
+        QStringLiteral("urn:uuid:4d696e69-0000-0000-0000-000000000001"));
+    QCOMPARE(NetworkScannerRegistry::keyFor(ssdp), QStringLiteral("uuid:4d696e69-0000-0000-0000-000000000001"));
+    QCOMPARE(NetworkScannerRegistry::keyFor(wsd), NetworkScannerRegistry::keyFor(ssdp));
+    QCOMPARE(NetworkScannerRegistry::hostFor(wsd), QStringLiteral("192.168.1.45"));
+
+    // 发现时随机生成的uuid不能作为键，退回主机地址
+    const NetworkScannerDevice anonymous = makeDevice(QStringLiteral("192.168.1.20"), QStringLiteral("{33333333-0000-4000-8000-000000000000}"));
+    QCOMPARE(NetworkScannerRegistry::keyFor(anonymous), QStringLiteral("192.168.1.20"));
+}
+
+void TestNetworkScannerRegistry::testHostEntryAdoptsIdentity()
+{
+    NetworkScannerRegistry registry(registryPath());
+
+    // 先经mDNS以主机地址登记
+    NetworkScannerDevice mdns = makeDevice(QStringLiteral("192.168.1.20"));
+    mdns.makeAndModel.clear();
+    registry.update(mdns);
+    QVERIFY(registry.contains(QStringLiteral("192.168.1.20")));
+
+    // 同一主机经SSDP报告了身份标识，条目改用身份标识为键
+    NetworkScannerDevice ssdp = makeDevice(QStringLiteral("192.168.1.20"), QStringLiteral("uuid:abcd"));
+    ssdp.protocol = QStringLiteral("UPnP");
+    registry.update(ssdp);
+    QCOMPARE(registry.size(), 1);
+    QVERIFY(registry.contains(QStringLiteral("uuid:abcd")));
+    QVERIFY(!registry.contains(QStringLiteral("192.168.1.20")));
+    QCOMPARE(registry.device(QStringLiteral("uuid:abcd")).makeAndModel, ssdp.makeAndModel);
+
+    // 之后没有身份标识的结果并入同一条目
+    registry.update(mdns);
+    QCOMPARE(registry.size(), 1);
+
+    // 同一地址上另一台自报身份的设备单独登记
+    registry.update(makeDevice(QStringLiteral("192.168.1.20"), QStringLiteral("uuid:ef01")));
+    QCOMPARE(registry.size(), 2);
+}
+
+QTEST_MAIN(TestNetworkScannerRegistry)
+#include "test_network_scanner_registry.moc"
@@ -0,0 +1,421 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QObject>
+#include <QGenericMatrix>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "advanced_image_processor.h"
+
+DSCANNER_BEGIN_NAMESPACE
+
+namespace {
+
+ImageBuffer createTestImage(int width, int height, PixelFormat format)
+{
+    ImageBuffer buffer(width, height, format);
+    const int channels = buffer.bytesPerPixel();
+    for (int y = 0; y < height; ++y) {
+        quint8 *line = buffer.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                line[x * channels + c] = static_cast<quint8>((x * 255 / width + y * 37 + c * 71 + (x * y) % 13) & 0xFF);
+            }
+        }
+    }
+    return buffer;
+}
+
+// 逐行比较，不受布局和行跨度影响
+bool sameImage(const ImageBuffer &a, const ImageBuffer &b)
+{
+    if (a.width() != b.width() || a.height() != b.height() || a.format() != b.format()) {
+        return false;
+    }
+    const ImageBuffer left = a.toInterleaved();
+    const ImageBuffer right = b.toInterleaved();
+    const int rowBytes = left.width() * left.bytesPerPixel();
+    for (int y = 0; y < left.height(); ++y) {
+        if (!std::equal(left.constScanLine(y), left.constScanLine(y) + rowBytes, right.constScanLine(y))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+class TestProcessingNodes : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testColorCorrectionFusedKernel();
+    void testNoiseReductionMedianMatchesSort();
+    void testNoiseReductionBilateralGridMode();
+    void testNoiseReductionNonLocalAndWavelet();
+    void testPixelShiftChannelShifts();
+    void testPixelShiftReusesCorrector();
+    void testShadingCorrection();
+};
+
+void TestProcessingNodes::testColorCorrectionFusedKernel()
+{
+    ImageBuffer input = createTestImage(97, 13, PixelFormat::Format3);
+
+    ColorCorrectionNode node;
+    node.setGamma(1.8);
+    node.setBrightness(10);
+    node.setContrast(120);
+
+    // 单位矩阵时融合内核退化为查表，应与逐步实现一致
+    ImageBuffer fused;
+    ImageBuffer reference;
+    QVERIFY(node.process(input, fused));
+    node.enableFusedKernel(false);
+    QVERIFY(node.process(input, reference));
+    QVERIFY(sameImage(fused, reference));
+
+    // 通道混合矩阵：SIMD 与标量定点路径逐字节一致
+    QMatrix3x3 matrix;
+    matrix(0, 0) = 0.8;  matrix(0, 1) = 0.3;  matrix(0, 2) = -0.1;
+    matrix(1, 0) = -0.2; matrix(1, 1) = 1.1;  matrix(1, 2) = 0.1;
+    matrix(2, 0) = 0.05; matrix(2, 1) = -0.3; matrix(2, 2) = 1.25;
+    node.setColorMatrix(matrix);
+    node.setSaturation(140);
+    node.enableFusedKernel(true);
+
+    ImageBuffer simd;
+    ImageBuffer scalar;
+    node.enableSIMDProcessing(true);
+    QVERIFY(node.process(input, simd));
+    node.enableSIMDProcessing(false);
+    QVERIFY(node.process(input, scalar));
+    QVERIFY(sameImage(simd, scalar));
+
+    // RGBA 保持Alpha通道
+    ImageBuffer rgba(5, 2, PixelFormat::Format4);
+    for (int y = 0; y < rgba.height(); ++y) {
+        for (int x = 0; x < rgba.width() * 4; ++x) {
+            rgba.scanLine(y)[x] = static_cast<quint8>(x * 17 + y);
+        }
+    }
+    ImageBuffer rgbaOut;
+    QVERIFY(node.process(rgba, rgbaOut));
+    QCOMPARE(rgbaOut.format(), PixelFormat::Format4);
+    QCOMPARE(rgbaOut.constScanLine(1)[7], rgba.constScanLine(1)[7]);
+}
+
+void TestProcessingNodes::testNoiseReductionMedianMatchesSort()
+{
+    ImageBuffer input(41, 23, PixelFormat::Format3);
+    for (int y = 0; y < input.height(); ++y) {
+        for (int x = 0; x < input.width() * 3; ++x) {
+            input.scanLine(y)[x] = static_cast<quint8>((x * 131 + y * 71 + (x * y) % 17) & 0xFF);
+        }
+    }
+
+    // 强度0.2为3×3排序网络，强度1.0为9×9直方图算法
+    for (double strength : {0.2, 0.4, 1.0}) {
+        NoiseReductionNode node;
+        node.setNoiseReductionType(NoiseReductionNode::NoiseReductionType::MedianFilter);
+        node.setStrength(strength);
+        const int radius = static_cast<int>(strength * 3) + 1;
+    
+        ImageBuffer output;
+        QVERIFY(node.process(input, output));
+    
+        for (int y = 0; y < input.height(); ++y) {
+            for (int x = 0; x < input.width(); ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    std::vector<quint8> window;
+                    for (int dy = -radius; dy <= radius; ++dy) {
+                        for (int dx = -radius; dx <= radius; ++dx) {
+                            int nx = qBound(0, x + dx, input.width() - 1);
+                            int ny = qBound(0, y + dy, input.height() - 1);
+                            window.push_back(input.constScanLine(ny)[nx * 3 + c]);
+                        }
+                    }
+                    std::nth_element(window.begin(), window.begin() + window.size() / 2, window.end());
+                    QCOMPARE(output.constScanLine(y)[x * 3 + c], window[window.size() / 2]);
+                }
+            }
+        }
+    }
+}
+
+void TestProcessingNodes::testNoiseReductionBilateralGridMode()
+{
+    // 左右两半为不同灰度的阶跃边缘，叠加小幅纹理
+    ImageBuffer input(64, 48, PixelFormat::Format1);
+    for (int y = 0; y < input.height(); ++y) {
+        for (int x = 0; x < input.width(); ++x) {
+            input.scanLine(y)[x] = static_cast<quint8>((x < 32 ? 60 : 190) + ((x * 7 + y * 13) % 9) - 4);
+        }
+    }
+
+    NoiseReductionNode exactNode;
+    exactNode.setNoiseReductionType(NoiseReductionNode::NoiseReductionType::Bilateral);
+    exactNode.setStrength(0.5);
+    ImageBuffer exact;
+    QVERIFY(exactNode.process(input, exact));
+
+    NoiseReductionNode gridNode;
+    gridNode.setNoiseReductionType(NoiseReductionNode::NoiseReductionType::Bilateral);
+    gridNode.setStrength(0.5);
+    gridNode.setApproximateBilateral(true);
+    ImageBuffer grid;
+    QVERIFY(gridNode.process(input, grid));
+
+    double totalDiff = 0.0;
+    for (int y = 0; y < input.height(); ++y) {
+        for (int x = 0; x < input.width(); ++x) {
+            const int e = exact.constScanLine(y)[x];
+            const int g = grid.constScanLine(y)[x];
+            totalDiff += qAbs(e - g);
+        
+            // 两种模式都不应跨越边缘混合
+            QVERIFY(qAbs(e - input.constScanLine(y)[x]) <= 8);
+            QVERIFY(qAbs(g - input.constScanLine(y)[x]) <= 12);
+        }
+    }
+    QVERIFY(totalDiff / (input.width() * input.height()) < 3.0);
+}
+
+void TestProcessingNodes::testNoiseReductionNonLocalAndWavelet()
+{
+    // 阶跃边缘叠加伪随机噪声（幅度约±12）
+    ImageBuffer input(48, 40, PixelFormat::Format1);
+    quint32 seed = 12345;
+    for (int y = 0; y < input.height(); ++y) {
+        for (int x = 0; x < input.width(); ++x) {
+            seed = seed * 1103515245u + 12345u;
+            const int noise = static_cast<int>((seed >> 16) % 25) - 12;
+            input.scanLine(y)[x] = static_cast<quint8>((x < 24 ? 70 : 180) + noise);
+        }
+    }
+
+    // 远离边缘的平坦区域标准差
+    auto flatDeviation = [](const ImageBuffer &image) {
+        double sum = 0.0;
+        double sumSq = 0.0;
+        int count = 0;
+        for (int y = 4; y < image.height() - 4; ++y) {
+            for (int x = 2; x < 18; ++x) {
+                const double v = image.constScanLine(y)[x];
+                sum += v;
+                sumSq += v * v;
+                ++count;
+            }
+        }
+        const double mean = sum / count;
+        return std::sqrt(sumSq / count - mean * mean);
+    };
+    const double inputDeviation = flatDeviation(input);
+
+    for (auto type : {NoiseReductionNode::NoiseReductionType::NonLocal,
+                      NoiseReductionNode::NoiseReductionType::Wavelet}) {
+        for (bool fast : {false, true}) {
+            NoiseReductionNode node;
+            node.setNoiseReductionType(type);
+            node.setStrength(0.6);
+            node.setFastNonLocalMeans(fast);
+        
+            ImageBuffer output;
+            QVERIFY(node.process(input, output));
+            QCOMPARE(output.format(), PixelFormat::Format1);
+            QVERIFY(flatDeviation(output) < inputDeviation * 0.5);
+        
+            // 边缘两侧均值保持
+            for (int y = 4; y < input.height() - 4; ++y) {
+                QVERIFY(qAbs(output.constScanLine(y)[20] - 70) <= 15);
+                QVERIFY(qAbs(output.constScanLine(y)[28] - 180) <= 15);
+            }
+        }
+    }
+}
+
+void TestProcessingNodes::testPixelShiftChannelShifts()
+{
+    // 每列取值不同、每行取值不同，便于定位源样本
+    ImageBuffer input(16, 12, PixelFormat::Format3);
+    for (int y = 0; y < input.height(); ++y) {
+        quint8 *line = input.scanLine(y);
+        for (int x = 0; x < input.width(); ++x) {
+            line[x * 3 + 0] = static_cast<quint8>(10 + y * 10);
+            line[x * 3 + 1] = static_cast<quint8>(10 + y * 10);
+            line[x * 3 + 2] = static_cast<quint8>(10 + x * 10);
+        }
+    }
+
+    // R下移1行、G上移2行、B右移0.5列
+    PixelShiftNode node;
+    node.setChannelShifts({{0.0, 1.0}, {0.0, -2.0}, {0.5, 0.0}});
+
+    ImageBuffer output;
+    QVERIFY(node.process(input, output));
+    QCOMPARE(output.width(), input.width());
+    QCOMPARE(output.height(), input.height());
+
+    for (int y = 0; y < output.height(); ++y) {
+        const quint8 *line = output.constScanLine(y);
+        for (int x = 0; x < output.width(); ++x) {
+            const int expectedR = y >= 1 ? 10 + (y - 1) * 10 : 0;
+            const int expectedG = y + 2 < input.height() ? 10 + (y + 2) * 10 : 0;
+            // 源列 x - 0.5，左边界外的样本为0
+            const int expectedB = x >= 1 ? 10 * x + 5 : 5;
+            QCOMPARE(static_cast<int>(line[x * 3 + 0]), expectedR);
+            QCOMPARE(static_cast<int>(line[x * 3 + 1]), expectedG);
+            QVERIFY(qAbs(line[x * 3 + 2] - expectedB) <= 1);
+        }
+    }
+
+    // 16位数据同样逐通道移位
+    ImageBuffer wide(8, 6, PixelFormat::Gray16);
+    for (int y = 0; y < wide.height(); ++y) {
+        quint16 *line = reinterpret_cast<quint16 *>(wide.scanLine(y));
+        for (int x = 0; x < wide.width(); ++x) {
+            line[x] = static_cast<quint16>(1000 * (y + 1));
+        }
+    }
+    PixelShiftNode wideNode;
+    wideNode.setSubPixelShift(0.0, 0.5);
+    ImageBuffer wideOutput;
+    QVERIFY(wideNode.process(wide, wideOutput));
+    QCOMPARE(reinterpret_cast<const quint16 *>(wideOutput.constScanLine(0))[3], quint16(500));
+    QCOMPARE(reinterpret_cast<const quint16 *>(wideOutput.constScanLine(3))[3], quint16(3500));
+}
+
+void TestProcessingNodes::testPixelShiftReusesCorrector()
+{
+    const QVector<LineShiftCorrector::ChannelShift> shifts = {{0.0, 1.5}, {-0.5, -2.0}, {1.0, 0.0}};
+    auto freshOutput = [](const ImageBuffer &input, const QVector<LineShiftCorrector::ChannelShift> &channelShifts) {
+        PixelShiftNode node;
+        node.setChannelShifts(channelShifts);
+        ImageBuffer output;
+        node.process(input, output);
+        return output;
+    };
+
+    PixelShiftNode node;
+    node.setChannelShifts(shifts);
+
+    // 同一节点连续处理多帧，结果与新建节点一致，不残留上一帧的行
+    const ImageBuffer first = createTestImage(24, 16, PixelFormat::Format3);
+    ImageBuffer second(24, 16, PixelFormat::Format3);
+    std::fill(second.data(), second.data() + second.totalBytes(), quint8(200));
+    const QList<const ImageBuffer *> frames = {&first, &second, &first};
+    for (const ImageBuffer *input : frames) {
+        ImageBuffer output;
+        QVERIFY(node.process(*input, output));
+        QVERIFY(sameImage(output, freshOutput(*input, shifts)));
+    }
+
+    // 帧尺寸变化
+    const ImageBuffer narrow = createTestImage(9, 20, PixelFormat::Format3);
+    ImageBuffer output;
+    QVERIFY(node.process(narrow, output));
+    QVERIFY(sameImage(output, freshOutput(narrow, shifts)));
+
+    // 参数变化后的下一帧使用新参数
+    const QVector<LineShiftCorrector::ChannelShift> changed = {{2.0, -1.0}, {0.0, 0.0}, {0.0, 3.0}};
+    node.setChannelShifts(changed);
+    QVERIFY(node.process(narrow, output));
+    QVERIFY(sameImage(output, freshOutput(narrow, changed)));
+    QVERIFY(!sameImage(output, freshOutput(narrow, shifts)));
+
+    node.setSubPixelShift(0.0, 0.5);
+    QVERIFY(node.process(narrow, output));
+    PixelShiftNode subPixel;
+    subPixel.setChannelShifts(changed);
+    subPixel.setSubPixelShift(0.0, 0.5);
+    ImageBuffer expected;
+    QVERIFY(subPixel.process(narrow, expected));
+    QVERIFY(sameImage(output, expected));
+}
+
+void TestProcessingNodes::testShadingCorrection()
+{
+    // 每列暗电平 10+x、白电平 200+x（16位小端，按8位量程×257）
+    const int width = 8;
+    const int channels = 3;
+    QByteArray black(width * channels * 2, '\0');
+    QByteArray white(width * channels * 2, '\0');
+    for (int x = 0; x < width; ++x) {
+        for (int c = 0; c < channels; ++c) {
+            qToLittleEndian<quint16>(static_cast<quint16>((10 + x) * 257),
+                                     reinterpret_cast<uchar *>(black.data()) + (x * channels + c) * 2);
+            qToLittleEndian<quint16>(static_cast<quint16>((200 + x) * 257),
+                                     reinterpret_cast<uchar *>(white.data()) + (x * channels + c) * 2);
+        }
+    }
+
+    ShadingCorrectionNode node;
+    QVERIFY(node.setReference(black, white, width, channels));
+    QVERIFY(!node.setReference(black, white, width + 1, channels));
+    QVERIFY(node.setReference(black, white, width, channels));
+
+    // 第0行为暗电平，第1行为白电平，第2行为两者中点
+    ImageBuffer input(width, 3, PixelFormat::Format3);
+    for (int x = 0; x < width; ++x) {
+        for (int c = 0; c < channels; ++c) {
+            input.scanLine(0)[x * 3 + c] = static_cast<quint8>(10 + x);
+            input.scanLine(1)[x * 3 + c] = static_cast<quint8>(200 + x);
+            input.scanLine(2)[x * 3 + c] = static_cast<quint8>(105 + x);
+        }
+    }
+
+    ImageBuffer output;
+    QVERIFY(node.process(input, output));
+    for (int i = 0; i < width * channels; ++i) {
+        QCOMPARE(static_cast<int>(output.constScanLine(0)[i]), 0);
+        QVERIFY(output.constScanLine(1)[i] >= 254);
+        QVERIFY(qAbs(output.constScanLine(2)[i] - 128) <= 1);
+    }
+
+    // 不按行对齐的分块原地校正与逐行结果一致
+    QByteArray stream(reinterpret_cast<const char *>(input.constData()), input.totalBytes());
+    const ShadingCorrector &corrector = node.corrector();
+    qint64 position = 0;
+    for (int chunk : {5, 1, 31, 35}) {
+        quint8 *data = reinterpret_cast<quint8 *>(stream.data()) + position;
+        corrector.apply8(data, data, position, chunk);
+        position += chunk;
+    }
+    QCOMPARE(position, static_cast<qint64>(input.totalBytes()));
+    QVERIFY(std::memcmp(stream.constData(), output.constData(), output.totalBytes()) == 0);
+
+    // 8位参考同样可用，16位数据按16位量程校正
+    ShadingCorrectionNode grayNode;
+    QVERIFY(grayNode.setReference(QByteArray(width, char(10)), QByteArray(width, char(200)), width, 1));
+    ImageBuffer wide(width, 2, PixelFormat::Gray16);
+    for (int x = 0; x < width; ++x) {
+        reinterpret_cast<quint16 *>(wide.scanLine(0))[x] = 200 * 257;
+        reinterpret_cast<quint16 *>(wide.scanLine(1))[x] = 105 * 257;
+    }
+    ImageBuffer wideOutput;
+    QVERIFY(grayNode.process(wide, wideOutput));
+    for (int x = 0; x < width; ++x) {
+        QVERIFY(reinterpret_cast<const quint16 *>(wideOutput.constScanLine(0))[x] >= 65500);
+        QVERIFY(qAbs(reinterpret_cast<const quint16 *>(wideOutput.constScanLine(1))[x] - 32768) <= 16);
+    }
+
+    // 参考与输入宽度不符时原样输出
+    ImageBuffer other(width + 2, 1, PixelFormat::Format3);
+    std::fill_n(other.scanLine(0), other.bytesPerLine(), quint8(77));
+    ImageBuffer otherOutput;
+    QVERIFY(node.process(other, otherOutput));
+    QCOMPARE(static_cast<int>(otherOutput.constScanLine(0)[0]), 77);
+}
+
+DSCANNER_END_NAMESPACE
+
+QTEST_MAIN(Dtk::Scanner::TestProcessingNodes)
+#include "test_processing_nodes.moc"
@@ -0,0 +1,417 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QObject>
+#include <QImage>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "advanced_image_processor.h"
+
+DSCANNER_BEGIN_NAMESPACE
+
+namespace {
+
+// 以平面布局输出的直通节点，检验管道对平面条带的处理
+class PlanarPassNode : public ImageProcessingNode
+{
+public:
+    PlanarPassNode() : ImageProcessingNode(ProcessingNodeType::Calibrate) {}
+
+    bool process(const ImageBuffer &input, ImageBuffer &output) override
+    {
+        output = input.toPlanar();
+        return true;
+    }
+
+    bool supportsPlanar() const override { return true; }
+};
+
+ImageBuffer createTestImage(int width, int height, PixelFormat format)
+{
+    ImageBuffer buffer(width, height, format);
+    const int channels = buffer.bytesPerPixel();
+    for (int y = 0; y < height; ++y) {
+        quint8 *line = buffer.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                line[x * channels + c] = static_cast<quint8>((x * 255 / width + y * 37 + c * 71 + (x * y) % 13) & 0xFF);
+            }
+        }
+    }
+    return buffer;
+}
+
+// 逐行比较，不受布局和行跨度影响
+bool sameImage(const ImageBuffer &a, const ImageBuffer &b)
+{
+    if (a.width() != b.width() || a.height() != b.height() || a.format() != b.format()) {
+        return false;
+    }
+    const ImageBuffer left = a.toInterleaved();
+    const ImageBuffer right = b.toInterleaved();
+    const int rowBytes = left.width() * left.bytesPerPixel();
+    for (int y = 0; y < left.height(); ++y) {
+        if (!std::equal(left.constScanLine(y), left.constScanLine(y) + rowBytes, right.constScanLine(y))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+class TestProcessingPipeline : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testImageBufferZeroCopyViews();
+    void testOutputDetachedFromViews();
+    void testStreamingMatchesFrame();
+    void testStreamingPlanarStrips();
+    void testNoiseReductionStreamingMatchesFrame_data();
+    void testNoiseReductionStreamingMatchesFrame();
+    void testBatchSIMDMatchesSingleImages();
+    void testImageBufferPlanarLayout();
+
+private:
+    bool runStreaming(AdvancedImageProcessor &processor, int stripHeight, ImageBuffer &result);
+};
+
+bool TestProcessingPipeline::runStreaming(AdvancedImageProcessor &processor, int stripHeight, ImageBuffer &result)
+{
+    processor.setStripHeight(stripHeight);
+
+    int nextRow = 0;
+    const bool success = processor.processStreaming([&](int firstRow, const ImageBuffer &strip) {
+        if (firstRow != nextRow || strip.isPlanar()) {
+            return false;
+        }
+        for (int y = 0; y < strip.height(); ++y) {
+            std::copy_n(strip.constScanLine(y), strip.width() * strip.bytesPerPixel(), result.scanLine(firstRow + y));
+        }
+        nextRow += strip.height();
+        return true;
+    });
+    return success && nextRow == result.height();
+}
+
+void TestProcessingPipeline::testImageBufferZeroCopyViews()
+{
+    // 包装外部内存，owner 保证视图存活期间内存有效
+    const int width = 8;
+    const int height = 6;
+    std::shared_ptr<quint8> block(new quint8[width * height * 3], std::default_delete<quint8[]>());
+    for (int i = 0; i < width * height * 3; ++i) {
+        block.get()[i] = static_cast<quint8>(i);
+    }
+    
+    ImageBuffer wrapped = ImageBuffer::wrap(block.get(), width, height, PixelFormat::Format3, block);
+    QCOMPARE(wrapped.constData(), block.get());
+    QCOMPARE(block.use_count(), 2L);
+    QVERIFY(!wrapped.isDetached());
+    
+    // 行视图指向原内存偏移
+    ImageBuffer rows = wrapped.rowsView(2, 3);
+    QCOMPARE(rows.height(), 3);
+    QCOMPARE(rows.constScanLine(0), wrapped.constScanLine(2));
+    QVERIFY(rows.sharesDataWith(wrapped));
+    QVERIFY(wrapped.rowsView(4, 3).constData() == nullptr);
+    
+    // 拷贝为深拷贝，移动转移所有权
+    ImageBuffer deep = wrapped.copy();
+    QVERIFY(!deep.sharesDataWith(wrapped));
+    QVERIFY(deep.isDetached());
+    ImageBuffer moved = std::move(deep);
+    QVERIFY(moved.constData() != nullptr);
+    QVERIFY(moved.isDetached());
+    QCOMPARE(moved.constScanLine(5)[0], wrapped.constScanLine(5)[0]);
+    
+    // 存在视图时不再独占
+    ImageBuffer movedView = moved.view();
+    QVERIFY(!moved.isDetached());
+    movedView = ImageBuffer();
+    QVERIFY(moved.isDetached());
+    
+    // QImage 视图引用同一内存，写入时分离
+    QImage image = rows.toQImageView();
+    QCOMPARE(image.constBits(), rows.constData());
+    image.setPixel(0, 0, qRgb(1, 2, 3));
+    QVERIFY(image.constBits() != rows.constData());
+    QCOMPARE(rows.constScanLine(0)[0], static_cast<quint8>(2 * width * 3));
+    
+    // 释放所有视图后 owner 引用归还
+    wrapped = ImageBuffer();
+    rows = ImageBuffer();
+    QCOMPARE(block.use_count(), 1L);
+}
+
+void TestProcessingPipeline::testOutputDetachedFromViews()
+{
+    const ImageBuffer input = createTestImage(16, 9, PixelFormat::Format3);
+    
+    // 源节点输出的是内部数据的视图，管道结果不得与之共享
+    AdvancedImageProcessor sourceOnly;
+    auto *source = new SourceNode();
+    source->setImageData(input);
+    sourceOnly.addNode(source);
+    ImageBuffer first;
+    QVERIFY(sourceOnly.processImage(ImageBuffer(), first));
+    QVERIFY(first.isDetached());
+    first.scanLine(0)[0] = static_cast<quint8>(~first.scanLine(0)[0]);
+    ImageBuffer second;
+    QVERIFY(sourceOnly.processImage(ImageBuffer(), second));
+    QVERIFY(sameImage(second, input));
+    
+    // 同格式转换直接返回输入视图
+    AdvancedImageProcessor convertOnly;
+    auto *convert = new FormatConvertNode();
+    convert->setTargetFormat(PixelFormat::Format3);
+    convertOnly.addNode(convert);
+    ImageBuffer converted;
+    QVERIFY(convertOnly.processImage(input, converted));
+    QVERIFY(!converted.sharesDataWith(input));
+    QVERIFY(converted.isDetached());
+    
+    // 包装的外部内存即使没有其他引用也要复制
+    std::vector<quint8> external(static_cast<size_t>(input.totalBytes()));
+    std::copy_n(input.constData(), external.size(), external.data());
+    ImageBuffer wrapped = ImageBuffer::wrap(external.data(), input.width(), input.height(), PixelFormat::Format3);
+    ImageBuffer result;
+    QVERIFY(convertOnly.processImage(wrapped, result));
+    QVERIFY(result.constData() != external.data());
+    QVERIFY(result.isDetached());
+}
+
+void TestProcessingPipeline::testStreamingMatchesFrame()
+{
+    const int width = 97;
+    const int height = 131;
+    const ImageBuffer input = createTestImage(width, height, PixelFormat::Format3);
+
+    auto buildPipeline = [](AdvancedImageProcessor *processor, SourceNode *source) {
+        processor->addNode(source);
+
+        auto *shiftNode = new PixelShiftNode();
+        shiftNode->setLineShift(3);
+        processor->addNode(shiftNode);
+
+        auto *noiseNode = new NoiseReductionNode();
+        noiseNode->setNoiseReductionType(NoiseReductionNode::NoiseReductionType::MedianFilter);
+        noiseNode->setStrength(0.5);
+        processor->addNode(noiseNode);
+    };
+
+    // 整帧参考结果
+    AdvancedImageProcessor frameProcessor;
+    auto *frameSource = new SourceNode();
+    frameSource->setImageData(input);
+    buildPipeline(&frameProcessor, frameSource);
+    ImageBuffer expected;
+    QVERIFY(frameProcessor.processImage(ImageBuffer(), expected));
+
+    // 通过行回调逐行供数的流式处理
+    AdvancedImageProcessor streamProcessor;
+    auto *streamSource = new SourceNode();
+    streamSource->setStreamGeometry(width, height, PixelFormat::Format3);
+    streamSource->setRowCallback([&input](int row, quint8 *data) {
+        std::copy_n(input.constScanLine(row), input.bytesPerLine(), data);
+        return true;
+    });
+    buildPipeline(&streamProcessor, streamSource);
+    QVERIFY(streamProcessor.canProcessStreaming());
+
+    // 条带高度小于节点上下文，验证跨条带的上下文缓存
+    ImageBuffer streamed(width, height, PixelFormat::Format3);
+    QVERIFY(runStreaming(streamProcessor, 2, streamed));
+    QVERIFY(sameImage(expected, streamed));
+
+    // 自动白平衡依赖整帧统计，不能流式处理
+    auto *colorNode = new ColorCorrectionNode();
+    colorNode->setAutoWhiteBalance(true);
+    streamProcessor.addNode(colorNode);
+    QVERIFY(!streamProcessor.canProcessStreaming());
+}
+
+void TestProcessingPipeline::testStreamingPlanarStrips()
+{
+    const int width = 45;
+    const int height = 29;
+    const ImageBuffer input = createTestImage(width, height, PixelFormat::Format3);
+
+    // 平面节点输出的条带行跨度按64字节对齐，大于交错行宽
+    auto buildPipeline = [&input](AdvancedImageProcessor *processor) {
+        auto *source = new SourceNode();
+        source->setImageData(input);
+        processor->addNode(source);
+        processor->addNode(new PlanarPassNode());
+
+        auto *noiseNode = new NoiseReductionNode();
+        noiseNode->setNoiseReductionType(NoiseReductionNode::NoiseReductionType::MedianFilter);
+        noiseNode->setStrength(0.5);
+        processor->addNode(noiseNode);
+    };
+
+    AdvancedImageProcessor frameProcessor;
+    buildPipeline(&frameProcessor);
+    ImageBuffer expected;
+    QVERIFY(frameProcessor.processImage(ImageBuffer(), expected));
+
+    for (int stripHeight : {1, 4, 16}) {
+        AdvancedImageProcessor streamProcessor;
+        buildPipeline(&streamProcessor);
+        ImageBuffer streamed(width, height, PixelFormat::Format3);
+        QVERIFY(runStreaming(streamProcessor, stripHeight, streamed));
+        QVERIFY(sameImage(expected, streamed));
+    }
+}
+
+void TestProcessingPipeline::testNoiseReductionStreamingMatchesFrame_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<double>("strength");
+    QTest::addColumn<bool>("fastMode");
+    QTest::addColumn<bool>("streaming");
+
+    using Type = NoiseReductionNode::NoiseReductionType;
+    QTest::newRow("gaussian-low") << static_cast<int>(Type::Gaussian) << 0.2 << false << true;
+    QTest::newRow("gaussian-high") << static_cast<int>(Type::Gaussian) << 1.0 << false << true;
+    QTest::newRow("bilateral") << static_cast<int>(Type::Bilateral) << 0.6 << false << true;
+    QTest::newRow("bilateral-grid") << static_cast<int>(Type::Bilateral) << 0.6 << true << false;
+    QTest::newRow("non-local") << static_cast<int>(Type::NonLocal) << 0.5 << true << true;
+    QTest::newRow("wavelet") << static_cast<int>(Type::Wavelet) << 0.5 << false << false;
+    QTest::newRow("median") << static_cast<int>(Type::MedianFilter) << 1.0 << false << true;
+}
+
+void TestProcessingPipeline::testNoiseReductionStreamingMatchesFrame()
+{
+    QFETCH(int, type);
+    QFETCH(double, strength);
+    QFETCH(bool, fastMode);
+    QFETCH(bool, streaming);
+
+    const int width = 53;
+    const int height = 47;
+    const ImageBuffer input = createTestImage(width, height, PixelFormat::Format3);
+
+    auto buildPipeline = [&](AdvancedImageProcessor *processor) {
+        auto *source = new SourceNode();
+        source->setImageData(input);
+        processor->addNode(source);
+
+        auto *noiseNode = new NoiseReductionNode();
+        noiseNode->setNoiseReductionType(static_cast<NoiseReductionNode::NoiseReductionType>(type));
+        noiseNode->setStrength(strength);
+        noiseNode->setApproximateBilateral(fastMode);
+        noiseNode->setFastNonLocalMeans(fastMode);
+        processor->addNode(noiseNode);
+    };
+
+    AdvancedImageProcessor frameProcessor;
+    buildPipeline(&frameProcessor);
+    ImageBuffer expected;
+    QVERIFY(frameProcessor.processImage(ImageBuffer(), expected));
+
+    AdvancedImageProcessor streamProcessor;
+    buildPipeline(&streamProcessor);
+    QCOMPARE(streamProcessor.canProcessStreaming(), streaming);
+    if (!streaming) {
+        return;
+    }
+
+    // 条带高度小于、等于和大于滤波半径时结果都应与整帧一致
+    for (int stripHeight : {1, 5, 16}) {
+        ImageBuffer streamed(width, height, PixelFormat::Format3);
+        QVERIFY(runStreaming(streamProcessor, stripHeight, streamed));
+        QVERIFY2(sameImage(expected, streamed), qPrintable(QString("strip height %1").arg(stripHeight)));
+    }
+}
+
+void TestProcessingPipeline::testBatchSIMDMatchesSingleImages()
+{
+    QList<QImage> images;
+    for (const QSize &size : {QSize(31, 17), QSize(8, 8), QSize(), QSize(64, 41)}) {
+        QImage image;
+        if (!size.isEmpty()) {
+            image = QImage(size, QImage::Format_RGB32);
+            for (int y = 0; y < size.height(); ++y) {
+                for (int x = 0; x < size.width(); ++x) {
+                    image.setPixel(x, y, qRgb((x * 7 + y) & 0xFF, (y * 11) & 0xFF, (x * y) & 0xFF));
+                }
+            }
+        }
+        images.append(image);
+    }
+
+    AdvancedImageProcessor::ProcessingParameters params;
+    params.brightness = 20.0;
+    params.contrast = -15.0;
+
+    // 批量任务经调度器分派到各工作线程，结果顺序与空图像位置保持不变
+    AdvancedImageProcessor processor;
+    const QList<QImage> results = processor.processBatchSIMD(images, params).result();
+    QCOMPARE(results.size(), images.size());
+    for (int i = 0; i < images.size(); ++i) {
+        if (images[i].isNull()) {
+            QVERIFY(results[i].isNull());
+        } else {
+            QVERIFY2(results[i] == processor.processImageWithSIMD(images[i], params), qPrintable(QString("image %1").arg(i)));
+        }
+    }
+}
+
+void TestProcessingPipeline::testImageBufferPlanarLayout()
+{
+    ImageBuffer interleaved(37, 5, PixelFormat::Format3);
+    for (int y = 0; y < interleaved.height(); ++y) {
+        for (int x = 0; x < interleaved.width() * 3; ++x) {
+            interleaved.scanLine(y)[x] = static_cast<quint8>(x * 7 + y * 13);
+        }
+    }
+
+    // 拆分为64字节对齐的平面，交错行访问不可用
+    ImageBuffer planar = interleaved.toPlanar();
+    QVERIFY(planar.isPlanar());
+    QCOMPARE(planar.bytesPerLine(), 64);
+    QVERIFY(planar.constScanLine(0) == nullptr);
+    for (int c = 0; c < 3; ++c) {
+        QCOMPARE(reinterpret_cast<quintptr>(planar.constPlaneLine(c, 3)) % 64, quintptr(0));
+    }
+    QCOMPARE(planar.constPlaneLine(1, 3)[5], interleaved.constScanLine(3)[5 * 3 + 1]);
+    QCOMPARE(planar.getPixel<PixelFormat::Format3>(5, 3).b, interleaved.constScanLine(3)[5 * 3 + 2]);
+
+    // 单个平面是零拷贝的单通道缓冲区
+    ImageBuffer green = planar.planeView(1);
+    QCOMPARE(green.format(), PixelFormat::Format1);
+    QVERIFY(green.sharesDataWith(planar));
+    QCOMPARE(green.constScanLine(4), planar.constPlaneLine(1, 4));
+
+    // 合并回交错布局后内容一致
+    ImageBuffer merged = planar.toInterleaved();
+    for (int y = 0; y < merged.height(); ++y) {
+        QVERIFY(std::equal(merged.constScanLine(y), merged.constScanLine(y) + 37 * 3, interleaved.constScanLine(y)));
+    }
+
+    // 16位格式以本机字节序按通道存储
+    ImageBuffer raw(9, 4, PixelFormat::Raw16Bit, ImageBuffer::Layout::Planar);
+    QCOMPARE(raw.bytesPerSample(), 2);
+    raw.setRawPixel<PixelFormat::Raw16Bit>(4, 2, RawPixel(1000, 40000, 65535));
+    QCOMPARE(reinterpret_cast<const quint16 *>(raw.constPlaneLine(1, 2))[4], quint16(40000));
+    QCOMPARE(raw.planeView(2).format(), PixelFormat::Gray16);
+    QCOMPARE(raw.toInterleaved().getRawPixel<PixelFormat::Raw16Bit>(4, 2).channels[2], quint16(65535));
+
+    // 单通道在两种布局间转换不复制数据
+    ImageBuffer gray(10, 3, PixelFormat::Format1);
+    QVERIFY(gray.toPlanar().sharesDataWith(gray));
+    QVERIFY(gray.toPlanar().toInterleaved().sharesDataWith(gray));
+}
+
+DSCANNER_END_NAMESPACE
+
+QTEST_MAIN(Dtk::Scanner::TestProcessingPipeline)
+#include "test_processing_pipeline.moc"
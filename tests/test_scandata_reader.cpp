@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+
+#include <cstring>
+
+#include "Scanner/DScannerDriver.h"
+#include "scandata_reader.h"
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+// 按块提供固定扫描数据的驱动；directRead 为false时只实现 readScanData()
+class FakeScanDriver : public DScannerDriver
+{
+public:
+    FakeScanDriver(const QByteArray &data, int chunkSize, bool directRead)
+        : m_data(data)
+        , m_chunkSize(chunkSize)
+        , m_directRead(directRead)
+    {
+    }
+
+    int readScanDataCalls = 0;
+    int directReadCalls = 0;
+    int failAt = -1;            // 读取位置到达此处时直接读取返回错误
+
+    bool supportsDirectRead() const override { return m_directRead; }
+
+    qint64 readScanDataInto(quint8 *buffer, qint64 maxLength) override
+    {
+        if (!m_directRead) {
+            return DScannerDriver::readScanDataInto(buffer, maxLength);
+        }
+        ++directReadCalls;
+        if (m_position == failAt) {
+            return -1;
+        }
+        const int count = static_cast<int>(qMin<qint64>(maxLength, nextChunkSize()));
+        std::memcpy(buffer, m_data.constData() + m_position, count);
+        m_position += count;
+        return count;
+    }
+
+    QByteArray readScanData() override
+    {
+        ++readScanDataCalls;
+        const int count = nextChunkSize();
+        const QByteArray chunk = m_data.mid(m_position, count);
+        m_position += count;
+        return chunk;
+    }
+
+    QString driverName() const override { return QStringLiteral("Fake"); }
+    QString driverVersion() const override { return QStringLiteral("1.0"); }
+    DriverType driverType() const override { return DriverType::Generic; }
+    QStringList supportedManufacturers() const override { return QStringList(); }
+    QStringList supportedModels() const override { return QStringList(); }
+    QStringList supportedDevices() const override { return QStringList(); }
+    bool initialize() override { return true; }
+    void shutdown() override {}
+    bool detectDevice(const USBDeviceInfo &) const override { return false; }
+    QList<DeviceInfo> discoverDevices() override { return QList<DeviceInfo>(); }
+    DeviceInfo deviceInfoFromUSB(const USBDeviceInfo &) const override { return DeviceInfo(); }
+    QList<DeviceInfo> discoverDevices() const override { return QList<DeviceInfo>(); }
+    bool isDeviceSupported(const DeviceInfo &) override { return false; }
+    bool openDevice(const QString &) override { return true; }
+    bool connectDevice(const DeviceInfo &) override { return true; }
+    void closeDevice() override {}
+    void disconnectDevice() override {}
+    bool isDeviceOpen() const override { return true; }
+    bool isConnected() const override { return true; }
+    QString currentDeviceName() const override { return QStringLiteral("fake"); }
+    bool resetDevice() override { return true; }
+    ScannerCapabilities getCapabilities() const override { return ScannerCapabilities(); }
+    ScanParameters getScanParameters() const override { return ScanParameters(); }
+    DeviceInfo getCurrentDeviceInfo() const override { return DeviceInfo(); }
+    QVariantMap getDeviceCapabilities() const override { return QVariantMap(); }
+    QStringList getSupportedOptions() const override { return QStringList(); }
+    QVariant getOptionValue(const QString &) const override { return QVariant(); }
+    bool setOptionValue(const QString &, const QVariant &) override { return false; }
+    ScannerStatus getStatus() const override { return ScannerStatus(); }
+    bool isReady() const override { return true; }
+    bool setScanParameters(const ScanParameters &) override { return true; }
+    bool startScan() override { return true; }
+    bool startScan(const ScanParameters &) override { return true; }
+    void cancelScan() override {}
+    void cleanup() override {}
+    void stopScan() override {}
+    bool pauseScan() override { return false; }
+    bool resumeScan() override { return false; }
+    int getScanProgress() const override { return 0; }
+    bool isScanning() const override { return m_position < m_data.size(); }
+    bool isScanComplete() const override { return m_position >= m_data.size(); }
+    QImage getScanData() override { return QImage(); }
+    QImage getPreview() override { return QImage(); }
+    bool calibrateDevice() override { return false; }
+    bool setParameter(const QString &, const QVariant &) override { return false; }
+    QVariant getParameter(const QString &) const override { return QVariant(); }
+    QStringList getParameterNames() const override { return QStringList(); }
+    QString lastError() const override { return QString(); }
+
+private:
+    int nextChunkSize() const { return qMin(m_chunkSize, m_data.size() - m_position); }
+
+    QByteArray m_data;
+    int m_position = 0;
+    int m_chunkSize;
+    bool m_directRead;
+};
+
+QByteArray scanData(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(i * 7 + 3);
+    }
+    return data;
+}
+
+} // namespace
+
+class TestScanDataReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDirectReadFillsCallerMemory();
+    void testFallbackKeepsPendingData();
+    void testDirectReadError();
+    void testDefaultDriverHasNoDirectRead();
+    void testInvalidArguments();
+};
+
+void TestScanDataReader::testDirectReadFillsCallerMemory()
+{
+    const QByteArray data = scanData(1000);
+    FakeScanDriver driver(data, 96, true);
+    ScanDataReader reader(&driver);
+
+    // 驱动每次只写入一部分，读取器循环直到填满
+    QByteArray target(600, '\0');
+    QCOMPARE(reader.read(reinterpret_cast<quint8 *>(target.data()), target.size()), qint64(600));
+    QCOMPARE(target, data.left(600));
+    QVERIFY(driver.directReadCalls > 1);
+    QCOMPARE(driver.readScanDataCalls, 0);
+    QCOMPARE(reader.copiedBytes(), qint64(0));
+    QVERIFY(!reader.atEnd());
+
+    // 扫描结束时返回剩余字节，之后返回0
+    QByteArray rest(600, '\0');
+    QCOMPARE(reader.read(reinterpret_cast<quint8 *>(rest.data()), rest.size()), qint64(400));
+    QCOMPARE(rest.left(400), data.mid(600));
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.read(reinterpret_cast<quint8 *>(rest.data()), rest.size()), qint64(0));
+    QCOMPARE(driver.readScanDataCalls, 0);
+}
+
+void TestScanDataReader::testFallbackKeepsPendingData()
+{
+    const QByteArray data = scanData(900);
+    FakeScanDriver driver(data, 300, false);
+    ScanDataReader reader(&driver);
+
+    QByteArray result;
+    QByteArray block(200, '\0');
+    quint8 *blockData = reinterpret_cast<quint8 *>(block.data());
+
+    // 第一块300字节：读取200，剩余100暂存
+    QCOMPARE(reader.read(blockData, 200), qint64(200));
+    result.append(block);
+    QCOMPARE(driver.readScanDataCalls, 1);
+
+    // 先取出暂存的100字节，再从下一块读取100
+    QCOMPARE(reader.read(blockData, 200), qint64(200));
+    result.append(block);
+    QCOMPARE(driver.readScanDataCalls, 2);
+
+    qint64 count = 0;
+    while ((count = reader.read(blockData, 200)) > 0) {
+        result.append(block.left(static_cast<int>(count)));
+    }
+    QCOMPARE(count, qint64(0));
+    QVERIFY(reader.atEnd());
+    QCOMPARE(result, data);
+
+    // 回退路径每个字节都经过一次复制
+    QCOMPARE(reader.copiedBytes(), qint64(data.size()));
+    QCOMPARE(driver.directReadCalls, 0);
+}
+
+void TestScanDataReader::testDirectReadError()
+{
+    const QByteArray data = scanData(400);
+    FakeScanDriver driver(data, 100, true);
+    driver.failAt = 200;
+    ScanDataReader reader(&driver);
+
+    // 出错前已写入的数据仍然返回
+    QByteArray target(400, '\0');
+    QCOMPARE(reader.read(reinterpret_cast<quint8 *>(target.data()), target.size()), qint64(200));
+    QCOMPARE(target.left(200), data.left(200));
+
+    // 没有数据时报告错误
+    QCOMPARE(reader.read(reinterpret_cast<quint8 *>(target.data()), target.size()), qint64(-1));
+    QVERIFY(!reader.atEnd());
+}
+
+void TestScanDataReader::testDefaultDriverHasNoDirectRead()
+{
+    const QByteArray data = scanData(64);
+    FakeScanDriver driver(data, 64, false);
+
+    // 基类默认不支持直接读取
+    QVERIFY(!driver.supportsDirectRead());
+    quint8 buffer[64];
+    QCOMPARE(driver.readScanDataInto(buffer, sizeof(buffer)), qint64(-1));
+
+    ScanDataReader reader(&driver);
+    QCOMPARE(reader.read(buffer, sizeof(buffer)), qint64(64));
+    QCOMPARE(QByteArray(reinterpret_cast<const char *>(buffer), sizeof(buffer)), data);
+    QCOMPARE(driver.readScanDataCalls, 1);
+}
+
+void TestScanDataReader::testInvalidArguments()
+{
+    FakeScanDriver driver(scanData(16), 16, true);
+    quint8 buffer[16];
+
+    QCOMPARE(ScanDataReader(nullptr).read(buffer, sizeof(buffer)), qint64(-1));
+    ScanDataReader reader(&driver);
+    QCOMPARE(reader.read(nullptr, 16), qint64(-1));
+    QCOMPARE(reader.read(buffer, 0), qint64(-1));
+    QCOMPARE(driver.directReadCalls, 0);
+}
+
+QTEST_MAIN(TestScanDataReader)
+#include "test_scandata_reader.moc"
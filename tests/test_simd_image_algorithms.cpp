@@ -0,0 +1,290 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QObject>
+#include <QImage>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "simd_image_algorithms.h"
+
+namespace {
+
+QImage createTestImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            line[x] = qRgb((x * 255) / width, (y * 255) / height, ((x / 24 + y / 24) % 2) * 255);
+        }
+    }
+    return image;
+}
+
+// 截断核直接卷积，边界复制，作为递归滤波的参考
+QImage directGaussianReference(const QImage &image, int radius, double sigma)
+{
+    std::vector<double> kernel(2 * radius + 1);
+    double sum = 0.0;
+    for (int k = -radius; k <= radius; ++k) {
+        kernel[k + radius] = std::exp(-(k * k) / (2.0 * sigma * sigma));
+        sum += kernel[k + radius];
+    }
+    for (double &value : kernel) {
+        value /= sum;
+    }
+
+    const int width = image.width();
+    const int height = image.height();
+    std::vector<double> temp(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        const uchar *src = image.constScanLine(y);
+        for (int x = 0; x < width * 4; ++x) {
+            double value = 0.0;
+            for (int k = -radius; k <= radius; ++k) {
+                value += kernel[k + radius] * src[qBound(0, x / 4 + k, width - 1) * 4 + x % 4];
+            }
+            temp[static_cast<size_t>(y) * width * 4 + x] = value;
+        }
+    }
+
+    QImage result(image.size(), QImage::Format_ARGB32);
+    for (int y = 0; y < height; ++y) {
+        uchar *dst = result.scanLine(y);
+        for (int x = 0; x < width * 4; ++x) {
+            double value = 0.0;
+            for (int k = -radius; k <= radius; ++k) {
+                value += kernel[k + radius] * temp[static_cast<size_t>(qBound(0, y + k, height - 1)) * width * 4 + x];
+            }
+            dst[x] = static_cast<uchar>(qBound(0.0, value + 0.5, 255.0));
+        }
+    }
+    return result;
+}
+
+// 奇数宽度、奇数行跨度，数据整体偏移1字节，行首和行尾都不落在向量边界上
+const int kPlaneWidth = 37;
+const int kPlaneHeight = 23;
+const int kPlaneBytesPerPixel = 3;
+const int kPlaneStride = kPlaneWidth * kPlaneBytesPerPixel + 1;
+
+std::vector<quint8> createUnalignedPlane()
+{
+    std::vector<quint8> plane(1 + static_cast<size_t>(kPlaneStride) * kPlaneHeight, 0);
+    for (int y = 0; y < kPlaneHeight; ++y) {
+        quint8 *line = plane.data() + 1 + y * kPlaneStride;
+        for (int x = 0; x < kPlaneWidth * kPlaneBytesPerPixel; ++x) {
+            line[x] = static_cast<quint8>((x * 29 + y * 53 + (x * y) % 17) & 0xFF);
+        }
+    }
+    return plane;
+}
+
+struct KernelOutput {
+    QString name;
+    std::vector<double> values;
+    double tolerance;  // 浮点内核在FMA版本中舍入可能不同
+};
+
+template<typename T>
+void appendValues(std::vector<double> &values, const T *data, int count)
+{
+    values.insert(values.end(), data, data + count);
+}
+
+std::vector<double> planeValues(const std::vector<quint8> &plane)
+{
+    std::vector<double> values;
+    for (int y = 0; y < kPlaneHeight; ++y) {
+        appendValues(values, plane.data() + 1 + y * kPlaneStride, kPlaneWidth * kPlaneBytesPerPixel);
+    }
+    return values;
+}
+
+std::vector<double> imageValues(const QImage &image)
+{
+    std::vector<double> values;
+    for (int y = 0; y < image.height(); ++y) {
+        appendValues(values, image.constScanLine(y), image.width() * image.depth() / 8);
+    }
+    return values;
+}
+
+// 用当前内核版本运行每个分派内核的公开入口
+QVector<KernelOutput> runDispatchedKernels()
+{
+    QVector<KernelOutput> outputs;
+    const std::vector<quint8> plane = createUnalignedPlane();
+    const quint8 *src = plane.data() + 1;
+    std::vector<quint8> result(plane.size(), 0);
+    quint8 *dst = result.data() + 1;
+
+    SIMDImageAlgorithms::gaussianBlur8(src, kPlaneStride, dst, kPlaneStride, kPlaneWidth, kPlaneHeight,
+                                       kPlaneBytesPerPixel, kPlaneBytesPerPixel, 1.5, 4);
+    outputs.append({"gaussianBlur8 直接卷积", planeValues(result), 1.0});
+    SIMDImageAlgorithms::gaussianBlur8(src, kPlaneStride, dst, kPlaneStride, kPlaneWidth, kPlaneHeight,
+                                       kPlaneBytesPerPixel, kPlaneBytesPerPixel, 8.0, 24);
+    outputs.append({"gaussianBlur8 递归滤波", planeValues(result), 1.0});
+    SIMDImageAlgorithms::nonLocalMeans8(src, kPlaneStride, dst, kPlaneStride, kPlaneWidth, kPlaneHeight,
+                                        kPlaneBytesPerPixel, kPlaneBytesPerPixel, 1, 3, 12.0);
+    outputs.append({"nonLocalMeans8", planeValues(result), 0.0});
+    SIMDImageAlgorithms::waveletDenoise8(src, kPlaneStride, dst, kPlaneStride, kPlaneWidth, kPlaneHeight,
+                                         kPlaneBytesPerPixel, kPlaneBytesPerPixel, 3, 1.5);
+    outputs.append({"waveletDenoise8", planeValues(result), 1.0});
+
+    const QImage image = createTestImage(kPlaneWidth, kPlaneHeight);
+    outputs.append({"adjustBrightnessSIMD", imageValues(SIMDImageAlgorithms::adjustBrightnessSIMD(image, 1.3)), 0.0});
+    outputs.append({"convertToGrayscaleSIMD", imageValues(SIMDImageAlgorithms::convertToGrayscaleSIMD(image)), 0.0});
+    for (int channel = -1; channel < 3; ++channel) {
+        const QVector<int> histogram = SIMDImageAlgorithms::calculateHistogramSIMD(image, channel);
+        std::vector<double> values;
+        appendValues(values, histogram.constData(), histogram.size());
+        outputs.append({QString("calculateHistogramSIMD 通道%1").arg(channel), values, 0.0});
+    }
+
+    // 逐行内核：长度覆盖各向量宽度的整倍数与余数，指针偏移一个元素
+    std::vector<double> shifted;
+    std::vector<double> shaded8;
+    std::vector<double> shaded16;
+    std::vector<double> matrixed;
+    const qint16 coeffs[3][4] = {{3277, 1229, -410, 2048}, {-819, 4506, 410, 2048}, {205, -1229, 5120, 2048}};
+    for (int count : {1, 3, 7, 15, 17, 31, 33, 63, 65, 67}) {
+        std::vector<float> above(count + 2);
+        std::vector<float> below(count + 2);
+        std::vector<float> out(count + 1);
+        std::vector<quint8> samples8(count + 1);
+        std::vector<quint8> corrected8(count + 1);
+        std::vector<quint16> samples16(count + 1);
+        std::vector<quint16> corrected16(count + 1);
+        std::vector<quint16> offset(count + 1);
+        std::vector<quint16> gain(count + 1);
+        for (int i = 0; i <= count; ++i) {
+            above[i] = (i * 37 % 251) * 0.75f;
+            below[i] = (i * 91 % 241) * 1.25f;
+            samples8[i] = static_cast<quint8>(i * 73 + count);
+            samples16[i] = static_cast<quint16>(i * 4099 + count * 17);
+            offset[i] = static_cast<quint16>(i % 13);
+            gain[i] = static_cast<quint16>(3000 + i * 211 % 5000);
+        }
+        above[count + 1] = 3.0f;
+        below[count + 1] = 5.0f;
+
+        const float weights[4] = {0.42f, 0.18f, 0.28f, 0.12f};
+        SIMDImageAlgorithms::bilinearShiftRow(above.data() + 1, below.data() + 1, weights, out.data() + 1, count);
+        appendValues(shifted, out.data() + 1, count);
+        SIMDImageAlgorithms::shadingCorrectRow8(samples8.data() + 1, offset.data() + 1, gain.data() + 1,
+                                                corrected8.data() + 1, count);
+        appendValues(shaded8, corrected8.data() + 1, count);
+        SIMDImageAlgorithms::shadingCorrectRow16(samples16.data() + 1, offset.data() + 1, gain.data() + 1,
+                                                 corrected16.data() + 1, count);
+        appendValues(shaded16, corrected16.data() + 1, count);
+
+        for (int bytesPerPixel : {3, 4}) {
+            std::vector<quint8> pixels(count * bytesPerPixel + 1);
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                pixels[i] = static_cast<quint8>(i * 59 + count * 7);
+            }
+            std::vector<quint8> planes(3 * (count + 1));
+            quint8 *const planePointers[3] = {planes.data() + 1, planes.data() + count + 2, planes.data() + 2 * count + 3};
+            SIMDImageAlgorithms::colorMatrixRow(pixels.data() + 1, bytesPerPixel, coeffs, 12, planePointers, count);
+            for (quint8 *plane : planePointers) {
+                appendValues(matrixed, plane, count);
+            }
+        }
+    }
+    outputs.append({"bilinearShiftRow", shifted, 1e-3});
+    outputs.append({"shadingCorrectRow8", shaded8, 0.0});
+    outputs.append({"shadingCorrectRow16", shaded16, 0.0});
+    outputs.append({"colorMatrixRow", matrixed, 0.0});
+    return outputs;
+}
+
+// 测试结束时恢复原来的内核版本
+class KernelSetGuard
+{
+public:
+    KernelSetGuard() : m_kernelSet(SIMDImageAlgorithms::activeKernelSet()) {}
+    ~KernelSetGuard() { SIMDImageAlgorithms::setActiveKernelSet(m_kernelSet); }
+
+private:
+    QString m_kernelSet;
+};
+
+}
+
+class TestSIMDImageAlgorithms : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testGaussianBlurLargeRadius();
+    void testKernelSetsMatchGeneric();
+};
+
+void TestSIMDImageAlgorithms::testGaussianBlurLargeRadius()
+{
+    // 大半径走递归滤波，结果应与截断核直接卷积一致（允许近似误差）
+    const int largeRadius = 30;
+    const double largeSigma = 10.0;
+
+    // 行数不是8的倍数，横向分组转置留下不足8行的尾部
+    const QImage image = createTestImage(157, 93);
+    const QImage reference = directGaussianReference(image, largeRadius, largeSigma);
+    const QImage blurred = SIMDImageAlgorithms::gaussianBlurSIMD(image, largeRadius, largeSigma);
+
+    QCOMPARE(blurred.size(), reference.size());
+    qint64 totalDiff = 0;
+    int maxDiff = 0;
+    for (int y = 0; y < blurred.height(); ++y) {
+        const uchar *a = blurred.constScanLine(y);
+        const uchar *b = reference.constScanLine(y);
+        for (int x = 0; x < blurred.width() * 4; ++x) {
+            const int diff = qAbs(a[x] - b[x]);
+            totalDiff += diff;
+            maxDiff = qMax(maxDiff, diff);
+        }
+    }
+    QVERIFY(maxDiff <= 8);
+    QVERIFY(totalDiff < static_cast<qint64>(blurred.width()) * blurred.height() * 4);
+}
+
+void TestSIMDImageAlgorithms::testKernelSetsMatchGeneric()
+{
+    const QStringList kernelSets = SIMDImageAlgorithms::supportedKernelSets();
+    QCOMPARE(kernelSets.first(), QString("Generic"));
+    QVERIFY(kernelSets.contains(SIMDImageAlgorithms::activeKernelSet()));
+
+    KernelSetGuard guard;
+    QVERIFY(!SIMDImageAlgorithms::setActiveKernelSet("NoSuchKernels"));
+    QVERIFY(SIMDImageAlgorithms::setActiveKernelSet("Generic"));
+    const QVector<KernelOutput> reference = runDispatchedKernels();
+
+    for (const QString &kernelSet : kernelSets) {
+        QVERIFY(SIMDImageAlgorithms::setActiveKernelSet(kernelSet));
+        QCOMPARE(SIMDImageAlgorithms::activeKernelSet(), kernelSet);
+
+        const QVector<KernelOutput> outputs = runDispatchedKernels();
+        QCOMPARE(outputs.size(), reference.size());
+        for (int i = 0; i < outputs.size(); ++i) {
+            const KernelOutput &expected = reference.at(i);
+            const std::vector<double> &actual = outputs.at(i).values;
+            QCOMPARE(actual.size(), expected.values.size());
+            double maxDiff = 0.0;
+            for (size_t k = 0; k < actual.size(); ++k) {
+                maxDiff = std::max(maxDiff, std::fabs(actual[k] - expected.values[k]));
+            }
+            QVERIFY2(maxDiff <= expected.tolerance,
+                     qPrintable(QString("%1 %2 最大误差 %3").arg(kernelSet, expected.name).arg(maxDiff)));
+        }
+    }
+}
+
+QTEST_MAIN(TestSIMDImageAlgorithms)
+#include "test_simd_image_algorithms.moc"
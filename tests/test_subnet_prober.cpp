@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2024-2025 eric2023
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QNetworkInterface>
+
+#include "network/network_discovery_tasks_p.h"
+
+DSCANNER_USE_NAMESPACE
+
+namespace {
+
+// 监听后立即关闭，得到一个本机上没有服务的端口
+quint16 closedPort()
+{
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost)) {
+        return 0;
+    }
+    const quint16 port = server.serverPort();
+    server.close();
+    return port;
+}
+
+QNetworkAddressEntry makeEntry(const QString &ip, int prefixLength)
+{
+    QNetworkAddressEntry entry;
+    entry.setIp(QHostAddress(ip));
+    entry.setPrefixLength(prefixLength);
+    return entry;
+}
+
+} // namespace
+
+class TestSubnetProber : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testOpenAndClosedPorts();
+    void testTimeoutBounds();
+    void testConcurrencyCap();
+    void testSubnetHostsCap();
+};
+
+void TestSubnetProber::testOpenAndClosedPorts()
+{
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    const quint16 openPort = server.serverPort();
+    const quint16 refusedPort = closedPort();
+    QVERIFY(refusedPort != 0);
+
+    SubnetProber prober;
+    QSignalSpy opened(&prober, &SubnetProber::portOpen);
+    QSignalSpy finished(&prober, &SubnetProber::finished);
+
+    prober.start({QHostAddress(QHostAddress::LocalHost)}, {openPort, refusedPort});
+    QVERIFY(prober.isRunning());
+    QTRY_COMPARE(finished.size(), 1);
+    QVERIFY(!prober.isRunning());
+    QCOMPARE(prober.inFlightCount(), 0);
+
+    // 只有监听中的端口被报告，被拒绝的连接不算超时
+    QCOMPARE(opened.size(), 1);
+    QCOMPARE(opened.at(0).at(0).value<QHostAddress>(), QHostAddress(QHostAddress::LocalHost));
+    QCOMPARE(opened.at(0).at(1).value<quint16>(), openPort);
+    QCOMPARE(prober.timeoutCount(), 0);
+
+    // 没有目标时立即结束
+    prober.start({}, {openPort});
+    QVERIFY(!prober.isRunning());
+    QCOMPARE(finished.size(), 2);
+}
+
+void TestSubnetProber::testTimeoutBounds()
+{
+    SubnetProber prober;
+
+    // 尚无RTT样本时使用上限
+    QCOMPARE(prober.currentTimeout(), 1000);
+    prober.setTimeoutBounds(20, 400);
+    QCOMPARE(prober.currentTimeout(), 400);
+
+    // 上限不低于下限，下限至少1毫秒
+    prober.setTimeoutBounds(300, 100);
+    QCOMPARE(prober.currentTimeout(), 300);
+    prober.setTimeoutBounds(0, 0);
+    QCOMPARE(prober.currentTimeout(), 1);
+
+    // 回环地址的RTT远低于下限，超时收紧到下限
+    const quint16 refusedPort = closedPort();
+    QVERIFY(refusedPort != 0);
+    prober.setTimeoutBounds(20, 400);
+    QSignalSpy finished(&prober, &SubnetProber::finished);
+    prober.start({QHostAddress(QHostAddress::LocalHost)}, {refusedPort});
+    QTRY_COMPARE(finished.size(), 1);
+    QCOMPARE(prober.currentTimeout(), 20);
+
+    // 新一轮探测重新从上限开始
+    prober.start({QHostAddress(QHostAddress::LocalHost)}, {refusedPort});
+    QCOMPARE(prober.currentTimeout(), 400);
+    QTRY_COMPARE(finished.size(), 2);
+}
+
+void TestSubnetProber::testConcurrencyCap()
+{
+    const quint16 refusedPort = closedPort();
+    QVERIFY(refusedPort != 0);
+    const QList<QHostAddress> hosts(300, QHostAddress(QHostAddress::LocalHost));
+
+    SubnetProber prober;
+    QCOMPARE(prober.maxInFlight(), 256);
+
+    // 同时在途的连接不超过上限，其余目标在有连接结束后补上
+    QSignalSpy finished(&prober, &SubnetProber::finished);
+    prober.start(hosts, {refusedPort});
+    QCOMPARE(prober.inFlightCount(), 256);
+    QTRY_COMPARE(finished.size(), 1);
+    QCOMPARE(prober.inFlightCount(), 0);
+    QCOMPARE(prober.timeoutCount(), 0);
+
+    prober.setMaxInFlight(8);
+    prober.start(hosts, {refusedPort});
+    QCOMPARE(prober.inFlightCount(), 8);
+    QTRY_COMPARE(finished.size(), 2);
+
+    // 上限至少为1
+    prober.setMaxInFlight(0);
+    QCOMPARE(prober.maxInFlight(), 1);
+}
+
+void TestSubnetProber::testSubnetHostsCap()
+{
+    // /16 只取本机所在的 /22：10.1.0.0 - 10.1.3.255，去掉网络、广播地址和本机
+    const QList<QHostAddress> capped = SubnetProber::subnetHosts(makeEntry(QStringLiteral("10.1.2.3"), 16));
+    QCOMPARE(capped.size(), 1021);
+    QCOMPARE(capped.first(), QHostAddress(QStringLiteral("10.1.0.1")));
+    QCOMPARE(capped.last(), QHostAddress(QStringLiteral("10.1.3.254")));
+    QVERIFY(!capped.contains(QHostAddress(QStringLiteral("10.1.2.3"))));
+    for (const QHostAddress &host : capped) {
+        QVERIFY(host.isInSubnet(QHostAddress(QStringLiteral("10.1.0.0")), 22));
+    }
+
+    QCOMPARE(SubnetProber::subnetHosts(makeEntry(QStringLiteral("10.1.2.3"), 16), 24).size(), 253);
+    QCOMPARE(SubnetProber::subnetHosts(makeEntry(QStringLiteral("192.168.1.10"), 24)).size(), 253);
+
+    const QList<QHostAddress> pointToPoint = SubnetProber::subnetHosts(makeEntry(QStringLiteral("192.168.1.1"), 30));
+    QCOMPARE(pointToPoint, QList<QHostAddress>({QHostAddress(QStringLiteral("192.168.1.2"))}));
+
+    QVERIFY(SubnetProber::subnetHosts(makeEntry(QStringLiteral("192.168.1.1"), 31)).isEmpty());
+    QVERIFY(SubnetProber::subnetHosts(makeEntry(QStringLiteral("fe80::1"), 64)).isEmpty());
+}
+
+QTEST_MAIN(TestSubnetProber)
+#include "test_subnet_prober.moc"